@@ -294,6 +294,19 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
 	}
 
 	scan->rs_numblocks = InvalidBlockNumber;
+
+	/*
+	 * Plain serial seqscans prefetch ahead of their reads, if configured.
+	 * Bitmap scans do their own prefetching, and the blocks a sample scan or
+	 * a participant in a parallel scan will read next aren't known.
+	 */
+	if (!scan->rs_bitmapscan && !scan->rs_samplescan &&
+		scan->rs_parallel == NULL)
+		scan->rs_prefetch_target = sequential_prefetch_size;
+	else
+		scan->rs_prefetch_target = 0;
+	scan->rs_prefetch_next = 0;
+
 	scan->rs_inited = false;
 	scan->rs_ctup.t_data = NULL;
 	ItemPointerSetInvalid(&scan->rs_ctup.t_self);
@@ -336,6 +349,48 @@ heap_setscanlimits(HeapScanDesc scan, BlockNumber startBlk, BlockNumber numBlks)
 	scan->rs_numblocks = numBlks;
 }
 
+/*
+ * heapgetpage_prefetch - subroutine for heapgetpage()
+ *
+ * Prefetch the blocks that a forward seqscan currently at "page" will read
+ * next.  To let the kernel merge them into fewer and larger reads, we don't
+ * prefetch one block at a time, but wait until only half of the prefetch
+ * distance is left and then request the next half in one go.
+ */
+static void
+heapgetpage_prefetch(HeapScanDesc scan, BlockNumber page)
+{
+	BlockNumber total;
+	BlockNumber pos;
+	BlockNumber start;
+	BlockNumber end;
+
+	/* number of blocks this scan will read in all */
+	total = scan->rs_nblocks;
+	if (scan->rs_numblocks != InvalidBlockNumber)
+		total = Min(total, scan->rs_numblocks);
+
+	/* position of the current page in the scan, which may have wrapped */
+	pos = (page + scan->rs_nblocks - scan->rs_startblock) % scan->rs_nblocks;
+
+	if (scan->rs_prefetch_next > pos + scan->rs_prefetch_target / 2)
+		return;
+
+	start = Max(scan->rs_prefetch_next, pos + 1);
+	end = Min(pos + 1 + scan->rs_prefetch_target, total);
+
+	while (start < end)
+	{
+		BlockNumber blk = (scan->rs_startblock + start) % scan->rs_nblocks;
+		BlockNumber n = Min(end - start, scan->rs_nblocks - blk);
+
+		PrefetchBufferRange(scan->rs_rd, MAIN_FORKNUM, blk, n);
+		start += n;
+	}
+
+	scan->rs_prefetch_next = Max(scan->rs_prefetch_next, end);
+}
+
 /*
  * heapgetpage - subroutine for heapgettup()
  *
@@ -371,6 +426,10 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
 	 */
 	CHECK_FOR_INTERRUPTS();
 
+	/* get the kernel started on the pages after this one, if wanted */
+	if (scan->rs_prefetch_target > 0)
+		heapgetpage_prefetch(scan, page);
+
 	/* read page using selected strategy */
 	scan->rs_cbuf = ReadBufferExtended(scan->rs_rd, MAIN_FORKNUM, page,
 									   RBM_NORMAL, scan->rs_strategy);
@@ -125,6 +125,9 @@ RelationGetIndexScan(Relation indexRelation, int nkeys, int norderbys)
 	scan->xs_cbuf = InvalidBuffer;
 	scan->xs_continue_hot = false;
 
+	scan->parallel_scan = NULL;
+	scan->xs_temp_snap = false;
+
 	return scan;
 }
 
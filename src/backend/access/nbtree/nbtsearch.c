@@ -30,6 +30,10 @@ static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir,
 static void _bt_saveitem(BTScanOpaque so, int itemIndex,
 			 OffsetNumber offnum, IndexTuple itup);
 static bool _bt_steppage(IndexScanDesc scan, ScanDirection dir);
+static bool _bt_readnextpage(IndexScanDesc scan, BlockNumber blkno,
+				 ScanDirection dir);
+static bool _bt_parallel_readpage(IndexScanDesc scan, BlockNumber blkno,
+					  ScanDirection dir);
 static Buffer _bt_walk_left(Relation rel, Buffer buf, Snapshot snapshot);
 static bool _bt_endpoint(IndexScanDesc scan, ScanDirection dir);
 static void _bt_drop_lock_and_maybe_pin(IndexScanDesc scan, BTScanPos sp);
@@ -564,6 +568,35 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 	if (!so->qual_ok)
 		return false;
 
+	/*
+	 * For parallel scans, get the starting page from shared state.  If the
+	 * scan has not started, proceed to find out the first leaf page in the
+	 * usual way while keeping other participating processes waiting.  If the
+	 * scan has already begun, use the page number from the shared structure.
+	 * Only forward scans are supported, which is all Gather ever asks for.
+	 */
+	if (scan->parallel_scan != NULL)
+	{
+		BlockNumber blkno;
+
+		if (!ScanDirectionIsForward(dir))
+			elog(ERROR, "parallel btree scans must be forward scans");
+
+		if (!_bt_parallel_seize(scan, &blkno))
+			return false;
+		else if (blkno == P_NONE)
+		{
+			_bt_parallel_done(scan);
+			return false;
+		}
+		else if (blkno != InvalidBlockNumber)
+		{
+			if (!_bt_parallel_readpage(scan, blkno, dir))
+				return false;
+			goto readcomplete;
+		}
+	}
+
 	/*----------
 	 * Examine the scan keys to discover where we need to start the scan.
 	 *
@@ -773,7 +806,10 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 
 			Assert(subkey->sk_flags & SK_ROW_MEMBER);
 			if (subkey->sk_flags & SK_ISNULL)
+			{
+				_bt_parallel_done(scan);
 				return false;
+			}
 			memcpy(scankeys + i, subkey, sizeof(ScanKeyData));
 
 			/*
@@ -993,6 +1029,12 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 		 * because nothing finer to lock exists.
 		 */
 		PredicateLockRelation(rel, scan->xs_snapshot);
+
+		/*
+		 * mark parallel scan as done, so that all the workers can finish
+		 * their scan
+		 */
+		_bt_parallel_done(scan);
 		return false;
 	}
 	else
@@ -1060,6 +1102,7 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 		_bt_drop_lock_and_maybe_pin(scan, &so->currPos);
 	}
 
+readcomplete:
 	/* OK, itemIndex says what to return */
 	currItem = &so->currPos.items[so->currPos.itemIndex];
 	scan->xs_ctup.t_self = currItem->heapTid;
@@ -1177,6 +1220,10 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 	 */
 	so->currPos.nextPage = opaque->btpo_next;
 
+	/* allow next page be processed by parallel worker */
+	if (scan->parallel_scan != NULL)
+		_bt_parallel_release(scan, opaque->btpo_next);
+
 	/* initialize tuple workspace to empty */
 	so->currPos.nextTupleOffset = 0;
 
@@ -1285,6 +1332,9 @@ _bt_saveitem(BTScanOpaque so, int itemIndex,
  *
  * If there are no more matching records in the given direction, we drop all
  * locks and pins, set so->currPos.buf to InvalidBuffer, and return FALSE.
+ *
+ * For a parallel scan, the next page to read comes from the shared state
+ * rather than from our own saved right-link.
  */
 static bool
 _bt_steppage(IndexScanDesc scan, ScanDirection dir)
@@ -1323,9 +1373,7 @@ _bt_steppage(IndexScanDesc scan, ScanDirection dir)
 
 	if (ScanDirectionIsForward(dir))
 	{
-		/* Walk right to the next page with data */
-		/* We must rely on the previously saved nextPage link! */
-		BlockNumber blkno = so->currPos.nextPage;
+		BlockNumber blkno;
 
 		/* Remember we left a page with data */
 		so->currPos.moreLeft = true;
@@ -1333,35 +1381,27 @@ _bt_steppage(IndexScanDesc scan, ScanDirection dir)
 		/* release the previous buffer, if pinned */
 		BTScanPosUnpinIfPinned(so->currPos);
 
-		for (;;)
+		/* Walk right to the next page with data */
+		if (scan->parallel_scan != NULL)
 		{
-			/* if we're at end of scan, give up */
-			if (blkno == P_NONE || !so->currPos.moreRight)
+			/*
+			 * Our right-link was already handed to the shared state, and may
+			 * have been consumed by someone else; take whatever is next.
+			 */
+			if (!_bt_parallel_seize(scan, &blkno))
 			{
 				BTScanPosInvalidate(so->currPos);
 				return false;
 			}
-			/* check for interrupts while we're not holding any buffer lock */
-			CHECK_FOR_INTERRUPTS();
-			/* step right one page */
-			so->currPos.buf = _bt_getbuf(rel, blkno, BT_READ);
-			/* check for deleted page */
-			page = BufferGetPage(so->currPos.buf);
-			TestForOldSnapshot(scan->xs_snapshot, rel, page);
-			opaque = (BTPageOpaque) PageGetSpecialPointer(page);
-			if (!P_IGNORE(opaque))
-			{
-				PredicateLockPage(rel, blkno, scan->xs_snapshot);
-				/* see if there are any matches on this page */
-				/* note that this will clear moreRight if we can stop */
-				if (_bt_readpage(scan, dir, P_FIRSTDATAKEY(opaque)))
-					break;
-			}
-
-			/* nope, keep going */
-			blkno = opaque->btpo_next;
-			_bt_relbuf(rel, so->currPos.buf);
 		}
+		else
+		{
+			/* We must rely on the previously saved nextPage link! */
+			blkno = so->currPos.nextPage;
+		}
+
+		if (!_bt_readnextpage(scan, blkno, dir))
+			return false;
 	}
 	else
 	{
@@ -1441,6 +1481,109 @@ _bt_steppage(IndexScanDesc scan, ScanDirection dir)
 	return true;
 }
 
+/*
+ *	_bt_readnextpage() -- Read next page containing valid data for a forward
+ *		scan, starting at blkno
+ *
+ * On success exit, so->currPos is updated to contain data from the next
+ * interesting page, and we hold a pin and read lock on it; the caller is
+ * responsible for releasing the lock (and perhaps the pin).
+ *
+ * If there are no more matching records, we drop all locks and pins,
+ * invalidate so->currPos, mark a parallel scan as done, and return FALSE.
+ *
+ * In a parallel scan, the caller must have seized the scan, and we seize it
+ * again each time we need another page.
+ */
+static bool
+_bt_readnextpage(IndexScanDesc scan, BlockNumber blkno, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	Page		page;
+	BTPageOpaque opaque;
+
+	Assert(ScanDirectionIsForward(dir));
+
+	for (;;)
+	{
+		/* if we're at end of scan, give up */
+		if (blkno == P_NONE || !so->currPos.moreRight)
+		{
+			_bt_parallel_done(scan);
+			BTScanPosInvalidate(so->currPos);
+			return false;
+		}
+		/* check for interrupts while we're not holding any buffer lock */
+		CHECK_FOR_INTERRUPTS();
+		/* step right one page */
+		so->currPos.buf = _bt_getbuf(rel, blkno, BT_READ);
+		/* check for deleted page */
+		page = BufferGetPage(so->currPos.buf);
+		TestForOldSnapshot(scan->xs_snapshot, rel, page);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+		if (!P_IGNORE(opaque))
+		{
+			PredicateLockPage(rel, blkno, scan->xs_snapshot);
+			/* see if there are any matches on this page */
+			/* note that this will clear moreRight if we can stop */
+			if (_bt_readpage(scan, dir, P_FIRSTDATAKEY(opaque)))
+				break;
+		}
+		else if (scan->parallel_scan != NULL)
+		{
+			/* allow next page be processed by parallel worker */
+			_bt_parallel_release(scan, opaque->btpo_next);
+		}
+
+		/* nope, keep going */
+		if (scan->parallel_scan != NULL)
+		{
+			_bt_relbuf(rel, so->currPos.buf);
+			if (!_bt_parallel_seize(scan, &blkno))
+			{
+				BTScanPosInvalidate(so->currPos);
+				return false;
+			}
+		}
+		else
+		{
+			blkno = opaque->btpo_next;
+			_bt_relbuf(rel, so->currPos.buf);
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	_bt_parallel_readpage() -- Read the current page of a parallel scan
+ *		that another participant has already started
+ *
+ * On success, release the lock (and maybe the pin) on the page we read and
+ * return true; so->currPos describes the page's matching items.  The caller
+ * must have seized the scan.
+ */
+static bool
+_bt_parallel_readpage(IndexScanDesc scan, BlockNumber blkno, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+
+	/* we're joining a forward scan partway through */
+	so->currPos.moreLeft = false;
+	so->currPos.moreRight = true;
+	so->numKilled = 0;			/* just paranoia */
+	Assert(so->markItemIndex == -1);
+
+	if (!_bt_readnextpage(scan, blkno, dir))
+		return false;
+
+	/* Drop the lock, and maybe the pin, on the current page */
+	_bt_drop_lock_and_maybe_pin(scan, &so->currPos);
+
+	return true;
+}
+
 /*
  * _bt_walk_left() -- step left one page, if possible
  *
@@ -1682,6 +1825,7 @@ _bt_endpoint(IndexScanDesc scan, ScanDirection dir)
 		 */
 		PredicateLockRelation(rel, scan->xs_snapshot);
 		BTScanPosInvalidate(so->currPos);
+		_bt_parallel_done(scan);
 		return false;
 	}
 
@@ -355,6 +355,9 @@ MarkAsPreparing(TransactionId xid, const char *gid,
 	GlobalTransaction gxact;
 	PGPROC	   *proc;
 	PGXACT	   *pgxact;
+	TransactionId *subxids;
+	uint64	   *fpLockBits;
+	Oid		   *fpRelId;
 	int			i;
 
 	if (strlen(gid) >= GIDSIZE)
@@ -405,9 +408,19 @@ MarkAsPreparing(TransactionId xid, const char *gid,
 	proc = &ProcGlobal->allProcs[gxact->pgprocno];
 	pgxact = &ProcGlobal->allPgXact[gxact->pgprocno];
 
-	/* Initialize the PGPROC entry */
+	/*
+	 * Initialize the PGPROC entry.  The subxid cache and the fast-path lock
+	 * arrays live outside the PGPROC, set up by InitProcGlobal, so keep the
+	 * pointers to them.
+	 */
+	subxids = proc->subxids.xids;
+	fpLockBits = proc->fpLockBits;
+	fpRelId = proc->fpRelId;
 	MemSet(proc, 0, sizeof(PGPROC));
 	proc->pgprocno = gxact->pgprocno;
+	proc->subxids.xids = subxids;
+	proc->fpLockBits = fpLockBits;
+	proc->fpRelId = fpRelId;
 	SHMQueueElemInit(&(proc->links));
 	proc->waitStatus = STATUS_OK;
 	/* We set up the gxact's VXID as InvalidBackendId/XID */
@@ -429,7 +442,7 @@ MarkAsPreparing(TransactionId xid, const char *gid,
 		SHMQueueInit(&(proc->myProcLocks[i]));
 	/* subxid data must be filled later by GXactLoadSubxactData */
 	pgxact->overflowed = false;
-	pgxact->nxids = 0;
+	SetProcSubxidCount(proc, pgxact, 0);
 
 	gxact->prepared_at = prepared_at;
 	/* initialize LSN to InvalidXLogRecPtr */
@@ -471,16 +484,16 @@ GXactLoadSubxactData(GlobalTransaction gxact, int nsubxacts,
 	PGXACT	   *pgxact = &ProcGlobal->allPgXact[gxact->pgprocno];
 
 	/* We need no extra lock since the GXACT isn't valid yet */
-	if (nsubxacts > PGPROC_MAX_CACHED_SUBXIDS)
+	if (nsubxacts > max_cached_subxids)
 	{
 		pgxact->overflowed = true;
-		nsubxacts = PGPROC_MAX_CACHED_SUBXIDS;
+		nsubxacts = max_cached_subxids;
 	}
 	if (nsubxacts > 0)
 	{
 		memcpy(proc->subxids.xids, children,
 			   nsubxacts * sizeof(TransactionId));
-		pgxact->nxids = nsubxacts;
+		SetProcSubxidCount(proc, pgxact, nsubxacts);
 	}
 }
 
@@ -226,12 +226,12 @@ GetNewTransactionId(bool isSubXact)
 			mypgxact->xid = xid;
 		else
 		{
-			int			nxids = mypgxact->nxids;
+			int			nxids = myproc->subxids.nxids;
 
-			if (nxids < PGPROC_MAX_CACHED_SUBXIDS)
+			if (nxids < max_cached_subxids)
 			{
 				myproc->subxids.xids[nxids] = xid;
-				mypgxact->nxids = nxids + 1;
+				SetProcSubxidCount(myproc, mypgxact, nxids + 1);
 			}
 			else
 				mypgxact->overflowed = true;
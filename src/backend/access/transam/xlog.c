@@ -33,6 +33,8 @@
 #include "access/xact.h"
 #include "access/xlog_internal.h"
 #include "access/xloginsert.h"
+#include "access/xlogparallel.h"
+#include "access/xlogprefetch.h"
 #include "access/xlogreader.h"
 #include "access/xlogutils.h"
 #include "catalog/catversion.h"
@@ -41,6 +43,7 @@
 #include "commands/tablespace.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "portability/instr_time.h"
 #include "postmaster/bgwriter.h"
 #include "postmaster/walwriter.h"
 #include "postmaster/startup.h"
@@ -87,18 +90,20 @@ int			max_wal_size = 64;	/* 1 GB */
 int			min_wal_size = 5;	/* 80 MB */
 int			wal_keep_segments = 0;
 int			XLOGbuffers = -1;
+int			XLOGinsertLocks = -1;
 int			XLogArchiveTimeout = 0;
 int			XLogArchiveMode = ARCHIVE_MODE_OFF;
 char	   *XLogArchiveCommand = NULL;
 bool		EnableHotStandby = false;
 bool		fullPageWrites = true;
 bool		wal_log_hints = false;
-bool		wal_compression = false;
+int			wal_compression = WAL_COMPRESSION_NONE;
 bool		log_checkpoints = false;
 int			sync_method = DEFAULT_SYNC_METHOD;
 int			wal_level = WAL_LEVEL_MINIMAL;
 int			CommitDelay = 0;	/* precommit delay in microseconds */
 int			CommitSiblings = 5; /* # concurrent xacts needed to sleep */
+bool		adaptive_commit_delay = false;
 int			wal_retrieve_retry_interval = 5000;
 
 #ifdef WAL_DEBUG
@@ -106,11 +111,13 @@ bool		XLOG_DEBUG = false;
 #endif
 
 /*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
+ * Parameters of the running averages kept for adaptive_commit_delay: each
+ * new sample gets weight 1/FLUSH_STATS_WEIGHT, and samples are clamped to
+ * FLUSH_STATS_MAX_SAMPLE microseconds so that an idle period doesn't take
+ * long to forget.
  */
-#define NUM_XLOGINSERT_LOCKS  8
+#define FLUSH_STATS_WEIGHT		8
+#define FLUSH_STATS_MAX_SAMPLE	1000000.0
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -160,6 +167,24 @@ const struct config_enum_entry archive_mode_options[] = {
 	{NULL, 0, false}
 };
 
+/*
+ * "on" predates the choice of method and means pglz.  Like archive_mode,
+ * we accept all the likely variants of "on" and "off".
+ */
+const struct config_enum_entry wal_compression_options[] = {
+	{"pglz", WAL_COMPRESSION_PGLZ, false},
+	{"lz4", WAL_COMPRESSION_LZ4, false},
+	{"on", WAL_COMPRESSION_PGLZ, false},
+	{"off", WAL_COMPRESSION_NONE, false},
+	{"true", WAL_COMPRESSION_PGLZ, true},
+	{"false", WAL_COMPRESSION_NONE, true},
+	{"yes", WAL_COMPRESSION_PGLZ, true},
+	{"no", WAL_COMPRESSION_NONE, true},
+	{"1", WAL_COMPRESSION_PGLZ, true},
+	{"0", WAL_COMPRESSION_NONE, true},
+	{NULL, 0, false}
+};
+
 /*
  * Statistics for current checkpoint are collected in this global struct.
  * Because only the checkpointer or a stand-alone backend can perform
@@ -439,11 +464,17 @@ typedef struct XLogwrtResult
  * the WAL record is just copied to the page and the lock is released. But
  * to avoid the deadlock-scenario explained above, the indicator is always
  * updated before sleeping while holding an insertion lock.
+ *
+ * prevLinkWait is the byte position whose prev-link the lock holder is
+ * sleeping for, or 0, and prevLinkWaitProc is the pgprocno of the sleeper.
+ * See XLogGetPrevLink().
  */
 typedef struct
 {
 	LWLock		lock;
 	XLogRecPtr	insertingAt;
+	pg_atomic_uint64 prevLinkWait;
+	int			prevLinkWaitProc;
 } WALInsertLock;
 
 /*
@@ -488,32 +519,59 @@ typedef enum ExclusiveBackupState
  */
 static SessionBackupState sessionBackupState = SESSION_BACKUP_NONE;
 
+/*
+ * An entry in the prev-link table, see ReserveXLogInsertLocation().  An
+ * entry in use maps the end of a reserved record, which is also the start of
+ * the next record, to the start of that record.  endpos is 0 if the entry is
+ * free, or XLOG_PREVLINK_BUSY while startpos is being filled in.  Both are
+ * "usable byte positions".
+ */
+typedef struct XLogPrevLink
+{
+	pg_atomic_uint64 endpos;
+	pg_atomic_uint64 startpos;
+} XLogPrevLink;
+
+#define XLOG_PREVLINK_BUSY		PG_UINT64_MAX
+
+/* Lookups to try before sleeping in XLogGetPrevLink() */
+#define XLOG_PREVLINK_SPINS		100
+
 /*
  * Shared state data for WAL insertion.
  */
 typedef struct XLogCtlInsert
 {
-	slock_t		insertpos_lck;	/* protects CurrBytePos and PrevBytePos */
-
 	/*
 	 * CurrBytePos is the end of reserved WAL. The next record will be
-	 * inserted at that position. PrevBytePos is the start position of the
-	 * previously inserted (or rather, reserved) record - it is copied to the
-	 * prev-link of the next record. These are stored as "usable byte
-	 * positions" rather than XLogRecPtrs (see XLogBytePosToRecPtr()).
+	 * inserted at that position. It is stored as a "usable byte position"
+	 * rather than an XLogRecPtr (see XLogBytePosToRecPtr()), and advanced
+	 * with an atomic fetch-and-add.  The start position of the previously
+	 * reserved record, which goes into the prev-link of the next record, is
+	 * passed along through the PrevLinks table.
 	 */
-	uint64		CurrBytePos;
-	uint64		PrevBytePos;
+	pg_atomic_uint64 CurrBytePos;
 
 	/*
-	 * Make sure the above heavily-contended spinlock and byte positions are
-	 * on their own cache line. In particular, the RedoRecPtr and full page
-	 * write variables below should be on a different cache line. They are
-	 * read on every WAL insertion, but updated rarely, and we don't want
-	 * those reads to steal the cache line containing Curr/PrevBytePos.
+	 * Make sure the above heavily-contended byte position is on its own
+	 * cache line. In particular, the RedoRecPtr and full page write variables
+	 * below should be on a different cache line. They are read on every WAL
+	 * insertion, but updated rarely, and we don't want those reads to steal
+	 * the cache line containing CurrBytePos.
 	 */
 	char		pad[PG_CACHE_LINE_SIZE];
 
+	/*
+	 * The prev-link table.  Its size is a power of two, at least twice the
+	 * number of WAL insertion locks plus one.  Never changes after shared
+	 * memory initialization.
+	 */
+	XLogPrevLink *PrevLinks;
+	uint32		PrevLinksMask;
+
+	/* number of inserters sleeping in XLogGetPrevLink() */
+	pg_atomic_uint32 PrevLinkWaiters;
+
 	/*
 	 * fullPageWrites is the master copy used by all backends to determine
 	 * whether to write full-page to WAL, instead of using process-local one.
@@ -573,6 +631,17 @@ typedef struct XLogCtlData
 	/* Time of last xlog segment switch. Protected by WALWriteLock. */
 	pg_time_t	lastSegSwitchTime;
 
+	/*
+	 * Running averages for adaptive_commit_delay, in microseconds.
+	 * flushAvgTime is the time XLogFlush spends writing and fsyncing, and is
+	 * protected by WALWriteLock.  flushAvgInterval is the time between
+	 * XLogFlush calls that had to wait for a flush; it and the time of the
+	 * latest such call are protected by info_lck.
+	 */
+	double		flushAvgTime;
+	double		flushAvgInterval;
+	uint64		flushLastRequest;
+
 	/*
 	 * Protected by info_lck and WALWriteLock (you must hold either lock to
 	 * read it, but both to update)
@@ -808,6 +877,14 @@ bool		reachedConsistency = false;
 
 static bool InRedo = false;
 
+/*
+ * End and timeline of the last record handed to a parallel redo worker, if
+ * the workers might not have applied it yet.  lastReplayedEndRecPtr catches
+ * up with it in WaitForParallelRedo().
+ */
+static XLogRecPtr lastDispatchedEndRecPtr = InvalidXLogRecPtr;
+static TimeLineID lastDispatchedTLI = 0;
+
 /* Have we launched bgwriter during recovery? */
 static bool bgwriterLaunched = false;
 
@@ -824,6 +901,7 @@ static void exitArchiveRecovery(TimeLineID endTLI, XLogRecPtr endOfLog);
 static bool recoveryStopsBefore(XLogReaderState *record);
 static bool recoveryStopsAfter(XLogReaderState *record);
 static void recoveryPausesHere(void);
+static void WaitForParallelRedo(void);
 static bool recoveryApplyDelay(XLogReaderState *record);
 static void SetLatestXTime(TimestampTz xtime);
 static void SetCurrentChunkStartTime(TimestampTz xtime);
@@ -887,11 +965,15 @@ static int	get_sync_bit(int method);
 static void CopyXLogRecordToWAL(int write_len, bool isLogSwitch,
 					XLogRecData *rdata,
 					XLogRecPtr StartPos, XLogRecPtr EndPos);
+static uint64 XLogGetPrevLink(uint64 bytepos, bool consume);
+static void XLogPublishPrevLink(uint64 endbytepos, uint64 startbytepos);
 static void ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos,
 						  XLogRecPtr *EndPos, XLogRecPtr *PrevPtr);
 static bool ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 				  XLogRecPtr *PrevPtr);
 static XLogRecPtr WaitXLogInsertionsToFinish(XLogRecPtr upto);
+static void RecordFlushRequest(void);
+static int	ChooseCommitDelay(void);
 static char *GetXLogBuffer(XLogRecPtr ptr);
 static XLogRecPtr XLogBytePosToRecPtr(uint64 bytepos);
 static XLogRecPtr XLogBytePosToEndRecPtr(uint64 bytepos);
@@ -951,8 +1033,8 @@ XLogInsertRecord(XLogRecData *rdata, XLogRecPtr fpw_lsn)
 	 * record to the shared WAL buffer cache is a two-step process:
 	 *
 	 * 1. Reserve the right amount of space from the WAL. The current head of
-	 *	  reserved space is kept in Insert->CurrBytePos, and is protected by
-	 *	  insertpos_lck.
+	 *	  reserved space is kept in Insert->CurrBytePos, and is advanced
+	 *	  atomically.
 	 *
 	 * 2. Copy the record to the reserved WAL space. This involves finding the
 	 *	  correct WAL buffer containing the reserved space, and copying the
@@ -962,7 +1044,7 @@ XLogInsertRecord(XLogRecData *rdata, XLogRecPtr fpw_lsn)
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
 	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
+	 * determined by the wal_insert_locks setting. When an inserter crosses a page
 	 * boundary, it updates the value stored in the lock to the how far it has
 	 * inserted, to allow the previous buffer to be flushed.
 	 *
@@ -1162,6 +1244,195 @@ XLogInsertRecord(XLogRecData *rdata, XLogRecPtr fpw_lsn)
 	return EndPos;
 }
 
+/*
+ * Hash a usable byte position to its home slot in the prev-link table.
+ */
+static inline uint32
+XLogPrevLinkSlot(uint64 bytepos)
+{
+	uint64		h = bytepos / MAXIMUM_ALIGNOF;
+
+	/* records are MAXALIGNed, so the low bits carry no information */
+	h ^= h >> 32;
+	return ((uint32) h * 0x9E3779B1) & XLogCtl->Insert.PrevLinksMask;
+}
+
+/*
+ * Search the prev-link table for the record that ends at 'bytepos'.  If it
+ * is there, store its start in *prevbytepos, remove the entry if 'consume'
+ * is true, and return true.
+ *
+ * Entries are placed by linear probing from their home slot, and since
+ * entries ahead of ours may have been freed meanwhile, we have to look at
+ * every slot before concluding that it isn't there.  The table is small.
+ */
+static bool
+XLogFindPrevLink(uint64 bytepos, bool consume, uint64 *prevbytepos)
+{
+	XLogCtlInsert *Insert = &XLogCtl->Insert;
+	uint32		slot = XLogPrevLinkSlot(bytepos);
+	uint32		n;
+
+	for (n = 0; n <= Insert->PrevLinksMask; n++)
+	{
+		XLogPrevLink *link = &Insert->PrevLinks[slot];
+
+		if (pg_atomic_read_u64(&link->endpos) == bytepos)
+		{
+			pg_read_barrier();
+			*prevbytepos = pg_atomic_read_u64(&link->startpos);
+
+			if (consume)
+			{
+				/* make sure we've read startpos before freeing the slot */
+				pg_memory_barrier();
+				pg_atomic_write_u64(&link->endpos, 0);
+			}
+			return true;
+		}
+		slot = (slot + 1) & Insert->PrevLinksMask;
+	}
+
+	return false;
+}
+
+/*
+ * Look up the start of the record that ends at 'bytepos', and if 'consume'
+ * is true, remove the entry from the prev-link table.
+ *
+ * The entry is published by whoever reserved that record, right after
+ * reserving it and before doing anything that could block, so if we get
+ * here first it normally shows up within a few spins.  But the reserver may
+ * have been descheduled in between, and spinning on a busy machine only
+ * makes that worse, so after XLOG_PREVLINK_SPINS tries we go to sleep on
+ * our semaphore, like an LWLock waiter.  We must not error out here, since
+ * we're in a critical section, which also rules out waiting on a latch.
+ *
+ * To be woken up, we advertise the position we're waiting for in the slot
+ * of the insertion lock we hold, so at most one sleeper per lock, and bump
+ * PrevLinkWaiters.  XLogPublishPrevLink() checks the counter after
+ * publishing, and if it is non-zero, scans the insertion locks for
+ * sleepers waiting for the entry it just published.  Either the publisher
+ * sees our advertisement, or we see its entry when we re-check the table
+ * after advertising: both sides write before they read, with a full
+ * barrier in between.
+ */
+static uint64
+XLogGetPrevLink(uint64 bytepos, bool consume)
+{
+	XLogCtlInsert *Insert = &XLogCtl->Insert;
+	WALInsertLock *mylock = &WALInsertLocks[MyLockNo].l;
+	uint64		prevbytepos;
+	int			spins;
+	int			extraWaits = 0;
+
+	for (spins = 0; spins < XLOG_PREVLINK_SPINS; spins++)
+	{
+		if (XLogFindPrevLink(bytepos, consume, &prevbytepos))
+			return prevbytepos;
+		pg_spin_delay();
+	}
+
+	mylock->prevLinkWaitProc = MyProc->pgprocno;
+	pg_write_barrier();
+	pg_atomic_write_u64(&mylock->prevLinkWait, bytepos);
+	pg_atomic_fetch_add_u32(&Insert->PrevLinkWaiters, 1);
+
+	for (;;)
+	{
+		uint64		expected = bytepos;
+
+		if (XLogFindPrevLink(bytepos, consume, &prevbytepos))
+		{
+			/*
+			 * Withdraw our advertisement.  If a publisher got to it first, it
+			 * has woken us up or is about to, and we must absorb that wakeup.
+			 */
+			if (!pg_atomic_compare_exchange_u64(&mylock->prevLinkWait,
+												&expected, 0))
+				PGSemaphoreLock(&MyProc->sem);
+			break;
+		}
+
+		PGSemaphoreLock(&MyProc->sem);
+
+		/* a wakeup meant for something else, such as an LWLock release */
+		if (pg_atomic_read_u64(&mylock->prevLinkWait) == bytepos)
+		{
+			extraWaits++;
+			continue;
+		}
+
+		/* we were woken by the publisher, so the entry is there now */
+		pg_atomic_write_u64(&mylock->prevLinkWait, bytepos);
+	}
+
+	pg_atomic_fetch_sub_u32(&Insert->PrevLinkWaiters, 1);
+
+	/* Fix the process wait semaphore's count for any absorbed wakeups */
+	while (extraWaits-- > 0)
+		PGSemaphoreUnlock(&MyProc->sem);
+
+	return prevbytepos;
+}
+
+/*
+ * Wake up anyone sleeping in XLogGetPrevLink() for the entry of the record
+ * that ends at 'endbytepos', which has just been published.
+ */
+static void
+XLogWakePrevLinkWaiters(uint64 endbytepos)
+{
+	int			i;
+
+	for (i = 0; i < XLOGinsertLocks; i++)
+	{
+		WALInsertLock *lock = &WALInsertLocks[i].l;
+		uint64		expected = endbytepos;
+
+		if (pg_atomic_read_u64(&lock->prevLinkWait) == endbytepos &&
+			pg_atomic_compare_exchange_u64(&lock->prevLinkWait, &expected, 0))
+			PGSemaphoreUnlock(&ProcGlobal->allProcs[lock->prevLinkWaitProc].sem);
+	}
+}
+
+/*
+ * Publish the prev-link of the record that will start at 'endbytepos'.
+ *
+ * An entry stays in the table only until the record following it has been
+ * reserved, and each in-progress reservation holds a WAL insertion lock.
+ * So at most wal_insert_locks + 1 entries can be in use at any time, and
+ * the table is sized so that there is always a free slot.
+ */
+static void
+XLogPublishPrevLink(uint64 endbytepos, uint64 startbytepos)
+{
+	XLogCtlInsert *Insert = &XLogCtl->Insert;
+	uint32		slot = XLogPrevLinkSlot(endbytepos);
+
+	for (;;)
+	{
+		XLogPrevLink *link = &Insert->PrevLinks[slot];
+		uint64		expected = 0;
+
+		if (pg_atomic_read_u64(&link->endpos) == 0 &&
+			pg_atomic_compare_exchange_u64(&link->endpos, &expected,
+										   XLOG_PREVLINK_BUSY))
+		{
+			pg_atomic_write_u64(&link->startpos, startbytepos);
+			pg_write_barrier();
+			pg_atomic_write_u64(&link->endpos, endbytepos);
+			break;
+		}
+		slot = (slot + 1) & Insert->PrevLinksMask;
+	}
+
+	/* pairs with the barrier between advertising and re-checking above */
+	pg_memory_barrier();
+	if (pg_atomic_read_u32(&Insert->PrevLinkWaiters) > 0)
+		XLogWakePrevLinkWaiters(endbytepos);
+}
+
 /*
  * Reserves the right amount of space for a record of given size from the WAL.
  * *StartPos is set to the beginning of the reserved section, *EndPos to
@@ -1169,9 +1440,9 @@ XLogInsertRecord(XLogRecData *rdata, XLogRecPtr fpw_lsn)
  * used to set the xl_prev of this record.
  *
  * This is the performance critical part of XLogInsert that must be serialized
- * across backends. The rest can happen mostly in parallel. Try to keep this
- * section as short as possible, insertpos_lck can be heavily contended on a
- * busy system.
+ * across backends. The rest can happen mostly in parallel.  The reservation
+ * itself is a single atomic fetch-and-add, so that concurrent inserters don't
+ * queue up behind each other on a lock.
  *
  * NB: The space calculation here must match the code in CopyXLogRecordToWAL,
  * where we actually copy the record to the reserved space.
@@ -1191,24 +1462,24 @@ ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 	Assert(size > SizeOfXLogRecord);
 
 	/*
-	 * The duration the spinlock needs to be held is minimized by minimizing
-	 * the calculations that have to be done while holding the lock. The
-	 * current tip of reserved WAL is kept in CurrBytePos, as a byte position
-	 * that only counts "usable" bytes in WAL, that is, it excludes all WAL
-	 * page headers. The mapping between "usable" byte positions and physical
-	 * positions (XLogRecPtrs) can be done outside the locked region, and
-	 * because the usable byte position doesn't include any headers, reserving
-	 * X bytes from WAL is almost as simple as "CurrBytePos += X".
+	 * The current tip of reserved WAL is kept in CurrBytePos, as a byte
+	 * position that only counts "usable" bytes in WAL, that is, it excludes
+	 * all WAL page headers. The mapping between "usable" byte positions and
+	 * physical positions (XLogRecPtrs) can be done afterwards, and because the
+	 * usable byte position doesn't include any headers, reserving X bytes
+	 * from WAL is as simple as "CurrBytePos += X".
+	 *
+	 * That doesn't tell us where the previous record started, though.  Its
+	 * reserver leaves that in the prev-link table under its end position,
+	 * which is our start position, and we do the same for our successor.
+	 * We publish our entry before looking up our predecessor's, so that our
+	 * successor never has to wait for us while we wait for someone else.
 	 */
-	SpinLockAcquire(&Insert->insertpos_lck);
-
-	startbytepos = Insert->CurrBytePos;
+	startbytepos = pg_atomic_fetch_add_u64(&Insert->CurrBytePos, size);
 	endbytepos = startbytepos + size;
-	prevbytepos = Insert->PrevBytePos;
-	Insert->CurrBytePos = endbytepos;
-	Insert->PrevBytePos = startbytepos;
 
-	SpinLockRelease(&Insert->insertpos_lck);
+	XLogPublishPrevLink(endbytepos, startbytepos);
+	prevbytepos = XLogGetPrevLink(startbytepos, true);
 
 	*StartPos = XLogBytePosToRecPtr(startbytepos);
 	*EndPos = XLogBytePosToEndRecPtr(endbytepos);
@@ -1244,25 +1515,21 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr)
 	uint32		segleft;
 
 	/*
-	 * These calculations are a bit heavy-weight to be done while holding a
-	 * spinlock, but since we're holding all the WAL insertion locks, there
-	 * are no other inserters competing for it. GetXLogInsertRecPtr() does
-	 * compete for it, but that's not called very frequently.
+	 * Since we're holding all the WAL insertion locks, there are no other
+	 * inserters, so we can read and then set CurrBytePos without fear of
+	 * anyone else advancing it meanwhile.
 	 */
-	SpinLockAcquire(&Insert->insertpos_lck);
-
-	startbytepos = Insert->CurrBytePos;
+	startbytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
 
 	ptr = XLogBytePosToEndRecPtr(startbytepos);
 	if (ptr % XLOG_SEG_SIZE == 0)
 	{
-		SpinLockRelease(&Insert->insertpos_lck);
 		*EndPos = *StartPos = ptr;
 		return false;
 	}
 
 	endbytepos = startbytepos + size;
-	prevbytepos = Insert->PrevBytePos;
+	prevbytepos = XLogGetPrevLink(startbytepos, true);
 
 	*StartPos = XLogBytePosToRecPtr(startbytepos);
 	*EndPos = XLogBytePosToEndRecPtr(endbytepos);
@@ -1274,10 +1541,8 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr)
 		*EndPos += segleft;
 		endbytepos = XLogRecPtrToBytePos(*EndPos);
 	}
-	Insert->CurrBytePos = endbytepos;
-	Insert->PrevBytePos = startbytepos;
-
-	SpinLockRelease(&Insert->insertpos_lck);
+	pg_atomic_write_u64(&Insert->CurrBytePos, endbytepos);
+	XLogPublishPrevLink(endbytepos, startbytepos);
 
 	*PrevPtr = XLogBytePosToRecPtr(prevbytepos);
 
@@ -1436,7 +1701,7 @@ WALInsertLockAcquire(void)
 	static int	lockToTry = -1;
 
 	if (lockToTry == -1)
-		lockToTry = MyProc->pgprocno % NUM_XLOGINSERT_LOCKS;
+		lockToTry = MyProc->pgprocno % XLOGinsertLocks;
 	MyLockNo = lockToTry;
 
 	/*
@@ -1454,7 +1719,7 @@ WALInsertLockAcquire(void)
 		 * than locks, it still helps to distribute the inserters evenly
 		 * across the locks.
 		 */
-		lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+		lockToTry = (lockToTry + 1) % XLOGinsertLocks;
 	}
 }
 
@@ -1472,7 +1737,7 @@ WALInsertLockAcquireExclusive(void)
 	 * indicator is set to 0xFFFFFFFFFFFFFFFF, which is higher than any real
 	 * XLogRecPtr value, to make sure that no-one blocks waiting on those.
 	 */
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS - 1; i++)
+	for (i = 0; i < XLOGinsertLocks - 1; i++)
 	{
 		LWLockAcquire(&WALInsertLocks[i].l.lock, LW_EXCLUSIVE);
 		LWLockUpdateVar(&WALInsertLocks[i].l.lock,
@@ -1498,7 +1763,7 @@ WALInsertLockRelease(void)
 	{
 		int			i;
 
-		for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+		for (i = 0; i < XLOGinsertLocks; i++)
 			LWLockReleaseClearVar(&WALInsertLocks[i].l.lock,
 								  &WALInsertLocks[i].l.insertingAt,
 								  0);
@@ -1526,8 +1791,8 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 		 * We use the last lock to mark our actual position, see comments in
 		 * WALInsertLockAcquireExclusive.
 		 */
-		LWLockUpdateVar(&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.lock,
-					 &WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.insertingAt,
+		LWLockUpdateVar(&WALInsertLocks[XLOGinsertLocks - 1].l.lock,
+					 &WALInsertLocks[XLOGinsertLocks - 1].l.insertingAt,
 						insertingAt);
 	}
 	else
@@ -1563,9 +1828,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 		elog(PANIC, "cannot wait without a PGPROC structure");
 
 	/* Read the current insert position */
-	SpinLockAcquire(&Insert->insertpos_lck);
-	bytepos = Insert->CurrBytePos;
-	SpinLockRelease(&Insert->insertpos_lck);
+	bytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
 	reservedUpto = XLogBytePosToEndRecPtr(bytepos);
 
 	/*
@@ -1594,7 +1857,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	 * out for any insertion that's still in progress.
 	 */
 	finishedUpto = reservedUpto;
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < XLOGinsertLocks; i++)
 	{
 		XLogRecPtr	insertingat = InvalidXLogRecPtr;
 
@@ -2605,6 +2868,7 @@ XLogFlush(XLogRecPtr record)
 {
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
+	bool		adaptive_delay;
 
 	/*
 	 * During REDO, we are reading not writing WAL.  Therefore, instead of
@@ -2631,6 +2895,14 @@ XLogFlush(XLogRecPtr record)
 		   (uint32) (LogwrtResult.Flush >> 32), (uint32) LogwrtResult.Flush);
 #endif
 
+	/*
+	 * The statistics for adaptive_commit_delay are only worth their
+	 * bookkeeping if we might actually sleep before flushing.
+	 */
+	adaptive_delay = adaptive_commit_delay && CommitDelay > 0 && enableFsync;
+	if (adaptive_delay)
+		RecordFlushRequest();
+
 	START_CRIT_SECTION();
 
 	/*
@@ -2651,6 +2923,8 @@ XLogFlush(XLogRecPtr record)
 	for (;;)
 	{
 		XLogRecPtr	insertpos;
+		int			delay;
+		instr_time	flush_start;
 
 		/* read LogwrtResult and update local state */
 		SpinLockAcquire(&XLogCtl->info_lck);
@@ -2700,13 +2974,22 @@ XLogFlush(XLogRecPtr record)
 		 * followers; this can significantly improve transaction throughput,
 		 * at the risk of increasing transaction latency.
 		 *
-		 * We do not sleep if enableFsync is not turned on, nor if there are
-		 * fewer than CommitSiblings other backends with active transactions.
+		 * We do not sleep if enableFsync is not turned on.  Otherwise the
+		 * delay is either chosen by ChooseCommitDelay(), or it's CommitDelay
+		 * if there are at least CommitSiblings other backends with active
+		 * transactions.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
-			MinimumActiveBackends(CommitSiblings))
+		delay = 0;
+		if (CommitDelay > 0 && enableFsync)
+		{
+			if (adaptive_delay)
+				delay = ChooseCommitDelay();
+			else if (MinimumActiveBackends(CommitSiblings))
+				delay = CommitDelay;
+		}
+		if (delay > 0)
 		{
-			pg_usleep(CommitDelay);
+			pg_usleep(delay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -2725,8 +3008,24 @@ XLogFlush(XLogRecPtr record)
 		WriteRqst.Write = insertpos;
 		WriteRqst.Flush = insertpos;
 
+		if (adaptive_delay)
+			INSTR_TIME_SET_CURRENT(flush_start);
+
 		XLogWrite(WriteRqst, false);
 
+		if (adaptive_delay)
+		{
+			instr_time	flush_time;
+			double		sample;
+
+			INSTR_TIME_SET_CURRENT(flush_time);
+			INSTR_TIME_SUBTRACT(flush_time, flush_start);
+			sample = Min(INSTR_TIME_GET_MICROSEC(flush_time),
+						 FLUSH_STATS_MAX_SAMPLE);
+			XLogCtl->flushAvgTime +=
+				(sample - XLogCtl->flushAvgTime) / FLUSH_STATS_WEIGHT;
+		}
+
 		LWLockRelease(WALWriteLock);
 		/* done */
 		break;
@@ -2765,6 +3064,69 @@ XLogFlush(XLogRecPtr record)
 		   (uint32) (LogwrtResult.Flush >> 32), (uint32) LogwrtResult.Flush);
 }
 
+/*
+ * Note the arrival of a flush request, for adaptive_commit_delay.
+ */
+static void
+RecordFlushRequest(void)
+{
+	instr_time	now;
+	uint64		now_us;
+
+	INSTR_TIME_SET_CURRENT(now);
+	now_us = INSTR_TIME_GET_MICROSEC(now);
+
+	SpinLockAcquire(&XLogCtl->info_lck);
+	if (XLogCtl->flushLastRequest != 0)
+	{
+		double		sample = 0;
+
+		/* requests arriving at the same time can be recorded out of order */
+		if (now_us > XLogCtl->flushLastRequest)
+			sample = Min(now_us - XLogCtl->flushLastRequest,
+						 FLUSH_STATS_MAX_SAMPLE);
+		XLogCtl->flushAvgInterval +=
+			(sample - XLogCtl->flushAvgInterval) / FLUSH_STATS_WEIGHT;
+	}
+	if (now_us > XLogCtl->flushLastRequest)
+		XLogCtl->flushLastRequest = now_us;
+	SpinLockRelease(&XLogCtl->info_lck);
+}
+
+/*
+ * Choose how long the flush leader should wait for more commits to join
+ * its group, in microseconds, when adaptive_commit_delay is on.
+ *
+ * If, on average, fewer than one new flush request arrives while a flush is
+ * in progress, waiting only adds latency; nobody would have had to wait for
+ * another flush anyway.  The more requests arrive per flush, the more of
+ * them a short wait lets us absorb into this flush rather than the next one.
+ * We wait up to half the average flush time, scaled by the fraction of
+ * arrivals beyond the first, and never more than commit_delay.
+ *
+ * Caller must hold WALWriteLock.
+ */
+static int
+ChooseCommitDelay(void)
+{
+	double		avgInterval;
+	double		arrivals;
+	double		delay;
+
+	SpinLockAcquire(&XLogCtl->info_lck);
+	avgInterval = XLogCtl->flushAvgInterval;
+	SpinLockRelease(&XLogCtl->info_lck);
+
+	/* expected number of flush requests arriving during one flush */
+	arrivals = XLogCtl->flushAvgTime / Max(avgInterval, 1.0);
+	if (arrivals <= 1.0)
+		return 0;
+
+	delay = XLogCtl->flushAvgTime / 2 * (1.0 - 1.0 / arrivals);
+
+	return (int) Min(delay, CommitDelay);
+}
+
 /*
  * Write & flush xlog, but without specifying exactly where to.
  *
@@ -4635,6 +4997,77 @@ check_wal_buffers(int *newval, void **extra, GucSource source)
 	return true;
 }
 
+/*
+ * Auto-tune the number of WAL insertion locks.
+ *
+ * Each core can be copying a record into the WAL buffers at the same time,
+ * so we use one lock per core, but no fewer than 8 (the historical fixed
+ * value) and no more than 128, because WaitXLogInsertionsToFinish() has to
+ * look at every lock whenever WAL is flushed.  That also happens to be the
+ * most that wal_insert_locks allows.
+ */
+static int
+XLOGChooseNumInsertLocks(void)
+{
+	int			nlocks = 8;
+
+#ifdef _SC_NPROCESSORS_ONLN
+	long		ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (ncpus > nlocks)
+		nlocks = (int) Min(ncpus, MAX_WAL_INSERT_LOCKS);
+#endif
+
+	return nlocks;
+}
+
+/*
+ * GUC check_hook for wal_insert_locks
+ */
+bool
+check_wal_insert_locks(int *newval, void **extra, GucSource source)
+{
+	/*
+	 * -1 indicates a request for auto-tune.  As for wal_buffers, leave the
+	 * boot_val alone until XLOGShmemSize is called.
+	 */
+	if (*newval == -1)
+	{
+		if (XLOGinsertLocks == -1)
+			return true;
+		*newval = XLOGChooseNumInsertLocks();
+	}
+
+	/* We need at least one lock; treat 0 as a request for the minimum */
+	if (*newval < 1)
+		*newval = 1;
+
+	/* Exclusive acquisition must not run out of held-LWLock slots */
+	if (*newval > MAX_WAL_INSERT_LOCKS)
+	{
+		GUC_check_errdetail("wal_insert_locks cannot be more than %d.",
+							MAX_WAL_INSERT_LOCKS);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Number of entries in the prev-link table: the smallest power of two that
+ * is at least twice the maximum number of entries that can be in use.
+ */
+static uint32
+XLogPrevLinksSize(void)
+{
+	uint32		size = 1;
+
+	while (size < 2 * (XLOGinsertLocks + 1))
+		size <<= 1;
+
+	return size;
+}
+
 /*
  * Initialization of shared memory for XLOG
  */
@@ -4658,11 +5091,24 @@ XLOGShmemSize(void)
 	}
 	Assert(XLOGbuffers > 0);
 
+	/* Likewise for wal_insert_locks */
+	if (XLOGinsertLocks == -1)
+	{
+		char		buf[32];
+
+		snprintf(buf, sizeof(buf), "%d", XLOGChooseNumInsertLocks());
+		SetConfigOption("wal_insert_locks", buf, PGC_POSTMASTER,
+						PGC_S_OVERRIDE);
+	}
+	Assert(XLOGinsertLocks > 0);
+
 	/* XLogCtl */
 	size = sizeof(XLogCtlData);
 
 	/* WAL insertion locks, plus alignment */
-	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NUM_XLOGINSERT_LOCKS + 1));
+	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), XLOGinsertLocks + 1));
+	/* prev-link table */
+	size = add_size(size, mul_size(sizeof(XLogPrevLink), XLogPrevLinksSize()));
 	/* xlblocks array */
 	size = add_size(size, mul_size(sizeof(XLogRecPtr), XLOGbuffers));
 	/* extra alignment padding for XLOG I/O buffers */
@@ -4737,18 +5183,31 @@ XLOGShmemInit(void)
 		((uintptr_t) allocptr) %sizeof(WALInsertLockPadded);
 	WALInsertLocks = XLogCtl->Insert.WALInsertLocks =
 		(WALInsertLockPadded *) allocptr;
-	allocptr += sizeof(WALInsertLockPadded) * NUM_XLOGINSERT_LOCKS;
+	allocptr += sizeof(WALInsertLockPadded) * XLOGinsertLocks;
 
 	XLogCtl->Insert.WALInsertLockTranche.name = "wal_insert";
 	XLogCtl->Insert.WALInsertLockTranche.array_base = WALInsertLocks;
 	XLogCtl->Insert.WALInsertLockTranche.array_stride = sizeof(WALInsertLockPadded);
 
 	LWLockRegisterTranche(LWTRANCHE_WAL_INSERT, &XLogCtl->Insert.WALInsertLockTranche);
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < XLOGinsertLocks; i++)
 	{
 		LWLockInitialize(&WALInsertLocks[i].l.lock, LWTRANCHE_WAL_INSERT);
 		WALInsertLocks[i].l.insertingAt = InvalidXLogRecPtr;
+		pg_atomic_init_u64(&WALInsertLocks[i].l.prevLinkWait, 0);
+		WALInsertLocks[i].l.prevLinkWaitProc = INVALID_PGPROCNO;
+	}
+
+	/* The prev-link table, which needs no extra alignment */
+	XLogCtl->Insert.PrevLinks = (XLogPrevLink *) allocptr;
+	XLogCtl->Insert.PrevLinksMask = XLogPrevLinksSize() - 1;
+	pg_atomic_init_u32(&XLogCtl->Insert.PrevLinkWaiters, 0);
+	for (i = 0; i <= XLogCtl->Insert.PrevLinksMask; i++)
+	{
+		pg_atomic_init_u64(&XLogCtl->Insert.PrevLinks[i].endpos, 0);
+		pg_atomic_init_u64(&XLogCtl->Insert.PrevLinks[i].startpos, 0);
 	}
+	allocptr += sizeof(XLogPrevLink) * XLogPrevLinksSize();
 
 	/*
 	 * Align the start of the page buffers to a full xlog block size boundary.
@@ -4764,11 +5223,12 @@ XLOGShmemInit(void)
 	 * in additional info.)
 	 */
 	XLogCtl->XLogCacheBlck = XLOGbuffers - 1;
+	XLogCtl->flushAvgInterval = FLUSH_STATS_MAX_SAMPLE;
 	XLogCtl->SharedRecoveryInProgress = true;
 	XLogCtl->SharedHotStandbyActive = false;
 	XLogCtl->WalWriterSleeping = false;
 
-	SpinLockInit(&XLogCtl->Insert.insertpos_lck);
+	pg_atomic_init_u64(&XLogCtl->Insert.CurrBytePos, 0);
 	SpinLockInit(&XLogCtl->info_lck);
 	SpinLockInit(&XLogCtl->ulsn_lck);
 	InitSharedLatch(&XLogCtl->recoveryWakeupLatch);
@@ -5685,6 +6145,9 @@ recoveryPausesHere(void)
 	if (!LocalHotStandbyActive)
 		return;
 
+	/* Let what's been replayed so far be visible while we're paused */
+	WaitForParallelRedo();
+
 	ereport(LOG,
 			(errmsg("recovery has paused"),
 			 errhint("Execute pg_xlog_replay_resume() to continue.")));
@@ -5696,6 +6159,29 @@ recoveryPausesHere(void)
 	}
 }
 
+/*
+ * Wait for the parallel redo workers to apply all records handed to them,
+ * and advance lastReplayedEndRecPtr past those records.
+ */
+static void
+WaitForParallelRedo(void)
+{
+	if (XLogRecPtrIsInvalid(lastDispatchedEndRecPtr))
+		return;
+
+	WaitForParallelRedoWorkers();
+
+	SpinLockAcquire(&XLogCtl->info_lck);
+	XLogCtl->lastReplayedEndRecPtr = lastDispatchedEndRecPtr;
+	XLogCtl->lastReplayedTLI = lastDispatchedTLI;
+	SpinLockRelease(&XLogCtl->info_lck);
+
+	lastDispatchedEndRecPtr = InvalidXLogRecPtr;
+
+	/* Allow read-only connections if we're consistent now */
+	CheckRecoveryConsistency();
+}
+
 bool
 RecoveryIsPaused(void)
 {
@@ -6752,6 +7238,7 @@ StartupXLOG(void)
 		{
 			ErrorContextCallback errcallback;
 			TimestampTz xtime;
+			XLogPrefetcher *prefetcher;
 
 			InRedo = true;
 
@@ -6759,6 +7246,11 @@ StartupXLOG(void)
 					(errmsg("redo starts at %X/%X",
 						 (uint32) (ReadRecPtr >> 32), (uint32) ReadRecPtr)));
 
+			/* Launch parallel redo workers, if enabled */
+			StartParallelRedo();
+
+			prefetcher = XLogPrefetcherAllocate();
+
 			/*
 			 * main redo apply loop
 			 */
@@ -6788,6 +7280,16 @@ StartupXLOG(void)
 				/* Handle interrupt signals of startup process */
 				HandleStartupProcInterrupts();
 
+				/*
+				 * Start reading the blocks that upcoming records will need.
+				 * When streaming, look no further than the WAL receiver has
+				 * flushed.
+				 */
+				XLogPrefetcherReadAhead(prefetcher, xlogreader, curFileTLI,
+										currentSource == XLOG_FROM_STREAM ?
+										GetWalRcvWriteRecPtr(NULL, NULL) :
+										InvalidXLogRecPtr);
+
 				/*
 				 * Pause WAL replay, if requested by a hot-standby session via
 				 * SetRecoveryPause().
@@ -6912,20 +7414,37 @@ StartupXLOG(void)
 					TransactionIdIsValid(record->xl_xid))
 					RecordKnownAssignedTransactionIds(record->xl_xid);
 
-				/* Now apply the WAL record itself */
-				RmgrTable[record->xl_rmid].rm_redo(xlogreader);
+				/*
+				 * Now apply the WAL record itself.  If a parallel redo worker
+				 * can replay it, just hand it over; otherwise, all records
+				 * handed out earlier must be applied before this one.
+				 */
+				if (ParallelRedoDispatch(xlogreader))
+				{
+					lastDispatchedEndRecPtr = EndRecPtr;
+					lastDispatchedTLI = ThisTimeLineID;
+				}
+				else
+				{
+					WaitForParallelRedo();
+					RmgrTable[record->xl_rmid].rm_redo(xlogreader);
+				}
 
 				/* Pop the error context stack */
 				error_context_stack = errcallback.previous;
 
 				/*
 				 * Update lastReplayedEndRecPtr after this record has been
-				 * successfully replayed.
+				 * successfully replayed.  If it was handed to a worker,
+				 * WaitForParallelRedo() will do it later.
 				 */
-				SpinLockAcquire(&XLogCtl->info_lck);
-				XLogCtl->lastReplayedEndRecPtr = EndRecPtr;
-				XLogCtl->lastReplayedTLI = ThisTimeLineID;
-				SpinLockRelease(&XLogCtl->info_lck);
+				if (XLogRecPtrIsInvalid(lastDispatchedEndRecPtr))
+				{
+					SpinLockAcquire(&XLogCtl->info_lck);
+					XLogCtl->lastReplayedEndRecPtr = EndRecPtr;
+					XLogCtl->lastReplayedTLI = ThisTimeLineID;
+					SpinLockRelease(&XLogCtl->info_lck);
+				}
 
 				/*
 				 * If rm_redo called XLogRequestWalReceiverReply, then we wake
@@ -6977,6 +7496,12 @@ StartupXLOG(void)
 			 * end of main redo apply loop
 			 */
 
+			/* Let the parallel redo workers finish, and shut them down */
+			WaitForParallelRedo();
+			EndParallelRedo();
+
+			XLogPrefetcherFree(prefetcher);
+
 			if (reachedStopPoint)
 			{
 				if (!reachedConsistency)
@@ -7191,8 +7716,9 @@ StartupXLOG(void)
 	 * previous incarnation.
 	 */
 	Insert = &XLogCtl->Insert;
-	Insert->PrevBytePos = XLogRecPtrToBytePos(LastRec);
-	Insert->CurrBytePos = XLogRecPtrToBytePos(EndOfLog);
+	pg_atomic_write_u64(&Insert->CurrBytePos, XLogRecPtrToBytePos(EndOfLog));
+	XLogPublishPrevLink(XLogRecPtrToBytePos(EndOfLog),
+						XLogRecPtrToBytePos(LastRec));
 
 	/*
 	 * Tricky point here: readBuf contains the *last* block that the LastRec
@@ -8215,6 +8741,7 @@ CreateCheckPoint(int flags)
 	XLogCtlInsert *Insert = &XLogCtl->Insert;
 	uint32		freespace;
 	XLogRecPtr	PriorRedoPtr;
+	uint64		curInsertBytePos;
 	XLogRecPtr	curInsert;
 	XLogRecPtr	prevPtr;
 	VirtualTransactionId *vxids;
@@ -8301,8 +8828,9 @@ CreateCheckPoint(int flags)
 	 * determine the checkpoint REDO pointer.
 	 */
 	WALInsertLockAcquireExclusive();
-	curInsert = XLogBytePosToRecPtr(Insert->CurrBytePos);
-	prevPtr = XLogBytePosToRecPtr(Insert->PrevBytePos);
+	curInsertBytePos = pg_atomic_read_u64(&Insert->CurrBytePos);
+	curInsert = XLogBytePosToRecPtr(curInsertBytePos);
+	prevPtr = XLogBytePosToRecPtr(XLogGetPrevLink(curInsertBytePos, false));
 
 	/*
 	 * If this isn't a shutdown or forced checkpoint, and we have not inserted
@@ -10784,9 +11312,7 @@ GetXLogInsertRecPtr(void)
 	XLogCtlInsert *Insert = &XLogCtl->Insert;
 	uint64		current_bytepos;
 
-	SpinLockAcquire(&Insert->insertpos_lck);
-	current_bytepos = Insert->CurrBytePos;
-	SpinLockRelease(&Insert->insertpos_lck);
+	current_bytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
 
 	return XLogBytePosToRecPtr(current_bytepos);
 }
@@ -11160,6 +11686,13 @@ retry:
 		(readSource == XLOG_FROM_STREAM &&
 		 receivedUpto < targetPagePtr + reqLen))
 	{
+		/*
+		 * We might have to wait for more WAL to arrive.  Before that, let
+		 * the parallel redo workers catch up, so that the replay position we
+		 * advertise, and hot standby, don't lag behind the WAL we've read.
+		 */
+		WaitForParallelRedo();
+
 		if (!WaitForWALToBecomeAvailable(targetPagePtr + reqLen,
 										 private->randAccess,
 										 private->fetching_ckpt,
@@ -24,6 +24,7 @@
 #include "access/xlog_internal.h"
 #include "access/xloginsert.h"
 #include "catalog/pg_control.h"
+#include "common/pg_lz4.h"
 #include "common/pg_lzcompress.h"
 #include "miscadmin.h"
 #include "replication/origin.h"
@@ -73,6 +74,17 @@ static XLogRecData *mainrdata_head;
 static XLogRecData *mainrdata_last = (XLogRecData *) &mainrdata_head;
 static uint32 mainrdata_len;	/* total # of bytes in chain */
 
+/*
+ * Working buffers for compressing the main data, when wal_compression is
+ * enabled.  'mainrdata_flat' holds the chain copied into one contiguous
+ * piece, and 'mainrdata_compressed' the result.  Like hdr_scratch, they
+ * are allocated at initialization, because records are assembled inside
+ * critical sections.
+ */
+static char *mainrdata_flat = NULL;
+static char *mainrdata_compressed = NULL;
+static XLogRecData mainrdata_compressed_rdt;
+
 /* Should the in-progress insertion log the origin? */
 static bool include_origin = false;
 
@@ -92,7 +104,7 @@ static char *hdr_scratch = NULL;
 #define HEADER_SCRATCH_SIZE \
 	(SizeOfXLogRecord + \
 	 MaxSizeOfXLogRecordBlockHeader * (XLR_MAX_BLOCK_ID + 1) + \
-	 SizeOfXLogRecordDataHeaderLong + SizeOfXlogOrigin)
+	 SizeOfXLogRecordDataHeaderCompressed + SizeOfXlogOrigin)
 
 /*
  * An array of XLogRecData structs, to hold registered data.
@@ -109,8 +121,11 @@ static MemoryContext xloginsert_cxt;
 static XLogRecData *XLogRecordAssemble(RmgrId rmid, uint8 info,
 				   XLogRecPtr RedoRecPtr, bool doPageWrites,
 				   XLogRecPtr *fpw_lsn);
+static int32 XLogCompressData(const char *source, int32 slen, char *dest,
+				 int32 limit);
 static bool XLogCompressBackupBlock(char *page, uint16 hole_offset,
 						uint16 hole_length, char *dest, uint16 *dlen);
+static int32 XLogCompressMainData(void);
 
 /*
  * Begin constructing a WAL record. This must be called before the
@@ -595,7 +610,7 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 			/*
 			 * Try to compress a block image if wal_compression is enabled
 			 */
-			if (wal_compression)
+			if (wal_compression != WAL_COMPRESSION_NONE)
 			{
 				is_compressed =
 					XLogCompressBackupBlock(page, bimg.hole_offset,
@@ -622,6 +637,8 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 			{
 				bimg.length = compressed_len;
 				bimg.bimg_info |= BKPIMAGE_IS_COMPRESSED;
+				if (wal_compression == WAL_COMPRESSION_LZ4)
+					bimg.bimg_info |= BKPIMAGE_COMPRESS_LZ4;
 
 				rdt_datas_last->data = regbuf->compressed_page;
 				rdt_datas_last->len = compressed_len;
@@ -711,20 +728,48 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 	/* followed by main data, if any */
 	if (mainrdata_len > 0)
 	{
-		if (mainrdata_len > 255)
+		int32		compressed_len = -1;
+
+		if (wal_compression != WAL_COMPRESSION_NONE &&
+			mainrdata_len >= XLR_DATA_COMPRESS_MIN &&
+			mainrdata_len <= XLR_DATA_COMPRESS_MAX)
+			compressed_len = XLogCompressMainData();
+
+		if (compressed_len >= 0)
 		{
-			*(scratch++) = (char) XLR_BLOCK_ID_DATA_LONG;
+			uint32		data_len = (uint32) compressed_len;
+
+			*(scratch++) = (char) XLR_BLOCK_ID_DATA_COMPRESSED;
+			*(scratch++) = (wal_compression == WAL_COMPRESSION_LZ4) ?
+				XLR_DATA_COMPRESS_LZ4 : XLR_DATA_COMPRESS_PGLZ;
+			memcpy(scratch, &data_len, sizeof(uint32));
+			scratch += sizeof(uint32);
 			memcpy(scratch, &mainrdata_len, sizeof(uint32));
 			scratch += sizeof(uint32);
+
+			mainrdata_compressed_rdt.data = mainrdata_compressed;
+			mainrdata_compressed_rdt.len = data_len;
+			rdt_datas_last->next = &mainrdata_compressed_rdt;
+			rdt_datas_last = &mainrdata_compressed_rdt;
+			total_len += data_len;
 		}
 		else
 		{
-			*(scratch++) = (char) XLR_BLOCK_ID_DATA_SHORT;
-			*(scratch++) = (uint8) mainrdata_len;
+			if (mainrdata_len > 255)
+			{
+				*(scratch++) = (char) XLR_BLOCK_ID_DATA_LONG;
+				memcpy(scratch, &mainrdata_len, sizeof(uint32));
+				scratch += sizeof(uint32);
+			}
+			else
+			{
+				*(scratch++) = (char) XLR_BLOCK_ID_DATA_SHORT;
+				*(scratch++) = (uint8) mainrdata_len;
+			}
+			rdt_datas_last->next = mainrdata_head;
+			rdt_datas_last = mainrdata_last;
+			total_len += mainrdata_len;
 		}
-		rdt_datas_last->next = mainrdata_head;
-		rdt_datas_last = mainrdata_last;
-		total_len += mainrdata_len;
 	}
 	rdt_datas_last->next = NULL;
 
@@ -759,6 +804,41 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 	return &hdr_rdt;
 }
 
+/*
+ * Compress 'slen' bytes at 'source' into 'dest', using the method selected
+ * by wal_compression.
+ *
+ * Returns the compressed length, or -1 if compression fails or the result
+ * is not shorter than 'limit' bytes.  'dest' must have room for
+ * PGLZ_MAX_OUTPUT(slen) bytes.
+ */
+static int32
+XLogCompressData(const char *source, int32 slen, char *dest, int32 limit)
+{
+	int32		len = -1;
+
+	switch (wal_compression)
+	{
+		case WAL_COMPRESSION_PGLZ:
+			len = pglz_compress(source, slen, dest, PGLZ_strategy_default);
+			break;
+
+		case WAL_COMPRESSION_LZ4:
+			/* LZ4 stops as soon as the output reaches the limit */
+			if (limit > 0)
+				len = pg_lz4_compress(source, slen, dest, limit - 1);
+			break;
+
+		default:
+			Assert(false);
+			break;
+	}
+
+	if (len < 0 || len >= limit)
+		return -1;
+	return len;
+}
+
 /*
  * Create a compressed version of a backup block image.
  *
@@ -795,13 +875,12 @@ XLogCompressBackupBlock(char *page, uint16 hole_offset, uint16 hole_length,
 		source = page;
 
 	/*
-	 * We recheck the actual size even if pglz_compress() reports success and
-	 * see if the number of bytes saved by compression is larger than the
-	 * length of extra data needed for the compressed version of block image.
+	 * Insist that the number of bytes saved by compression is larger than
+	 * the length of extra data needed for the compressed version of block
+	 * image.
 	 */
-	len = pglz_compress(source, orig_len, dest, PGLZ_strategy_default);
-	if (len >= 0 &&
-		len + extra_bytes < orig_len)
+	len = XLogCompressData(source, orig_len, dest, orig_len - extra_bytes);
+	if (len >= 0)
 	{
 		*dlen = (uint16) len;	/* successful compression */
 		return true;
@@ -809,6 +888,47 @@ XLogCompressBackupBlock(char *page, uint16 hole_offset, uint16 hole_length,
 	return false;
 }
 
+/*
+ * Create a compressed version of the main data registered for the record,
+ * in mainrdata_compressed.
+ *
+ * Returns the compressed length, or -1 if compression did not save more
+ * than the extra header bytes a compressed main data fragment needs.
+ */
+static int32
+XLogCompressMainData(void)
+{
+	char	   *source;
+	int32		limit;
+
+	Assert(mainrdata_len >= XLR_DATA_COMPRESS_MIN &&
+		   mainrdata_len <= XLR_DATA_COMPRESS_MAX);
+
+	/* Most callers register a single chunk, which we can use in place */
+	if (mainrdata_head == mainrdata_last)
+		source = mainrdata_head->data;
+	else
+	{
+		XLogRecData *rdt;
+		char	   *ptr = mainrdata_flat;
+
+		for (rdt = mainrdata_head; rdt != NULL; rdt = rdt->next)
+		{
+			memcpy(ptr, rdt->data, rdt->len);
+			ptr += rdt->len;
+			if (rdt == mainrdata_last)
+				break;
+		}
+		source = mainrdata_flat;
+	}
+
+	limit = mainrdata_len -
+		(SizeOfXLogRecordDataHeaderCompressed - SizeOfXLogRecordDataHeaderLong);
+
+	return XLogCompressData(source, mainrdata_len, mainrdata_compressed,
+							limit);
+}
+
 /*
  * Determine whether the buffer referenced has to be backed up.
  *
@@ -1020,4 +1140,15 @@ InitXLogInsert(void)
 	if (hdr_scratch == NULL)
 		hdr_scratch = MemoryContextAllocZero(xloginsert_cxt,
 											 HEADER_SCRATCH_SIZE);
+
+	/*
+	 * Allocate the buffers used to compress main data.
+	 */
+	if (mainrdata_flat == NULL)
+		mainrdata_flat = MemoryContextAlloc(xloginsert_cxt,
+											XLR_DATA_COMPRESS_MAX);
+	if (mainrdata_compressed == NULL)
+		mainrdata_compressed =
+			MemoryContextAlloc(xloginsert_cxt,
+							   PGLZ_MAX_OUTPUT(XLR_DATA_COMPRESS_MAX));
 }
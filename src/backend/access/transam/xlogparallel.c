@@ -0,0 +1,765 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogparallel.c
+ *	  Replay of WAL records by parallel redo workers
+ *
+ * The startup process reads and replays WAL one record at a time.  When
+ * parallel_redo_workers is set, it instead hands records that modify a
+ * single data block to a pool of background workers, choosing the worker by
+ * a hash of the block's identity.  Each worker applies its records in the
+ * order it receives them, so all changes to a given block are still
+ * replayed in WAL order, while changes to different blocks are replayed
+ * concurrently.
+ *
+ * Every other record is a barrier: the startup process waits until the
+ * workers have applied everything handed to them so far, and then replays
+ * the record itself, exactly as it would without workers.  That covers
+ * records touching several blocks, transaction commits and aborts,
+ * catalog, file and database operations, and anything that may need to
+ * resolve hot standby conflicts.  See the "Parallel Redo" section of
+ * src/backend/access/transam/README for the reasoning.
+ *
+ * Portions Copyright (c) 1996-2016, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/transam/xlogparallel.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/heapam_xlog.h"
+#include "access/nbtree.h"
+#include "access/xact.h"
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "access/xlogparallel.h"
+#include "access/xlogutils.h"
+#include "lib/stringinfo.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/startup.h"
+#include "storage/bufmgr.h"
+#include "storage/dsm.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/shm_toc.h"
+#include "storage/smgr.h"
+#include "tcop/tcopprot.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+/* GUC parameter */
+int			parallel_redo_workers = 0;
+
+/* Magic number and keys for the dynamic shared memory segment */
+#define PARALLEL_REDO_MAGIC				0x5245444f
+#define PARALLEL_REDO_KEY_SHARED		0
+#define PARALLEL_REDO_KEY_QUEUES		1
+
+/* Size of each worker's queue of records */
+#define PARALLEL_REDO_QUEUE_SIZE		(256 * 1024)
+
+/* Message types */
+#define PARALLEL_REDO_MSG_RECORD		'R'
+#define PARALLEL_REDO_MSG_CLOSE_FILES	'C'
+
+/*
+ * Every message sent to a worker starts with this header.  A record message
+ * is followed by the raw record, exactly as read from WAL.
+ */
+typedef struct ParallelRedoMessage
+{
+	char		type;			/* PARALLEL_REDO_MSG_* */
+	XLogRecPtr	ReadRecPtr;		/* start of the record */
+	XLogRecPtr	EndRecPtr;		/* end+1 of the record */
+} ParallelRedoMessage;
+
+/* State shared between the startup process and the workers */
+typedef struct ParallelRedoShared
+{
+	PGPROC	   *startup;		/* the startup process */
+	pg_atomic_uint32 startupWaiting;	/* should workers wake it up? */
+	pg_atomic_uint64 applied[FLEXIBLE_ARRAY_MEMBER];	/* messages processed,
+														 * per worker */
+} ParallelRedoShared;
+
+/* The startup process's view of one worker */
+typedef struct ParallelRedoWorker
+{
+	int			index;			/* worker's slot in the segment */
+	BackgroundWorkerHandle *handle;
+	shm_mq_handle *mqh;			/* queue we send its records to */
+	uint64		sent;			/* messages sent to it so far */
+} ParallelRedoWorker;
+
+/* Key used to assign a block to a worker */
+typedef struct ParallelRedoBlockKey
+{
+	RelFileNode rnode;
+	BlockNumber blkno;
+} ParallelRedoBlockKey;
+
+/* Startup process state; redo_nworkers is zero unless we're running */
+static dsm_segment *redo_seg = NULL;
+static ParallelRedoShared *redo_shared = NULL;
+static ParallelRedoWorker *redo_workers = NULL;
+static int	redo_nworkers = 0;
+
+/* Must workers close their files before replaying another record? */
+static bool redo_close_files_pending = false;
+
+static bool RecordIsParallelSafe(XLogReaderState *record);
+static bool RecordDropsFiles(XLogReaderState *record);
+static bool PrepareBlockForWorker(XLogReaderState *record, RelFileNode rnode,
+					  BlockNumber blkno);
+static void SendToWorker(ParallelRedoWorker *worker, char type,
+			 XLogReaderState *record);
+static BgwHandleStatus WaitForWorkerState(BackgroundWorkerHandle *handle,
+				   bool startup, pid_t *pidp);
+static void ForgetCachedForkSizes(XLogReaderState *record);
+static void parallel_redo_error_callback(void *arg);
+
+
+/*
+ * Launch the parallel redo workers, if configured.
+ *
+ * Called by the startup process just before it enters the redo loop.  If
+ * fewer workers than requested can be started, we carry on with those we
+ * got; with none, every record is simply replayed by the startup process.
+ */
+void
+StartParallelRedo(void)
+{
+	int			nworkers = parallel_redo_workers;
+	MemoryContext oldcontext;
+	ResourceOwner owner;
+	shm_toc_estimator e;
+	shm_toc    *toc;
+	Size		segsize;
+	Size		sharedsize;
+	char	   *queues;
+	BackgroundWorker worker;
+	int			i;
+
+	Assert(redo_seg == NULL);
+
+	/* Workers are started by the postmaster, so there are none standalone */
+	if (nworkers <= 0 || !IsUnderPostmaster)
+		return;
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+	/* Estimate and create the segment holding the shared state and queues */
+	sharedsize = add_size(offsetof(ParallelRedoShared, applied),
+						  mul_size(nworkers, sizeof(pg_atomic_uint64)));
+	shm_toc_initialize_estimator(&e);
+	shm_toc_estimate_chunk(&e, sharedsize);
+	shm_toc_estimate_chunk(&e, mul_size(nworkers, PARALLEL_REDO_QUEUE_SIZE));
+	shm_toc_estimate_keys(&e, 2);
+	segsize = shm_toc_estimate(&e);
+
+	/*
+	 * The startup process runs without a resource owner, but creating a
+	 * segment needs one.  Pin the mapping so that it survives for as long as
+	 * we need it, and get rid of the owner again.
+	 */
+	Assert(CurrentResourceOwner == NULL);
+	owner = ResourceOwnerCreate(NULL, "parallel redo");
+	CurrentResourceOwner = owner;
+	redo_seg = dsm_create(segsize, 0);
+	dsm_pin_mapping(redo_seg);
+	CurrentResourceOwner = NULL;
+	ResourceOwnerDelete(owner);
+
+	toc = shm_toc_create(PARALLEL_REDO_MAGIC, dsm_segment_address(redo_seg),
+						 segsize);
+
+	redo_shared = shm_toc_allocate(toc, sharedsize);
+	redo_shared->startup = MyProc;
+	pg_atomic_init_u32(&redo_shared->startupWaiting, 0);
+	for (i = 0; i < nworkers; i++)
+		pg_atomic_init_u64(&redo_shared->applied[i], 0);
+	shm_toc_insert(toc, PARALLEL_REDO_KEY_SHARED, redo_shared);
+
+	queues = shm_toc_allocate(toc, mul_size(nworkers, PARALLEL_REDO_QUEUE_SIZE));
+	shm_toc_insert(toc, PARALLEL_REDO_KEY_QUEUES, queues);
+
+	redo_workers = palloc0(sizeof(ParallelRedoWorker) * nworkers);
+
+	/* Configure a worker */
+	memset(&worker, 0, sizeof(worker));
+	snprintf(worker.bgw_name, BGW_MAXLEN, "parallel redo worker");
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+	worker.bgw_restart_time = BGW_NEVER_RESTART;
+	worker.bgw_main = NULL;
+	sprintf(worker.bgw_library_name, "postgres");
+	sprintf(worker.bgw_function_name, "ParallelRedoWorkerMain");
+	worker.bgw_main_arg = UInt32GetDatum(dsm_segment_handle(redo_seg));
+	worker.bgw_notify_pid = 0;	/* see WaitForWorkerState */
+
+	/* Start workers, and wait for each to come up */
+	for (i = 0; i < nworkers; i++)
+	{
+		shm_mq	   *mq;
+		BackgroundWorkerHandle *handle;
+		pid_t		pid;
+
+		mq = shm_mq_create(queues + i * PARALLEL_REDO_QUEUE_SIZE,
+						   PARALLEL_REDO_QUEUE_SIZE);
+		shm_mq_set_sender(mq, MyProc);
+
+		memcpy(worker.bgw_extra, &i, sizeof(int));
+		if (!RegisterDynamicBackgroundWorker(&worker, &handle))
+			break;				/* out of worker slots */
+		if (WaitForWorkerState(handle, true, &pid) != BGWH_STARTED)
+		{
+			pfree(handle);
+			continue;
+		}
+
+		redo_workers[redo_nworkers].index = i;
+		redo_workers[redo_nworkers].handle = handle;
+		redo_workers[redo_nworkers].mqh = shm_mq_attach(mq, redo_seg, handle);
+		redo_workers[redo_nworkers].sent = 0;
+		redo_nworkers++;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	if (redo_nworkers < nworkers)
+		ereport(LOG,
+				(errmsg("started %d of %d parallel redo workers",
+						redo_nworkers, nworkers),
+				 errhint("You might need to increase max_worker_processes.")));
+	else
+		ereport(DEBUG1,
+				(errmsg("started %d parallel redo workers", redo_nworkers)));
+
+	if (redo_nworkers == 0)
+		EndParallelRedo();
+}
+
+/*
+ * Hand a record to a parallel redo worker, if it can be replayed by one.
+ *
+ * Returns true if the record was dispatched.  Otherwise the caller must
+ * replay it itself, after WaitForParallelRedoWorkers().
+ */
+bool
+ParallelRedoDispatch(XLogReaderState *record)
+{
+	ParallelRedoBlockKey key;
+	ForkNumber	forknum;
+	ParallelRedoWorker *worker;
+	int			i;
+
+	if (redo_nworkers == 0)
+		return false;
+
+	memset(&key, 0, sizeof(key));
+	if (!RecordIsParallelSafe(record) ||
+		!XLogRecGetBlockTag(record, 0, &key.rnode, &forknum, &key.blkno) ||
+		forknum != MAIN_FORKNUM ||
+		!PrepareBlockForWorker(record, key.rnode, key.blkno))
+	{
+		/*
+		 * If the startup process is about to drop or truncate files, the
+		 * workers must forget their open file descriptors and cached
+		 * relation sizes before they see another record, much as regular
+		 * backends would on receiving an smgr invalidation.
+		 */
+		if (RecordDropsFiles(record))
+			redo_close_files_pending = true;
+		return false;
+	}
+
+	if (redo_close_files_pending)
+	{
+		for (i = 0; i < redo_nworkers; i++)
+			SendToWorker(&redo_workers[i], PARALLEL_REDO_MSG_CLOSE_FILES,
+						 NULL);
+		redo_close_files_pending = false;
+	}
+
+	worker = &redo_workers[hash_any((unsigned char *) &key, sizeof(key)) %
+						   redo_nworkers];
+	SendToWorker(worker, PARALLEL_REDO_MSG_RECORD, record);
+
+	return true;
+}
+
+/*
+ * Wait until the workers have applied every record handed to them.
+ */
+void
+WaitForParallelRedoWorkers(void)
+{
+	if (redo_nworkers == 0)
+		return;
+
+	pg_atomic_write_u32(&redo_shared->startupWaiting, 1);
+
+	for (;;)
+	{
+		bool		caught_up = true;
+		int			rc;
+		int			i;
+
+		/* Pairs with the atomic increment of applied[] in the workers */
+		pg_memory_barrier();
+
+		for (i = 0; i < redo_nworkers; i++)
+		{
+			ParallelRedoWorker *worker = &redo_workers[i];
+			pid_t		pid;
+
+			if (pg_atomic_read_u64(&redo_shared->applied[worker->index]) >=
+				worker->sent)
+				continue;
+
+			caught_up = false;
+			if (GetBackgroundWorkerPid(worker->handle, &pid) == BGWH_STOPPED)
+				ereport(FATAL,
+						(errmsg("parallel redo worker exited unexpectedly")));
+			break;
+		}
+		if (caught_up)
+			break;
+
+		/*
+		 * The workers set our latch as they make progress, but nobody tells
+		 * us if one of them dies, so check every now and then.
+		 */
+		rc = WaitLatch(MyLatch,
+					   WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+					   1000L);
+		if (rc & WL_POSTMASTER_DEATH)
+			proc_exit(1);
+		ResetLatch(MyLatch);
+
+		HandleStartupProcInterrupts();
+	}
+
+	pg_atomic_write_u32(&redo_shared->startupWaiting, 0);
+}
+
+/*
+ * Wait for the workers to finish, and shut them down.
+ */
+void
+EndParallelRedo(void)
+{
+	int			i;
+
+	if (redo_seg == NULL)
+		return;
+
+	WaitForParallelRedoWorkers();
+
+	/* Detaching from the queues tells the workers to exit */
+	for (i = 0; i < redo_nworkers; i++)
+		shm_mq_detach(shm_mq_get_queue(redo_workers[i].mqh));
+	for (i = 0; i < redo_nworkers; i++)
+	{
+		(void) WaitForWorkerState(redo_workers[i].handle, false, NULL);
+		pfree(redo_workers[i].handle);
+	}
+
+	dsm_detach(redo_seg);
+	pfree(redo_workers);
+
+	redo_seg = NULL;
+	redo_shared = NULL;
+	redo_workers = NULL;
+	redo_nworkers = 0;
+	redo_close_files_pending = false;
+}
+
+/*
+ * Wait for a worker to start (if 'startup'), or to stop.  Returns the
+ * worker's status, and stores its PID in *pidp if that's not NULL.
+ *
+ * WaitForBackgroundWorkerStartup and WaitForBackgroundWorkerShutdown can't
+ * be used here: they wait for the postmaster to signal bgw_notify_pid, which
+ * it only does for regular backends, not for the startup process; and the
+ * startup process's SIGUSR1 handler wouldn't set our latch anyway.  So we
+ * poll the worker's status instead.
+ */
+static BgwHandleStatus
+WaitForWorkerState(BackgroundWorkerHandle *handle, bool startup, pid_t *pidp)
+{
+	for (;;)
+	{
+		BgwHandleStatus status;
+		pid_t		pid;
+		int			rc;
+
+		status = GetBackgroundWorkerPid(handle, &pid);
+		if (status == BGWH_STOPPED || status == BGWH_POSTMASTER_DIED ||
+			(startup && status == BGWH_STARTED))
+		{
+			if (pidp)
+				*pidp = pid;
+			return status;
+		}
+
+		rc = WaitLatch(MyLatch,
+					   WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+					   10L);
+		if (rc & WL_POSTMASTER_DEATH)
+			proc_exit(1);
+		ResetLatch(MyLatch);
+
+		HandleStartupProcInterrupts();
+	}
+}
+
+/*
+ * Can this record be replayed by a worker?
+ *
+ * Only record types that modify a single block, and touch nothing else
+ * but the free space map and visibility map pages covering it (which are
+ * protected by buffer locks like in normal operation), qualify.  In
+ * particular, nothing that resolves hot standby conflicts, needs a cleanup
+ * lock, or changes the structure of an index is on this list.
+ */
+static bool
+RecordIsParallelSafe(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	if (record->max_block_id != 0)
+		return false;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_HEAP_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP_INSERT:
+				case XLOG_HEAP_DELETE:
+				case XLOG_HEAP_HOT_UPDATE:
+				case XLOG_HEAP_LOCK:
+					return true;
+			}
+			return false;
+
+		case RM_HEAP2_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP2_MULTI_INSERT:
+				case XLOG_HEAP2_LOCK_UPDATED:
+					return true;
+			}
+			return false;
+
+		case RM_BTREE_ID:
+			return info == XLOG_BTREE_INSERT_LEAF;
+
+		default:
+			return false;
+	}
+}
+
+/*
+ * Does replaying this record drop or truncate relation files?
+ */
+static bool
+RecordDropsFiles(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_SMGR_ID:
+		case RM_DBASE_ID:
+		case RM_TBLSPC_ID:
+			return true;
+
+		case RM_XACT_ID:
+			switch (info & XLOG_XACT_OPMASK)
+			{
+				case XLOG_XACT_COMMIT:
+				case XLOG_XACT_COMMIT_PREPARED:
+					{
+						xl_xact_parsed_commit parsed;
+
+						ParseCommitRecord(XLogRecGetInfo(record),
+									(xl_xact_commit *) XLogRecGetData(record),
+										  &parsed);
+						return parsed.nrels > 0;
+					}
+				case XLOG_XACT_ABORT:
+				case XLOG_XACT_ABORT_PREPARED:
+					{
+						xl_xact_parsed_abort parsed;
+
+						ParseAbortRecord(XLogRecGetInfo(record),
+									 (xl_xact_abort *) XLogRecGetData(record),
+										 &parsed);
+						return parsed.nrels > 0;
+					}
+			}
+			return false;
+
+		default:
+			return false;
+	}
+}
+
+/*
+ * Make sure the block a record refers to exists, before handing the record
+ * to a worker.
+ *
+ * Workers must never extend a relation's main fork, as they run
+ * concurrently with each other and with us.  A block that the record
+ * initializes from scratch, or restores from a full-page image, can be
+ * created here by extending the relation.  Any other reference beyond the
+ * end of the relation is left to the startup process, which keeps track of
+ * such invalid pages; returns false in that case.
+ */
+static bool
+PrepareBlockForWorker(XLogReaderState *record, RelFileNode rnode,
+					  BlockNumber blkno)
+{
+	SMgrRelation smgr;
+	Buffer		buffer;
+
+	smgr = smgropen(rnode, InvalidBackendId);
+	smgrcreate(smgr, MAIN_FORKNUM, true);
+	if (blkno < smgrnblocks(smgr, MAIN_FORKNUM))
+		return true;
+
+	if (!XLogRecHasBlockImage(record, 0) &&
+		(record->blocks[0].flags & BKPBLOCK_WILL_INIT) == 0)
+		return false;
+
+	buffer = XLogReadBufferExtended(rnode, MAIN_FORKNUM, blkno,
+									RBM_ZERO_AND_LOCK);
+	LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
+	ReleaseBuffer(buffer);
+
+	return true;
+}
+
+/*
+ * Send a message to a worker.  For a record message, 'record' is the
+ * record to replay; otherwise it's NULL.
+ */
+static void
+SendToWorker(ParallelRedoWorker *worker, char type, XLogReaderState *record)
+{
+	ParallelRedoMessage msg;
+	shm_mq_iovec iov[2];
+	int			iovcnt = 1;
+	shm_mq_result res;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = type;
+	iov[0].data = (char *) &msg;
+	iov[0].len = sizeof(msg);
+
+	if (record != NULL)
+	{
+		msg.ReadRecPtr = record->ReadRecPtr;
+		msg.EndRecPtr = record->EndRecPtr;
+		iov[1].data = (char *) record->decoded_record;
+		iov[1].len = record->decoded_record->xl_tot_len;
+		iovcnt = 2;
+	}
+
+	res = shm_mq_sendv(worker->mqh, iov, iovcnt, false);
+	if (res != SHM_MQ_SUCCESS)
+		ereport(FATAL,
+				(errmsg("parallel redo worker exited unexpectedly")));
+
+	worker->sent++;
+}
+
+/*
+ * Main entry point for parallel redo workers.
+ */
+void
+ParallelRedoWorkerMain(Datum main_arg)
+{
+	dsm_segment *seg;
+	shm_toc    *toc;
+	ParallelRedoShared *shared;
+	char	   *queues;
+	shm_mq	   *mq;
+	shm_mq_handle *mqh;
+	XLogReaderState *reader;
+	MemoryContext redo_context;
+	ErrorContextCallback errcallback;
+	int			myindex;
+
+	/* Establish signal handlers. */
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	memcpy(&myindex, MyBgworkerEntry->bgw_extra, sizeof(int));
+
+	/* Attach to the segment and find our queue */
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "parallel redo worker");
+	seg = dsm_attach(DatumGetUInt32(main_arg));
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+	toc = shm_toc_attach(PARALLEL_REDO_MAGIC, dsm_segment_address(seg));
+	if (toc == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+		   errmsg("invalid magic number in dynamic shared memory segment")));
+	shared = shm_toc_lookup(toc, PARALLEL_REDO_KEY_SHARED);
+	queues = shm_toc_lookup(toc, PARALLEL_REDO_KEY_QUEUES);
+
+	mq = (shm_mq *) (queues + myindex * PARALLEL_REDO_QUEUE_SIZE);
+	shm_mq_set_receiver(mq, MyProc);
+	mqh = shm_mq_attach(mq, seg, NULL);
+
+	/* Redo routines expect to be run in recovery, as in the startup process */
+	InRecovery = true;
+
+	reader = XLogReaderAllocate(NULL, NULL);
+	if (reader == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+			errdetail("Failed while allocating an XLog reading processor.")));
+
+	redo_context = AllocSetContextCreate(TopMemoryContext,
+										 "Parallel redo",
+										 ALLOCSET_DEFAULT_SIZES);
+
+	errcallback.callback = parallel_redo_error_callback;
+	errcallback.arg = (void *) reader;
+
+	for (;;)
+	{
+		ParallelRedoMessage msg;
+		shm_mq_result res;
+		Size		nbytes;
+		void	   *data;
+
+		res = shm_mq_receive(mqh, &nbytes, &data, false);
+		if (res != SHM_MQ_SUCCESS)
+			break;				/* the startup process is done with us */
+
+		if (nbytes < sizeof(msg))
+			elog(ERROR, "invalid parallel redo message length %zu", nbytes);
+		memcpy(&msg, data, sizeof(msg));
+
+		if (msg.type == PARALLEL_REDO_MSG_CLOSE_FILES)
+			smgrcloseall();
+		else if (msg.type == PARALLEL_REDO_MSG_RECORD)
+		{
+			XLogRecord *record;
+			MemoryContext oldcontext;
+			char	   *errormsg;
+
+			/* shm_mq hands us MAXALIGN'd data, and the header keeps it so */
+			record = (XLogRecord *) ((char *) data + sizeof(msg));
+
+			reader->ReadRecPtr = msg.ReadRecPtr;
+			reader->EndRecPtr = msg.EndRecPtr;
+			if (!DecodeXLogRecord(reader, record, &errormsg))
+				elog(ERROR, "could not decode WAL record at %X/%X: %s",
+					 (uint32) (msg.ReadRecPtr >> 32), (uint32) msg.ReadRecPtr,
+					 errormsg);
+
+			ForgetCachedForkSizes(reader);
+
+			oldcontext = MemoryContextSwitchTo(redo_context);
+			errcallback.previous = error_context_stack;
+			error_context_stack = &errcallback;
+
+			RmgrTable[record->xl_rmid].rm_redo(reader);
+
+			error_context_stack = errcallback.previous;
+			MemoryContextSwitchTo(oldcontext);
+			MemoryContextReset(redo_context);
+		}
+		else
+			elog(ERROR, "invalid parallel redo message type %d", msg.type);
+
+		/*
+		 * Report progress, and wake up the startup process if it's waiting
+		 * for us.  The increment is a full barrier, so we can't miss its
+		 * setting startupWaiting after checking our progress.
+		 */
+		pg_atomic_fetch_add_u64(&shared->applied[myindex], 1);
+		if (pg_atomic_read_u32(&shared->startupWaiting) != 0)
+			SetLatch(&shared->startup->procLatch);
+	}
+}
+
+/*
+ * Forget the cached sizes of the visibility map and free space map of the
+ * relations a record refers to.
+ *
+ * The startup process and other workers extend those forks behind our back
+ * (heap_xlog_visible, for one, is replayed by the startup process), and
+ * nobody sends us an smgr invalidation when they do.  The redo routines
+ * trust the cached sizes -- visibilitymap_clear() fails if the map page
+ * isn't there -- so make them look the sizes up again.  That costs an
+ * lseek per fork, only when the fork is used.
+ */
+static void
+ForgetCachedForkSizes(XLogReaderState *record)
+{
+	int			block_id;
+
+	for (block_id = 0; block_id <= record->max_block_id; block_id++)
+	{
+		RelFileNode rnode;
+		ForkNumber	forknum;
+		BlockNumber blkno;
+		SMgrRelation smgr;
+
+		if (!XLogRecGetBlockTag(record, block_id, &rnode, &forknum, &blkno))
+			continue;
+
+		smgr = smgropen(rnode, InvalidBackendId);
+		smgr->smgr_fsm_nblocks = InvalidBlockNumber;
+		smgr->smgr_vm_nblocks = InvalidBlockNumber;
+	}
+}
+
+/*
+ * Error context callback for errors occurring during rm_redo() in a worker.
+ */
+static void
+parallel_redo_error_callback(void *arg)
+{
+	XLogReaderState *record = (XLogReaderState *) arg;
+	RmgrId		rmid = XLogRecGetRmid(record);
+	uint8		info = XLogRecGetInfo(record);
+	const char *id;
+	StringInfoData buf;
+
+	initStringInfo(&buf);
+	appendStringInfoString(&buf, RmgrTable[rmid].rm_name);
+	appendStringInfoChar(&buf, '/');
+	id = RmgrTable[rmid].rm_identify(info);
+	if (id == NULL)
+		appendStringInfo(&buf, "UNKNOWN (%X): ", info & ~XLR_INFO_MASK);
+	else
+		appendStringInfo(&buf, "%s: ", id);
+	RmgrTable[rmid].rm_desc(&buf, record);
+
+	/* translator: %s is an XLog record description */
+	errcontext("xlog redo at %X/%X for %s",
+			   (uint32) (record->ReadRecPtr >> 32),
+			   (uint32) record->ReadRecPtr,
+			   buf.data);
+
+	pfree(buf.data);
+}
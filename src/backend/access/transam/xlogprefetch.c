@@ -0,0 +1,313 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogprefetch.c
+ *	  Prefetching of blocks referenced by WAL during recovery
+ *
+ * Redo routines read the blocks a WAL record modifies synchronously, one
+ * record at a time, so replay of a workload whose data doesn't fit in
+ * memory spends most of its time waiting for reads.  To avoid that, the
+ * startup process runs a second xlogreader some distance ahead of the
+ * record being replayed, and issues prefetch requests for the blocks that
+ * records in that window refer to, so that by the time replay reaches
+ * them, the reads are already done or at least in progress.
+ *
+ * The lookahead reader only reads WAL that is already available in pg_xlog,
+ * and when streaming, only as far as the WAL receiver has flushed.  It
+ * never waits for more WAL or restores files from the archive; when it runs
+ * out of WAL it just stops, and tries again once replay has moved on.
+ * Anything it gets wrong costs at most a useless prefetch, since replay
+ * itself reads every record again and doesn't depend on the lookahead.
+ *
+ * Portions Copyright (c) 1996-2016, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/transam/xlogprefetch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "access/hash.h"
+#include "access/xlog_internal.h"
+#include "access/xlogprefetch.h"
+#include "access/xlogreader.h"
+#include "storage/bufmgr.h"
+#include "storage/fd.h"
+#include "storage/smgr.h"
+
+
+/* GUC parameter: how far ahead of replay to read WAL, in kB; 0 disables */
+int			recovery_prefetch_distance = 0;
+
+/*
+ * Number of recently prefetched blocks we remember, to avoid issuing the same
+ * prefetch over and over for a hot block.  Must be a power of 2.
+ */
+#define XLOGPREFETCHER_RECENT_SIZE		256
+
+typedef struct XLogPrefetchBlock
+{
+	RelFileNode rnode;
+	ForkNumber	forknum;
+	BlockNumber blkno;
+} XLogPrefetchBlock;
+
+struct XLogPrefetcher
+{
+	XLogReaderState *reader;	/* the lookahead reader */
+
+	/* must the lookahead restart at the record being replayed? */
+	bool		reset;
+
+	/* after running out of WAL, don't try again until replay gets here */
+	XLogRecPtr	retryPtr;
+
+	/* state of XLogPrefetcherReadPage */
+	TimeLineID	tli;			/* timeline of the WAL files to read */
+	XLogRecPtr	limitPtr;		/* don't read past here, if valid */
+	int			readFile;		/* currently open WAL file, or -1 */
+	XLogSegNo	readSegNo;		/* segment number of readFile */
+
+	/* direct-mapped cache of blocks prefetched recently */
+	XLogPrefetchBlock recent[XLOGPREFETCHER_RECENT_SIZE];
+
+	/* statistics, reported at the end of recovery */
+	uint64		prefetched;
+	uint64		skipped;
+};
+
+static int XLogPrefetcherReadPage(XLogReaderState *xlogreader,
+					   XLogRecPtr targetPagePtr, int reqLen,
+					   XLogRecPtr targetRecPtr, char *readBuf,
+					   TimeLineID *pageTLI);
+static void XLogPrefetcherCloseFile(XLogPrefetcher *prefetcher);
+static void XLogPrefetcherScanBlocks(XLogPrefetcher *prefetcher);
+
+
+/*
+ * Create a prefetcher.  It does nothing until XLogPrefetcherReadAhead is
+ * called with recovery_prefetch_distance set.
+ */
+XLogPrefetcher *
+XLogPrefetcherAllocate(void)
+{
+	XLogPrefetcher *prefetcher;
+
+	prefetcher = palloc0(sizeof(XLogPrefetcher));
+	prefetcher->reader = XLogReaderAllocate(&XLogPrefetcherReadPage,
+											prefetcher);
+	if (!prefetcher->reader)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+			errdetail("Failed while allocating an XLog reading processor.")));
+	prefetcher->reset = true;
+	prefetcher->retryPtr = InvalidXLogRecPtr;
+	prefetcher->readFile = -1;
+
+	return prefetcher;
+}
+
+/*
+ * Release a prefetcher's resources.
+ */
+void
+XLogPrefetcherFree(XLogPrefetcher *prefetcher)
+{
+	if (prefetcher->prefetched > 0 || prefetcher->skipped > 0)
+		elog(DEBUG1, "recovery prefetched " UINT64_FORMAT " blocks, skipped "
+			 UINT64_FORMAT, prefetcher->prefetched, prefetcher->skipped);
+
+	XLogPrefetcherCloseFile(prefetcher);
+	XLogReaderFree(prefetcher->reader);
+	pfree(prefetcher);
+}
+
+/*
+ * Read ahead of the record that replay is about to apply, and prefetch the
+ * blocks referenced by the records found, until the lookahead is
+ * recovery_prefetch_distance ahead of replay or there's no more WAL to read.
+ *
+ * 'replay' is the reader replay uses, positioned at the record about to be
+ * replayed.  'tli' is the timeline of the WAL file that record was read
+ * from.  If 'limitPtr' is valid, WAL beyond it isn't read.
+ */
+void
+XLogPrefetcherReadAhead(XLogPrefetcher *prefetcher, XLogReaderState *replay,
+						TimeLineID tli, XLogRecPtr limitPtr)
+{
+	XLogReaderState *reader = prefetcher->reader;
+	XLogRecPtr	startPtr = InvalidXLogRecPtr;
+	XLogRecPtr	distance;
+
+	if (recovery_prefetch_distance <= 0)
+		return;
+	distance = (XLogRecPtr) recovery_prefetch_distance * 1024;
+
+	/* Did we run out of WAL recently? */
+	if (replay->ReadRecPtr < prefetcher->retryPtr)
+		return;
+
+	/* WAL ahead of us is different on a new timeline, so start over */
+	if (tli != prefetcher->tli)
+	{
+		XLogPrefetcherCloseFile(prefetcher);
+		prefetcher->tli = tli;
+		prefetcher->reset = true;
+	}
+	prefetcher->limitPtr = limitPtr;
+
+	/*
+	 * Start at the record being replayed if we haven't started yet, or if
+	 * replay has overtaken the lookahead, which happens when the WAL replay
+	 * reads is restored from the archive.
+	 */
+	if (prefetcher->reset || reader->EndRecPtr <= replay->ReadRecPtr)
+	{
+		startPtr = replay->ReadRecPtr;
+		prefetcher->reset = false;
+	}
+
+	while (!XLogRecPtrIsInvalid(startPtr) ||
+		   reader->EndRecPtr < replay->EndRecPtr + distance)
+	{
+		XLogRecord *record;
+		char	   *errormsg;
+
+		record = XLogReadRecord(reader, startPtr, &errormsg);
+		if (record == NULL)
+		{
+			/*
+			 * We've read all the WAL available so far, or hit the end of
+			 * WAL.  Try again once replay has consumed another page's worth;
+			 * the reader picks up where it left off.
+			 */
+			if (!XLogRecPtrIsInvalid(startPtr))
+				prefetcher->reset = true;
+			prefetcher->retryPtr = replay->ReadRecPtr + XLOG_BLCKSZ;
+			break;
+		}
+		startPtr = InvalidXLogRecPtr;
+
+		XLogPrefetcherScanBlocks(prefetcher);
+	}
+}
+
+/*
+ * Issue prefetch requests for the blocks referenced by the record the
+ * lookahead reader has just read.
+ */
+static void
+XLogPrefetcherScanBlocks(XLogPrefetcher *prefetcher)
+{
+	XLogReaderState *reader = prefetcher->reader;
+	int			block_id;
+
+	for (block_id = 0; block_id <= reader->max_block_id; block_id++)
+	{
+		XLogPrefetchBlock block;
+		XLogPrefetchBlock *recent;
+		uint32		hash;
+		SMgrRelation reln;
+
+		if (!XLogRecGetBlockTag(reader, block_id,
+								&block.rnode, &block.forknum, &block.blkno))
+			continue;
+
+		/* Replay won't read a page it is going to overwrite anyway */
+		if (XLogRecHasBlockImage(reader, block_id) ||
+			(reader->blocks[block_id].flags & BKPBLOCK_WILL_INIT) != 0)
+		{
+			prefetcher->skipped++;
+			continue;
+		}
+
+		/* Have we asked for this block recently? */
+		hash = DatumGetUInt32(hash_any((unsigned char *) &block,
+									   sizeof(block)));
+		recent = &prefetcher->recent[hash & (XLOGPREFETCHER_RECENT_SIZE - 1)];
+		if (memcmp(recent, &block, sizeof(block)) == 0)
+		{
+			prefetcher->skipped++;
+			continue;
+		}
+		*recent = block;
+
+		/*
+		 * The relation doesn't exist yet if a record we haven't replayed yet
+		 * creates it, and the block is beyond the end if the relation is
+		 * about to be extended.  There's nothing to read in either case.
+		 */
+		reln = smgropen(block.rnode, InvalidBackendId);
+		if (!smgrexists(reln, block.forknum) ||
+			block.blkno >= smgrnblocks(reln, block.forknum))
+		{
+			prefetcher->skipped++;
+			continue;
+		}
+
+		PrefetchSharedBufferRange(reln, block.forknum, block.blkno, 1);
+		prefetcher->prefetched++;
+	}
+}
+
+/*
+ * Page read callback for the lookahead reader.  Reads WAL straight from the
+ * files in pg_xlog, and returns -1 rather than waiting if the page isn't
+ * there yet.
+ */
+static int
+XLogPrefetcherReadPage(XLogReaderState *xlogreader, XLogRecPtr targetPagePtr,
+					   int reqLen, XLogRecPtr targetRecPtr, char *readBuf,
+					   TimeLineID *pageTLI)
+{
+	XLogPrefetcher *prefetcher = (XLogPrefetcher *) xlogreader->private_data;
+	uint32		targetPageOff;
+	int			readLen = XLOG_BLCKSZ;
+
+	/* Don't use WAL the WAL receiver hasn't flushed yet */
+	if (!XLogRecPtrIsInvalid(prefetcher->limitPtr))
+	{
+		if (targetPagePtr + reqLen > prefetcher->limitPtr)
+			return -1;
+		if (targetPagePtr + XLOG_BLCKSZ > prefetcher->limitPtr)
+			readLen = prefetcher->limitPtr - targetPagePtr;
+	}
+
+	if (prefetcher->readFile >= 0 &&
+		!XLByteInSeg(targetPagePtr, prefetcher->readSegNo))
+		XLogPrefetcherCloseFile(prefetcher);
+
+	if (prefetcher->readFile < 0)
+	{
+		char		path[MAXPGPATH];
+
+		XLByteToSeg(targetPagePtr, prefetcher->readSegNo);
+		XLogFilePath(path, prefetcher->tli, prefetcher->readSegNo);
+		prefetcher->readFile = BasicOpenFile(path, O_RDONLY | PG_BINARY, 0);
+		if (prefetcher->readFile < 0)
+			return -1;
+	}
+
+	targetPageOff = targetPagePtr % XLogSegSize;
+	if (lseek(prefetcher->readFile, (off_t) targetPageOff, SEEK_SET) < 0 ||
+		read(prefetcher->readFile, readBuf, XLOG_BLCKSZ) != XLOG_BLCKSZ)
+		return -1;
+
+	*pageTLI = prefetcher->tli;
+	return readLen;
+}
+
+static void
+XLogPrefetcherCloseFile(XLogPrefetcher *prefetcher)
+{
+	if (prefetcher->readFile >= 0)
+	{
+		close(prefetcher->readFile);
+		prefetcher->readFile = -1;
+	}
+}
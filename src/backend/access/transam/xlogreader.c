@@ -22,6 +22,7 @@
 #include "access/xlog_internal.h"
 #include "access/xlogreader.h"
 #include "catalog/pg_control.h"
+#include "common/pg_lz4.h"
 #include "common/pg_lzcompress.h"
 #include "replication/origin.h"
 
@@ -1026,6 +1027,8 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 	uint32		datatotal;
 	RelFileNode *rnode = NULL;
 	uint8		block_id;
+	uint8		main_data_method = 0;
+	uint32		main_data_rawlen = 0;
 
 	ResetDecoder(state);
 
@@ -1065,6 +1068,41 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 			break;				/* by convention, the main data fragment is
 								 * always last */
 		}
+		else if (block_id == XLR_BLOCK_ID_DATA_COMPRESSED)
+		{
+			/* XLogRecordDataHeaderCompressed */
+			uint32		main_data_len;
+
+			COPY_HEADER_FIELD(&main_data_method, sizeof(uint8));
+			COPY_HEADER_FIELD(&main_data_len, sizeof(uint32));
+			COPY_HEADER_FIELD(&main_data_rawlen, sizeof(uint32));
+			if (main_data_method != XLR_DATA_COMPRESS_PGLZ &&
+				main_data_method != XLR_DATA_COMPRESS_LZ4)
+			{
+				report_invalid_record(state,
+						"invalid main data compression method %u at %X/%X",
+									  (unsigned int) main_data_method,
+									  (uint32) (state->ReadRecPtr >> 32), (uint32) state->ReadRecPtr);
+				goto err;
+			}
+			/* only data that actually shrank is ever stored compressed */
+			if (main_data_len == 0 ||
+				main_data_rawlen < XLR_DATA_COMPRESS_MIN ||
+				main_data_rawlen > XLR_DATA_COMPRESS_MAX ||
+				main_data_len >= main_data_rawlen)
+			{
+				report_invalid_record(state,
+									  "invalid compressed main data length %u, raw length %u at %X/%X",
+									  (unsigned int) main_data_len,
+									  (unsigned int) main_data_rawlen,
+									  (uint32) (state->ReadRecPtr >> 32), (uint32) state->ReadRecPtr);
+				goto err;
+			}
+			state->main_data_len = main_data_len;
+			datatotal += main_data_len;
+			break;				/* by convention, the main data fragment is
+								 * always last */
+		}
 		else if (block_id == XLR_BLOCK_ID_ORIGIN)
 		{
 			COPY_HEADER_FIELD(&state->record_origin, sizeof(RepOriginId));
@@ -1177,6 +1215,19 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 					goto err;
 				}
 
+				/*
+				 * cross-check that COMPRESS_LZ4 is only set together with
+				 * IS_COMPRESSED.
+				 */
+				if ((blk->bimg_info & BKPIMAGE_COMPRESS_LZ4) &&
+					!(blk->bimg_info & BKPIMAGE_IS_COMPRESSED))
+				{
+					report_invalid_record(state,
+										  "BKPIMAGE_COMPRESS_LZ4 set, but BKPIMAGE_IS_COMPRESSED not set at %X/%X",
+										  (uint32) (state->ReadRecPtr >> 32), (uint32) state->ReadRecPtr);
+					goto err;
+				}
+
 				/*
 				 * cross-check that bimg_len = BLCKSZ if neither HAS_HOLE nor
 				 * IS_COMPRESSED flag is set.
@@ -1261,9 +1312,14 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 		}
 	}
 
-	/* and finally, the main data */
+	/* and finally, the main data, decompressing it if needed */
 	if (state->main_data_len > 0)
 	{
+		uint32		data_len = state->main_data_len;
+
+		if (main_data_method != 0)
+			state->main_data_len = main_data_rawlen;
+
 		if (!state->main_data || state->main_data_len > state->main_data_bufsz)
 		{
 			if (state->main_data)
@@ -1271,8 +1327,28 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 			state->main_data_bufsz = state->main_data_len;
 			state->main_data = palloc(state->main_data_bufsz);
 		}
-		memcpy(state->main_data, ptr, state->main_data_len);
-		ptr += state->main_data_len;
+
+		if (main_data_method == 0)
+			memcpy(state->main_data, ptr, data_len);
+		else
+		{
+			int32		len;
+
+			if (main_data_method == XLR_DATA_COMPRESS_LZ4)
+				len = pg_lz4_decompress(ptr, data_len, state->main_data,
+										main_data_rawlen);
+			else
+				len = pglz_decompress(ptr, data_len, state->main_data,
+									  main_data_rawlen);
+			if (len != (int32) main_data_rawlen)
+			{
+				report_invalid_record(state,
+									  "invalid compressed main data at %X/%X",
+									  (uint32) (state->ReadRecPtr >> 32), (uint32) state->ReadRecPtr);
+				goto err;
+			}
+		}
+		ptr += data_len;
 	}
 
 	return true;
@@ -1364,9 +1440,16 @@ RestoreBlockImage(XLogReaderState *record, uint8 block_id, char *page)
 
 	if (bkpb->bimg_info & BKPIMAGE_IS_COMPRESSED)
 	{
+		int32		len;
+
 		/* If a backup block image is compressed, decompress it */
-		if (pglz_decompress(ptr, bkpb->bimg_len, tmp,
-							BLCKSZ - bkpb->hole_length) < 0)
+		if (bkpb->bimg_info & BKPIMAGE_COMPRESS_LZ4)
+			len = pg_lz4_decompress(ptr, bkpb->bimg_len, tmp,
+									BLCKSZ - bkpb->hole_length);
+		else
+			len = pglz_decompress(ptr, bkpb->bimg_len, tmp,
+								  BLCKSZ - bkpb->hole_length);
+		if (len < 0)
 		{
 			report_invalid_record(record, "invalid compressed image at %X/%X, block %d",
 								  (uint32) (record->ReadRecPtr >> 32),
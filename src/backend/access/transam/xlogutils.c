@@ -21,9 +21,11 @@
 
 #include "access/xlog.h"
 #include "access/xlog_internal.h"
+#include "access/xlogparallel.h"
 #include "access/xlogutils.h"
 #include "catalog/catalog.h"
 #include "miscadmin.h"
+#include "storage/lmgr.h"
 #include "storage/smgr.h"
 #include "utils/guc.h"
 #include "utils/hsearch.h"
@@ -438,6 +440,7 @@ XLogReadBufferExtended(RelFileNode rnode, ForkNumber forknum,
 	BlockNumber lastblock;
 	Buffer		buffer;
 	SMgrRelation smgr;
+	Relation	fakerel = NULL;
 
 	Assert(blkno != P_NEW);
 
@@ -472,9 +475,18 @@ XLogReadBufferExtended(RelFileNode rnode, ForkNumber forknum,
 		}
 		if (mode == RBM_NORMAL_NO_LOG)
 			return InvalidBuffer;
-		/* OK to extend the file */
-		/* we do this in recovery only - no rel-extension lock needed */
+
+		/*
+		 * OK to extend the file.  We do this in recovery only, so normally
+		 * no rel-extension lock is needed.  But parallel redo workers may update the free space map
+		 * of the same relation concurrently, so take it if they're enabled.
+		 */
 		Assert(InRecovery);
+		if (parallel_redo_workers > 0)
+		{
+			fakerel = CreateFakeRelcacheEntry(rnode);
+			LockRelationForExtension(fakerel, ExclusiveLock);
+		}
 		buffer = InvalidBuffer;
 		do
 		{
@@ -497,6 +509,11 @@ XLogReadBufferExtended(RelFileNode rnode, ForkNumber forknum,
 			buffer = ReadBufferWithoutRelcache(rnode, forknum, blkno,
 											   mode, NULL);
 		}
+		if (fakerel != NULL)
+		{
+			UnlockRelationForExtension(fakerel, ExclusiveLock);
+			FreeFakeRelcacheEntry(fakerel);
+		}
 	}
 
 	if (mode == RBM_NORMAL)
@@ -350,7 +350,10 @@ AuxiliaryProcessMain(int argc, char *argv[])
 
 	/* Initialize MaxBackends (if under postmaster, was done already) */
 	if (!IsUnderPostmaster)
+	{
 		InitializeMaxBackends();
+		InitializeFastPathLocks();
+	}
 
 	BaseInit();
 
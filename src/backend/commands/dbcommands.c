@@ -2066,6 +2066,12 @@ dbase_redo(XLogReaderState *record)
 		 */
 		if (stat(dst_path, &st) == 0 && S_ISDIR(st.st_mode))
 		{
+			/*
+			 * Close any files we have open in it first; mdexists() relies
+			 * on redo closing files before it removes them.
+			 */
+			smgrcloseall();
+
 			if (!rmtree(dst_path, true))
 				/* If this failed, copydir() below is going to error. */
 				ereport(WARNING,
@@ -100,6 +100,8 @@ static void show_tablesample(TableSampleClause *tsc, PlanState *planstate,
 				 List *ancestors, ExplainState *es);
 static void show_sort_info(SortState *sortstate, ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
+static void show_resultcache_info(ResultCacheState *rcstate, List *ancestors,
+					  ExplainState *es);
 static void show_tidbitmap_info(BitmapHeapScanState *planstate,
 					ExplainState *es);
 static void show_instrumentation_count(const char *qlabel, int which,
@@ -945,6 +947,9 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Material:
 			pname = sname = "Materialize";
 			break;
+		case T_ResultCache:
+			pname = sname = "Result Cache";
+			break;
 		case T_Sort:
 			pname = sname = "Sort";
 			break;
@@ -1500,6 +1505,10 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Hash:
 			show_hash_info((HashState *) planstate, es);
 			break;
+		case T_ResultCache:
+			show_resultcache_info((ResultCacheState *) planstate, ancestors,
+								  es);
+			break;
 		default:
 			break;
 	}
@@ -2228,6 +2237,67 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 	}
 }
 
+/*
+ * Show the cache keys of a Result Cache node, and if it's EXPLAIN ANALYZE,
+ * how well the cache did.
+ */
+static void
+show_resultcache_info(ResultCacheState *rcstate, List *ancestors,
+					  ExplainState *es)
+{
+	Plan	   *plan = ((PlanState *) rcstate)->plan;
+	List	   *context;
+	StringInfoData keystr;
+	bool		useprefix;
+	char	   *separator = "";
+	ListCell   *lc;
+
+	initStringInfo(&keystr);
+
+	useprefix = (list_length(es->rtable) > 1 || es->verbose);
+
+	/* Set up deparsing context */
+	context = set_deparse_context_planstate(es->deparse_cxt,
+											(Node *) rcstate,
+											ancestors);
+
+	foreach(lc, ((ResultCache *) plan)->param_exprs)
+	{
+		Node	   *expr = (Node *) lfirst(lc);
+
+		appendStringInfoString(&keystr, separator);
+		appendStringInfoString(&keystr,
+							   deparse_expression(expr, context,
+												  useprefix, false));
+		separator = ", ";
+	}
+
+	ExplainPropertyText("Cache Key", keystr.data, es);
+	pfree(keystr.data);
+
+	if (!es->analyze)
+		return;
+
+	if (es->format != EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainPropertyLong("Cache Hits", rcstate->cache_hits, es);
+		ExplainPropertyLong("Cache Misses", rcstate->cache_misses, es);
+		ExplainPropertyLong("Cache Evictions", rcstate->cache_evictions, es);
+		ExplainPropertyLong("Cache Overflows", rcstate->cache_overflows, es);
+		ExplainPropertyLong("Peak Memory Usage",
+							(rcstate->mem_peak + 1023) / 1024, es);
+	}
+	else
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+						 "Hits: %ld  Misses: %ld  Evictions: %ld  Overflows: %ld  Memory Usage: %ldkB\n",
+						 rcstate->cache_hits, rcstate->cache_misses,
+						 rcstate->cache_evictions, rcstate->cache_overflows,
+						 (long) ((rcstate->mem_peak + 1023) / 1024));
+	}
+}
+
 /*
  * If it's EXPLAIN ANALYZE, show exact/lossy pages for a BitmapHeapScan node
  */
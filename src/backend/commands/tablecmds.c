@@ -8436,6 +8436,24 @@ ATExecAlterColumnType(AlteredTableInfo *tab, Relation rel,
 			case OCLASS_FOREIGN_SERVER:
 			case OCLASS_USER_MAPPING:
 			case OCLASS_DEFACL:
+			case OCLASS_STATISTIC_EXT:
+
+				/*
+				 * Extended statistics keep working across the type change,
+				 * and are recomputed by the next ANALYZE; but ANALYZE needs
+				 * to be able to sort the new type.
+				 */
+				if (!OidIsValid(lookup_type_cache(targettype,
+												  TYPECACHE_LT_OPR)->lt_opr))
+					ereport(ERROR,
+							(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+							 errmsg("cannot alter type of a column used by a statistics object"),
+							 errdetail("%s depends on column \"%s\", and type %s has no default btree operator class.",
+									   getObjectDescription(&foundObject),
+									   colName,
+									   format_type_be(targettype))));
+				break;
+
 			case OCLASS_EXTENSION:
 
 				/*
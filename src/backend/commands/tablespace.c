@@ -73,6 +73,7 @@
 #include "postmaster/bgwriter.h"
 #include "storage/fd.h"
 #include "storage/lmgr.h"
+#include "storage/smgr.h"
 #include "storage/standby.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
@@ -1498,7 +1499,12 @@ tblspc_redo(XLogReaderState *record)
 		 * permissions on a standby server when they were okay on the primary,
 		 * etc etc. There's not much we can do about that, so just remove what
 		 * we can and press on.
+		 *
+		 * Close any relation files we may still have open first, since
+		 * mdexists() relies on redo closing files before it removes them.
 		 */
+		smgrcloseall();
+
 		if (!destroy_tablespace_directories(xlrec->ts_id, true))
 		{
 			ResolveRecoveryConflictWithTablespace(xlrec->ts_id);
@@ -468,6 +468,7 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 	Buffer		vmbuffer = InvalidBuffer;
 	BlockNumber next_unskippable_block;
 	bool		skipping_blocks;
+	BlockNumber prefetch_next = 0;
 	xl_heap_freeze_tuple *frozen;
 	StringInfoData buf;
 	const int	initprog_index[] = {
@@ -676,6 +677,28 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 			all_visible_according_to_vm = true;
 		}
 
+		/*
+		 * Prefetch the blocks after this one, if so configured.  As in a
+		 * seqscan, we do so in batches of half the prefetch distance.  Any
+		 * blocks up to next_unskippable_block that we're going to skip need
+		 * not be fetched, but we don't bother to look further ahead than
+		 * that in the visibility map.
+		 */
+		if (sequential_prefetch_size > 0 &&
+			prefetch_next <= blkno + sequential_prefetch_size / 2)
+		{
+			BlockNumber pstart = Max(prefetch_next, blkno + 1);
+			BlockNumber pend = Min(blkno + 1 + sequential_prefetch_size,
+								   nblocks);
+
+			if (skipping_blocks)
+				pstart = Max(pstart, next_unskippable_block);
+			if (pstart < pend)
+				PrefetchBufferRange(onerel, MAIN_FORKNUM, pstart,
+									pend - pstart);
+			prefetch_next = Max(prefetch_next, pend);
+		}
+
 		vacuum_delay_point();
 
 		/*
@@ -56,6 +56,7 @@
 #include "utils/acl.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/plancache.h"
 #include "utils/rls.h"
 #include "utils/snapmgr.h"
 #include "utils/tqual.h"
@@ -467,6 +468,14 @@ standard_ExecutorEnd(QueryDesc *queryDesc)
 
 	ExecEndPlan(queryDesc->planstate, estate);
 
+	/*
+	 * If the row counts seen at run time were badly off from the planner's
+	 * estimates, let the plan cache know so that it won't keep reusing a
+	 * generic plan built on the same estimates.
+	 */
+	if (estate->es_misestimated)
+		PlanCacheNoteMisestimate(queryDesc->plannedstmt);
+
 	/* do away with our snapshots */
 	UnregisterSnapshot(estate->es_snapshot);
 	UnregisterSnapshot(estate->es_crosscheck_snapshot);
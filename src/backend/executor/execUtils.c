@@ -31,6 +31,10 @@
  *		RegisterExprContextCallback    Register function shutdown callback
  *		UnregisterExprContextCallback  Deregister function shutdown callback
  *
+ *		ExecCheckRowEstimate	Compare actual row count against estimate
+ *
+ *		ExecPruneSubplans		Run-time constraint exclusion for Append
+ *
  *	 NOTES
  *		This file has traditionally been the place to stick misc.
  *		executor support stuff that doesn't really go anyplace else.
@@ -41,14 +45,31 @@
 #include "access/relscan.h"
 #include "access/transam.h"
 #include "executor/executor.h"
+#include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/predtest.h"
 #include "parser/parsetree.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
 
+/* GUC parameter */
+double		misestimate_replan_ratio = 0.0;
+
+/* Working state for substitute_param_values_mutator */
+typedef struct
+{
+	PlanState  *parent;			/* node whose ExprContext we use */
+	List	   *params;			/* Params evaluated so far */
+	List	   *values;			/* ... and the Consts we made for them */
+} substitute_param_values_context;
+
 static bool get_last_attnums(Node *node, ProjectionInfo *projInfo);
 static void ShutdownExprContext(ExprContext *econtext, bool isCommit);
+static Node *substitute_param_values_mutator(Node *node,
+								substitute_param_values_context *context);
 
 
 /* ----------------------------------------------------------------
@@ -140,6 +161,8 @@ CreateExecutorState(void)
 	estate->es_epqTupleSet = NULL;
 	estate->es_epqScanDone = NULL;
 
+	estate->es_misestimated = false;
+
 	/*
 	 * Return the executor state structure
 	 */
@@ -958,3 +981,162 @@ ShutdownExprContext(ExprContext *econtext, bool isCommit)
 
 	MemoryContextSwitchTo(oldcontext);
 }
+
+/*
+ * ExecCheckRowEstimate
+ *
+ * Compare the number of rows a plan node has actually processed with the
+ * planner's estimate, and make a note in the EState if they differ by more
+ * than a factor of misestimate_replan_ratio in either direction.  A ratio
+ * of zero disables the check; the GUC doesn't allow ratios below one.
+ *
+ * This is meant to be called by nodes that read their entire input before
+ * returning anything (Hash, Sort, Material), once they have seen all of it:
+ * at that point the true row count is known, and it is the rows flowing
+ * into such nodes that most plan choices above them are based on.  The
+ * note is acted on by standard_ExecutorEnd, which tells the plan cache not
+ * to keep reusing the plan.
+ */
+void
+ExecCheckRowEstimate(PlanState *node, double actual_rows)
+{
+	EState	   *estate = node->state;
+	double		estimated_rows;
+
+	if (misestimate_replan_ratio <= 0 || estate->es_misestimated)
+		return;
+
+	/* the planner never estimates less than one row; nor shall we */
+	estimated_rows = Max(node->plan->plan_rows, 1.0);
+	actual_rows = Max(actual_rows, 1.0);
+
+	if (actual_rows > estimated_rows * misestimate_replan_ratio ||
+		estimated_rows > actual_rows * misestimate_replan_ratio)
+	{
+		estate->es_misestimated = true;
+		elog(DEBUG1, "plan node processed %.0f rows, but %.0f were estimated",
+			 actual_rows, estimated_rows);
+	}
+}
+
+/*
+ * ExecPruneSubplans
+ *
+ * Work out which subplans of an Append or MergeAppend need not be run,
+ * because substituting the current parameter values into the restriction
+ * clauses in prunequals yields clauses that refute the child's constraints
+ * in pruneconstraints (see get_runtime_prune_info in createplan.c).  This is
+ * the same test relation_excluded_by_constraints makes at plan time, so a
+ * subplan is skipped only if its relation can't contain any matching rows.
+ *
+ * The verdicts are stored into pruned[], which has an entry per subplan.
+ * The parent node must have an ExprContext for evaluating the Params.
+ */
+void
+ExecPruneSubplans(PlanState *parent, List *pruneconstraints,
+				  List *prunequals, bool *pruned)
+{
+	ExprContext *econtext = parent->ps_ExprContext;
+	substitute_param_values_context context;
+	MemoryContext oldcontext;
+	ListCell   *lc1;
+	ListCell   *lc2;
+	int			i = 0;
+
+	Assert(econtext != NULL);
+
+	/* Everything we build here is garbage as soon as we're done */
+	ResetExprContext(econtext);
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	context.parent = parent;
+	context.params = NIL;
+	context.values = NIL;
+
+	forboth(lc1, pruneconstraints, lc2, prunequals)
+	{
+		List	   *constraints = (List *) lfirst(lc1);
+		List	   *quals = (List *) lfirst(lc2);
+		ListCell   *lc;
+
+		pruned[i] = false;
+
+		if (quals != NIL)
+		{
+			quals = (List *)
+				substitute_param_values_mutator((Node *) quals, &context);
+			quals = (List *) eval_const_expressions(NULL, (Node *) quals);
+
+			/* A constant-FALSE or -NULL clause means no rows at all */
+			foreach(lc, quals)
+			{
+				Node	   *qual = (Node *) lfirst(lc);
+
+				if (IsA(qual, Const) &&
+					(((Const *) qual)->constisnull ||
+					 !DatumGetBool(((Const *) qual)->constvalue)))
+				{
+					pruned[i] = true;
+					break;
+				}
+			}
+
+			if (!pruned[i])
+				pruned[i] = predicate_refuted_by(constraints, quals);
+		}
+
+		i++;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+	ResetExprContext(econtext);
+}
+
+/*
+ * Replace each Param in an expression by a Const holding its current value.
+ * Each distinct Param is evaluated only once, since the same ones typically
+ * appear in the clauses for every child.
+ */
+static Node *
+substitute_param_values_mutator(Node *node,
+								substitute_param_values_context *context)
+{
+	if (node == NULL)
+		return NULL;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+		ExprState  *exprstate;
+		Datum		value;
+		bool		isnull;
+		int16		typLen;
+		bool		typByVal;
+		Const	   *result;
+		ListCell   *lc1;
+		ListCell   *lc2;
+
+		forboth(lc1, context->params, lc2, context->values)
+		{
+			Param	   *prev = (Param *) lfirst(lc1);
+
+			if (prev->paramkind == param->paramkind &&
+				prev->paramid == param->paramid)
+				return (Node *) lfirst(lc2);
+		}
+
+		exprstate = ExecInitExpr((Expr *) param, context->parent);
+		value = ExecEvalExpr(exprstate, context->parent->ps_ExprContext,
+							 &isnull, NULL);
+		get_typlenbyval(param->paramtype, &typLen, &typByVal);
+		result = makeConst(param->paramtype, param->paramtypmod,
+						   param->paramcollid, (int) typLen,
+						   value, isnull, typByVal);
+
+		context->params = lappend(context->params, param);
+		context->values = lappend(context->values, result);
+
+		return (Node *) result;
+	}
+	return expression_tree_mutator(node, substitute_param_values_mutator,
+								   (void *) context);
+}
@@ -17,6 +17,9 @@
  *		ExecAppend		- retrieve the next tuple from the node
  *		ExecEndAppend	- shut down the append node
  *		ExecReScanAppend - rescan the append node
+ *		ExecAppendEstimate, ExecAppendInitializeDSM,
+ *		ExecAppendReInitializeDSM, ExecAppendInitializeWorker
+ *						- parallel-aware Append support
  *
  *	 NOTES
  *		Each append node contains a list of one or more subplans which
@@ -53,14 +56,55 @@
  *			  nil	nil		 Scan	 Scan	  Scan	   Scan
  *							  |		  |		   |		|
  *							person employee student student-emp
+ *
+ *		If the planner attached run-time pruning information, the first
+ *		call after initialization or a change of parameters decides which
+ *		subplans can be skipped because their CHECK constraints contradict
+ *		the current parameter values.  A skipped subplan is treated as if
+ *		it had returned no rows.
+ *
+ *		A parallel-aware Append spreads the participants of a parallel
+ *		query across its subplans instead of having each of them run
+ *		through the subplans in order.  The subplans before
+ *		first_partial_plan are non-partial: each of those is given to just
+ *		one participant, which runs it to completion.  The remaining,
+ *		partial, subplans can be run by any number of participants at once,
+ *		each producing its share of the rows; a participant that finishes
+ *		one moves on to whichever subplan has the fewest participants so far,
+ *		which we approximate by handing them out round-robin.  The leader
+ *		works from the end of the list, so that it tends to pick up the
+ *		cheaper partial subplans and remain free to read tuples from the
+ *		workers.
  */
 
 #include "postgres.h"
 
+#include "access/parallel.h"
 #include "executor/execdebug.h"
 #include "executor/nodeAppend.h"
+#include "storage/lwlock.h"
+
+/*
+ * Shared state for a parallel-aware Append, in the parallel query's DSM.
+ *
+ * pa_next_plan is the subplan the next worker should try; pa_finished[i]
+ * is set once subplan i needs no more participants, that is once any
+ * participant has finished it, or as soon as someone starts it if it is
+ * non-partial.
+ */
+typedef struct ParallelAppendState
+{
+	LWLock		pa_lock;		/* protects the fields below */
+	int			pa_next_plan;	/* next plan to choose by any worker */
+	bool		pa_finished[FLEXIBLE_ARRAY_MEMBER];
+} ParallelAppendState;
+
+#define INVALID_SUBPLAN_INDEX		-1
 
 static bool exec_append_initialize_next(AppendState *appendstate);
+static bool exec_append_parallel_next(AppendState *node);
+static bool exec_append_leader_next(AppendState *node);
+static bool exec_append_worker_next(AppendState *node);
 
 
 /* ----------------------------------------------------------------
@@ -142,13 +186,23 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 	appendstate->ps.state = estate;
 	appendstate->appendplans = appendplanstates;
 	appendstate->as_nplans = nplans;
+	appendstate->as_pstate = NULL;
+	appendstate->as_pruned = NULL;
+	appendstate->as_prune_pending = false;
 
 	/*
 	 * Miscellaneous initialization
 	 *
-	 * Append plans don't have expression contexts because they never call
-	 * ExecQual or ExecProject.
+	 * Append plans don't need expression contexts because they never call
+	 * ExecQual or ExecProject, except that run-time pruning uses one to
+	 * evaluate Params.
 	 */
+	if (node->prunequals != NIL)
+	{
+		ExecAssignExprContext(estate, &appendstate->ps);
+		appendstate->as_pruned = (bool *) palloc0(nplans * sizeof(bool));
+		appendstate->as_prune_pending = true;
+	}
 
 	/*
 	 * append nodes still have Result slots, which hold pointers to tuples, so
@@ -193,6 +247,21 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 TupleTableSlot *
 ExecAppend(AppendState *node)
 {
+	/* Decide which subplans to skip, now that the Params have values. */
+	if (node->as_prune_pending)
+	{
+		Append	   *plan = (Append *) node->ps.plan;
+
+		ExecPruneSubplans(&node->ps, plan->pruneconstraints,
+						  plan->prunequals, node->as_pruned);
+		node->as_prune_pending = false;
+	}
+
+	/* A parallel-aware Append must first claim a subplan to run. */
+	if (node->as_whichplan == INVALID_SUBPLAN_INDEX &&
+		!exec_append_parallel_next(node))
+		return ExecClearTuple(node->ps.ps_ResultTupleSlot);
+
 	for (;;)
 	{
 		PlanState  *subnode;
@@ -204,9 +273,12 @@ ExecAppend(AppendState *node)
 		subnode = node->appendplans[node->as_whichplan];
 
 		/*
-		 * get a tuple from the subplan
+		 * get a tuple from the subplan, unless it has been pruned
 		 */
-		result = ExecProcNode(subnode);
+		if (node->as_pruned && node->as_pruned[node->as_whichplan])
+			result = NULL;
+		else
+			result = ExecProcNode(subnode);
 
 		if (!TupIsNull(result))
 		{
@@ -218,6 +290,17 @@ ExecAppend(AppendState *node)
 			return result;
 		}
 
+		/*
+		 * In a parallel-aware Append, ask the shared state which subplan to
+		 * run next.
+		 */
+		if (node->as_pstate != NULL)
+		{
+			if (!exec_append_parallel_next(node))
+				return ExecClearTuple(node->ps.ps_ResultTupleSlot);
+			continue;
+		}
+
 		/*
 		 * Go on to the "next" subplan in the appropriate direction. If no
 		 * more subplans, return the empty slot set up for us by
@@ -285,6 +368,250 @@ ExecReScanAppend(AppendState *node)
 		if (subnode->chgParam == NULL)
 			ExecReScan(subnode);
 	}
-	node->as_whichplan = 0;
-	exec_append_initialize_next(node);
+
+	/* New parameter values may allow pruning different subplans */
+	if (node->as_pruned && node->ps.chgParam != NULL)
+		node->as_prune_pending = true;
+
+	/*
+	 * A parallel-aware Append must choose its subplan afresh, once the shared
+	 * state has been reset by ExecAppendReInitializeDSM.
+	 */
+	if (node->as_pstate != NULL)
+		node->as_whichplan = INVALID_SUBPLAN_INDEX;
+	else
+	{
+		node->as_whichplan = 0;
+		exec_append_initialize_next(node);
+	}
+}
+
+/* ----------------------------------------------------------------
+ *						Parallel Append Support
+ * ----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------
+ *		ExecAppendEstimate
+ *
+ *		estimates the space required to serialize Append node.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAppendEstimate(AppendState *node,
+				   ParallelContext *pcxt)
+{
+	node->pstate_len =
+		add_size(offsetof(ParallelAppendState, pa_finished),
+				 sizeof(bool) * node->as_nplans);
+
+	shm_toc_estimate_chunk(&pcxt->estimator, node->pstate_len);
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAppendInitializeDSM
+ *
+ *		Set up shared state for Parallel Append.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAppendInitializeDSM(AppendState *node,
+						ParallelContext *pcxt)
+{
+	ParallelAppendState *pstate;
+
+	pstate = shm_toc_allocate(pcxt->toc, node->pstate_len);
+	memset(pstate, 0, node->pstate_len);
+	LWLockInitialize(&pstate->pa_lock, LWTRANCHE_PARALLEL_APPEND);
+	shm_toc_insert(pcxt->toc, node->ps.plan->plan_node_id, pstate);
+
+	node->as_pstate = pstate;
+	node->as_whichplan = INVALID_SUBPLAN_INDEX;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAppendReInitializeDSM
+ *
+ *		Reset shared state before beginning a fresh scan.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAppendReInitializeDSM(AppendState *node, ParallelContext *pcxt)
+{
+	ParallelAppendState *pstate = node->as_pstate;
+
+	pstate->pa_next_plan = 0;
+	memset(pstate->pa_finished, 0, sizeof(bool) * node->as_nplans);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAppendInitializeWorker
+ *
+ *		Copy relevant information from TOC into planstate, and initialize
+ *		whatever is required to choose and execute the optimal subplan.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAppendInitializeWorker(AppendState *node, shm_toc *toc)
+{
+	node->as_pstate = shm_toc_lookup(toc, node->ps.plan->plan_node_id);
+	node->as_whichplan = INVALID_SUBPLAN_INDEX;
+}
+
+/* ----------------------------------------------------------------
+ *		exec_append_parallel_next
+ *
+ *		Choose the next subplan for a parallel-aware Append, marking
+ *		the one just completed (if any) as finished.
+ *
+ *		Returns false if there is nothing left for us to do.
+ * ----------------------------------------------------------------
+ */
+static bool
+exec_append_parallel_next(AppendState *node)
+{
+	Assert(node->as_pstate != NULL);
+
+	/* Backward scan is not supported by parallel-aware plans */
+	Assert(ScanDirectionIsForward(node->ps.state->es_direction));
+
+	if (IsParallelWorker())
+		return exec_append_worker_next(node);
+	else
+		return exec_append_leader_next(node);
+}
+
+/*
+ * exec_append_leader_next
+ *
+ *		The leader works backwards from the last subplan, so that it tends
+ *		to pick partial subplans, which the workers may help to finish.
+ */
+static bool
+exec_append_leader_next(AppendState *node)
+{
+	ParallelAppendState *pstate = node->as_pstate;
+	Append	   *append = (Append *) node->ps.plan;
+
+	LWLockAcquire(&pstate->pa_lock, LW_EXCLUSIVE);
+
+	if (node->as_whichplan != INVALID_SUBPLAN_INDEX)
+	{
+		/* Mark just-completed subplan as finished. */
+		pstate->pa_finished[node->as_whichplan] = true;
+	}
+	else
+	{
+		/* Start with last subplan. */
+		node->as_whichplan = node->as_nplans - 1;
+	}
+
+	/* Loop until we find a subplan to execute. */
+	while (pstate->pa_finished[node->as_whichplan])
+	{
+		if (node->as_whichplan == 0)
+		{
+			pstate->pa_next_plan = INVALID_SUBPLAN_INDEX;
+			node->as_whichplan = INVALID_SUBPLAN_INDEX;
+			LWLockRelease(&pstate->pa_lock);
+			return false;
+		}
+		node->as_whichplan--;
+	}
+
+	/* If non-partial, immediately mark as finished. */
+	if (node->as_whichplan < append->first_partial_plan)
+		pstate->pa_finished[node->as_whichplan] = true;
+
+	LWLockRelease(&pstate->pa_lock);
+
+	return true;
+}
+
+/*
+ * exec_append_worker_next
+ *
+ *		Workers take subplans in order, starting from pa_next_plan: first
+ *		the non-partial ones, then cycling among the partial ones until all
+ *		of those are finished.
+ */
+static bool
+exec_append_worker_next(AppendState *node)
+{
+	ParallelAppendState *pstate = node->as_pstate;
+	Append	   *append = (Append *) node->ps.plan;
+
+	LWLockAcquire(&pstate->pa_lock, LW_EXCLUSIVE);
+
+	/* Mark just-completed subplan as finished. */
+	if (node->as_whichplan != INVALID_SUBPLAN_INDEX)
+		pstate->pa_finished[node->as_whichplan] = true;
+
+	/* If all the plans are already done, we have nothing to do */
+	if (pstate->pa_next_plan == INVALID_SUBPLAN_INDEX)
+	{
+		node->as_whichplan = INVALID_SUBPLAN_INDEX;
+		LWLockRelease(&pstate->pa_lock);
+		return false;
+	}
+
+	/* Save the plan from which we are starting the search. */
+	node->as_whichplan = pstate->pa_next_plan;
+
+	/* Loop until we find a subplan to execute. */
+	while (pstate->pa_finished[pstate->pa_next_plan])
+	{
+		if (pstate->pa_next_plan < node->as_nplans - 1)
+		{
+			/* Advance to next plan. */
+			pstate->pa_next_plan++;
+		}
+		else if (node->as_whichplan > append->first_partial_plan)
+		{
+			/* Loop back to first partial plan. */
+			pstate->pa_next_plan = append->first_partial_plan;
+		}
+		else
+		{
+			/*
+			 * At last plan, and either there are no partial plans or we've
+			 * tried them all.  Arrange to bail out.
+			 */
+			pstate->pa_next_plan = node->as_whichplan;
+		}
+
+		if (pstate->pa_next_plan == node->as_whichplan)
+		{
+			/* We've tried everything! */
+			pstate->pa_next_plan = INVALID_SUBPLAN_INDEX;
+			node->as_whichplan = INVALID_SUBPLAN_INDEX;
+			LWLockRelease(&pstate->pa_lock);
+			return false;
+		}
+	}
+
+	/* Pick the plan we found, and advance pa_next_plan one more time. */
+	node->as_whichplan = pstate->pa_next_plan++;
+	if (pstate->pa_next_plan >= node->as_nplans)
+	{
+		if (append->first_partial_plan < node->as_nplans)
+			pstate->pa_next_plan = append->first_partial_plan;
+		else
+		{
+			/*
+			 * We have only non-partial plans, and we already chose the last
+			 * one; so arrange for the other workers to immediately bail out.
+			 */
+			pstate->pa_next_plan = INVALID_SUBPLAN_INDEX;
+		}
+	}
+
+	/* If non-partial, immediately mark as finished. */
+	if (node->as_whichplan < append->first_partial_plan)
+		pstate->pa_finished[node->as_whichplan] = true;
+
+	LWLockRelease(&pstate->pa_lock);
+
+	return true;
 }
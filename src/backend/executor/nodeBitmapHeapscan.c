@@ -32,6 +32,10 @@
  *		ExecInitBitmapHeapScan		creates and initializes state info.
  *		ExecReScanBitmapHeapScan	prepares to rescan the plan.
  *		ExecEndBitmapHeapScan		releases all storage.
+ *		ExecBitmapHeapEstimate		estimates DSM space for parallel scan
+ *		ExecBitmapHeapInitializeDSM builds the bitmap to be shared
+ *		ExecBitmapHeapReInitializeDSM rebuilds it after a rescan
+ *		ExecBitmapHeapInitializeWorker attaches to the shared bitmap
  */
 #include "postgres.h"
 
@@ -41,6 +45,7 @@
 #include "executor/nodeBitmapHeapscan.h"
 #include "pgstat.h"
 #include "storage/bufmgr.h"
+#include "storage/dsm.h"
 #include "storage/predicate.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
@@ -49,8 +54,22 @@
 #include "utils/tqual.h"
 
 
+/*
+ * Shared state for a parallel bitmap heap scan, in the parallel query's DSM.
+ *
+ * The leader runs the bitmap index scans itself, before any worker starts,
+ * and copies the result into a DSM segment of its own, since its size can't
+ * be known when the parallel query's segment is laid out.  Everyone then
+ * takes pages from that copy until there are none left.
+ */
+typedef struct ParallelBitmapHeapState
+{
+	dsm_handle	bitmap_handle;	/* segment holding the shared bitmap */
+} ParallelBitmapHeapState;
+
 static TupleTableSlot *BitmapHeapNext(BitmapHeapScanState *node);
 static void bitgetpage(HeapScanDesc scan, TBMIterateResult *tbmres);
+static void BitmapHeapShareBitmap(BitmapHeapScanState *node);
 
 
 /* ----------------------------------------------------------------
@@ -98,8 +117,12 @@ BitmapHeapNext(BitmapHeapScanState *node)
 	 * desired prefetch distance, which starts small and increases up to the
 	 * node->prefetch_maximum.  This is to avoid doing a lot of prefetching in
 	 * a scan that stops after a few tuples because of a LIMIT.
+	 *
+	 * In a parallel scan, the shared bitmap was built before we got here, and
+	 * we don't prefetch, since we can't tell which pages the other
+	 * participants will claim.
 	 */
-	if (tbm == NULL)
+	if (tbm == NULL && node->shared_tbmiterator == NULL)
 	{
 		tbm = (TIDBitmap *) MultiExecProcNode(outerPlanState(node));
 
@@ -130,7 +153,11 @@ BitmapHeapNext(BitmapHeapScanState *node)
 		 */
 		if (tbmres == NULL)
 		{
-			node->tbmres = tbmres = tbm_iterate(tbmiterator);
+			if (node->shared_tbmiterator)
+				node->tbmres = tbmres =
+					tbm_shared_iterate(node->shared_tbmiterator);
+			else
+				node->tbmres = tbmres = tbm_iterate(tbmiterator);
 			if (tbmres == NULL)
 			{
 				/* no more entries in the bitmap */
@@ -465,6 +492,17 @@ ExecReScanBitmapHeapScan(BitmapHeapScanState *node)
 	node->tbmres = NULL;
 	node->prefetch_iterator = NULL;
 
+	/*
+	 * Only the leader rescans a parallel scan, and only once the workers are
+	 * gone; the bitmap is shared again by ExecBitmapHeapReInitializeDSM.
+	 */
+	if (node->shared_tbmiterator)
+		tbm_end_shared_iterate(node->shared_tbmiterator);
+	if (node->bitmap_seg)
+		dsm_detach(node->bitmap_seg);
+	node->shared_tbmiterator = NULL;
+	node->bitmap_seg = NULL;
+
 	ExecScanReScan(&node->ss);
 
 	/*
@@ -516,6 +554,10 @@ ExecEndBitmapHeapScan(BitmapHeapScanState *node)
 		tbm_end_iterate(node->prefetch_iterator);
 	if (node->tbm)
 		tbm_free(node->tbm);
+	if (node->shared_tbmiterator)
+		tbm_end_shared_iterate(node->shared_tbmiterator);
+	if (node->bitmap_seg)
+		dsm_detach(node->bitmap_seg);
 
 	/*
 	 * close heap scan
@@ -567,6 +609,9 @@ ExecInitBitmapHeapScan(BitmapHeapScan *node, EState *estate, int eflags)
 	scanstate->prefetch_target = 0;
 	/* may be updated below */
 	scanstate->prefetch_maximum = target_prefetch_pages;
+	scanstate->pstate = NULL;
+	scanstate->bitmap_seg = NULL;
+	scanstate->shared_tbmiterator = NULL;
 
 	/*
 	 * Miscellaneous initialization
@@ -653,3 +698,114 @@ ExecInitBitmapHeapScan(BitmapHeapScan *node, EState *estate, int eflags)
 	 */
 	return scanstate;
 }
+
+/* ----------------------------------------------------------------
+ *						Parallel Scan Support
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * BitmapHeapShareBitmap - build the bitmap and make it available to workers
+ *
+ * Runs the bitmap index scan(s) below us, copies the result into a new DSM
+ * segment, and advertises the segment in the parallel scan state.
+ */
+static void
+BitmapHeapShareBitmap(BitmapHeapScanState *node)
+{
+	TIDBitmap  *tbm;
+	dsm_segment *seg;
+	TBMSharedIteratorState *istate;
+
+	Assert(node->bitmap_seg == NULL);
+
+	tbm = (TIDBitmap *) MultiExecProcNode(outerPlanState(node));
+
+	if (!tbm || !IsA(tbm, TIDBitmap))
+		elog(ERROR, "unrecognized result from subplan");
+
+	seg = dsm_create(tbm_shared_iterate_size(tbm), 0);
+	istate = (TBMSharedIteratorState *) dsm_segment_address(seg);
+	tbm_prepare_shared_iterate(tbm, istate);
+	tbm_free(tbm);
+
+	node->bitmap_seg = seg;
+	node->shared_tbmiterator = tbm_attach_shared_iterate(istate);
+	node->tbmres = NULL;
+	node->pstate->bitmap_handle = dsm_segment_handle(seg);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecBitmapHeapEstimate
+ *
+ *		estimates the space required to serialize bitmap scan node.
+ * ----------------------------------------------------------------
+ */
+void
+ExecBitmapHeapEstimate(BitmapHeapScanState *node,
+					   ParallelContext *pcxt)
+{
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(ParallelBitmapHeapState));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecBitmapHeapInitializeDSM
+ *
+ *		Set up a parallel bitmap heap scan descriptor, and build the
+ *		bitmap the participants will share.
+ * ----------------------------------------------------------------
+ */
+void
+ExecBitmapHeapInitializeDSM(BitmapHeapScanState *node,
+							ParallelContext *pcxt)
+{
+	ParallelBitmapHeapState *pstate;
+
+	pstate = shm_toc_allocate(pcxt->toc, sizeof(ParallelBitmapHeapState));
+	shm_toc_insert(pcxt->toc, node->ss.ps.plan->plan_node_id, pstate);
+	node->pstate = pstate;
+
+	BitmapHeapShareBitmap(node);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecBitmapHeapReInitializeDSM
+ *
+ *		Share a freshly built bitmap before a rescan's workers start.
+ * ----------------------------------------------------------------
+ */
+void
+ExecBitmapHeapReInitializeDSM(BitmapHeapScanState *node,
+							  ParallelContext *pcxt)
+{
+	/* ExecReScanBitmapHeapScan has already let go of the previous bitmap */
+	if (node->bitmap_seg == NULL)
+		BitmapHeapShareBitmap(node);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecBitmapHeapInitializeWorker
+ *
+ *		Copy relevant information from TOC into planstate, and attach
+ *		to the shared bitmap.
+ * ----------------------------------------------------------------
+ */
+void
+ExecBitmapHeapInitializeWorker(BitmapHeapScanState *node, shm_toc *toc)
+{
+	ParallelBitmapHeapState *pstate;
+	dsm_segment *seg;
+
+	pstate = shm_toc_lookup(toc, node->ss.ps.plan->plan_node_id);
+	node->pstate = pstate;
+
+	seg = dsm_attach(pstate->bitmap_handle);
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+	node->bitmap_seg = seg;
+	node->shared_tbmiterator = tbm_attach_shared_iterate(
+						  (TBMSharedIteratorState *) dsm_segment_address(seg));
+}
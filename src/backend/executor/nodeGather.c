@@ -154,11 +154,16 @@ ExecGather(GatherState *node)
 		{
 			ParallelContext *pcxt;
 
-			/* Initialize the workers required to execute Gather node. */
+			/*
+			 * Initialize the workers required to execute Gather node, or
+			 * reset the shared state left over from a previous execution.
+			 */
 			if (!node->pei)
 				node->pei = ExecInitParallelPlan(node->ps.lefttree,
 												 estate,
 												 gather->num_workers);
+			else
+				ExecParallelReinitialize(node->pei);
 
 			/*
 			 * Register backend workers. We might not get as many as we
@@ -463,14 +468,12 @@ ExecReScanGather(GatherState *node)
 	 * Re-initialize the parallel workers to perform rescan of relation. We
 	 * want to gracefully shutdown all the workers so that they should be able
 	 * to propagate any error or other information to master backend before
-	 * dying.  Parallel context will be reused for rescan.
+	 * dying.  Parallel context will be reused for rescan, and is reset by
+	 * ExecGather once the child plan has been rescanned.
 	 */
 	ExecShutdownGatherWorkers(node);
 
 	node->initialized = false;
 
-	if (node->pei)
-		ExecParallelReinitialize(node->pei);
-
 	ExecReScan(node->ps.lefttree);
 }
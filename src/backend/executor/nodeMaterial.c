@@ -132,8 +132,10 @@ ExecMaterial(MaterialState *node)
 		if (TupIsNull(outerslot))
 		{
 			node->eof_underlying = true;
+			ExecCheckRowEstimate(&node->ss.ps, node->ntuples);
 			return NULL;
 		}
+		node->ntuples += 1;
 
 		/*
 		 * Append a copy of the returned tuple to tuplestore.  NOTE: because
@@ -193,6 +195,7 @@ ExecInitMaterial(Material *node, EState *estate, int eflags)
 		matstate->eflags |= EXEC_FLAG_REWIND;
 
 	matstate->eof_underlying = false;
+	matstate->ntuples = 0;
 	matstate->tuplestorestate = NULL;
 
 	/*
@@ -349,6 +352,7 @@ ExecReScanMaterial(MaterialState *node)
 			if (outerPlan->chgParam == NULL)
 				ExecReScan(outerPlan);
 			node->eof_underlying = false;
+			node->ntuples = 0;
 		}
 		else
 			tuplestore_rescan(node->tuplestorestate);
@@ -364,5 +368,6 @@ ExecReScanMaterial(MaterialState *node)
 		if (outerPlan->chgParam == NULL)
 			ExecReScan(outerPlan);
 		node->eof_underlying = false;
+		node->ntuples = 0;
 	}
 }
@@ -89,13 +89,20 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
 	mergestate->ms_slots = (TupleTableSlot **) palloc0(sizeof(TupleTableSlot *) * nplans);
 	mergestate->ms_heap = binaryheap_allocate(nplans, heap_compare_slots,
 											  mergestate);
+	mergestate->ms_pruned = NULL;
 
 	/*
 	 * Miscellaneous initialization
 	 *
-	 * MergeAppend plans don't have expression contexts because they never
-	 * call ExecQual or ExecProject.
+	 * MergeAppend plans don't need expression contexts because they never
+	 * call ExecQual or ExecProject, except that run-time pruning uses one to
+	 * evaluate Params.
 	 */
+	if (node->prunequals != NIL)
+	{
+		ExecAssignExprContext(estate, &mergestate->ps);
+		mergestate->ms_pruned = (bool *) palloc0(nplans * sizeof(bool));
+	}
 
 	/*
 	 * MergeAppend nodes do have Result slots, which hold pointers to tuples,
@@ -173,10 +180,21 @@ ExecMergeAppend(MergeAppendState *node)
 	{
 		/*
 		 * First time through: pull the first tuple from each subplan, and set
-		 * up the heap.
+		 * up the heap.  Subplans whose constraints contradict the current
+		 * parameter values are left out altogether.
 		 */
+		if (node->ms_pruned)
+		{
+			MergeAppend *plan = (MergeAppend *) node->ps.plan;
+
+			ExecPruneSubplans(&node->ps, plan->pruneconstraints,
+							  plan->prunequals, node->ms_pruned);
+		}
+
 		for (i = 0; i < node->ms_nplans; i++)
 		{
+			if (node->ms_pruned && node->ms_pruned[i])
+				continue;
 			node->ms_slots[i] = ExecProcNode(node->mergeplans[i]);
 			if (!TupIsNull(node->ms_slots[i]))
 				binaryheap_add_unordered(node->ms_heap, Int32GetDatum(i));
@@ -0,0 +1,834 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeResultCache.c
+ *	  Routines to handle caching of results from parameterized nodes
+ *
+ * Portions Copyright (c) 1996-2016, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeResultCache.c
+ *
+ * A Result Cache node sits above the parameterized inner side of a nested
+ * loop join.  For each distinct set of parameter values (the cache key) it
+ * remembers the tuples produced by its subplan, so that when the same outer
+ * key shows up again the inner side need not be rescanned.
+ *
+ * The cache is a hash table keyed on the parameter values.  Each entry
+ * points to a singly-linked list of the tuples the subplan returned for
+ * that key, and all keys are linked into an LRU list.  When storing a new
+ * tuple makes the cache exceed work_mem, entries are evicted starting from
+ * the least recently used one.  If the entry being filled is itself too
+ * large to fit, it is discarded and the rest of that scan just passes the
+ * subplan's tuples through.
+ *
+ * Cache keys are compared by their binary image, not with the equality
+ * operator of their type.  Values the operator considers equal can still be
+ * told apart by the subplan -- numeric 1.0 and 1.00, say, or strings under a
+ * case-insensitive collation -- and it might well return different rows for
+ * them.  Identical bits always give identical results, since the subplan is
+ * known to be free of volatile functions.  At worst, a value that could be
+ * represented more than one way is cached more than once.
+ *
+ * Only entries for which the subplan was read to completion are used to
+ * answer lookups.  A rescan arriving while an entry is still being filled
+ * removes that entry again.  If a parameter that is not part of the cache
+ * key changes, the subplan's output may change for every key, so the whole
+ * cache is thrown away.
+ *
+ *-------------------------------------------------------------------------
+ */
+/*
+ * INTERFACE ROUTINES
+ *		ExecResultCache			- lookup cache, exec subplan when not found
+ *		ExecInitResultCache		- initialize node and subnodes
+ *		ExecEndResultCache		- shutdown node and subnodes
+ *		ExecReScanResultCache	- rescan the result cache
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "executor/executor.h"
+#include "executor/nodeResultCache.h"
+#include "miscadmin.h"
+#include "utils/datum.h"
+#include "utils/memutils.h"
+
+/* States of the ExecResultCache state machine */
+#define RC_CACHE_LOOKUP				1	/* attempt to perform a cache lookup */
+#define RC_CACHE_FETCH_NEXT_TUPLE	2	/* get another tuple from the cache */
+#define RC_FILLING_CACHE			3	/* read subplan to fill the cache */
+#define RC_CACHE_BYPASS_MODE		4	/* entry too big for the cache; just
+										 * read the subplan */
+#define RC_END_OF_SCAN				5	/* ready for rescan */
+
+/* A cached tuple, linked to the next tuple for the same key */
+typedef struct ResultCacheTuple
+{
+	MinimalTuple mintuple;		/* cached tuple */
+	struct ResultCacheTuple *next;		/* next tuple with the same key */
+} ResultCacheTuple;
+
+/* The cache key of an entry, also linked into the LRU list */
+typedef struct ResultCacheKey
+{
+	MinimalTuple params;		/* parameter values forming the key */
+	dlist_node	lru_node;		/* pointer to next/prev key in LRU list */
+} ResultCacheKey;
+
+/* A hash table entry */
+typedef struct ResultCacheEntry
+{
+	ResultCacheKey *key;		/* hash key; NULL means "the probe slot" */
+	ResultCacheTuple *tuplehead;	/* first cached tuple, or NULL */
+	uint32		hash;			/* hash value (cached) */
+	char		status;			/* hash status */
+	bool		complete;		/* did we read the subplan to completion? */
+} ResultCacheEntry;
+
+static uint32 ResultCacheHash_hash(struct resultcache_hash *tb,
+					 const ResultCacheKey *key);
+static bool ResultCacheHash_equal(struct resultcache_hash *tb,
+					  const ResultCacheKey *key1,
+					  const ResultCacheKey *key2);
+
+#define SH_PREFIX resultcache
+#define SH_ELEMENT_TYPE ResultCacheEntry
+#define SH_KEY_TYPE ResultCacheKey *
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) ResultCacheHash_hash(tb, key)
+#define SH_EQUAL(tb, a, b) ResultCacheHash_equal(tb, a, b)
+#define SH_SCOPE static inline
+#define SH_STORE_HASH
+#define SH_GET_HASH(tb, a) a->hash
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+
+/*
+ * key_datum_hash
+ *		Hash a non-null cache key value by its binary image.
+ *
+ * Varlena values are hashed after detoasting and ignoring the header, since
+ * forming the stored key's MinimalTuple may convert a 4-byte header to a
+ * short one.
+ */
+static uint32
+key_datum_hash(Datum value, Form_pg_attribute attr)
+{
+	uint32		result;
+
+	if (attr->attbyval)
+		result = DatumGetUInt32(hash_any((unsigned char *) &value,
+										 sizeof(Datum)));
+	else if (attr->attlen == -1)
+	{
+		struct varlena *v = (struct varlena *) DatumGetPointer(value);
+		struct varlena *dv = pg_detoast_datum_packed(v);
+
+		result = DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(dv),
+										 VARSIZE_ANY_EXHDR(dv)));
+		if (dv != v)
+			pfree(dv);
+	}
+	else
+		result = DatumGetUInt32(hash_any((unsigned char *) DatumGetPointer(value),
+							   datumGetSize(value, false, attr->attlen)));
+
+	return result;
+}
+
+/*
+ * key_datum_equal
+ *		Compare two non-null cache key values by their binary image.
+ */
+static bool
+key_datum_equal(Datum value1, Datum value2, Form_pg_attribute attr)
+{
+	bool		result;
+
+	if (attr->attbyval)
+		result = (value1 == value2);
+	else if (attr->attlen == -1)
+	{
+		struct varlena *v1 = (struct varlena *) DatumGetPointer(value1);
+		struct varlena *v2 = (struct varlena *) DatumGetPointer(value2);
+		struct varlena *dv1 = pg_detoast_datum_packed(v1);
+		struct varlena *dv2 = pg_detoast_datum_packed(v2);
+
+		result = (VARSIZE_ANY_EXHDR(dv1) == VARSIZE_ANY_EXHDR(dv2) &&
+				  memcmp(VARDATA_ANY(dv1), VARDATA_ANY(dv2),
+						 VARSIZE_ANY_EXHDR(dv1)) == 0);
+		if (dv1 != v1)
+			pfree(dv1);
+		if (dv2 != v2)
+			pfree(dv2);
+	}
+	else
+		result = datumIsEqual(value1, value2, false, attr->attlen);
+
+	return result;
+}
+
+/*
+ * ResultCacheHash_hash
+ *		Hash function for simplehash hashtable.  'key' is NULL when we
+ *		are hashing the parameter values currently in the probe slot.
+ */
+static uint32
+ResultCacheHash_hash(struct resultcache_hash *tb, const ResultCacheKey *key)
+{
+	ResultCacheState *rcstate = (ResultCacheState *) tb->private_data;
+	TupleTableSlot *slot;
+	Form_pg_attribute *attrs = rcstate->hashkeydesc->attrs;
+	int			numkeys = rcstate->nkeys;
+	uint32		hashkey = 0;
+	int			i;
+
+	if (key == NULL)
+		slot = rcstate->probeslot;
+	else
+	{
+		slot = rcstate->tableslot;
+		ExecStoreMinimalTuple(key->params, slot, false);
+	}
+
+	for (i = 0; i < numkeys; i++)
+	{
+		Datum		attr;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		attr = slot_getattr(slot, i + 1, &isNull);
+
+		if (!isNull)			/* treat nulls as having hash key 0 */
+			hashkey ^= key_datum_hash(attr, attrs[i]);
+	}
+
+	return DatumGetUInt32(hash_uint32(hashkey));
+}
+
+/*
+ * ResultCacheHash_equal
+ *		Equality function for simplehash hashtable.  As for the hash
+ *		function, a NULL key stands for the probe slot.
+ */
+static bool
+ResultCacheHash_equal(struct resultcache_hash *tb, const ResultCacheKey *key1,
+					  const ResultCacheKey *key2)
+{
+	ResultCacheState *rcstate = (ResultCacheState *) tb->private_data;
+	TupleTableSlot *tslot = rcstate->tableslot;
+	TupleTableSlot *pslot = rcstate->probeslot;
+	Form_pg_attribute *attrs = rcstate->hashkeydesc->attrs;
+	int			numkeys = rcstate->nkeys;
+	int			i;
+
+	/*
+	 * Each key is stored in the table only once, so two stored keys are
+	 * equal only if they are the same key.  This case arises when we look
+	 * up an entry by its own key in order to evict it.
+	 */
+	if (key1 != NULL && key2 != NULL)
+		return key1 == key2;
+
+	if (key1 == NULL)
+		key1 = key2;
+	Assert(key1 != NULL);
+
+	ExecStoreMinimalTuple(key1->params, tslot, false);
+
+	for (i = 0; i < numkeys; i++)
+	{
+		Datum		attr1;
+		Datum		attr2;
+		bool		isNull1;
+		bool		isNull2;
+
+		attr1 = slot_getattr(pslot, i + 1, &isNull1);
+		attr2 = slot_getattr(tslot, i + 1, &isNull2);
+
+		if (isNull1 != isNull2)
+			return false;
+		if (isNull1)
+			continue;			/* both are null, treat as equal */
+
+		if (!key_datum_equal(attr1, attr2, attrs[i]))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * build_hash_table
+ *		(Re)create the hash table and reset the memory accounting.
+ */
+static void
+build_hash_table(ResultCacheState *rcstate, uint32 size)
+{
+	/* Make a guess at a sane initial size if the planner didn't */
+	if (size == 0)
+		size = 1024;
+
+	rcstate->hashtable = resultcache_create(rcstate->tableContext, size,
+											rcstate);
+	dlist_init(&rcstate->lru_list);
+	rcstate->mem_used = rcstate->hashtable->size * sizeof(ResultCacheEntry);
+	rcstate->mem_peak = Max(rcstate->mem_peak, rcstate->mem_used);
+}
+
+/*
+ * prepare_probe_slot
+ *		Evaluate the cache key expressions into the probe slot.
+ */
+static void
+prepare_probe_slot(ResultCacheState *rcstate)
+{
+	TupleTableSlot *pslot = rcstate->probeslot;
+	ExprContext *econtext = rcstate->ss.ps.ps_ExprContext;
+	ListCell   *lc;
+	int			i = 0;
+
+	ExecClearTuple(pslot);
+
+	foreach(lc, rcstate->param_exprs)
+	{
+		ExprState  *exprstate = (ExprState *) lfirst(lc);
+
+		pslot->tts_values[i] = ExecEvalExpr(exprstate, econtext,
+											&pslot->tts_isnull[i], NULL);
+		i++;
+	}
+
+	ExecStoreVirtualTuple(pslot);
+}
+
+/*
+ * entry_purge_tuples
+ *		Free all cached tuples of 'entry', leaving the entry in place.
+ */
+static void
+entry_purge_tuples(ResultCacheState *rcstate, ResultCacheEntry *entry)
+{
+	ResultCacheTuple *tuple = entry->tuplehead;
+
+	while (tuple != NULL)
+	{
+		ResultCacheTuple *next = tuple->next;
+
+		rcstate->mem_used -= GetMemoryChunkSpace(tuple->mintuple) +
+			GetMemoryChunkSpace(tuple);
+		pfree(tuple->mintuple);
+		pfree(tuple);
+
+		tuple = next;
+	}
+
+	entry->tuplehead = NULL;
+	entry->complete = false;
+}
+
+/*
+ * remove_cache_entry
+ *		Remove 'entry' and its tuples from the cache.  Note that this may
+ *		move other entries around within the hash table.
+ */
+static void
+remove_cache_entry(ResultCacheState *rcstate, ResultCacheEntry *entry)
+{
+	ResultCacheKey *key = entry->key;
+
+	entry_purge_tuples(rcstate, entry);
+
+	dlist_delete(&key->lru_node);
+	rcstate->mem_used -= GetMemoryChunkSpace(key->params) +
+		GetMemoryChunkSpace(key);
+	pfree(key->params);
+	pfree(key);
+
+	resultcache_delete_item(rcstate->hashtable, entry);
+}
+
+/*
+ * cache_reduce_memory
+ *		Evict entries, least recently used first, until the cache fits in
+ *		its memory limit again.
+ *
+ * 'specialkey' is the key of the entry currently being filled; it is always
+ * the most recently used one, so it is evicted only once nothing else is
+ * left.  Returns false if it had to go, else true.  In the latter case
+ * rcstate->entry is refreshed, since evictions may move entries around.
+ */
+static bool
+cache_reduce_memory(ResultCacheState *rcstate, ResultCacheKey *specialkey)
+{
+	ExprContext *econtext = rcstate->ss.ps.ps_ExprContext;
+	bool		specialkey_intact = true;
+	dlist_mutable_iter iter;
+	MemoryContext oldcontext;
+
+	/* hash and equality function calls may leak, as in ExecResultCache */
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	dlist_foreach_modify(iter, &rcstate->lru_list)
+	{
+		ResultCacheKey *key = dlist_container(ResultCacheKey, lru_node,
+											  iter.cur);
+		ResultCacheEntry *entry;
+
+		if (rcstate->mem_used <= rcstate->mem_limit)
+			break;
+
+		if (key == specialkey)
+			specialkey_intact = false;
+
+		entry = resultcache_lookup(rcstate->hashtable, key);
+		Assert(entry != NULL);
+
+		remove_cache_entry(rcstate, entry);
+		rcstate->cache_evictions++;
+	}
+
+	if (specialkey_intact && specialkey != NULL)
+		rcstate->entry = resultcache_lookup(rcstate->hashtable, specialkey);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return specialkey_intact;
+}
+
+/*
+ * cache_lookup
+ *		Look up the current probe slot's parameter values, creating a new
+ *		(empty, incomplete) entry if there is none.
+ *
+ * Returns NULL if a new entry could not be made to fit in the cache.
+ */
+static ResultCacheEntry *
+cache_lookup(ResultCacheState *rcstate, bool *found)
+{
+	ResultCacheEntry *entry;
+	ResultCacheKey *key;
+	uint64		oldsize = rcstate->hashtable->size;
+	MemoryContext oldcontext;
+
+	entry = resultcache_insert(rcstate->hashtable, NULL, found);
+
+	if (*found)
+	{
+		/* Move the key to the tail of the LRU list */
+		dlist_delete(&entry->key->lru_node);
+		dlist_push_tail(&rcstate->lru_list, &entry->key->lru_node);
+		return entry;
+	}
+
+	/* The table may have grown to make room for the new entry */
+	if (rcstate->hashtable->size != oldsize)
+		rcstate->mem_used += (rcstate->hashtable->size - oldsize) *
+			sizeof(ResultCacheEntry);
+
+	oldcontext = MemoryContextSwitchTo(rcstate->tableContext);
+
+	key = (ResultCacheKey *) palloc(sizeof(ResultCacheKey));
+	key->params = ExecCopySlotMinimalTuple(rcstate->probeslot);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	entry->key = key;
+	entry->tuplehead = NULL;
+	entry->complete = false;
+
+	dlist_push_tail(&rcstate->lru_list, &key->lru_node);
+	rcstate->mem_used += GetMemoryChunkSpace(key->params) +
+		GetMemoryChunkSpace(key);
+	rcstate->mem_peak = Max(rcstate->mem_peak, rcstate->mem_used);
+
+	rcstate->entry = entry;
+	if (rcstate->mem_used > rcstate->mem_limit)
+	{
+		if (!cache_reduce_memory(rcstate, key))
+			return NULL;
+		entry = rcstate->entry;
+	}
+
+	return entry;
+}
+
+/*
+ * cache_store_tuple
+ *		Append a copy of 'slot' to the tuples of the entry being filled.
+ *
+ * Returns false if the entry no longer fits in the cache, in which case it
+ * has been removed.
+ */
+static bool
+cache_store_tuple(ResultCacheState *rcstate, TupleTableSlot *slot)
+{
+	ResultCacheTuple *tuple;
+	ResultCacheEntry *entry = rcstate->entry;
+	MemoryContext oldcontext;
+
+	Assert(entry != NULL);
+
+	oldcontext = MemoryContextSwitchTo(rcstate->tableContext);
+
+	tuple = (ResultCacheTuple *) palloc(sizeof(ResultCacheTuple));
+	tuple->mintuple = ExecCopySlotMinimalTuple(slot);
+	tuple->next = NULL;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	rcstate->mem_used += GetMemoryChunkSpace(tuple->mintuple) +
+		GetMemoryChunkSpace(tuple);
+	rcstate->mem_peak = Max(rcstate->mem_peak, rcstate->mem_used);
+
+	/* last_tuple is the tail of the entry's list while filling */
+	if (entry->tuplehead == NULL)
+		entry->tuplehead = tuple;
+	else
+		rcstate->last_tuple->next = tuple;
+	rcstate->last_tuple = tuple;
+
+	if (rcstate->mem_used > rcstate->mem_limit)
+	{
+		/*
+		 * Evict the entries this one has crowded out.  If even that isn't
+		 * enough, this scan is too big for the cache.
+		 */
+		if (!cache_reduce_memory(rcstate, entry->key))
+			return false;
+	}
+
+	return true;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecResultCache
+ *
+ *		Look up the current parameter values in the cache.  On a hit,
+ *		return the cached tuples; on a miss, return the subplan's tuples
+ *		and store them in the cache as we go.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecResultCache(ResultCacheState *node)
+{
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	PlanState  *outerNode;
+	TupleTableSlot *slot;
+	TupleTableSlot *outerslot;
+	ResultCacheEntry *entry;
+	MemoryContext oldcontext;
+	bool		found;
+
+	switch (node->rc_status)
+	{
+		case RC_CACHE_LOOKUP:
+
+			/*
+			 * Evaluate the cache keys and do the lookup in per-tuple memory,
+			 * so that whatever the hash and equality functions leak is
+			 * reclaimed at the next lookup.
+			 */
+			ResetExprContext(econtext);
+			oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+			prepare_probe_slot(node);
+			entry = cache_lookup(node, &found);
+			MemoryContextSwitchTo(oldcontext);
+
+			if (found && entry->complete)
+			{
+				node->cache_hits++;
+				node->entry = entry;
+
+				if (entry->tuplehead == NULL)
+				{
+					/* The subplan returned no rows for these parameters */
+					node->rc_status = RC_END_OF_SCAN;
+					return NULL;
+				}
+
+				node->last_tuple = entry->tuplehead;
+				node->rc_status = RC_CACHE_FETCH_NEXT_TUPLE;
+
+				slot = node->ss.ps.ps_ResultTupleSlot;
+				return ExecStoreMinimalTuple(entry->tuplehead->mintuple,
+											 slot, false);
+			}
+
+			node->cache_misses++;
+
+			/* An incomplete entry is of no use; refill it from scratch */
+			if (found)
+				entry_purge_tuples(node, entry);
+
+			outerNode = outerPlanState(node);
+
+			if (entry == NULL)
+			{
+				/* Couldn't even make room for the key */
+				node->cache_overflows++;
+				node->entry = NULL;
+				node->rc_status = RC_CACHE_BYPASS_MODE;
+
+				outerslot = ExecProcNode(outerNode);
+				if (TupIsNull(outerslot))
+				{
+					node->rc_status = RC_END_OF_SCAN;
+					return NULL;
+				}
+				return outerslot;
+			}
+
+			node->entry = entry;
+			node->last_tuple = NULL;
+
+			outerslot = ExecProcNode(outerNode);
+			if (TupIsNull(outerslot))
+			{
+				/* Cache the fact that there are no rows for these keys */
+				entry->complete = true;
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+
+			node->rc_status = RC_FILLING_CACHE;
+			if (!cache_store_tuple(node, outerslot))
+			{
+				node->cache_overflows++;
+				node->entry = NULL;
+				node->last_tuple = NULL;
+				node->rc_status = RC_CACHE_BYPASS_MODE;
+			}
+			return outerslot;
+
+		case RC_CACHE_FETCH_NEXT_TUPLE:
+			node->last_tuple = node->last_tuple->next;
+			if (node->last_tuple == NULL)
+			{
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+
+			slot = node->ss.ps.ps_ResultTupleSlot;
+			return ExecStoreMinimalTuple(node->last_tuple->mintuple,
+										 slot, false);
+
+		case RC_FILLING_CACHE:
+			outerNode = outerPlanState(node);
+			outerslot = ExecProcNode(outerNode);
+			if (TupIsNull(outerslot))
+			{
+				node->entry->complete = true;
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+
+			if (!cache_store_tuple(node, outerslot))
+			{
+				node->cache_overflows++;
+				node->entry = NULL;
+				node->last_tuple = NULL;
+				node->rc_status = RC_CACHE_BYPASS_MODE;
+			}
+			return outerslot;
+
+		case RC_CACHE_BYPASS_MODE:
+			outerNode = outerPlanState(node);
+			outerslot = ExecProcNode(outerNode);
+			if (TupIsNull(outerslot))
+			{
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+			return outerslot;
+
+		case RC_END_OF_SCAN:
+
+			/*
+			 * We've already returned NULL for this scan, but just in case
+			 * something calls us again by mistake.
+			 */
+			return NULL;
+
+		default:
+			elog(ERROR, "unrecognized resultcache state: %d",
+				 node->rc_status);
+			return NULL;
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitResultCache
+ * ----------------------------------------------------------------
+ */
+ResultCacheState *
+ExecInitResultCache(ResultCache *node, EState *estate, int eflags)
+{
+	ResultCacheState *rcstate;
+	Plan	   *outerPlan;
+	ListCell   *lc;
+
+	/* check for unsupported flags */
+	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
+
+	/*
+	 * create state structure
+	 */
+	rcstate = makeNode(ResultCacheState);
+	rcstate->ss.ps.plan = (Plan *) node;
+	rcstate->ss.ps.state = estate;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * create expression context for evaluating the cache keys
+	 */
+	ExecAssignExprContext(estate, &rcstate->ss.ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &rcstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &rcstate->ss);
+
+	/*
+	 * initialize child nodes
+	 *
+	 * The cache is what lets us avoid rescanning the child, so there's no
+	 * point in asking it to support REWIND.
+	 */
+	eflags &= ~EXEC_FLAG_REWIND;
+
+	outerPlan = outerPlan(node);
+	outerPlanState(rcstate) = ExecInitNode(outerPlan, estate, eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&rcstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&rcstate->ss);
+	rcstate->ss.ps.ps_ProjInfo = NULL;
+
+	/*
+	 * set up the cache keys
+	 */
+	rcstate->nkeys = node->numKeys;
+	rcstate->hashkeydesc = ExecTypeFromExprList(node->param_exprs);
+	rcstate->tableslot = MakeSingleTupleTableSlot(rcstate->hashkeydesc);
+	rcstate->probeslot = MakeSingleTupleTableSlot(rcstate->hashkeydesc);
+
+	rcstate->param_exprs = (List *)
+		ExecInitExpr((Expr *) node->param_exprs, (PlanState *) rcstate);
+
+	/*
+	 * Remember which params make up the key.  A change in any other param
+	 * the subplan depends on invalidates the whole cache.
+	 */
+	rcstate->keyparamids = NULL;
+	foreach(lc, node->param_exprs)
+	{
+		Param	   *param = (Param *) lfirst(lc);
+
+		Assert(IsA(param, Param) && param->paramkind == PARAM_EXEC);
+		rcstate->keyparamids = bms_add_member(rcstate->keyparamids,
+											  param->paramid);
+	}
+
+	/*
+	 * create the cache itself
+	 */
+	rcstate->tableContext = AllocSetContextCreate(CurrentMemoryContext,
+												  "ResultCacheHashTable",
+												  ALLOCSET_DEFAULT_SIZES);
+	rcstate->mem_limit = work_mem * 1024L;
+	rcstate->mem_peak = 0;
+	build_hash_table(rcstate, node->est_entries);
+
+	rcstate->entry = NULL;
+	rcstate->last_tuple = NULL;
+	rcstate->rc_status = RC_CACHE_LOOKUP;
+
+	return rcstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndResultCache
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndResultCache(ResultCacheState *node)
+{
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	ExecDropSingleTupleTableSlot(node->tableslot);
+	ExecDropSingleTupleTableSlot(node->probeslot);
+
+	/*
+	 * free exprcontext
+	 */
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * Release the cache
+	 */
+	MemoryContextDelete(node->tableContext);
+	node->hashtable = NULL;
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+}
+
+/* ----------------------------------------------------------------
+ *		ExecReScanResultCache
+ *
+ *		Prepare for a lookup with new parameter values.
+ * ----------------------------------------------------------------
+ */
+void
+ExecReScanResultCache(ResultCacheState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+
+	/*
+	 * An entry whose scan didn't run to completion can't be used to answer
+	 * future lookups, so get rid of it.
+	 */
+	if (node->entry != NULL && !node->entry->complete)
+		remove_cache_entry(node, node->entry);
+
+	node->entry = NULL;
+	node->last_tuple = NULL;
+	node->rc_status = RC_CACHE_LOOKUP;
+
+	/*
+	 * If any param other than the cache keys changed, all cached results
+	 * are potentially stale.
+	 */
+	if (node->ss.ps.chgParam != NULL &&
+		bms_nonempty_difference(node->ss.ps.chgParam, node->keyparamids))
+	{
+		MemoryContextReset(node->tableContext);
+		build_hash_table(node, ((ResultCache *) node->ss.ps.plan)->est_entries);
+	}
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+}
@@ -63,6 +63,7 @@ ExecSort(SortState *node)
 		Sort	   *plannode = (Sort *) node->ss.ps.plan;
 		PlanState  *outerNode;
 		TupleDesc	tupDesc;
+		double		ntuples = 0;
 
 		SO1_printf("ExecSort: %s\n",
 				   "sorting subplan");
@@ -106,8 +107,11 @@ ExecSort(SortState *node)
 				break;
 
 			tuplesort_puttupleslot(tuplesortstate, slot);
+			ntuples += 1;
 		}
 
+		ExecCheckRowEstimate(&node->ss.ps, ntuples);
+
 		/*
 		 * Complete the sort.
 		 */
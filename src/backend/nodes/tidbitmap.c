@@ -43,6 +43,8 @@
 #include "access/htup_details.h"
 #include "nodes/bitmapset.h"
 #include "nodes/tidbitmap.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
 #include "utils/hsearch.h"
 
 /*
@@ -155,6 +157,33 @@ struct TBMIterator
 	TBMIterateResult output;	/* MUST BE LAST (because variable-size) */
 };
 
+/*
+ * A bitmap can also be flattened into a single chunk of shared memory, so
+ * that the processes taking part in a parallel bitmap heap scan can divide
+ * its pages among themselves.  The sorted exact pages come first in entries[],
+ * followed by the sorted lossy chunks; the iteration pointers have the same
+ * meaning as in TBMIterator, but are shared by all the participants.
+ */
+struct TBMSharedIteratorState
+{
+	slock_t		mutex;			/* protects the iteration pointers */
+	int			npages;			/* number of exact entries */
+	int			nchunks;		/* number of lossy entries */
+	int			spageptr;		/* next exact page to hand out */
+	int			schunkptr;		/* next lossy chunk to look at */
+	int			schunkbit;		/* next bit to check in current chunk */
+	PagetableEntry entries[FLEXIBLE_ARRAY_MEMBER];
+};
+
+/*
+ * Backend-private handle on a TBMSharedIteratorState.
+ */
+struct TBMSharedIterator
+{
+	TBMSharedIteratorState *state;	/* shared state */
+	TBMIterateResult output;	/* MUST BE LAST (because variable-size) */
+};
+
 
 /* Local function prototypes */
 static void tbm_union_page(TIDBitmap *a, const PagetableEntry *bpage);
@@ -166,6 +195,7 @@ static PagetableEntry *tbm_get_pageentry(TIDBitmap *tbm, BlockNumber pageno);
 static bool tbm_page_is_lossy(const TIDBitmap *tbm, BlockNumber pageno);
 static void tbm_mark_page_lossy(TIDBitmap *tbm, BlockNumber pageno);
 static void tbm_lossify(TIDBitmap *tbm);
+static void tbm_sort_pages(TIDBitmap *tbm);
 static int	tbm_comparator(const void *left, const void *right);
 
 
@@ -598,12 +628,22 @@ tbm_begin_iterate(TIDBitmap *tbm)
 	iterator->schunkptr = 0;
 	iterator->schunkbit = 0;
 
-	/*
-	 * If we have a hashtable, create and fill the sorted page lists, unless
-	 * we already did that for a previous iterator.  Note that the lists are
-	 * attached to the bitmap not the iterator, so they can be used by more
-	 * than one iterator.
-	 */
+	tbm_sort_pages(tbm);
+
+	return iterator;
+}
+
+/*
+ * tbm_sort_pages - prepare a TIDBitmap for iteration
+ *
+ * If we have a hashtable, create and fill the sorted page lists, unless
+ * we already did that for a previous iterator.  Note that the lists are
+ * attached to the bitmap not the iterator, so they can be used by more
+ * than one iterator.
+ */
+static void
+tbm_sort_pages(TIDBitmap *tbm)
+{
 	if (tbm->status == TBM_HASH && !tbm->iterating)
 	{
 		HASH_SEQ_STATUS status;
@@ -640,8 +680,6 @@ tbm_begin_iterate(TIDBitmap *tbm)
 	}
 
 	tbm->iterating = true;
-
-	return iterator;
 }
 
 /*
@@ -769,6 +807,198 @@ tbm_end_iterate(TBMIterator *iterator)
 	pfree(iterator);
 }
 
+/*
+ * tbm_shared_iterate_size - space needed to share a TIDBitmap
+ *
+ * Returns the number of bytes that tbm_prepare_shared_iterate will need to
+ * store the bitmap's contents along with the shared iteration state.
+ */
+Size
+tbm_shared_iterate_size(const TIDBitmap *tbm)
+{
+	return add_size(offsetof(TBMSharedIteratorState, entries),
+					mul_size(tbm->npages + tbm->nchunks,
+							 sizeof(PagetableEntry)));
+}
+
+/*
+ * tbm_prepare_shared_iterate - flatten a TIDBitmap for shared iteration
+ *
+ * Copies the bitmap's entries, in the order tbm_iterate would return them,
+ * into 'target', which must have room for tbm_shared_iterate_size bytes,
+ * and initializes the shared iteration state there.  Participating
+ * processes then call tbm_attach_shared_iterate on the same memory.  The
+ * bitmap itself is no longer needed afterwards; like tbm_begin_iterate,
+ * this makes it read-only.
+ */
+void
+tbm_prepare_shared_iterate(TIDBitmap *tbm, TBMSharedIteratorState *target)
+{
+	PagetableEntry *entries = target->entries;
+	int			i;
+
+	tbm_sort_pages(tbm);
+
+	SpinLockInit(&target->mutex);
+	target->npages = tbm->npages;
+	target->nchunks = tbm->nchunks;
+	target->spageptr = 0;
+	target->schunkptr = 0;
+	target->schunkbit = 0;
+
+	if (tbm->status == TBM_ONE_PAGE)
+	{
+		/* In ONE_PAGE state there are no sorted lists to copy from */
+		memcpy(&entries[0], &tbm->entry1, sizeof(PagetableEntry));
+	}
+	else if (tbm->status == TBM_HASH)
+	{
+		for (i = 0; i < tbm->npages; i++)
+			memcpy(&entries[i], tbm->spages[i], sizeof(PagetableEntry));
+		for (i = 0; i < tbm->nchunks; i++)
+			memcpy(&entries[tbm->npages + i], tbm->schunks[i],
+				   sizeof(PagetableEntry));
+	}
+}
+
+/*
+ * tbm_attach_shared_iterate - join an iteration over a shared TIDBitmap
+ *
+ * 'state' must have been set up by tbm_prepare_shared_iterate, in this or
+ * some other process.
+ */
+TBMSharedIterator *
+tbm_attach_shared_iterate(TBMSharedIteratorState *state)
+{
+	TBMSharedIterator *iterator;
+
+	iterator = (TBMSharedIterator *) palloc(sizeof(TBMSharedIterator) +
+								 MAX_TUPLES_PER_PAGE * sizeof(OffsetNumber));
+	iterator->state = state;
+
+	return iterator;
+}
+
+/*
+ * tbm_shared_iterate - claim the next page of a shared TIDBitmap
+ *
+ * As tbm_iterate, except that each page is returned to only one of the
+ * processes iterating over the bitmap.  Each process still sees its own
+ * pages in numerical order.
+ */
+TBMIterateResult *
+tbm_shared_iterate(TBMSharedIterator *iterator)
+{
+	TBMSharedIteratorState *state = iterator->state;
+	TBMIterateResult *output = &(iterator->output);
+	PagetableEntry *page = NULL;
+	int			ntuples;
+	int			wordnum;
+
+	SpinLockAcquire(&state->mutex);
+
+	/*
+	 * If lossy chunk pages remain, make sure we've advanced schunkptr/
+	 * schunkbit to the next set bit.
+	 */
+	while (state->schunkptr < state->nchunks)
+	{
+		PagetableEntry *chunk = &state->entries[state->npages +
+												state->schunkptr];
+		int			schunkbit = state->schunkbit;
+
+		while (schunkbit < PAGES_PER_CHUNK)
+		{
+			int			wordnum = WORDNUM(schunkbit);
+			int			bitnum = BITNUM(schunkbit);
+
+			if ((chunk->words[wordnum] & ((bitmapword) 1 << bitnum)) != 0)
+				break;
+			schunkbit++;
+		}
+		if (schunkbit < PAGES_PER_CHUNK)
+		{
+			state->schunkbit = schunkbit;
+			break;
+		}
+		/* advance to next chunk */
+		state->schunkptr++;
+		state->schunkbit = 0;
+	}
+
+	/*
+	 * If both chunk and per-page data remain, must output the numerically
+	 * earlier page.
+	 */
+	if (state->schunkptr < state->nchunks)
+	{
+		PagetableEntry *chunk = &state->entries[state->npages +
+												state->schunkptr];
+		BlockNumber chunk_blockno;
+
+		chunk_blockno = chunk->blockno + state->schunkbit;
+		if (state->spageptr >= state->npages ||
+			chunk_blockno < state->entries[state->spageptr].blockno)
+		{
+			/* Return a lossy page indicator from the chunk */
+			state->schunkbit++;
+			SpinLockRelease(&state->mutex);
+
+			output->blockno = chunk_blockno;
+			output->ntuples = -1;
+			output->recheck = true;
+			return output;
+		}
+	}
+
+	if (state->spageptr < state->npages)
+		page = &state->entries[state->spageptr++];
+
+	SpinLockRelease(&state->mutex);
+
+	/* Nothing more in the bitmap? */
+	if (page == NULL)
+		return NULL;
+
+	/*
+	 * The entry is never modified once shared, so we can decode it without
+	 * holding the lock.
+	 */
+	ntuples = 0;
+	for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
+	{
+		bitmapword	w = page->words[wordnum];
+
+		if (w != 0)
+		{
+			int			off = wordnum * BITS_PER_BITMAPWORD + 1;
+
+			while (w != 0)
+			{
+				if (w & 1)
+					output->offsets[ntuples++] = (OffsetNumber) off;
+				off++;
+				w >>= 1;
+			}
+		}
+	}
+	output->blockno = page->blockno;
+	output->ntuples = ntuples;
+	output->recheck = page->recheck;
+	return output;
+}
+
+/*
+ * tbm_end_shared_iterate - finish this process's part of a shared iteration
+ *
+ * The shared state itself belongs to whoever allocated it.
+ */
+void
+tbm_end_shared_iterate(TBMSharedIterator *iterator)
+{
+	pfree(iterator);
+}
+
 /*
  * tbm_find_pageentry - find a PagetableEntry for the pageno
  *
@@ -57,6 +57,7 @@ typedef struct pushdown_safety_info
 /* These parameters are set by GUC */
 bool		enable_geqo = false;	/* just in case GUC doesn't set it */
 int			geqo_threshold;
+int			greedy_join_threshold;
 int			min_parallel_relation_size;
 
 /* Hook for plugins to get control in set_rel_pathlist() */
@@ -98,6 +99,8 @@ static void generate_mergeappend_paths(PlannerInfo *root, RelOptInfo *rel,
 static Path *get_cheapest_parameterized_child_path(PlannerInfo *root,
 									  RelOptInfo *rel,
 									  Relids required_outer);
+static Path *get_cheapest_parallel_safe_total_path(RelOptInfo *rel);
+static int	append_parallel_workers(List *live_childrels);
 static List *accumulate_append_subpath(List *subpaths, Path *path);
 static void set_subquery_pathlist(PlannerInfo *root, RelOptInfo *rel,
 					  Index rti, RangeTblEntry *rte);
@@ -138,6 +141,7 @@ make_one_rel(PlannerInfo *root, List *joinlist)
 {
 	RelOptInfo *rel;
 	Index		rti;
+	double		total_pages;
 
 	/*
 	 * Construct the all_baserels Relids set.
@@ -168,6 +172,40 @@ make_one_rel(PlannerInfo *root, List *joinlist)
 	 * then generate access paths.
 	 */
 	set_base_rel_sizes(root);
+
+	/*
+	 * We should now have size estimates for every actual table involved in
+	 * the query, and we also know which if any have been deleted from the
+	 * query by join removal or excluded by constraints; so we can compute
+	 * total_table_pages.
+	 *
+	 * Note that appendrels are not double-counted here, even though we don't
+	 * bother to distinguish RelOptInfos for appendrel parents, because the
+	 * parents will still have size zero.
+	 *
+	 * XXX if a table is self-joined, we will count it once per appearance,
+	 * which perhaps is the wrong thing ... but that's not completely clear,
+	 * and detecting self-joins here is difficult, so ignore it for now.
+	 */
+	total_pages = 0;
+	for (rti = 1; rti < root->simple_rel_array_size; rti++)
+	{
+		RelOptInfo *brel = root->simple_rel_array[rti];
+
+		if (brel == NULL)
+			continue;
+
+		Assert(brel->relid == rti);		/* sanity check on array */
+
+		if (IS_DUMMY_REL(brel))
+			continue;
+
+		if (brel->reloptkind == RELOPT_BASEREL ||
+			brel->reloptkind == RELOPT_OTHER_MEMBER_REL)
+			total_pages += (double) brel->pages;
+	}
+	root->total_table_pages = total_pages;
+
 	set_base_rel_pathlists(root);
 
 	/*
@@ -679,6 +717,29 @@ create_plain_partial_paths(PlannerInfo *root, RelOptInfo *rel)
 {
 	int			parallel_workers;
 
+	parallel_workers = compute_parallel_worker(rel, rel->pages);
+
+	/* If any limit was set to zero, the user doesn't want a parallel scan. */
+	if (parallel_workers <= 0)
+		return;
+
+	/* Add an unordered partial path based on a parallel sequential scan. */
+	add_partial_path(rel, create_seqscan_path(root, rel, NULL, parallel_workers));
+}
+
+/*
+ * compute_parallel_worker
+ *	  Compute the number of parallel workers that should be used to scan a
+ *	  relation, given the number of pages the scan will visit.
+ *
+ * Returns 0 if the scan isn't worth parallelizing.  Used for parallel
+ * sequential, index and bitmap heap scans alike.
+ */
+int
+compute_parallel_worker(RelOptInfo *rel, BlockNumber pages)
+{
+	int			parallel_workers;
+
 	/*
 	 * If the user has set the parallel_workers reloption, use that; otherwise
 	 * select a default number of workers.
@@ -696,9 +757,9 @@ create_plain_partial_paths(PlannerInfo *root, RelOptInfo *rel)
 		 * might not be worthwhile just for this relation, but when combined
 		 * with all of its inheritance siblings it may well pay off.
 		 */
-		if (rel->pages < (BlockNumber) min_parallel_relation_size &&
+		if (pages < (BlockNumber) min_parallel_relation_size &&
 			rel->reloptkind == RELOPT_BASEREL)
-			return;
+			return 0;
 
 		/*
 		 * Select the number of workers based on the log of the size of the
@@ -709,7 +770,7 @@ create_plain_partial_paths(PlannerInfo *root, RelOptInfo *rel)
 		 */
 		parallel_workers = 1;
 		parallel_threshold = Max(min_parallel_relation_size, 1);
-		while (rel->pages >= (BlockNumber) (parallel_threshold * 3))
+		while (pages >= (BlockNumber) (parallel_threshold * 3))
 		{
 			parallel_workers++;
 			parallel_threshold *= 3;
@@ -723,12 +784,7 @@ create_plain_partial_paths(PlannerInfo *root, RelOptInfo *rel)
 	 */
 	parallel_workers = Min(parallel_workers, max_parallel_workers_per_gather);
 
-	/* If any limit was set to zero, the user doesn't want a parallel scan. */
-	if (parallel_workers <= 0)
-		return;
-
-	/* Add an unordered partial path based on a parallel sequential scan. */
-	add_partial_path(rel, create_seqscan_path(root, rel, NULL, parallel_workers));
+	return parallel_workers;
 }
 
 /*
@@ -961,6 +1017,13 @@ set_append_rel_size(PlannerInfo *root, RelOptInfo *rel,
 			continue;
 		}
 
+		/*
+		 * Now that we know the child will be scanned, fetch the catalog
+		 * information that get_relation_info() put off for it.
+		 */
+		if (childRTE->rtekind == RTE_RELATION)
+			finish_relation_info(root, childrel);
+
 		/*
 		 * CE failed, so finish copying/modifying targetlist and join quals.
 		 *
@@ -1127,6 +1190,9 @@ set_append_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
 	bool		subpaths_valid = true;
 	List	   *partial_subpaths = NIL;
 	bool		partial_subpaths_valid = true;
+	List	   *pa_partial_subpaths = NIL;
+	List	   *pa_nonpartial_subpaths = NIL;
+	bool		pa_subpaths_valid = enable_parallel_append;
 	List	   *all_child_pathkeys = NIL;
 	List	   *all_child_outers = NIL;
 	ListCell   *l;
@@ -1197,6 +1263,45 @@ set_append_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
 		else
 			partial_subpaths_valid = false;
 
+		/*
+		 * Same idea, but for a parallel-aware append, which can mix partial
+		 * and non-partial paths: use whichever of the cheapest partial path
+		 * and the cheapest parallel-safe ordinary path is cheaper.
+		 */
+		if (pa_subpaths_valid)
+		{
+			Path	   *ppath = NULL;
+			Path	   *nppath;
+
+			if (childrel->partial_pathlist != NIL)
+				ppath = linitial(childrel->partial_pathlist);
+			nppath = get_cheapest_parallel_safe_total_path(childrel);
+
+			if (ppath == NULL && nppath == NULL)
+			{
+				/* Neither a partial nor a parallel-safe path?  Forget it. */
+				pa_subpaths_valid = false;
+			}
+			else if (nppath == NULL ||
+					 (ppath != NULL && ppath->total_cost < nppath->total_cost))
+			{
+				/* Partial path is cheaper or the only option. */
+				pa_partial_subpaths =
+					accumulate_append_subpath(pa_partial_subpaths, ppath);
+			}
+			else
+			{
+				/*
+				 * Either we've got only a non-partial path, or we think that
+				 * a single backend can execute the best non-partial path
+				 * faster than all the parallel backends working together can
+				 * execute the best partial path.
+				 */
+				pa_nonpartial_subpaths =
+					accumulate_append_subpath(pa_nonpartial_subpaths, nppath);
+			}
+		}
+
 		/*
 		 * Collect lists of all the available path orderings and
 		 * parameterizations for all the children.  We use these as a
@@ -1268,23 +1373,20 @@ set_append_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
 	 * if we have zero or one live subpath due to constraint exclusion.)
 	 */
 	if (subpaths_valid)
-		add_path(rel, (Path *) create_append_path(rel, subpaths, NULL, 0));
+		add_path(rel, (Path *) create_append_path(rel, subpaths, NIL,
+												  NULL, 0, false));
 
 	/*
 	 * Consider an append of partial unordered, unparameterized partial paths.
+	 * Make it parallel-aware if possible.
 	 */
-	if (partial_subpaths_valid)
+	if (partial_subpaths_valid && partial_subpaths != NIL)
 	{
 		AppendPath *appendpath;
 		ListCell   *lc;
 		int			parallel_workers = 0;
 
-		/*
-		 * Decide on the number of workers to request for this append path.
-		 * For now, we just use the maximum value from among the members.  It
-		 * might be useful to use a higher number if the Append node were
-		 * smart enough to spread out the workers, but it currently isn't.
-		 */
+		/* Find the highest number of workers requested for any subpath. */
 		foreach(lc, partial_subpaths)
 		{
 			Path	   *path = lfirst(lc);
@@ -1293,12 +1395,72 @@ set_append_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
 		}
 		Assert(parallel_workers > 0);
 
+		/*
+		 * If the use of parallel append is permitted, always request at least
+		 * log2(# of children) workers.  We assume it can be useful to have
+		 * extra workers in this case because they will be spread out across
+		 * the children.  The precise formula is just a guess, but we don't
+		 * want to end up with a radically different answer for a table with
+		 * N partitions vs. an unpartitioned table with the same data, so the
+		 * use of some kind of log-scaling here seems to make some sense.
+		 */
+		if (enable_parallel_append)
+		{
+			parallel_workers = Max(parallel_workers,
+								   append_parallel_workers(live_childrels));
+			parallel_workers = Min(parallel_workers,
+								   max_parallel_workers_per_gather);
+		}
+		Assert(parallel_workers > 0);
+
 		/* Generate a partial append path. */
-		appendpath = create_append_path(rel, partial_subpaths, NULL,
-										parallel_workers);
+		appendpath = create_append_path(rel, NIL, partial_subpaths, NULL,
+										parallel_workers,
+										enable_parallel_append);
 		add_partial_path(rel, (Path *) appendpath);
 	}
 
+	/*
+	 * Consider a parallel-aware append using a mix of partial and non-partial
+	 * paths.  (This only matters if some children have no partial path, or
+	 * a cheaper non-partial one; otherwise we built it just above.)
+	 */
+	if (pa_subpaths_valid && pa_nonpartial_subpaths != NIL)
+	{
+		AppendPath *appendpath;
+		ListCell   *lc;
+		int			parallel_workers = 0;
+
+		/*
+		 * Find the highest number of workers requested for any partial
+		 * subpath.
+		 */
+		foreach(lc, pa_partial_subpaths)
+		{
+			Path	   *path = lfirst(lc);
+
+			parallel_workers = Max(parallel_workers, path->parallel_workers);
+		}
+
+		/*
+		 * Same formula here as above.  It's even more important in this
+		 * instance because the non-partial paths won't contribute anything to
+		 * the planned number of parallel workers.
+		 */
+		parallel_workers = Max(parallel_workers,
+							   append_parallel_workers(live_childrels));
+		parallel_workers = Min(parallel_workers,
+							   max_parallel_workers_per_gather);
+
+		if (parallel_workers > 0)
+		{
+			appendpath = create_append_path(rel, pa_nonpartial_subpaths,
+											pa_partial_subpaths,
+											NULL, parallel_workers, true);
+			add_partial_path(rel, (Path *) appendpath);
+		}
+	}
+
 	/*
 	 * Also build unparameterized MergeAppend paths based on the collected
 	 * list of child pathkeys.
@@ -1347,7 +1509,8 @@ set_append_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
 
 		if (subpaths_valid)
 			add_path(rel, (Path *)
-					 create_append_path(rel, subpaths, required_outer, 0));
+					 create_append_path(rel, subpaths, NIL,
+										required_outer, 0, false));
 	}
 }
 
@@ -1522,6 +1685,48 @@ get_cheapest_parameterized_child_path(PlannerInfo *root, RelOptInfo *rel,
 	return cheapest;
 }
 
+/*
+ * get_cheapest_parallel_safe_total_path
+ *		Return the cheapest-total unparameterized parallel-safe path of a rel,
+ *		or NULL if there isn't one.
+ */
+static Path *
+get_cheapest_parallel_safe_total_path(RelOptInfo *rel)
+{
+	ListCell   *l;
+
+	/* pathlist is sorted by total cost, so the first match is cheapest */
+	foreach(l, rel->pathlist)
+	{
+		Path	   *path = (Path *) lfirst(l);
+
+		if (path->parallel_safe && path->param_info == NULL)
+			return path;
+	}
+
+	return NULL;
+}
+
+/*
+ * append_parallel_workers
+ *		Number of workers a parallel-aware Append over the given children
+ *		should request regardless of its subpaths: log2(# of children) + 1.
+ */
+static int
+append_parallel_workers(List *live_childrels)
+{
+	int			nchildren = list_length(live_childrels);
+	int			parallel_workers = 0;
+
+	while (nchildren > 0)
+	{
+		parallel_workers++;
+		nchildren >>= 1;
+	}
+
+	return parallel_workers;
+}
+
 /*
  * accumulate_append_subpath
  *		Add a subpath to the list being built for an Append or MergeAppend
@@ -1535,11 +1740,16 @@ get_cheapest_parameterized_child_path(PlannerInfo *root, RelOptInfo *rel,
  * omitting a sort step, which seems fine: if the parent is to be an Append,
  * its result would be unsorted anyway, while if the parent is to be a
  * MergeAppend, there's no point in a separate sort on a child.
+ *
+ * A parallel-aware child Append that has non-partial subpaths is kept as is,
+ * since its subpaths must not be mistaken for partial ones.
  */
 static List *
 accumulate_append_subpath(List *subpaths, Path *path)
 {
-	if (IsA(path, AppendPath))
+	if (IsA(path, AppendPath) &&
+		!(path->parallel_aware &&
+		  ((AppendPath *) path)->first_partial_path > 0))
 	{
 		AppendPath *apath = (AppendPath *) path;
 
@@ -1577,7 +1787,7 @@ set_dummy_rel_pathlist(RelOptInfo *rel)
 	rel->pathlist = NIL;
 	rel->partial_pathlist = NIL;
 
-	add_path(rel, (Path *) create_append_path(rel, NIL, NULL, 0));
+	add_path(rel, (Path *) create_append_path(rel, NIL, NIL, NULL, 0, false));
 
 	/*
 	 * We set the cheapest path immediately, to ensure that IS_DUMMY_REL()
@@ -2102,7 +2312,8 @@ make_rel_from_joinlist(PlannerInfo *root, List *joinlist)
 	{
 		/*
 		 * Consider the different orders in which we could join the rels,
-		 * using a plugin, GEQO, or the regular join search code.
+		 * using a plugin, the greedy search, GEQO, or the regular join search
+		 * code.
 		 *
 		 * We put the initial_rels list into a PlannerInfo field because
 		 * has_legal_joinclause() needs to look at it (ugly :-().
@@ -2111,6 +2322,9 @@ make_rel_from_joinlist(PlannerInfo *root, List *joinlist)
 
 		if (join_search_hook)
 			return (*join_search_hook) (root, levels_needed, initial_rels);
+		else if (greedy_join_threshold > 0 &&
+				 levels_needed >= greedy_join_threshold)
+			return greedy_join_search(root, levels_needed, initial_rels);
 		else if (enable_geqo && levels_needed >= geqo_threshold)
 			return geqo(root, levels_needed, initial_rels);
 		else
@@ -124,6 +124,10 @@ bool		enable_sort = true;
 bool		enable_hashagg = true;
 bool		enable_nestloop = true;
 bool		enable_material = true;
+bool		enable_resultcache = false;
+bool		enable_parallel_append = true;
+bool		enable_partitionwise_join = false;
+bool		enable_partitionwise_aggregate = false;
 bool		enable_mergejoin = true;
 bool		enable_hashjoin = true;
 
@@ -160,8 +164,13 @@ static Selectivity get_foreign_key_join_selectivity(PlannerInfo *root,
 								 List **restrictlist);
 static void set_rel_width(PlannerInfo *root, RelOptInfo *rel);
 static double relation_byte_size(double tuples, int width);
+static void cost_resultcache_rescan(PlannerInfo *root, ResultCachePath *rcpath,
+						Cost *rescan_startup_cost,
+						Cost *rescan_total_cost);
 static double page_size(double tuples, int width);
 static double get_parallel_divisor(Path *path);
+static Cost append_nonpartial_cost(List *subpaths, int numpaths,
+					   int parallel_workers);
 
 
 /*
@@ -411,6 +420,7 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count)
 				max_IO_cost;
 	QualCost	qpqual_cost;
 	Cost		cpu_per_tuple;
+	Cost		cpu_run_cost = 0;
 	double		tuples_fetched;
 	double		pages_fetched;
 
@@ -602,11 +612,24 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count)
 	startup_cost += qpqual_cost.startup;
 	cpu_per_tuple = cpu_tuple_cost + qpqual_cost.per_tuple;
 
-	run_cost += cpu_per_tuple * tuples_fetched;
+	cpu_run_cost += cpu_per_tuple * tuples_fetched;
 
 	/* tlist eval costs are paid per output row, not per tuple scanned */
 	startup_cost += path->path.pathtarget->cost.startup;
-	run_cost += path->path.pathtarget->cost.per_tuple * path->path.rows;
+	cpu_run_cost += path->path.pathtarget->cost.per_tuple * path->path.rows;
+
+	/* Adjust costing for parallelism, if used. */
+	if (path->path.parallel_workers > 0)
+	{
+		double		parallel_divisor = get_parallel_divisor(&path->path);
+
+		path->path.rows = clamp_row_est(path->path.rows / parallel_divisor);
+
+		/* The CPU cost is divided among all the workers. */
+		cpu_run_cost /= parallel_divisor;
+	}
+
+	run_cost += cpu_run_cost;
 
 	path->path.startup_cost = startup_cost;
 	path->path.total_cost = startup_cost + run_cost;
@@ -816,6 +839,7 @@ cost_bitmap_heap_scan(Path *path, PlannerInfo *root, RelOptInfo *baserel,
 	Selectivity indexSelectivity;
 	QualCost	qpqual_cost;
 	Cost		cpu_per_tuple;
+	Cost		cpu_run_cost;
 	Cost		cost_per_page;
 	double		tuples_fetched;
 	double		pages_fetched;
@@ -914,12 +938,28 @@ cost_bitmap_heap_scan(Path *path, PlannerInfo *root, RelOptInfo *baserel,
 
 	startup_cost += qpqual_cost.startup;
 	cpu_per_tuple = cpu_tuple_cost + qpqual_cost.per_tuple;
-
-	run_cost += cpu_per_tuple * tuples_fetched;
+	cpu_run_cost = cpu_per_tuple * tuples_fetched;
 
 	/* tlist eval costs are paid per output row, not per tuple scanned */
 	startup_cost += path->pathtarget->cost.startup;
-	run_cost += path->pathtarget->cost.per_tuple * path->rows;
+	cpu_run_cost += path->pathtarget->cost.per_tuple * path->rows;
+
+	/* Adjust costing for parallelism, if used. */
+	if (path->parallel_workers > 0)
+	{
+		double		parallel_divisor = get_parallel_divisor(path);
+
+		/*
+		 * The CPU cost is divided among all the workers; as for a parallel
+		 * seqscan, we assume the heap I/O isn't amortized, and the bitmap
+		 * itself is built just once, by the leader.
+		 */
+		cpu_run_cost /= parallel_divisor;
+
+		path->rows = clamp_row_est(path->rows / parallel_divisor);
+	}
+
+	run_cost += cpu_run_cost;
 
 	path->startup_cost = startup_cost;
 	path->total_cost = startup_cost + run_cost;
@@ -1551,6 +1591,167 @@ cost_sort(Path *path, PlannerInfo *root,
 	path->total_cost = startup_cost + run_cost;
 }
 
+/*
+ * cost_append
+ *	  Determines and returns the cost of an Append node.
+ *
+ * For an ordinary Append, rows and costs are simply the sums of those of
+ * the subpaths.  We charge nothing extra for the Append itself, which
+ * perhaps is too optimistic, but since it doesn't do any selection or
+ * projection, it is a pretty cheap node.
+ *
+ * For a parallel-aware Append, the subpaths' costs are per participant,
+ * and what we want is the cost for the participant that takes longest.
+ * Each partial subpath is shared by all participants, so its cost counts
+ * in full; non-partial subpaths are spread among the workers, so they
+ * count only as much as the busiest worker is expected to run.
+ */
+void
+cost_append(AppendPath *apath)
+{
+	ListCell   *l;
+
+	apath->path.rows = 0;
+	apath->path.startup_cost = 0;
+	apath->path.total_cost = 0;
+
+	if (apath->subpaths == NIL)
+		return;
+
+	if (!apath->path.parallel_aware)
+	{
+		foreach(l, apath->subpaths)
+		{
+			Path	   *subpath = (Path *) lfirst(l);
+
+			if (l == list_head(apath->subpaths))	/* first node? */
+				apath->path.startup_cost = subpath->startup_cost;
+			apath->path.rows += subpath->rows;
+			apath->path.total_cost += subpath->total_cost;
+		}
+	}
+	else
+	{
+		double		parallel_divisor = get_parallel_divisor(&apath->path);
+		int			i = 0;
+
+		foreach(l, apath->subpaths)
+		{
+			Path	   *subpath = (Path *) lfirst(l);
+
+			if (i == 0)
+				apath->path.startup_cost = subpath->startup_cost;
+
+			if (i < apath->first_partial_path)
+			{
+				/* Non-partial path: its rows are produced only once. */
+				apath->path.rows += subpath->rows / parallel_divisor;
+			}
+			else
+			{
+				double		subpath_parallel_divisor;
+
+				/*
+				 * Partial path: its rows are per participant, given its own
+				 * number of workers.
+				 */
+				subpath_parallel_divisor = get_parallel_divisor(subpath);
+				apath->path.rows += subpath->rows *
+					(subpath_parallel_divisor / parallel_divisor);
+				apath->path.total_cost += subpath->total_cost;
+			}
+			i++;
+		}
+
+		apath->path.rows = clamp_row_est(apath->path.rows);
+
+		/* Add cost for non-partial subpaths. */
+		apath->path.total_cost +=
+			append_nonpartial_cost(apath->subpaths,
+								   apath->first_partial_path,
+								   apath->path.parallel_workers);
+	}
+}
+
+/*
+ * append_nonpartial_cost
+ *	  Estimate the cost of running the first 'numpaths' non-partial subpaths
+ *	  of a parallel-aware Append, as seen by the busiest worker.
+ *
+ * The subpaths are sorted by decreasing cost, and each is handed to the
+ * worker that is least busy so far, which is what happens at execution
+ * time, where each worker picks up the next subpath when it finishes one.
+ */
+static Cost
+append_nonpartial_cost(List *subpaths, int numpaths, int parallel_workers)
+{
+	Cost	   *costarr;
+	int			arrlen;
+	ListCell   *l;
+	ListCell   *cell;
+	int			i;
+	int			path_index;
+	int			min_index;
+	int			max_index;
+
+	if (numpaths == 0)
+		return 0;
+
+	/*
+	 * Array length is number of workers or number of relevant paths,
+	 * whichever is less.
+	 */
+	arrlen = Min(parallel_workers, numpaths);
+	costarr = (Cost *) palloc(sizeof(Cost) * arrlen);
+
+	/* The first few paths will each be claimed by a different worker. */
+	path_index = 0;
+	foreach(cell, subpaths)
+	{
+		Path	   *subpath = (Path *) lfirst(cell);
+
+		if (path_index == arrlen)
+			break;
+		costarr[path_index++] = subpath->total_cost;
+	}
+
+	/*
+	 * Since subpaths are sorted by decreasing cost, the last one will have
+	 * the minimum cost.
+	 */
+	min_index = arrlen - 1;
+
+	/*
+	 * For each of the remaining non-partial subpaths, add its cost to the
+	 * array element with minimum cost.
+	 */
+	for_each_cell(l, cell)
+	{
+		Path	   *subpath = (Path *) lfirst(l);
+
+		if (path_index++ == numpaths)
+			break;
+
+		costarr[min_index] += subpath->total_cost;
+
+		/* Update the new min cost array index */
+		for (min_index = i = 0; i < arrlen; i++)
+		{
+			if (costarr[i] < costarr[min_index])
+				min_index = i;
+		}
+	}
+
+	/* Return the highest cost from the array */
+	for (max_index = i = 0; i < arrlen; i++)
+	{
+		if (costarr[i] > costarr[max_index])
+			max_index = i;
+	}
+
+	return costarr[max_index];
+}
+
 /*
  * cost_merge_append
  *	  Determines and returns the cost of a MergeAppend node.
@@ -3087,6 +3288,87 @@ cost_subplan(PlannerInfo *root, SubPlan *subplan, Plan *plan)
 }
 
 
+/*
+ * cost_resultcache_rescan
+ *	  Determines the estimated cost of rescanning a ResultCache node.
+ *
+ * Each rescan either finds its parameter values in the cache, in which case
+ * we just return the cached tuples, or has to rescan the subpath and store
+ * its output.  We estimate the number of distinct parameter values with
+ * estimate_num_groups(), i.e. from the n_distinct statistics of the outer
+ * side's join columns, and the number of entries that fit into work_mem
+ * from the subpath's size.  From those we derive the fraction of rescans
+ * that will be cache hits.
+ *
+ * As a side effect, this sets rcpath->est_entries, which the executor uses
+ * to size its hash table.
+ */
+static void
+cost_resultcache_rescan(PlannerInfo *root, ResultCachePath *rcpath,
+						Cost *rescan_startup_cost, Cost *rescan_total_cost)
+{
+	Path	   *subpath = rcpath->subpath;
+	Cost		input_startup_cost = subpath->startup_cost;
+	Cost		input_total_cost = subpath->total_cost;
+	double		tuples = subpath->rows;
+	double		calls = rcpath->calls;
+	int			width = subpath->pathtarget->width;
+	long		work_mem_bytes = work_mem * 1024L;
+	double		est_entry_bytes;
+	double		est_cache_entries;
+	double		ndistinct;
+	double		evict_ratio;
+	double		hit_ratio;
+	Cost		startup_cost;
+	Cost		total_cost;
+
+	/*
+	 * Each entry holds the subpath's tuples plus the key and some
+	 * bookkeeping, which we count as one more tuple.
+	 */
+	est_entry_bytes = relation_byte_size(tuples + 1, width);
+	est_cache_entries = floor(work_mem_bytes / est_entry_bytes);
+
+	ndistinct = estimate_num_groups(root, rcpath->hash_exprs, calls, NULL);
+
+	/* estimate_num_groups() should clamp to 'calls' already, but be sure */
+	if (ndistinct <= 0 || ndistinct > calls)
+		ndistinct = calls;
+
+	rcpath->est_entries = (uint32) Min(Min(ndistinct, est_cache_entries),
+									   PG_UINT32_MAX);
+
+	/* Fraction of entries we expect to have to evict for lack of room */
+	evict_ratio = 1.0 - Min(est_cache_entries, ndistinct) / ndistinct;
+
+	/*
+	 * The first call for each distinct key is always a miss.  Of the
+	 * remaining calls, only those whose key is still in the cache are hits.
+	 */
+	hit_ratio = ((calls - ndistinct) / calls) *
+		(Min(est_cache_entries, ndistinct) / ndistinct);
+	hit_ratio = Max(hit_ratio, 0.0);
+
+	/*
+	 * Every rescan has to hash the parameters and probe the cache.  Misses
+	 * pay for a rescan of the subpath plus storing its tuples; hits only pay
+	 * for returning the cached tuples.  Evictions cost about as much as
+	 * storing the tuples did.
+	 */
+	total_cost = cpu_operator_cost * list_length(rcpath->hash_exprs) +
+		cpu_tuple_cost;
+	total_cost += (1.0 - hit_ratio) *
+		(input_total_cost + cpu_tuple_cost * tuples);
+	total_cost += hit_ratio * cpu_tuple_cost * tuples;
+	total_cost += evict_ratio * cpu_tuple_cost * tuples;
+
+	startup_cost = cpu_operator_cost * list_length(rcpath->hash_exprs) +
+		(1.0 - hit_ratio) * input_startup_cost;
+
+	*rescan_startup_cost = startup_cost;
+	*rescan_total_cost = total_cost;
+}
+
 /*
  * cost_rescan
  *		Given a finished Path, estimate the costs of rescanning it after
@@ -3191,6 +3473,10 @@ cost_rescan(PlannerInfo *root, Path *path,
 				*rescan_total_cost = run_cost;
 			}
 			break;
+		case T_ResultCache:
+			cost_resultcache_rescan(root, (ResultCachePath *) path,
+									rescan_startup_cost, rescan_total_cost);
+			break;
 		default:
 			*rescan_startup_cost = path->startup_cost;
 			*rescan_total_cost = path->total_cost;
@@ -0,0 +1,278 @@
+/*-------------------------------------------------------------------------
+ *
+ * greedyjoin.c
+ *	  Greedy join order search for queries with many relations.
+ *
+ * standard_join_search() considers every way of building every subset of
+ * the relations to be joined, which takes time exponential in the number of
+ * relations.  GEQO bounds the effort, but its randomized search gives plans
+ * of uneven quality that can change from one run to the next.  The search
+ * here is a deterministic alternative for large join problems: we start out
+ * with each input relation as a separate "clump", and repeatedly join the
+ * pair of clumps whose join has the lowest estimated cost, until a single
+ * clump is left.  The joinrel for each candidate pair is remembered, so
+ * that after a merge only pairs involving the new clump have to be costed.
+ * That makes the search quadratic in the number of relations.
+ *
+ * After each merge we also try a few rotations of the new join, ie for
+ * (A JOIN B) JOIN C we additionally consider A JOIN (B JOIN C) and
+ * B JOIN (A JOIN C).  This is a cheap local improvement that fixes most
+ * of the cases where the greedy choice of the lower join was shortsighted,
+ * while adding only a constant amount of work per merge.
+ *
+ * Portions Copyright (c) 1996-2016, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/optimizer/path/greedyjoin.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "optimizer/joininfo.h"
+#include "optimizer/pathnode.h"
+#include "optimizer/paths.h"
+
+
+/* A set of already-joined relations, along with how it was built */
+typedef struct GreedyClump
+{
+	RelOptInfo *joinrel;		/* joinrel for the set of relations */
+	struct GreedyClump *left;	/* inputs of the chosen join, or NULL */
+	struct GreedyClump *right;
+} GreedyClump;
+
+/* What we know about joining two clumps */
+typedef struct GreedyPair
+{
+	bool		checked;		/* have we determined "desirable" yet? */
+	bool		desirable;		/* is there a join clause or restriction? */
+	bool		built;			/* have we tried to make the joinrel? */
+	RelOptInfo *joinrel;		/* the joinrel, or NULL if not legal */
+} GreedyPair;
+
+static RelOptInfo *greedy_make_join(PlannerInfo *root,
+				 RelOptInfo *rel1, RelOptInfo *rel2);
+static bool greedy_desirable_join(PlannerInfo *root,
+					  RelOptInfo *rel1, RelOptInfo *rel2);
+static void greedy_try_rotation(PlannerInfo *root, RelOptInfo *outer_rel,
+					RelOptInfo *rel1, RelOptInfo *rel2);
+static bool greedy_cheaper(RelOptInfo *rel1, RelOptInfo *rel2);
+
+
+/*
+ * greedy_join_search
+ *	  Find a join order for the given rels by greedy pairwise merging.
+ *
+ * The arguments and result are as for standard_join_search().
+ */
+RelOptInfo *
+greedy_join_search(PlannerInfo *root, int levels_needed, List *initial_rels)
+{
+	GreedyClump **clumps;
+	GreedyPair *pairs;
+	int			nclumps;
+	int			i;
+	int			j;
+	ListCell   *lc;
+
+	Assert(levels_needed == list_length(initial_rels));
+
+	clumps = (GreedyClump **) palloc(levels_needed * sizeof(GreedyClump *));
+	pairs = (GreedyPair *) palloc0(levels_needed * levels_needed *
+								   sizeof(GreedyPair));
+	i = 0;
+	foreach(lc, initial_rels)
+	{
+		GreedyClump *clump = (GreedyClump *) palloc(sizeof(GreedyClump));
+
+		clump->joinrel = (RelOptInfo *) lfirst(lc);
+		clump->left = NULL;
+		clump->right = NULL;
+		clumps[i++] = clump;
+	}
+
+	for (nclumps = levels_needed; nclumps > 1; nclumps--)
+	{
+		int			best_i = -1;
+		int			best_j = -1;
+		RelOptInfo *best_rel = NULL;
+		bool		force;
+		GreedyClump *newclump;
+
+		/*
+		 * Look for the cheapest join among pairs that have a join clause or
+		 * a join order restriction between them.  Only if there is none at
+		 * all do we consider clauseless joins; compare the heuristics in
+		 * join_search_one_level() and GEQO's desirable_join().
+		 */
+		for (force = false;; force = true)
+		{
+			for (i = 0; i < levels_needed; i++)
+			{
+				if (clumps[i] == NULL)
+					continue;
+				for (j = i + 1; j < levels_needed; j++)
+				{
+					GreedyPair *pair = &pairs[i * levels_needed + j];
+
+					if (clumps[j] == NULL)
+						continue;
+
+					if (!pair->checked)
+					{
+						pair->desirable =
+							greedy_desirable_join(root, clumps[i]->joinrel,
+												  clumps[j]->joinrel);
+						pair->checked = true;
+					}
+					if (!pair->desirable && !force)
+						continue;
+
+					if (!pair->built)
+					{
+						pair->joinrel = greedy_make_join(root,
+														 clumps[i]->joinrel,
+														 clumps[j]->joinrel);
+						pair->built = true;
+					}
+					if (pair->joinrel == NULL)
+						continue;
+
+					if (best_rel == NULL ||
+						greedy_cheaper(pair->joinrel, best_rel))
+					{
+						best_i = i;
+						best_j = j;
+						best_rel = pair->joinrel;
+					}
+				}
+			}
+			if (best_rel != NULL || force)
+				break;
+		}
+
+		if (best_rel == NULL)
+			elog(ERROR, "greedy join search failed to make a valid plan");
+
+		/* Merge the two clumps into the slot of the first one */
+		newclump = (GreedyClump *) palloc(sizeof(GreedyClump));
+		newclump->joinrel = best_rel;
+		newclump->left = clumps[best_i];
+		newclump->right = clumps[best_j];
+
+		/* Look for improvements by reassociating the lower joins */
+		if (newclump->left->left)
+		{
+			greedy_try_rotation(root, newclump->left->left->joinrel,
+								newclump->left->right->joinrel,
+								newclump->right->joinrel);
+			greedy_try_rotation(root, newclump->left->right->joinrel,
+								newclump->left->left->joinrel,
+								newclump->right->joinrel);
+		}
+		if (newclump->right->left)
+		{
+			greedy_try_rotation(root, newclump->right->left->joinrel,
+								newclump->right->right->joinrel,
+								newclump->left->joinrel);
+			greedy_try_rotation(root, newclump->right->right->joinrel,
+								newclump->right->left->joinrel,
+								newclump->left->joinrel);
+		}
+		generate_gather_paths(root, best_rel);
+		set_cheapest(best_rel);
+
+		clumps[best_i] = newclump;
+		clumps[best_j] = NULL;
+
+		/* Forget what we knew about pairs involving the replaced clump */
+		for (i = 0; i < levels_needed; i++)
+		{
+			MemSet(&pairs[i * levels_needed + best_i], 0, sizeof(GreedyPair));
+			MemSet(&pairs[best_i * levels_needed + i], 0, sizeof(GreedyPair));
+		}
+	}
+
+	/* The surviving clump is always in the first slot */
+	Assert(clumps[0] != NULL);
+
+	return clumps[0]->joinrel;
+}
+
+/*
+ * Build the joinrel for two clumps and set its cheapest paths.
+ * Returns NULL if the join is not legal.
+ */
+static RelOptInfo *
+greedy_make_join(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2)
+{
+	RelOptInfo *joinrel;
+
+	joinrel = make_join_rel(root, rel1, rel2);
+	if (joinrel == NULL || joinrel->pathlist == NIL)
+		return NULL;
+
+	generate_gather_paths(root, joinrel);
+	set_cheapest(joinrel);
+	if (joinrel->cheapest_total_path == NULL)
+		return NULL;
+
+	return joinrel;
+}
+
+/*
+ * Is it worth considering a join between these two rels without being
+ * forced to?
+ */
+static bool
+greedy_desirable_join(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2)
+{
+	return have_relevant_joinclause(root, rel1, rel2) ||
+		have_join_order_restriction(root, rel1, rel2);
+}
+
+/*
+ * Consider building the join of outer_rel, rel1 and rel2 as
+ * outer_rel JOIN (rel1 JOIN rel2), adding any resulting paths to the joinrel
+ * for the whole set.  We only bother if rel1 and rel2 have a reason to be
+ * joined directly.
+ */
+static void
+greedy_try_rotation(PlannerInfo *root, RelOptInfo *outer_rel,
+					RelOptInfo *rel1, RelOptInfo *rel2)
+{
+	RelOptInfo *inner_rel;
+
+	if (!greedy_desirable_join(root, rel1, rel2))
+		return;
+
+	/* Reuse the inner joinrel if we've already built it for another pair */
+	inner_rel = find_join_rel(root, bms_union(rel1->relids, rel2->relids));
+	if (inner_rel == NULL || inner_rel->cheapest_total_path == NULL)
+	{
+		inner_rel = greedy_make_join(root, rel1, rel2);
+		if (inner_rel == NULL)
+			return;
+	}
+
+	(void) make_join_rel(root, outer_rel, inner_rel);
+}
+
+/*
+ * Is the cheapest path of rel1 cheaper than that of rel2?  Ties are broken
+ * by the estimated number of rows; beyond that we keep the first candidate
+ * found, which makes the search deterministic.
+ */
+static bool
+greedy_cheaper(RelOptInfo *rel1, RelOptInfo *rel2)
+{
+	Cost		cost1 = rel1->cheapest_total_path->total_cost;
+	Cost		cost2 = rel2->cheapest_total_path->total_cost;
+
+	if (cost1 != cost2)
+		return cost1 < cost2;
+	return rel1->rows < rel2->rows;
+}
@@ -337,8 +337,27 @@ create_index_paths(PlannerInfo *root, RelOptInfo *rel)
 
 		bitmapqual = choose_bitmap_and(root, rel, bitindexpaths);
 		bpath = create_bitmap_heap_path(root, rel, bitmapqual,
-										rel->lateral_relids, 1.0);
+										rel->lateral_relids, 1.0, 0);
 		add_path(rel, (Path *) bpath);
+
+		/*
+		 * Also consider a parallel bitmap heap scan, in which the bitmap is
+		 * built once and its pages are then handed out to the workers.
+		 */
+		if (rel->consider_parallel && rel->lateral_relids == NULL)
+		{
+			int			parallel_workers;
+
+			parallel_workers = compute_parallel_worker(rel, rel->pages);
+
+			if (parallel_workers > 0)
+			{
+				bpath = create_bitmap_heap_path(root, rel, bitmapqual,
+												NULL, 1.0,
+												parallel_workers);
+				add_partial_path(rel, (Path *) bpath);
+			}
+		}
 	}
 
 	/*
@@ -410,7 +429,7 @@ create_index_paths(PlannerInfo *root, RelOptInfo *rel)
 			required_outer = get_bitmap_tree_required_outer(bitmapqual);
 			loop_count = get_loop_count(root, rel->relid, required_outer);
 			bpath = create_bitmap_heap_path(root, rel, bitmapqual,
-											required_outer, loop_count);
+											required_outer, loop_count, 0);
 			add_path(rel, (Path *) bpath);
 		}
 	}
@@ -870,6 +889,7 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	List	   *index_pathkeys;
 	List	   *useful_pathkeys;
 	bool		found_lower_saop_clause;
+	bool		found_saop_clause;
 	bool		pathkeys_possibly_useful;
 	bool		index_is_ordered;
 	bool		index_only_scan;
@@ -917,6 +937,7 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	index_clauses = NIL;
 	clause_columns = NIL;
 	found_lower_saop_clause = false;
+	found_saop_clause = false;
 	outer_relids = bms_copy(rel->lateral_relids);
 	for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
 	{
@@ -949,6 +970,7 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 					}
 					found_lower_saop_clause = true;
 				}
+				found_saop_clause = true;
 			}
 			index_clauses = lappend(index_clauses, rinfo);
 			clause_columns = lappend_int(clause_columns, indexcol);
@@ -1042,8 +1064,44 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 								  NoMovementScanDirection,
 								  index_only_scan,
 								  outer_relids,
-								  loop_count);
+								  loop_count,
+								  0);
 		result = lappend(result, ipath);
+
+		/*
+		 * If appropriate, consider a parallel scan of the index too.  The
+		 * result of a parallel scan is unordered, so there's no need to
+		 * consider backward scans or ordering operators; and the index AM
+		 * needn't cope with array keys, which it would have to step through
+		 * in lockstep across all the participants.
+		 */
+		if (index->amcanparallel &&
+			rel->consider_parallel && outer_relids == NULL &&
+			scantype != ST_BITMAPSCAN &&
+			!found_saop_clause && orderbyclauses == NIL)
+		{
+			int			parallel_workers;
+
+			parallel_workers = compute_parallel_worker(rel, index->pages);
+
+			if (parallel_workers > 0)
+			{
+				ipath = create_index_path(root, index,
+										  index_clauses,
+										  clause_columns,
+										  NIL,
+										  NIL,
+										  NIL,
+										  index_is_ordered ?
+										  ForwardScanDirection :
+										  NoMovementScanDirection,
+										  index_only_scan,
+										  NULL,
+										  loop_count,
+										  parallel_workers);
+				add_partial_path(rel, (Path *) ipath);
+			}
+		}
 	}
 
 	/*
@@ -1066,7 +1124,8 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 									  BackwardScanDirection,
 									  index_only_scan,
 									  outer_relids,
-									  loop_count);
+									  loop_count,
+									  0);
 			result = lappend(result, ipath);
 		}
 	}
@@ -18,9 +18,11 @@
 
 #include "executor/executor.h"
 #include "foreign/fdwapi.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/var.h"
 
 /* Hook for plugins to get control in add_paths_to_joinrel() */
 set_join_pathlist_hook_type set_join_pathlist_hook = NULL;
@@ -34,6 +36,9 @@ static void sort_inner_and_outer(PlannerInfo *root, RelOptInfo *joinrel,
 static void match_unsorted_outer(PlannerInfo *root, RelOptInfo *joinrel,
 					 RelOptInfo *outerrel, RelOptInfo *innerrel,
 					 JoinType jointype, JoinPathExtraData *extra);
+static Path *get_resultcache_path(PlannerInfo *root, RelOptInfo *innerrel,
+					 RelOptInfo *outerrel, Path *inner_path,
+					 Path *outer_path, JoinType jointype);
 static void consider_parallel_nestloop(PlannerInfo *root,
 						   RelOptInfo *joinrel,
 						   RelOptInfo *outerrel,
@@ -957,6 +962,7 @@ match_unsorted_outer(PlannerInfo *root,
 			foreach(lc2, innerrel->cheapest_parameterized_paths)
 			{
 				Path	   *innerpath = (Path *) lfirst(lc2);
+				Path	   *rcpath;
 
 				try_nestloop_path(root,
 								  joinrel,
@@ -965,6 +971,22 @@ match_unsorted_outer(PlannerInfo *root,
 								  merge_pathkeys,
 								  jointype,
 								  extra);
+
+				/*
+				 * Also try caching the results of a parameterized inner path,
+				 * in case the outer side repeats its join keys.
+				 */
+				rcpath = get_resultcache_path(root, innerrel, outerrel,
+											  innerpath, outerpath,
+											  save_jointype);
+				if (rcpath != NULL)
+					try_nestloop_path(root,
+									  joinrel,
+									  outerpath,
+									  rcpath,
+									  merge_pathkeys,
+									  jointype,
+									  extra);
 			}
 
 			/* Also consider materialized form of the cheapest inner path */
@@ -1198,6 +1220,95 @@ match_unsorted_outer(PlannerInfo *root,
 								   save_jointype, extra);
 }
 
+/*
+ * get_resultcache_path
+ *	  If possible, build a ResultCachePath caching the output of the
+ *	  parameterized 'inner_path' for each distinct set of outer values, for
+ *	  use as the inner side of a nestloop with 'outer_path'.  Returns NULL
+ *	  when a result cache isn't applicable.
+ *
+ * We only cache parameterized scans of base relations.  The cache keys are
+ * the nestloop params the scan depends on, which are the outer rel's Vars
+ * (and PlaceHolderVars) appearing in its join clauses; we estimate the
+ * number of distinct keys from those same expressions.  The executor
+ * compares keys by binary image, so any data type will do.
+ */
+static Path *
+get_resultcache_path(PlannerInfo *root, RelOptInfo *innerrel,
+					 RelOptInfo *outerrel, Path *inner_path,
+					 Path *outer_path, JoinType jointype)
+{
+	List	   *hash_exprs = NIL;
+	ListCell   *lc;
+
+	if (!enable_resultcache)
+		return NULL;
+
+	/* No point in caching if the inner side is scanned only once */
+	if (outer_path->rows < 2)
+		return NULL;
+
+	/* Only parameterized paths have anything to key the cache on */
+	if (inner_path->param_info == NULL)
+		return NULL;
+
+	/*
+	 * Semi and anti joins stop reading the inner side after the first match,
+	 * so entries would never be completed.
+	 */
+	if (jointype == JOIN_SEMI || jointype == JOIN_ANTI)
+		return NULL;
+
+	if (innerrel->reloptkind != RELOPT_BASEREL ||
+		!bms_is_empty(innerrel->lateral_relids))
+		return NULL;
+
+	/* The inner side must give the same answer for the same parameters */
+	if (contain_volatile_functions((Node *) innerrel->reltarget->exprs))
+		return NULL;
+
+	foreach(lc, innerrel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+		if (contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+	}
+
+	foreach(lc, inner_path->param_info->ppi_clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		List	   *vars;
+		ListCell   *lc2;
+
+		if (contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+
+		/* Collect the outer Vars, which become the nestloop params */
+		vars = pull_var_clause((Node *) rinfo->clause,
+							   PVC_INCLUDE_PLACEHOLDERS);
+		foreach(lc2, vars)
+		{
+			Node	   *node = (Node *) lfirst(lc2);
+
+			if (IsA(node, Var) &&
+				bms_is_member(((Var *) node)->varno, outerrel->relids))
+				hash_exprs = list_append_unique(hash_exprs, node);
+			else if (IsA(node, PlaceHolderVar) &&
+					 bms_overlap(((PlaceHolderVar *) node)->phrels,
+								 outerrel->relids))
+				hash_exprs = list_append_unique(hash_exprs, node);
+		}
+		list_free(vars);
+	}
+
+	if (hash_exprs == NIL)
+		return NULL;
+
+	return (Path *) create_resultcache_path(root, innerrel, inner_path,
+											hash_exprs, outer_path->rows);
+}
+
 /*
  * consider_parallel_nestloop
  *	  Try to build partial paths for a joinrel by joining a partial path for the
@@ -14,12 +14,46 @@
  */
 #include "postgres.h"
 
+#include "access/sysattr.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
 #include "optimizer/joininfo.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/plancat.h"
+#include "optimizer/predtest.h"
+#include "optimizer/prep.h"
+#include "optimizer/var.h"
+#include "parser/parsetree.h"
 #include "utils/memutils.h"
+#include "utils/typcache.h"
 
 
+/*
+ * Information about one member of an inheritance tree, used to match up the
+ * children of two inheritance trees for a partition-wise join.
+ */
+typedef struct InhJoinMember
+{
+	RelOptInfo *rel;			/* the member relation */
+	AppendRelInfo *appinfo;		/* its AppendRelInfo */
+	List	   *keyquals;		/* its CHECK constraints on the key column,
+								 * rewritten to use a common Var */
+	bool		live;			/* might it contain any rows? */
+	int			partner;		/* index of matching member of the other
+								 * tree, or -1 */
+} InhJoinMember;
+
+/* Context for replace_join_key_mutator */
+typedef struct
+{
+	Index		varno;			/* varno of the member's key column */
+	AttrNumber	varattno;		/* attno of the member's key column */
+	Var		   *commonvar;		/* Var to replace it with */
+} replace_join_key_context;
+
 static void make_rels_by_clause_joins(PlannerInfo *root,
 						  RelOptInfo *old_rel,
 						  ListCell *other_rels);
@@ -32,6 +66,34 @@ static bool is_dummy_rel(RelOptInfo *rel);
 static void mark_dummy_rel(RelOptInfo *rel);
 static bool restriction_is_constant_false(List *restrictlist,
 							  bool only_pushed_down);
+static void populate_joinrel_with_paths(PlannerInfo *root, RelOptInfo *rel1,
+							RelOptInfo *rel2, RelOptInfo *joinrel,
+							SpecialJoinInfo *sjinfo, List *restrictlist);
+static void try_partitionwise_join(PlannerInfo *root, RelOptInfo *rel1,
+					   RelOptInfo *rel2, RelOptInfo *joinrel,
+					   SpecialJoinInfo *parent_sjinfo,
+					   List *parent_restrictlist);
+static bool is_inheritance_parent(PlannerInfo *root, RelOptInfo *rel);
+static bool get_join_key_vars(RestrictInfo *rinfo, JoinType jointype,
+				  RelOptInfo *rel1, RelOptInfo *rel2,
+				  Var **keyvar1, Var **keyvar2);
+static InhJoinMember *get_inheritance_members(PlannerInfo *root,
+						RelOptInfo *rel, Var *keyvar, int *nmembers);
+static Node *replace_join_key_mutator(Node *node,
+						 replace_join_key_context *context);
+static bool match_inheritance_members(InhJoinMember *members1, int nmembers1,
+						  InhJoinMember *members2, int nmembers2,
+						  JoinType jointype);
+static bool inheritance_members_disjoint(InhJoinMember *members,
+							 int nmembers);
+static bool keyquals_equal(List *keyquals1, List *keyquals2);
+static bool member_refuted_by_all(InhJoinMember *member,
+					  InhJoinMember *others, int nothers);
+static SpecialJoinInfo *build_child_join_sjinfo(PlannerInfo *root,
+						SpecialJoinInfo *parent_sjinfo,
+						AppendRelInfo *appinfo1, AppendRelInfo *appinfo2);
+static Relids adjust_child_join_relids(Relids relids,
+						 AppendRelInfo *appinfo1, AppendRelInfo *appinfo2);
 
 
 /*
@@ -724,6 +786,33 @@ make_join_rel(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2)
 		return joinrel;
 	}
 
+	/* Add paths to the join relation. */
+	populate_joinrel_with_paths(root, rel1, rel2, joinrel, sjinfo,
+								restrictlist);
+
+	/* Consider joining matching children of the two relations. */
+	if (!is_dummy_rel(joinrel))
+		try_partitionwise_join(root, rel1, rel2, joinrel, sjinfo,
+							   restrictlist);
+
+	bms_free(joinrelids);
+
+	return joinrel;
+}
+
+
+/*
+ * populate_joinrel_with_paths
+ *	  Add paths to the given joinrel for the given pair of joining relations.
+ *	  The SpecialJoinInfo provides details about the join and the restrictlist
+ *	  contains the join clauses and the other clauses applicable for given
+ *	  pair of the joining relations.
+ */
+static void
+populate_joinrel_with_paths(PlannerInfo *root, RelOptInfo *rel1,
+							RelOptInfo *rel2, RelOptInfo *joinrel,
+							SpecialJoinInfo *sjinfo, List *restrictlist)
+{
 	/*
 	 * Consider paths using each rel as both outer and inner.  Depending on
 	 * the join type, a provably empty outer or inner rel might mean the join
@@ -868,12 +957,523 @@ make_join_rel(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2)
 			elog(ERROR, "unrecognized join type: %d", (int) sjinfo->jointype);
 			break;
 	}
+}
 
-	bms_free(joinrelids);
+/*
+ * try_partitionwise_join
+ *	  Consider building the join of two inheritance trees as an Append of
+ *	  joins between matching children.
+ *
+ * This is possible when both relations are inheritance parents partitioned
+ * on the columns equated by one of the join clauses: every member of either
+ * tree must carry CHECK constraints on its key column that are provably
+ * disjoint from those of its siblings, and the constraints of each member
+ * must be identical to those of one member of the other tree.  Rows that
+ * could join then can only come from a matched pair of children, so the
+ * join can be computed pair by pair, each pair planned for its own size and
+ * statistics.
+ *
+ * Members that are provably empty, either because they were excluded by the
+ * query's restrictions or because their own constraints are contradictory
+ * (such as the common CHECK (false) NO INHERIT on an inheritance parent),
+ * are ignored.  An unmatched member is tolerated only if its constraints
+ * contradict those of every member of the other tree and the join type
+ * lets us simply drop its rows.
+ *
+ * We only handle joins between two base inheritance trees; the resulting
+ * Append path competes with the ordinary join paths on cost.
+ */
+static void
+try_partitionwise_join(PlannerInfo *root, RelOptInfo *rel1,
+					   RelOptInfo *rel2, RelOptInfo *joinrel,
+					   SpecialJoinInfo *parent_sjinfo,
+					   List *parent_restrictlist)
+{
+	JoinType	jointype = parent_sjinfo->jointype;
+	InhJoinMember *members1 = NULL;
+	InhJoinMember *members2 = NULL;
+	int			nmembers1 = 0;
+	int			nmembers2 = 0;
+	List	   *subpaths = NIL;
+	ListCell   *lc;
+	int			i;
 
-	return joinrel;
+	if (!enable_partitionwise_join)
+		return;
+
+	if (!is_inheritance_parent(root, rel1) ||
+		!is_inheritance_parent(root, rel2))
+		return;
+
+	/*
+	 * Translating PlaceHolderVars and lateral references to the children is
+	 * more trouble than it's worth here.
+	 */
+	if (root->placeholder_list != NIL || root->hasLateralRTEs)
+		return;
+
+	if (jointype != JOIN_INNER && jointype != JOIN_LEFT &&
+		jointype != JOIN_FULL && jointype != JOIN_SEMI &&
+		jointype != JOIN_ANTI)
+		return;
+
+	/* Look for a join clause on which both trees are partitioned. */
+	foreach(lc, parent_restrictlist)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		Var		   *keyvar1;
+		Var		   *keyvar2;
+
+		if (!get_join_key_vars(rinfo, jointype, rel1, rel2,
+							   &keyvar1, &keyvar2))
+			continue;
+
+		members1 = get_inheritance_members(root, rel1, keyvar1, &nmembers1);
+		if (members1 != NULL)
+			members2 = get_inheritance_members(root, rel2, keyvar2,
+											   &nmembers2);
+		if (members2 != NULL &&
+			match_inheritance_members(members1, nmembers1,
+									  members2, nmembers2, jointype))
+			break;
+
+		members1 = members2 = NULL;
+	}
+
+	if (members1 == NULL)
+		return;
+
+	/* Plan the join of each matched pair of children. */
+	for (i = 0; i < nmembers1; i++)
+	{
+		InhJoinMember *member1 = &members1[i];
+		InhJoinMember *member2;
+		SpecialJoinInfo *child_sjinfo;
+		List	   *child_restrictlist;
+		RelOptInfo *child_joinrel;
+
+		if (member1->partner < 0)
+			continue;
+		member2 = &members2[member1->partner];
+
+		child_restrictlist = (List *)
+			adjust_appendrel_attrs(root, (Node *) parent_restrictlist,
+								   member1->appinfo);
+		child_restrictlist = (List *)
+			adjust_appendrel_attrs(root, (Node *) child_restrictlist,
+								   member2->appinfo);
+		child_sjinfo = build_child_join_sjinfo(root, parent_sjinfo,
+											   member1->appinfo,
+											   member2->appinfo);
+
+		child_joinrel = build_child_join_rel(root, member1->rel, member2->rel,
+											 joinrel,
+											 member1->appinfo,
+											 member2->appinfo,
+											 child_sjinfo,
+											 child_restrictlist);
+
+		populate_joinrel_with_paths(root, member1->rel, member2->rel,
+									child_joinrel, child_sjinfo,
+									child_restrictlist);
+
+		/* Give up if we couldn't find an unparameterized path for a pair. */
+		if (child_joinrel->pathlist == NIL)
+			return;
+		set_cheapest(child_joinrel);
+		if (is_dummy_rel(child_joinrel))
+			continue;
+		if (child_joinrel->cheapest_total_path->param_info != NULL)
+			return;
+
+		subpaths = lappend(subpaths, child_joinrel->cheapest_total_path);
+	}
+
+	add_path(joinrel, (Path *) create_append_path(joinrel, subpaths, NIL,
+												  NULL, 0, false));
+}
+
+/*
+ * is_inheritance_parent
+ *	  Is the given relation a base relation expanded into an inheritance
+ *	  tree?
+ */
+static bool
+is_inheritance_parent(PlannerInfo *root, RelOptInfo *rel)
+{
+	RangeTblEntry *rte;
+
+	if (rel->reloptkind != RELOPT_BASEREL || rel->rtekind != RTE_RELATION)
+		return false;
+	rte = planner_rt_fetch(rel->relid, root);
+
+	/* rte->inh is cleared if the relation turned out to have no children */
+	return rte->inh;
+}
+
+/*
+ * get_join_key_vars
+ *	  If the given join clause equates a column of rel1 with a column of
+ *	  rel2 of the same type, using that type's default equality operator,
+ *	  return those columns' Vars in *keyvar1 and *keyvar2.
+ *
+ * Requiring the default equality operator means that rows can only be
+ * joined if their key values are the same, and therefore satisfy the same
+ * CHECK constraints.
+ */
+static bool
+get_join_key_vars(RestrictInfo *rinfo, JoinType jointype,
+				  RelOptInfo *rel1, RelOptInfo *rel2,
+				  Var **keyvar1, Var **keyvar2)
+{
+	OpExpr	   *opexpr;
+	Var		   *leftvar;
+	Var		   *rightvar;
+	TypeCacheEntry *typentry;
+
+	if (!rinfo->can_join || rinfo->mergeopfamilies == NIL)
+		return false;
+
+	/* For an outer join, only the join's own quals decide which rows match */
+	if (IS_OUTER_JOIN(jointype) && rinfo->is_pushed_down)
+		return false;
+
+	if (!is_opclause(rinfo->clause) ||
+		list_length(((OpExpr *) rinfo->clause)->args) != 2)
+		return false;
+	opexpr = (OpExpr *) rinfo->clause;
+
+	leftvar = (Var *) linitial(opexpr->args);
+	rightvar = (Var *) lsecond(opexpr->args);
+	if (!IsA(leftvar, Var) || !IsA(rightvar, Var) ||
+		leftvar->varlevelsup != 0 || rightvar->varlevelsup != 0 ||
+		leftvar->varattno <= 0 || rightvar->varattno <= 0)
+		return false;
+
+	if (leftvar->varno == rel1->relid && rightvar->varno == rel2->relid)
+	{
+		*keyvar1 = leftvar;
+		*keyvar2 = rightvar;
+	}
+	else if (leftvar->varno == rel2->relid && rightvar->varno == rel1->relid)
+	{
+		*keyvar1 = rightvar;
+		*keyvar2 = leftvar;
+	}
+	else
+		return false;
+
+	if (leftvar->vartype != rightvar->vartype ||
+		leftvar->varcollid != rightvar->varcollid)
+		return false;
+
+	typentry = lookup_type_cache(leftvar->vartype, TYPECACHE_EQ_OPR);
+	if (opexpr->opno != typentry->eq_opr)
+		return false;
+
+	return true;
 }
 
+/*
+ * get_inheritance_members
+ *	  Collect the members of the inheritance tree rooted at 'rel', along with
+ *	  their CHECK constraints on the column identified by 'keyvar'.
+ *
+ * Returns NULL if some member that might contain rows has no usable
+ * constraints on the key column.
+ */
+static InhJoinMember *
+get_inheritance_members(PlannerInfo *root, RelOptInfo *rel, Var *keyvar,
+						int *nmembers)
+{
+	InhJoinMember *members;
+	Var		   *commonvar;
+	int			n = 0;
+	ListCell   *lc;
+
+	members = (InhJoinMember *)
+		palloc0(list_length(root->append_rel_list) * sizeof(InhJoinMember));
+
+	/*
+	 * Constraints of all members, in both trees, are rewritten in terms of
+	 * this Var, so that they can be compared with each other.
+	 */
+	commonvar = makeVar(1, 1, keyvar->vartype, -1, keyvar->varcollid, 0);
+
+	foreach(lc, root->append_rel_list)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(lc);
+		InhJoinMember *member;
+		RelOptInfo *childrel;
+		Var		   *childvar;
+		ListCell   *lc2;
+
+		if (appinfo->parent_relid != rel->relid)
+			continue;
+
+		childrel = find_base_rel(root, appinfo->child_relid);
+		childvar = (Var *) list_nth(appinfo->translated_vars,
+									keyvar->varattno - 1);
+		if (childvar == NULL || !IsA(childvar, Var))
+			return NULL;
+
+		member = &members[n++];
+		member->rel = childrel;
+		member->appinfo = appinfo;
+		member->live = !is_dummy_rel(childrel);
+		member->partner = -1;
+
+		if (!member->live)
+			continue;
+
+		foreach(lc2, get_relation_immutable_constraints(root, childrel, false))
+		{
+			Node	   *pred = (Node *) lfirst(lc2);
+			Bitmapset  *attnos = NULL;
+			replace_join_key_context context;
+
+			/* A constant-false constraint means the member must be empty. */
+			if (IsA(pred, Const) &&
+				(((Const *) pred)->constisnull ||
+				 !DatumGetBool(((Const *) pred)->constvalue)))
+			{
+				member->live = false;
+				break;
+			}
+
+			/* Keep only constraints on the key column alone. */
+			pull_varattnos(pred, childrel->relid, &attnos);
+			if (bms_membership(attnos) != BMS_SINGLETON ||
+				bms_singleton_member(attnos) !=
+				childvar->varattno - FirstLowInvalidHeapAttributeNumber)
+				continue;
+
+			context.varno = childrel->relid;
+			context.varattno = childvar->varattno;
+			context.commonvar = commonvar;
+			member->keyquals = lappend(member->keyquals,
+									   replace_join_key_mutator(pred,
+																&context));
+		}
+
+		if (member->live && member->keyquals == NIL)
+			return NULL;
+	}
+
+	*nmembers = n;
+	return members;
+}
+
+/*
+ * replace_join_key_mutator
+ *	  Replace Vars for a member's key column with the common key Var.
+ */
+static Node *
+replace_join_key_mutator(Node *node, replace_join_key_context *context)
+{
+	if (node == NULL)
+		return NULL;
+	if (IsA(node, Var))
+	{
+		Var		   *var = (Var *) node;
+
+		if (var->varno == context->varno &&
+			var->varattno == context->varattno &&
+			var->varlevelsup == 0)
+			return (Node *) copyObject(context->commonvar);
+		return node;
+	}
+	return expression_tree_mutator(node, replace_join_key_mutator,
+								   (void *) context);
+}
+
+/*
+ * match_inheritance_members
+ *	  Pair up the live members of two inheritance trees that have identical
+ *	  key constraints, filling in their 'partner' fields.
+ *
+ * Returns false if the trees can't be joined member by member.
+ */
+static bool
+match_inheritance_members(InhJoinMember *members1, int nmembers1,
+						  InhJoinMember *members2, int nmembers2,
+						  JoinType jointype)
+{
+	bool		found_pair = false;
+	int			i;
+	int			j;
+
+	if (!inheritance_members_disjoint(members1, nmembers1) ||
+		!inheritance_members_disjoint(members2, nmembers2))
+		return false;
+
+	for (i = 0; i < nmembers1; i++)
+	{
+		if (!members1[i].live)
+			continue;
+
+		for (j = 0; j < nmembers2; j++)
+		{
+			if (!members2[j].live || members2[j].partner >= 0)
+				continue;
+			if (keyquals_equal(members1[i].keyquals, members2[j].keyquals))
+			{
+				members1[i].partner = j;
+				members2[j].partner = i;
+				found_pair = true;
+				break;
+			}
+		}
+	}
+
+	if (!found_pair)
+		return false;
+
+	/*
+	 * An unmatched member can be left out only if none of its rows can join
+	 * to anything and the join type doesn't need its rows anyway.  Rows of
+	 * the left-hand relation are needed for all but inner and semi joins;
+	 * rows of the right-hand relation only for full joins.
+	 */
+	for (i = 0; i < nmembers1; i++)
+	{
+		if (!members1[i].live || members1[i].partner >= 0)
+			continue;
+		if (jointype != JOIN_INNER && jointype != JOIN_SEMI)
+			return false;
+		if (!member_refuted_by_all(&members1[i], members2, nmembers2))
+			return false;
+	}
+	for (j = 0; j < nmembers2; j++)
+	{
+		if (!members2[j].live || members2[j].partner >= 0)
+			continue;
+		if (jointype == JOIN_FULL)
+			return false;
+		if (!member_refuted_by_all(&members2[j], members1, nmembers1))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * inheritance_members_disjoint
+ *	  Check that no two live members of a tree can hold the same key value.
+ */
+static bool
+inheritance_members_disjoint(InhJoinMember *members, int nmembers)
+{
+	int			i;
+
+	for (i = 0; i < nmembers; i++)
+	{
+		if (!members[i].live)
+			continue;
+		if (!member_refuted_by_all(&members[i], members + i + 1,
+								   nmembers - i - 1))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * keyquals_equal
+ *	  Are two lists of key constraints the same, ignoring order?
+ */
+static bool
+keyquals_equal(List *keyquals1, List *keyquals2)
+{
+	ListCell   *lc;
+
+	foreach(lc, keyquals1)
+	{
+		if (!list_member(keyquals2, lfirst(lc)))
+			return false;
+	}
+	foreach(lc, keyquals2)
+	{
+		if (!list_member(keyquals1, lfirst(lc)))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * member_refuted_by_all
+ *	  Do the key constraints of every live member of 'others' contradict
+ *	  those of 'member'?
+ */
+static bool
+member_refuted_by_all(InhJoinMember *member, InhJoinMember *others,
+					  int nothers)
+{
+	int			i;
+
+	for (i = 0; i < nothers; i++)
+	{
+		if (!others[i].live)
+			continue;
+		if (!predicate_refuted_by(member->keyquals, others[i].keyquals))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * build_child_join_sjinfo
+ *	  Construct the SpecialJoinInfo for a join between two children from the
+ *	  SpecialJoinInfo for the join between their parents.
+ */
+static SpecialJoinInfo *
+build_child_join_sjinfo(PlannerInfo *root, SpecialJoinInfo *parent_sjinfo,
+						AppendRelInfo *appinfo1, AppendRelInfo *appinfo2)
+{
+	SpecialJoinInfo *sjinfo = makeNode(SpecialJoinInfo);
+
+	memcpy(sjinfo, parent_sjinfo, sizeof(SpecialJoinInfo));
+	sjinfo->min_lefthand = adjust_child_join_relids(sjinfo->min_lefthand,
+													appinfo1, appinfo2);
+	sjinfo->min_righthand = adjust_child_join_relids(sjinfo->min_righthand,
+													 appinfo1, appinfo2);
+	sjinfo->syn_lefthand = adjust_child_join_relids(sjinfo->syn_lefthand,
+													appinfo1, appinfo2);
+	sjinfo->syn_righthand = adjust_child_join_relids(sjinfo->syn_righthand,
+													 appinfo1, appinfo2);
+	sjinfo->semi_rhs_exprs = (List *)
+		adjust_appendrel_attrs(root, (Node *) sjinfo->semi_rhs_exprs,
+							   appinfo1);
+	sjinfo->semi_rhs_exprs = (List *)
+		adjust_appendrel_attrs(root, (Node *) sjinfo->semi_rhs_exprs,
+							   appinfo2);
+
+	return sjinfo;
+}
+
+/*
+ * adjust_child_join_relids
+ *	  Replace the parents' relids by the children's in a relid set.
+ */
+static Relids
+adjust_child_join_relids(Relids relids,
+						 AppendRelInfo *appinfo1, AppendRelInfo *appinfo2)
+{
+	relids = bms_copy(relids);
+	if (bms_is_member(appinfo1->parent_relid, relids))
+	{
+		relids = bms_del_member(relids, appinfo1->parent_relid);
+		relids = bms_add_member(relids, appinfo1->child_relid);
+	}
+	if (bms_is_member(appinfo2->parent_relid, relids))
+	{
+		relids = bms_del_member(relids, appinfo2->parent_relid);
+		relids = bms_add_member(relids, appinfo2->child_relid);
+	}
+	return relids;
+}
 
 /*
  * have_join_order_restriction
@@ -1197,7 +1797,7 @@ mark_dummy_rel(RelOptInfo *rel)
 	rel->partial_pathlist = NIL;
 
 	/* Set up the dummy path */
-	add_path(rel, (Path *) create_append_path(rel, NIL, NULL, 0));
+	add_path(rel, (Path *) create_append_path(rel, NIL, NIL, NULL, 0, false));
 
 	/* Set or update cheapest_total_path and related fields */
 	set_cheapest(rel);
@@ -81,6 +81,9 @@ static Plan *create_join_plan(PlannerInfo *root, JoinPath *best_path);
 static Plan *create_append_plan(PlannerInfo *root, AppendPath *best_path);
 static Plan *create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path);
 static Result *create_result_plan(PlannerInfo *root, ResultPath *best_path);
+static ResultCache *create_resultcache_plan(PlannerInfo *root,
+						ResultCachePath *best_path, int flags);
+static Plan *finish_resultcache_plan(ResultCache *rcplan, List *nestParams);
 static Material *create_material_plan(PlannerInfo *root, MaterialPath *best_path,
 					 int flags);
 static Plan *create_unique_plan(PlannerInfo *root, UniquePath *best_path,
@@ -145,6 +148,9 @@ static CustomScan *create_customscan_plan(PlannerInfo *root,
 static NestLoop *create_nestloop_plan(PlannerInfo *root, NestPath *best_path);
 static MergeJoin *create_mergejoin_plan(PlannerInfo *root, MergePath *best_path);
 static HashJoin *create_hashjoin_plan(PlannerInfo *root, HashPath *best_path);
+static void get_runtime_prune_info(PlannerInfo *root, List *subpaths,
+					   List **pruneconstraints, List **prunequals);
+static bool contain_param_walker(Node *node, void *context);
 static Node *replace_nestloop_params(PlannerInfo *root, Node *expr);
 static Node *replace_nestloop_params_mutator(Node *node, PlannerInfo *root);
 static void process_subquery_nestloop_params(PlannerInfo *root,
@@ -193,7 +199,8 @@ static CteScan *make_ctescan(List *qptlist, List *qpqual,
 			 Index scanrelid, int ctePlanId, int cteParam);
 static WorkTableScan *make_worktablescan(List *qptlist, List *qpqual,
 				   Index scanrelid, int wtParam);
-static Append *make_append(List *appendplans, List *tlist);
+static Append *make_append(List *appendplans, int first_partial_plan,
+			List *tlist);
 static RecursiveUnion *make_recursive_union(List *tlist,
 					 Plan *lefttree,
 					 Plan *righttree,
@@ -246,6 +253,7 @@ static Sort *make_sort_from_groupcols(List *groupcls,
 						 AttrNumber *grpColIdx,
 						 Plan *lefttree);
 static Material *make_material(Plan *lefttree);
+static ResultCache *make_resultcache(Plan *lefttree, uint32 est_entries);
 static WindowAgg *make_windowagg(List *tlist, Index winref,
 			   int partNumCols, AttrNumber *partColIdx, Oid *partOperators,
 			   int ordNumCols, AttrNumber *ordColIdx, Oid *ordOperators,
@@ -397,6 +405,11 @@ create_plan_recurse(PlannerInfo *root, Path *best_path, int flags)
 												 (MaterialPath *) best_path,
 												 flags);
 			break;
+		case T_ResultCache:
+			plan = (Plan *) create_resultcache_plan(root,
+												(ResultCachePath *) best_path,
+													flags);
+			break;
 		case T_Unique:
 			if (IsA(best_path, UpperUniquePath))
 			{
@@ -1010,10 +1023,13 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path)
 	 * parent-rel Vars it'll be asked to emit.
 	 */
 
-	plan = make_append(subplans, tlist);
+	plan = make_append(subplans, best_path->first_partial_path, tlist);
 
 	copy_generic_path_info(&plan->plan, (Path *) best_path);
 
+	get_runtime_prune_info(root, best_path->subpaths,
+						   &plan->pruneconstraints, &plan->prunequals);
+
 	return (Plan *) plan;
 }
 
@@ -1120,9 +1136,117 @@ create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path)
 
 	node->mergeplans = subplans;
 
+	get_runtime_prune_info(root, best_path->subpaths,
+						   &node->pruneconstraints, &node->prunequals);
+
 	return (Plan *) node;
 }
 
+/*
+ * get_runtime_prune_info
+ *	  Collect what the executor needs to skip, at run time, children of an
+ *	  Append or MergeAppend that constraint exclusion couldn't remove at plan
+ *	  time because the restriction clauses that would refute them compare
+ *	  against Params rather than Consts.
+ *
+ * Typical cases are generic plans for prepared statements, and the inner
+ * side of a nestloop whose join clauses have become nestloop Params.  For
+ * each inheritance child we keep its usable constraints and those of its
+ * restriction clauses (including parameterized join clauses) that involve
+ * Params.  If no child has both, we set both output lists to NIL, which
+ * tells the executor that there's nothing to do.
+ */
+static void
+get_runtime_prune_info(PlannerInfo *root, List *subpaths,
+					   List **pruneconstraints, List **prunequals)
+{
+	List	   *constraints = NIL;
+	List	   *quals = NIL;
+	bool		found = false;
+	ListCell   *lc;
+
+	*pruneconstraints = NIL;
+	*prunequals = NIL;
+
+	/* Constraint exclusion is skipped entirely if it's disabled */
+	if (constraint_exclusion == CONSTRAINT_EXCLUSION_OFF)
+		return;
+
+	foreach(lc, subpaths)
+	{
+		Path	   *subpath = (Path *) lfirst(lc);
+		RelOptInfo *rel = subpath->parent;
+		List	   *childconstraints = NIL;
+		List	   *childquals = NIL;
+
+		if (rel->reloptkind == RELOPT_OTHER_MEMBER_REL &&
+			rel->rtekind == RTE_RELATION)
+		{
+			List	   *clauses;
+			ListCell   *lc2;
+
+			clauses = extract_actual_clauses(rel->baserestrictinfo, false);
+			if (subpath->param_info)
+			{
+				List	   *joinclauses;
+
+				joinclauses =
+					extract_actual_clauses(subpath->param_info->ppi_clauses,
+										   false);
+				joinclauses = (List *)
+					replace_nestloop_params(root, (Node *) joinclauses);
+				clauses = list_concat(list_copy(clauses), joinclauses);
+			}
+
+			/*
+			 * Clauses without Params were already considered at plan time.
+			 * We can't make deductions from mutable functions, nor can the
+			 * executor substitute for anything but plain Params.
+			 */
+			foreach(lc2, clauses)
+			{
+				Node	   *clause = (Node *) lfirst(lc2);
+
+				if (contain_param_walker(clause, NULL) &&
+					!contain_mutable_functions(clause) &&
+					!contain_subplans(clause))
+					childquals = lappend(childquals, clause);
+			}
+
+			if (childquals != NIL)
+				childconstraints =
+					get_relation_immutable_constraints(root, rel, true);
+			if (childconstraints != NIL)
+				found = true;
+			else
+				childquals = NIL;
+		}
+
+		constraints = lappend(constraints, childconstraints);
+		quals = lappend(quals, childquals);
+	}
+
+	if (found)
+	{
+		*pruneconstraints = constraints;
+		*prunequals = quals;
+	}
+}
+
+/*
+ * contain_param_walker
+ *	  Does the expression contain any Param?
+ */
+static bool
+contain_param_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+		return true;
+	return expression_tree_walker(node, contain_param_walker, context);
+}
+
 /*
  * create_result_plan
  *	  Create a Result plan for 'best_path'.
@@ -1178,6 +1302,73 @@ create_material_plan(PlannerInfo *root, MaterialPath *best_path, int flags)
 	return plan;
 }
 
+/*
+ * create_resultcache_plan
+ *	  Create a ResultCache plan for 'best_path' and (recursively) plans
+ *	  for its subpaths.
+ *
+ *	  The cache keys are the nestloop params the subplan depends on, which
+ *	  aren't known until the parent nestloop has been planned; see
+ *	  finish_resultcache_plan().
+ *
+ *	  Returns a Plan node.
+ */
+static ResultCache *
+create_resultcache_plan(PlannerInfo *root, ResultCachePath *best_path,
+						int flags)
+{
+	ResultCache *plan;
+	Plan	   *subplan;
+
+	/* As with Material, don't cache any excess columns */
+	subplan = create_plan_recurse(root, best_path->subpath,
+								  flags | CP_SMALL_TLIST);
+
+	plan = make_resultcache(subplan, best_path->est_entries);
+
+	copy_generic_path_info(&plan->plan, (Path *) best_path);
+
+	return plan;
+}
+
+/*
+ * finish_resultcache_plan
+ *	  Fill in the cache keys of a ResultCache plan on the inner side of a
+ *	  nestloop, given the nestloop's params.
+ *
+ *	  Returns the plan to use as the inner side, which is just the subplan
+ *	  if there are no params to key the cache on after all.
+ */
+static Plan *
+finish_resultcache_plan(ResultCache *rcplan, List *nestParams)
+{
+	List	   *param_exprs = NIL;
+	ListCell   *lc;
+
+	if (nestParams == NIL)
+		return rcplan->plan.lefttree;
+
+	foreach(lc, nestParams)
+	{
+		NestLoopParam *nlp = (NestLoopParam *) lfirst(lc);
+		Param	   *param = makeNode(Param);
+
+		param->paramkind = PARAM_EXEC;
+		param->paramid = nlp->paramno;
+		param->paramtype = exprType((Node *) nlp->paramval);
+		param->paramtypmod = exprTypmod((Node *) nlp->paramval);
+		param->paramcollid = exprCollation((Node *) nlp->paramval);
+		param->location = -1;
+
+		param_exprs = lappend(param_exprs, param);
+	}
+
+	rcplan->numKeys = list_length(param_exprs);
+	rcplan->param_exprs = param_exprs;
+
+	return (Plan *) rcplan;
+}
+
 /*
  * create_unique_plan
  *	  Create a Unique plan for 'best_path' and (recursively) plans
@@ -3497,6 +3688,11 @@ create_nestloop_plan(PlannerInfo *root,
 			prev = cell;
 	}
 
+	/* Key a Result Cache on the inner side on the params we supply */
+	if (IsA(inner_plan, ResultCache))
+		inner_plan = finish_resultcache_plan((ResultCache *) inner_plan,
+											 nestParams);
+
 	join_plan = make_nestloop(tlist,
 							  joinclauses,
 							  otherclauses,
@@ -4943,7 +5139,7 @@ make_foreignscan(List *qptlist,
 }
 
 static Append *
-make_append(List *appendplans, List *tlist)
+make_append(List *appendplans, int first_partial_plan, List *tlist)
 {
 	Append	   *node = makeNode(Append);
 	Plan	   *plan = &node->plan;
@@ -4953,6 +5149,7 @@ make_append(List *appendplans, List *tlist)
 	plan->lefttree = NULL;
 	plan->righttree = NULL;
 	node->appendplans = appendplans;
+	node->first_partial_plan = first_partial_plan;
 
 	return node;
 }
@@ -5622,6 +5819,25 @@ make_material(Plan *lefttree)
 	return node;
 }
 
+static ResultCache *
+make_resultcache(Plan *lefttree, uint32 est_entries)
+{
+	ResultCache *node = makeNode(ResultCache);
+	Plan	   *plan = &node->plan;
+
+	plan->targetlist = lefttree->targetlist;
+	plan->qual = NIL;
+	plan->lefttree = lefttree;
+	plan->righttree = NULL;
+
+	/* cache keys are filled in by finish_resultcache_plan */
+	node->numKeys = 0;
+	node->param_exprs = NIL;
+	node->est_entries = est_entries;
+
+	return node;
+}
+
 /*
  * materialize_finished_plan: stick a Material node atop a completed plan
  *
@@ -6189,6 +6405,7 @@ is_projection_capable_path(Path *path)
 	{
 		case T_Hash:
 		case T_Material:
+		case T_ResultCache:
 		case T_Sort:
 		case T_Unique:
 		case T_SetOp:
@@ -6225,6 +6442,7 @@ is_projection_capable_plan(Plan *plan)
 	{
 		case T_Hash:
 		case T_Material:
+		case T_ResultCache:
 		case T_Sort:
 		case T_Unique:
 		case T_SetOp:
@@ -22,6 +22,7 @@
 #include "access/parallel.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
+#include "catalog/pg_aggregate.h"
 #include "catalog/pg_constraint_fn.h"
 #include "catalog/pg_type.h"
 #include "executor/executor.h"
@@ -48,6 +49,7 @@
 #include "parser/analyze.h"
 #include "parser/parsetree.h"
 #include "parser/parse_agg.h"
+#include "parser/parse_oper.h"
 #include "rewrite/rewriteManip.h"
 #include "storage/dsm_impl.h"
 #include "utils/rel.h"
@@ -142,6 +144,29 @@ static PathTarget *make_group_input_target(PlannerInfo *root,
 						PathTarget *final_target);
 static PathTarget *make_partial_grouping_target(PlannerInfo *root,
 							 PathTarget *grouping_target);
+static AppendPath *get_partitionwise_agg_input(RelOptInfo *input_rel);
+static void add_partitionwise_agg_paths(PlannerInfo *root,
+							RelOptInfo *grouped_rel,
+							AppendPath *input_path,
+							PathTarget *target,
+							PathTarget *partial_grouping_target,
+							const AggClauseCosts *agg_partial_costs,
+							const AggClauseCosts *agg_final_costs,
+							double dNumGroups,
+							bool can_sort,
+							bool can_hash);
+static PathTarget *adjust_pathtarget_for_child(PlannerInfo *root,
+							PathTarget *target,
+							RelOptInfo *childrel);
+static void add_partial_distinct_agg_path(PlannerInfo *root,
+							  RelOptInfo *grouped_rel,
+							  RelOptInfo *input_rel,
+							  PathTarget *target,
+							  const AggClauseCosts *agg_costs,
+							  double dNumGroups);
+static SortGroupClause *find_distinct_var_clause(Expr *expr,
+						 List *distinct_vars,
+						 List *distinct_clauses);
 static List *postprocess_setop_tlist(List *new_tlist, List *orig_tlist);
 static List *select_active_windows(PlannerInfo *root, WindowFuncLists *wflists);
 static PathTarget *make_window_input_target(PlannerInfo *root,
@@ -3289,8 +3314,9 @@ create_grouping_paths(PlannerInfo *root,
 	Path	   *cheapest_path = input_rel->cheapest_total_path;
 	RelOptInfo *grouped_rel;
 	PathTarget *partial_grouping_target = NULL;
-	AggClauseCosts agg_partial_costs;	/* parallel only */
-	AggClauseCosts agg_final_costs;		/* parallel only */
+	AggClauseCosts agg_partial_costs;	/* parallel/partition-wise only */
+	AggClauseCosts agg_final_costs;		/* parallel/partition-wise only */
+	AppendPath *partitionwise_input = NULL;
 	Size		hashaggtablesize;
 	double		dNumGroups;
 	double		dNumPartialGroups = 0;
@@ -3365,8 +3391,10 @@ create_grouping_paths(PlannerInfo *root,
 			path = (Path *)
 				create_append_path(grouped_rel,
 								   paths,
+								   NIL,
 								   NULL,
-								   0);
+								   0,
+								   false);
 			path->pathtarget = target;
 		}
 		else
@@ -3466,17 +3494,19 @@ create_grouping_paths(PlannerInfo *root,
 	}
 
 	/*
-	 * Before generating paths for grouped_rel, we first generate any possible
-	 * partial paths; that way, later code can easily consider both parallel
-	 * and non-parallel approaches to grouping.  Note that the partial paths
-	 * we generate here are also partially aggregated, so simply pushing a
-	 * Gather node on top is insufficient to create a final path, as would be
-	 * the case for a scan/join rel.
+	 * Partition-wise aggregation, that is, partial aggregation of each child
+	 * of an Append followed by a final aggregation above it, has the same
+	 * requirements as parallel aggregation except for parallel safety; but
+	 * we need an Append to push the partial aggregation into.
 	 */
-	if (try_parallel_aggregation)
-	{
-		Path	   *cheapest_partial_path = linitial(input_rel->partial_pathlist);
+	if (enable_partitionwise_aggregate &&
+		(parse->hasAggs || parse->groupClause != NIL) &&
+		parse->groupingSets == NIL &&
+		!agg_costs->hasNonPartial && !agg_costs->hasNonSerial)
+		partitionwise_input = get_partitionwise_agg_input(input_rel);
 
+	if (try_parallel_aggregation || partitionwise_input != NULL)
+	{
 		/*
 		 * Build target list for partial aggregate paths.  These paths cannot
 		 * just emit the same tlist as regular aggregate paths, because (1) we
@@ -3486,15 +3516,9 @@ create_grouping_paths(PlannerInfo *root,
 		 */
 		partial_grouping_target = make_partial_grouping_target(root, target);
 
-		/* Estimate number of partial groups. */
-		dNumPartialGroups = get_number_of_groups(root,
-												 cheapest_partial_path->rows,
-												 NIL,
-												 NIL);
-
 		/*
 		 * Collect statistics about aggregates for estimating costs of
-		 * performing aggregation in parallel.
+		 * performing aggregation in two phases.
 		 */
 		MemSet(&agg_partial_costs, 0, sizeof(AggClauseCosts));
 		MemSet(&agg_final_costs, 0, sizeof(AggClauseCosts));
@@ -3513,6 +3537,25 @@ create_grouping_paths(PlannerInfo *root,
 								 AGGSPLIT_FINAL_DESERIAL,
 								 &agg_final_costs);
 		}
+	}
+
+	/*
+	 * Before generating paths for grouped_rel, we first generate any possible
+	 * partial paths; that way, later code can easily consider both parallel
+	 * and non-parallel approaches to grouping.  Note that the partial paths
+	 * we generate here are also partially aggregated, so simply pushing a
+	 * Gather node on top is insufficient to create a final path, as would be
+	 * the case for a scan/join rel.
+	 */
+	if (try_parallel_aggregation)
+	{
+		Path	   *cheapest_partial_path = linitial(input_rel->partial_pathlist);
+
+		/* Estimate number of partial groups. */
+		dNumPartialGroups = get_number_of_groups(root,
+												 cheapest_partial_path->rows,
+												 NIL,
+												 NIL);
 
 		if (can_sort)
 		{
@@ -3802,6 +3845,27 @@ create_grouping_paths(PlannerInfo *root,
 		}
 	}
 
+	/* Consider aggregating each child of an Append separately */
+	if (partitionwise_input != NULL)
+		add_partitionwise_agg_paths(root, grouped_rel, partitionwise_input,
+									target, partial_grouping_target,
+									&agg_partial_costs, &agg_final_costs,
+									dNumGroups, can_sort, can_hash);
+
+	/*
+	 * DISTINCT aggregates can't be split into partial and final steps, but
+	 * if those are the only kind of aggregates we have, the workers can
+	 * still weed out duplicate input rows before the leader aggregates.
+	 */
+	if (grouped_rel->consider_parallel &&
+		input_rel->partial_pathlist != NIL &&
+		parse->hasAggs &&
+		parse->groupingSets == NIL &&
+		agg_costs->numOrderedAggs > 0 &&
+		can_sort)
+		add_partial_distinct_agg_path(root, grouped_rel, input_rel, target,
+									  agg_costs, dNumGroups);
+
 	/* Give a helpful error if we failed to find any implementation */
 	if (grouped_rel->pathlist == NIL)
 		ereport(ERROR,
@@ -4527,6 +4591,477 @@ make_partial_grouping_target(PlannerInfo *root, PathTarget *grouping_target)
 	return set_pathtarget_cost_width(root, partial_target);
 }
 
+/*
+ * get_partitionwise_agg_input
+ *	  Find an Append path among the input rel's paths whose children could
+ *	  be aggregated separately, or return NULL.
+ *
+ * The input rel's paths normally carry a projection to the grouping input
+ * target, which we look through: each child's partial aggregation will
+ * compute what it needs from the child's own columns.
+ */
+static AppendPath *
+get_partitionwise_agg_input(RelOptInfo *input_rel)
+{
+	Path	   *path = input_rel->cheapest_total_path;
+
+	if (IsA(path, ProjectionPath))
+		path = ((ProjectionPath *) path)->subpath;
+
+	if (!IsA(path, AppendPath) ||
+		path->param_info != NULL ||
+		path->parallel_aware ||
+		((AppendPath *) path)->subpaths == NIL)
+		return NULL;
+
+	return (AppendPath *) path;
+}
+
+/*
+ * add_partitionwise_agg_paths
+ *	  Consider aggregating each child of an Append separately, and combining
+ *	  the partial results above the Append.
+ *
+ * For an inheritance tree, or a partition-wise join of two, this keeps the
+ * hash tables of the partial aggregations as small as the children, and
+ * lets each child's number of groups be estimated for its own size.  The
+ * partial aggregations are always hashed (or plain, without GROUP BY):
+ * sorting a child's output could require pathkey expressions that have no
+ * child equivalent.
+ *
+ * 'target', 'dNumGroups', 'can_sort' and 'can_hash' are as for the serial
+ * plan; 'partial_grouping_target' and the two cost structs are as for a
+ * parallel aggregation.
+ */
+static void
+add_partitionwise_agg_paths(PlannerInfo *root,
+							RelOptInfo *grouped_rel,
+							AppendPath *input_path,
+							PathTarget *target,
+							PathTarget *partial_grouping_target,
+							const AggClauseCosts *agg_partial_costs,
+							const AggClauseCosts *agg_final_costs,
+							double dNumGroups,
+							bool can_sort,
+							bool can_hash)
+{
+	Query	   *parse = root->parse;
+	List	   *subpaths = NIL;
+	Path	   *path;
+	Size		hashaggtablesize;
+	ListCell   *lc;
+
+	/* Without GROUP BY, the partial aggregations are plain Aggs */
+	if (parse->groupClause != NIL && !can_hash)
+		return;
+
+	/* Build a partial aggregation atop each child */
+	foreach(lc, input_path->subpaths)
+	{
+		Path	   *subpath = (Path *) lfirst(lc);
+		PathTarget *child_target;
+		double		dNumChildGroups;
+
+		child_target = adjust_pathtarget_for_child(root,
+												   partial_grouping_target,
+												   subpath->parent);
+		dNumChildGroups = get_number_of_groups(root, subpath->rows, NIL, NIL);
+
+		if (parse->groupClause != NIL)
+		{
+			/* Give up if a child's hash table would not fit in work_mem */
+			hashaggtablesize = estimate_hashagg_tablesize(subpath,
+														  agg_partial_costs,
+														  dNumChildGroups);
+			if (hashaggtablesize >= work_mem * 1024L)
+				return;
+		}
+
+		subpaths = lappend(subpaths,
+						   create_agg_path(root,
+										   grouped_rel,
+										   subpath,
+										   child_target,
+							parse->groupClause ? AGG_HASHED : AGG_PLAIN,
+										   AGGSPLIT_INITIAL_SERIAL,
+										   parse->groupClause,
+										   NIL,
+										   agg_partial_costs,
+										   dNumChildGroups));
+	}
+
+	/* Append the partial results ... */
+	path = (Path *) create_append_path(grouped_rel, subpaths, NIL,
+									   NULL, 0, false);
+	path->pathtarget = partial_grouping_target;
+
+	/* ... and combine them */
+	if (can_hash)
+	{
+		hashaggtablesize = estimate_hashagg_tablesize(path,
+													  agg_final_costs,
+													  dNumGroups);
+		if (hashaggtablesize < work_mem * 1024L)
+			add_path(grouped_rel, (Path *)
+					 create_agg_path(root,
+									 grouped_rel,
+									 path,
+									 target,
+									 AGG_HASHED,
+									 AGGSPLIT_FINAL_DESERIAL,
+									 parse->groupClause,
+									 (List *) parse->havingQual,
+									 agg_final_costs,
+									 dNumGroups));
+	}
+
+	if (can_sort)
+	{
+		/*
+		 * Append's output is unsorted, so we'll need to sort unless there's
+		 * no GROUP BY clause or a degenerate (constant) one.
+		 */
+		if (root->group_pathkeys)
+			path = (Path *) create_sort_path(root,
+											 grouped_rel,
+											 path,
+											 root->group_pathkeys,
+											 -1.0);
+
+		if (parse->hasAggs)
+			add_path(grouped_rel, (Path *)
+					 create_agg_path(root,
+									 grouped_rel,
+									 path,
+									 target,
+									 parse->groupClause ? AGG_SORTED : AGG_PLAIN,
+									 AGGSPLIT_FINAL_DESERIAL,
+									 parse->groupClause,
+									 (List *) parse->havingQual,
+									 agg_final_costs,
+									 dNumGroups));
+		else
+			add_path(grouped_rel, (Path *)
+					 create_group_path(root,
+									   grouped_rel,
+									   path,
+									   target,
+									   parse->groupClause,
+									   (List *) parse->havingQual,
+									   dNumGroups));
+	}
+}
+
+/*
+ * adjust_pathtarget_for_child
+ *	  Translate a PathTarget expressed in terms of the parent relations into
+ *	  one for a child of an appendrel, or for a join of such children.
+ */
+static PathTarget *
+adjust_pathtarget_for_child(PlannerInfo *root, PathTarget *target,
+							RelOptInfo *childrel)
+{
+	PathTarget *result = copy_pathtarget(target);
+	int			relid = -1;
+
+	while ((relid = bms_next_member(childrel->relids, relid)) >= 0)
+	{
+		RelOptInfo *rel = find_base_rel(root, relid);
+
+		if (rel->reloptkind == RELOPT_OTHER_MEMBER_REL)
+			result->exprs = (List *)
+				adjust_appendrel_attrs_multilevel(root,
+												  (Node *) result->exprs,
+												  rel);
+	}
+
+	return result;
+}
+
+/*
+ * add_partial_distinct_agg_path
+ *	  Consider a parallel plan for a query whose aggregates all use DISTINCT.
+ *
+ * Each worker feeds its share of the input through a HashAgg that removes
+ * rows which agree on the grouping columns and on every Var the aggregates
+ * (and HAVING) use; the leader gathers the surviving rows and aggregates them
+ * normally.  Since a DISTINCT aggregate only ever sees each distinct input
+ * value once anyway, removing duplicates early can't change its result, and
+ * duplicates that survive because they were seen by different workers are
+ * removed by the final aggregation as usual.
+ *
+ * That reasoning only holds if the workers consider two values equal exactly
+ * when the aggregate would: an operator that merges values the aggregate
+ * tells apart would lose input, and values that are equal but
+ * distinguishable (numeric 1.0 and 1.00, say) can't be compared at all if
+ * the aggregate sees them through some expression.  So every aggregate
+ * argument must be a bare Var, which is deduplicated with the equality
+ * operator of the aggregate's own DISTINCT clause, or contain no Vars.
+ *
+ * 'target', 'agg_costs' and 'dNumGroups' are as for the serial plan.
+ */
+static void
+add_partial_distinct_agg_path(PlannerInfo *root,
+							  RelOptInfo *grouped_rel,
+							  RelOptInfo *input_rel,
+							  PathTarget *target,
+							  const AggClauseCosts *agg_costs,
+							  double dNumGroups)
+{
+	Query	   *parse = root->parse;
+	Path	   *cheapest_partial_path = linitial(input_rel->partial_pathlist);
+	PathTarget *dedup_target;
+	List	   *dedup_clause;
+	List	   *non_group_cols;
+	List	   *non_group_exprs;
+	List	   *aggrefs;
+	List	   *distinct_vars = NIL;
+	List	   *distinct_clauses = NIL;
+	AggClauseCosts dedup_costs;
+	Index		maxref = 0;
+	double		dNumDedupRows;
+	double		total_rows;
+	Path	   *path;
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			i;
+
+	if (parse->groupClause && !grouping_is_hashable(parse->groupClause))
+		return;
+
+	/* Start with the grouping columns, as make_partial_grouping_target does */
+	dedup_target = create_empty_pathtarget();
+	non_group_cols = NIL;
+
+	i = 0;
+	foreach(lc, target->exprs)
+	{
+		Expr	   *expr = (Expr *) lfirst(lc);
+		Index		sgref = get_pathtarget_sortgroupref(target, i);
+
+		if (sgref && parse->groupClause &&
+			get_sortgroupref_clause_noerr(sgref, parse->groupClause) != NULL)
+			add_column_to_pathtarget(dedup_target, expr, sgref);
+		else
+			non_group_cols = lappend(non_group_cols, expr);
+
+		i++;
+	}
+
+	if (parse->havingQual)
+		non_group_cols = lappend(non_group_cols, parse->havingQual);
+
+	/*
+	 * Every aggregate must be a plain DISTINCT aggregate without FILTER, else
+	 * duplicates matter.  Collect the Vars that are aggregate arguments along
+	 * with the DISTINCT clauses the aggregates compare them with; give up if
+	 * two aggregates would compare the same Var differently.
+	 */
+	aggrefs = pull_var_clause((Node *) non_group_cols,
+							  PVC_INCLUDE_AGGREGATES |
+							  PVC_RECURSE_WINDOWFUNCS |
+							  PVC_INCLUDE_PLACEHOLDERS);
+	foreach(lc, aggrefs)
+	{
+		Aggref	   *aggref = (Aggref *) lfirst(lc);
+
+		if (!IsA(aggref, Aggref))
+			continue;
+		if (aggref->aggkind != AGGKIND_NORMAL ||
+			aggref->aggdistinct == NIL ||
+			aggref->aggfilter != NULL)
+			return;
+
+		foreach(lc2, aggref->args)
+		{
+			TargetEntry *tle = (TargetEntry *) lfirst(lc2);
+			SortGroupClause *sgc;
+			SortGroupClause *prev;
+
+			if (!IsA(tle->expr, Var) || ((Var *) tle->expr)->varlevelsup != 0)
+			{
+				if (contain_var_clause((Node *) tle->expr))
+					return;
+				continue;
+			}
+
+			sgc = get_sortgroupref_clause_noerr(tle->ressortgroupref,
+												aggref->aggdistinct);
+			if (sgc == NULL)
+				return;
+
+			prev = find_distinct_var_clause(tle->expr,
+											distinct_vars, distinct_clauses);
+			if (prev == NULL)
+			{
+				distinct_vars = lappend(distinct_vars, tle->expr);
+				distinct_clauses = lappend(distinct_clauses, sgc);
+			}
+			else if (prev->eqop != sgc->eqop)
+				return;
+		}
+	}
+
+	if (contain_volatile_functions((Node *) non_group_cols))
+		return;
+
+	/*
+	 * Add the Vars used in the aggregates and elsewhere to the target, with
+	 * grouping clauses of their own.  We need sortgrouprefs for them that
+	 * don't collide with any used in the query's targetlist.
+	 */
+	foreach(lc, parse->targetList)
+	{
+		TargetEntry *tle = (TargetEntry *) lfirst(lc);
+
+		maxref = Max(maxref, tle->ressortgroupref);
+	}
+
+	dedup_clause = list_copy(parse->groupClause);
+
+	non_group_exprs = pull_var_clause((Node *) non_group_cols,
+									  PVC_RECURSE_AGGREGATES |
+									  PVC_RECURSE_WINDOWFUNCS |
+									  PVC_INCLUDE_PLACEHOLDERS);
+	foreach(lc, non_group_exprs)
+	{
+		Expr	   *expr = (Expr *) lfirst(lc);
+		SortGroupClause *distinct_sgc;
+		SortGroupClause *sgc;
+
+		distinct_sgc = find_distinct_var_clause(expr, distinct_vars,
+												distinct_clauses);
+
+		/*
+		 * A column that's already there (a grouping column, or a repeated
+		 * Var) is deduplicated by its existing clause, which had better agree
+		 * with any aggregate using it.
+		 */
+		i = 0;
+		foreach(lc2, dedup_target->exprs)
+		{
+			if (equal(lfirst(lc2), expr))
+				break;
+			i++;
+		}
+		if (lc2 != NULL)
+		{
+			if (distinct_sgc != NULL &&
+				get_sortgroupref_clause(get_pathtarget_sortgroupref(dedup_target,
+																	i),
+										dedup_clause)->eqop !=
+				distinct_sgc->eqop)
+				return;
+			continue;
+		}
+
+		if (distinct_sgc != NULL)
+		{
+			/* compare it as the aggregates do */
+			sgc = (SortGroupClause *) copyObject(distinct_sgc);
+			sgc->hashable = op_hashjoinable(sgc->eqop,
+											exprType((Node *) expr));
+		}
+		else
+		{
+			/*
+			 * Used only outside aggregates, so it's functionally dependent on
+			 * the grouping columns, and which of several equal values the
+			 * final step gets to see doesn't matter; use the default
+			 * operators.
+			 */
+			sgc = makeNode(SortGroupClause);
+			get_sort_group_operators(exprType((Node *) expr),
+									 false, false, false,
+									 &sgc->sortop, &sgc->eqop, NULL,
+									 &sgc->hashable);
+			sgc->nulls_first = false;
+		}
+		if (!OidIsValid(sgc->eqop) || !sgc->hashable)
+			return;
+		sgc->tleSortGroupRef = ++maxref;
+
+		add_column_to_pathtarget(dedup_target, expr, sgc->tleSortGroupRef);
+		dedup_clause = lappend(dedup_clause, sgc);
+	}
+
+	dedup_target = set_pathtarget_cost_width(root, dedup_target);
+
+	/* Removing duplicates needs no aggregates, so it has no agg costs */
+	MemSet(&dedup_costs, 0, sizeof(AggClauseCosts));
+
+	dNumDedupRows = estimate_num_groups(root, dedup_target->exprs,
+										cheapest_partial_path->rows,
+										NULL);
+
+	if (estimate_hashagg_tablesize(cheapest_partial_path, &dedup_costs,
+								   dNumDedupRows) >= work_mem * 1024L)
+		return;
+
+	/* Remove duplicates in each worker */
+	path = (Path *) create_projection_path(root, input_rel,
+										   cheapest_partial_path,
+										   dedup_target);
+	path = (Path *) create_agg_path(root,
+									grouped_rel,
+									path,
+									dedup_target,
+									AGG_HASHED,
+									AGGSPLIT_SIMPLE,
+									dedup_clause,
+									NIL,
+									&dedup_costs,
+									dNumDedupRows);
+
+	total_rows = path->rows * path->parallel_workers;
+	path = (Path *) create_gather_path(root,
+									   grouped_rel,
+									   path,
+									   dedup_target,
+									   NULL,
+									   &total_rows);
+
+	/* And aggregate the remaining rows in the leader, as usual */
+	if (root->group_pathkeys)
+		path = (Path *) create_sort_path(root,
+										 grouped_rel,
+										 path,
+										 root->group_pathkeys,
+										 -1.0);
+
+	add_path(grouped_rel, (Path *)
+			 create_agg_path(root,
+							 grouped_rel,
+							 path,
+							 target,
+							 parse->groupClause ? AGG_SORTED : AGG_PLAIN,
+							 AGGSPLIT_SIMPLE,
+							 parse->groupClause,
+							 (List *) parse->havingQual,
+							 agg_costs,
+							 dNumGroups));
+}
+
+/*
+ * find_distinct_var_clause
+ *	  Find the DISTINCT clause add_partial_distinct_agg_path collected for a
+ *	  Var, or NULL if it isn't an aggregate argument.
+ */
+static SortGroupClause *
+find_distinct_var_clause(Expr *expr, List *distinct_vars,
+						 List *distinct_clauses)
+{
+	ListCell   *lc1;
+	ListCell   *lc2;
+
+	forboth(lc1, distinct_vars, lc2, distinct_clauses)
+	{
+		if (equal(lfirst(lc1), expr))
+			return (SortGroupClause *) lfirst(lc2);
+	}
+	return NULL;
+}
+
 /*
  * mark_partial_aggref
  *	  Adjust an Aggref to make it represent a partial-aggregation step.
@@ -5257,7 +5792,7 @@ plan_cluster_use_sort(Oid tableOid, Oid indexOid)
 	indexScanPath = create_index_path(root, indexInfo,
 									  NIL, NIL, NIL, NIL, NIL,
 									  ForwardScanDirection, false,
-									  NULL, 1.0);
+									  NULL, 1.0, 0);
 
 	return (seqScanAndSortPath.total_cost < indexScanPath->path.total_cost);
 }
@@ -629,6 +629,22 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			 */
 			Assert(plan->qual == NIL);
 			break;
+		case T_ResultCache:
+			{
+				ResultCache *rcplan = (ResultCache *) plan;
+
+				/*
+				 * Like the plan types above, ResultCache doesn't evaluate its
+				 * tlist or quals.  Its cache keys are just Params, but run
+				 * them through fix_scan_expr anyway for consistency.
+				 */
+				set_dummy_tlist_references(plan, rtoffset);
+				Assert(plan->qual == NIL);
+
+				rcplan->param_exprs = fix_scan_list(root, rcplan->param_exprs,
+													rtoffset);
+			}
+			break;
 		case T_LockRows:
 			{
 				LockRows   *splan = (LockRows *) plan;
@@ -866,6 +882,12 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 											  (Plan *) lfirst(l),
 											  rtoffset);
 				}
+				/* run-time pruning clauses refer to the child rels */
+				splan->pruneconstraints = (List *)
+					fix_scan_expr(root, (Node *) splan->pruneconstraints,
+								  rtoffset);
+				splan->prunequals = (List *)
+					fix_scan_expr(root, (Node *) splan->prunequals, rtoffset);
 			}
 			break;
 		case T_MergeAppend:
@@ -884,6 +906,12 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 											  (Plan *) lfirst(l),
 											  rtoffset);
 				}
+				/* run-time pruning clauses refer to the child rels */
+				splan->pruneconstraints = (List *)
+					fix_scan_expr(root, (Node *) splan->pruneconstraints,
+								  rtoffset);
+				splan->prunequals = (List *)
+					fix_scan_expr(root, (Node *) splan->prunequals, rtoffset);
 			}
 			break;
 		case T_RecursiveUnion:
@@ -2541,6 +2541,8 @@ finalize_plan(PlannerInfo *root, Plan *plan, Bitmapset *valid_params,
 			{
 				ListCell   *l;
 
+				finalize_primnode((Node *) ((Append *) plan)->prunequals,
+								  &context);
 				foreach(l, ((Append *) plan)->appendplans)
 				{
 					context.paramids =
@@ -2557,6 +2559,8 @@ finalize_plan(PlannerInfo *root, Plan *plan, Bitmapset *valid_params,
 			{
 				ListCell   *l;
 
+				finalize_primnode((Node *) ((MergeAppend *) plan)->prunequals,
+								  &context);
 				foreach(l, ((MergeAppend *) plan)->mergeplans)
 				{
 					context.paramids =
@@ -2679,6 +2683,11 @@ finalize_plan(PlannerInfo *root, Plan *plan, Bitmapset *valid_params,
 			}
 			break;
 
+		case T_ResultCache:
+			finalize_primnode((Node *) ((ResultCache *) plan)->param_exprs,
+							  &context);
+			break;
+
 		case T_WindowAgg:
 			finalize_primnode(((WindowAgg *) plan)->startOffset,
 							  &context);
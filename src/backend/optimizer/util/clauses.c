@@ -571,6 +571,15 @@ get_agg_clause_costs_walker(Node *node, get_agg_clause_costs_context *context)
 			else if (aggtranstype == INTERNALOID &&
 					 (!OidIsValid(aggserialfn) || !OidIsValid(aggdeserialfn)))
 				costs->hasNonSerial = true;
+
+			/*
+			 * Serialized INTERNAL states may embed input values verbatim,
+			 * which doesn't work for anonymous record types: their typmods
+			 * are only meaningful within one backend.
+			 */
+			else if (aggtranstype == INTERNALOID &&
+					 list_member_oid(aggref->aggargtypes, RECORDOID))
+				costs->hasNonSerial = true;
 		}
 
 		/*
@@ -28,6 +28,7 @@
 #include "catalog/dependency.h"
 #include "catalog/heap.h"
 #include "catalog/pg_am.h"
+#include "catalog/pg_statistic_ext.h"
 #include "foreign/fdwapi.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
@@ -39,10 +40,12 @@
 #include "parser/parse_relation.h"
 #include "parser/parsetree.h"
 #include "rewrite/rewriteManip.h"
+#include "statistics/statistics.h"
 #include "storage/bufmgr.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
+#include "utils/syscache.h"
 
 
 /* GUC parameter */
@@ -52,8 +55,11 @@ int			constraint_exclusion = CONSTRAINT_EXCLUSION_PARTITION;
 get_relation_info_hook_type get_relation_info_hook = NULL;
 
 
+static void get_relation_details(PlannerInfo *root, RelOptInfo *rel,
+					 Relation relation, bool inhparent);
 static void get_relation_foreign_keys(PlannerInfo *root, RelOptInfo *rel,
 						  Relation relation, bool inhparent);
+static List *get_relation_statistics(RelOptInfo *rel, Relation relation);
 static bool infer_collation_opclass_match(InferenceElem *elem, Relation idxRel,
 							  List *idxExprs);
 static int32 get_rel_data_width(Relation rel, int32 *attr_widths);
@@ -90,15 +96,18 @@ static List *build_index_tlist(PlannerInfo *root, IndexOptInfo *index,
  * the RelOptInfo actually represents the appendrel formed by an inheritance
  * tree, and so the parent rel's physical size and index information isn't
  * important for it.
+ *
+ * If the rel is an appendrel member, we only set up the attr arrays here,
+ * and leave the rest to finish_relation_info().  A query on a table with
+ * thousands of inheritance children often needs only a few of them after
+ * constraint exclusion, and there is no point in reading the size and
+ * index information of the others.
  */
 void
 get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 				  RelOptInfo *rel)
 {
-	Index		varno = rel->relid;
 	Relation	relation;
-	bool		hasindex;
-	List	   *indexinfos = NIL;
 
 	/*
 	 * We need not lock the relation since it was already locked, either by
@@ -123,6 +132,72 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 	rel->attr_widths = (int32 *)
 		palloc0((rel->max_attr - rel->min_attr + 1) * sizeof(int32));
 
+	if (rel->reloptkind == RELOPT_OTHER_MEMBER_REL && !inhparent)
+	{
+		rel->catalog_info_pending = true;
+		heap_close(relation, NoLock);
+		return;
+	}
+
+	get_relation_details(root, rel, relation, inhparent);
+
+	heap_close(relation, NoLock);
+
+	/*
+	 * Allow a plugin to editorialize on the info we obtained from the
+	 * catalogs.  Actions might include altering the assumed relation size,
+	 * removing an index, or adding a hypothetical index to the indexlist.
+	 */
+	if (get_relation_info_hook)
+		(*get_relation_info_hook) (root, relationObjectId, inhparent, rel);
+}
+
+/*
+ * finish_relation_info -
+ *	  Retrieves the catalog information postponed by get_relation_info()
+ *	  for an appendrel member.
+ *
+ * This is a no-op if the information has already been retrieved, or was
+ * never postponed.
+ */
+void
+finish_relation_info(PlannerInfo *root, RelOptInfo *rel)
+{
+	Oid			relationObjectId;
+	Relation	relation;
+
+	if (!rel->catalog_info_pending)
+		return;
+
+	relationObjectId = planner_rt_fetch(rel->relid, root)->relid;
+
+	/* As above, the relation must already be locked */
+	relation = heap_open(relationObjectId, NoLock);
+
+	get_relation_details(root, rel, relation, false);
+
+	heap_close(relation, NoLock);
+
+	rel->catalog_info_pending = false;
+
+	/* Let the plugin see the completed info, as in get_relation_info() */
+	if (get_relation_info_hook)
+		(*get_relation_info_hook) (root, relationObjectId, false, rel);
+}
+
+/*
+ * get_relation_details -
+ *	  Workhorse for get_relation_info() and finish_relation_info(): fill in
+ *	  the size, index, statistics and foreign-table fields of the rel.
+ */
+static void
+get_relation_details(PlannerInfo *root, RelOptInfo *rel,
+					 Relation relation, bool inhparent)
+{
+	Index		varno = rel->relid;
+	bool		hasindex;
+	List	   *indexinfos = NIL;
+
 	/*
 	 * Estimate relation size --- unless it's an inheritance parent, in which
 	 * case the size will be computed later in set_append_rel_pathlist, and we
@@ -242,6 +317,7 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 			info->amsearchnulls = amroutine->amsearchnulls;
 			info->amhasgettuple = (amroutine->amgettuple != NULL);
 			info->amhasgetbitmap = (amroutine->amgetbitmap != NULL);
+			info->amcanparallel = (amroutine->amestimateparallelscan != NULL);
 			info->amcostestimate = amroutine->amcostestimate;
 			Assert(info->amcostestimate != NULL);
 
@@ -396,6 +472,13 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 
 	rel->indexlist = indexinfos;
 
+	/*
+	 * Extended statistics describe only the rows of the relation itself, so
+	 * they're of no use when we're planning a scan of an inheritance tree.
+	 */
+	if (!inhparent)
+		rel->statlist = get_relation_statistics(rel, relation);
+
 	/* Grab foreign-table info using the relcache, while we have it */
 	if (relation->rd_rel->relkind == RELKIND_FOREIGN_TABLE)
 	{
@@ -410,16 +493,6 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 
 	/* Collect info about relation's foreign keys, if relevant */
 	get_relation_foreign_keys(root, rel, relation, inhparent);
-
-	heap_close(relation, NoLock);
-
-	/*
-	 * Allow a plugin to editorialize on the info we obtained from the
-	 * catalogs.  Actions might include altering the assumed relation size,
-	 * removing an index, or adding a hypothetical index to the indexlist.
-	 */
-	if (get_relation_info_hook)
-		(*get_relation_info_hook) (root, relationObjectId, inhparent, rel);
 }
 
 /*
@@ -525,6 +598,78 @@ get_relation_foreign_keys(PlannerInfo *root, RelOptInfo *rel,
 	}
 }
 
+/*
+ * get_relation_statistics
+ *		Retrieve extended statistics defined on the table.
+ *
+ * Returns a List (possibly empty) of StatisticExtInfo objects describing
+ * the statistics.  Note that this doesn't load the actual statistics data,
+ * just the identifying metadata.  Only stats actually built are considered.
+ */
+static List *
+get_relation_statistics(RelOptInfo *rel, Relation relation)
+{
+	List	   *statoidlist;
+	List	   *stainfos = NIL;
+	ListCell   *l;
+
+	statoidlist = RelationGetStatExtList(relation);
+
+	foreach(l, statoidlist)
+	{
+		Oid			statOid = lfirst_oid(l);
+		Form_pg_statistic_ext staForm;
+		HeapTuple	htup;
+		Bitmapset  *keys = NULL;
+		int			i;
+
+		htup = SearchSysCache1(STATEXTOID, ObjectIdGetDatum(statOid));
+		if (!htup)
+			elog(ERROR, "cache lookup failed for statistics object %u", statOid);
+		staForm = (Form_pg_statistic_ext) GETSTRUCT(htup);
+
+		/*
+		 * First, build the array of columns covered.  This is ultimately
+		 * wasted if no stats within the object have actually been built, but
+		 * it doesn't seem worth troubling over that case.
+		 */
+		for (i = 0; i < staForm->stxkeys.dim1; i++)
+			keys = bms_add_member(keys, staForm->stxkeys.values[i]);
+
+		/* add one StatisticExtInfo for each kind built */
+		if (statext_is_kind_built(htup, STATS_EXT_NDISTINCT))
+		{
+			StatisticExtInfo *info = makeNode(StatisticExtInfo);
+
+			info->statOid = statOid;
+			info->rel = rel;
+			info->kind = STATS_EXT_NDISTINCT;
+			info->keys = bms_copy(keys);
+
+			stainfos = lcons(info, stainfos);
+		}
+
+		if (statext_is_kind_built(htup, STATS_EXT_DEPENDENCIES))
+		{
+			StatisticExtInfo *info = makeNode(StatisticExtInfo);
+
+			info->statOid = statOid;
+			info->rel = rel;
+			info->kind = STATS_EXT_DEPENDENCIES;
+			info->keys = bms_copy(keys);
+
+			stainfos = lcons(info, stainfos);
+		}
+
+		ReleaseSysCache(htup);
+		bms_free(keys);
+	}
+
+	list_free(statoidlist);
+
+	return stainfos;
+}
+
 /*
  * infer_arbiter_indexes -
  *	  Determine the unique indexes used to arbitrate speculative insertion.
@@ -1128,8 +1273,9 @@ get_relation_data_width(Oid relid, int32 *attr_widths)
  * and added to the result for each column that's marked attnotnull.
  *
  * Note: at present this is invoked at most once per relation per planner
- * run, and in many cases it won't be invoked at all, so there seems no
- * point in caching the data in RelOptInfo.
+ * run for constraint exclusion, plus once per candidate join when
+ * partition-wise join is enabled, and in many cases it won't be invoked at
+ * all, so there seems no point in caching the data in RelOptInfo.
  */
 static List *
 get_relation_constraints(PlannerInfo *root,
@@ -1149,47 +1295,17 @@ get_relation_constraints(PlannerInfo *root,
 	constr = relation->rd_att->constr;
 	if (constr != NULL)
 	{
-		int			num_check = constr->num_check;
 		int			i;
 
-		for (i = 0; i < num_check; i++)
-		{
-			Node	   *cexpr;
-
-			/*
-			 * If this constraint hasn't been fully validated yet, we must
-			 * ignore it here.
-			 */
-			if (!constr->check[i].ccvalid)
-				continue;
-
-			cexpr = stringToNode(constr->check[i].ccbin);
-
-			/*
-			 * Run each expression through const-simplification and
-			 * canonicalization.  This is not just an optimization, but is
-			 * necessary, because we will be comparing it to
-			 * similarly-processed qual clauses, and may fail to detect valid
-			 * matches without this.  This must match the processing done to
-			 * qual clauses in preprocess_expression()!  (We can skip the
-			 * stuff involving subqueries, however, since we don't allow any
-			 * in check constraints.)
-			 */
-			cexpr = eval_const_expressions(root, cexpr);
-
-			cexpr = (Node *) canonicalize_qual((Expr *) cexpr);
-
-			/* Fix Vars to have the desired varno */
-			if (varno != 1)
-				ChangeVarNodes(cexpr, 1, varno, 0);
-
-			/*
-			 * Finally, convert to implicit-AND format (that is, a List) and
-			 * append the resulting item(s) to our output list.
-			 */
-			result = list_concat(result,
-								 make_ands_implicit((Expr *) cexpr));
-		}
+		/*
+		 * The relcache keeps the CHECK constraints already const-simplified
+		 * and canonicalized, as qual clauses are in preprocess_expression(),
+		 * and in implicit-AND format.  We need only fix the Vars to have the
+		 * desired varno.
+		 */
+		result = RelationGetCheckConstraintExprs(relation);
+		if (varno != 1)
+			ChangeVarNodes((Node *) result, 1, varno, 0);
 
 		/* Add NOT NULL constraints in expression form, if requested */
 		if (include_notnull && constr->has_not_null)
@@ -1231,6 +1347,39 @@ get_relation_constraints(PlannerInfo *root,
 }
 
 
+/*
+ * get_relation_immutable_constraints
+ *
+ * Retrieve the validated CHECK constraints of a plain member relation that
+ * are safe to reason about at plan time, that is, those containing no
+ * mutable functions.  The result is in the form produced by
+ * get_relation_constraints; "col IS NOT NULL" entries for NOT NULL columns
+ * are included only if include_notnull is true.
+ */
+List *
+get_relation_immutable_constraints(PlannerInfo *root, RelOptInfo *rel,
+								   bool include_notnull)
+{
+	RangeTblEntry *rte = planner_rt_fetch(rel->relid, root);
+	List	   *safe_constraints = NIL;
+	ListCell   *lc;
+
+	/* Only plain relations have constraints */
+	if (rte->rtekind != RTE_RELATION || rte->inh)
+		return NIL;
+
+	foreach(lc, get_relation_constraints(root, rte->relid, rel,
+										 include_notnull))
+	{
+		Node	   *pred = (Node *) lfirst(lc);
+
+		if (!contain_mutable_functions(pred))
+			safe_constraints = lappend(safe_constraints, pred);
+	}
+
+	return safe_constraints;
+}
+
 /*
  * relation_excluded_by_constraints
  *
@@ -21,6 +21,7 @@
 #include "optimizer/paths.h"
 #include "optimizer/placeholder.h"
 #include "optimizer/plancat.h"
+#include "optimizer/prep.h"
 #include "optimizer/restrictinfo.h"
 #include "optimizer/tlist.h"
 #include "utils/hsearch.h"
@@ -76,6 +77,29 @@ setup_simple_rel_arrays(PlannerInfo *root)
 
 		root->simple_rte_array[rti++] = rte;
 	}
+
+	/* append_rel_array is not needed if there are no AppendRelInfos */
+	if (root->append_rel_list == NIL)
+	{
+		root->append_rel_array = NULL;
+		return;
+	}
+
+	root->append_rel_array = (AppendRelInfo **)
+		palloc0(root->simple_rel_array_size * sizeof(AppendRelInfo *));
+	foreach(lc, root->append_rel_list)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(lc);
+		Index		child_relid = appinfo->child_relid;
+
+		/* Sanity check */
+		Assert(child_relid < root->simple_rel_array_size);
+
+		if (root->append_rel_array[child_relid])
+			elog(ERROR, "child relation already exists");
+
+		root->append_rel_array[child_relid] = appinfo;
+	}
 }
 
 /*
@@ -121,12 +145,14 @@ build_simple_rel(PlannerInfo *root, int relid, RelOptKind reloptkind)
 	rel->lateral_vars = NIL;
 	rel->lateral_referencers = NULL;
 	rel->indexlist = NIL;
+	rel->statlist = NIL;
 	rel->pages = 0;
 	rel->tuples = 0;
 	rel->allvisfrac = 0;
 	rel->subroot = NULL;
 	rel->subplan_params = NIL;
 	rel->rel_parallel_workers = -1;		/* set up in get_relation_info */
+	rel->catalog_info_pending = false;	/* set up in get_relation_info */
 	rel->serverid = InvalidOid;
 	rel->userid = rte->checkAsUser;
 	rel->useridiscurrent = false;
@@ -393,6 +419,7 @@ build_join_rel(PlannerInfo *root,
 	joinrel->lateral_vars = NIL;
 	joinrel->lateral_referencers = NULL;
 	joinrel->indexlist = NIL;
+	joinrel->statlist = NIL;
 	joinrel->pages = 0;
 	joinrel->tuples = 0;
 	joinrel->allvisfrac = 0;
@@ -554,6 +581,81 @@ build_join_rel(PlannerInfo *root,
 	return joinrel;
 }
 
+/*
+ * build_child_join_rel
+ *	  Build a RelOptInfo for the join of two inheritance children, used as
+ *	  one member of a partition-wise join of their parents.
+ *
+ * 'outer_rel', 'inner_rel': the child relations being joined
+ * 'parent_joinrel': the join of their parents
+ * 'outer_appinfo', 'inner_appinfo': AppendRelInfos of the two children
+ * 'sjinfo': child-relative SpecialJoinInfo for the join
+ * 'restrictlist': child-relative restrictlist for the join
+ *
+ * Unlike build_join_rel, the result is not entered into the planner's list
+ * of join relations: nothing but the parent join needs to find it, and the
+ * join search must not try to build on it.
+ */
+RelOptInfo *
+build_child_join_rel(PlannerInfo *root,
+					 RelOptInfo *outer_rel,
+					 RelOptInfo *inner_rel,
+					 RelOptInfo *parent_joinrel,
+					 AppendRelInfo *outer_appinfo,
+					 AppendRelInfo *inner_appinfo,
+					 SpecialJoinInfo *sjinfo,
+					 List *restrictlist)
+{
+	RelOptInfo *joinrel = makeNode(RelOptInfo);
+	List	   *exprs;
+
+	joinrel->reloptkind = RELOPT_JOINREL;
+	joinrel->relids = bms_union(outer_rel->relids, inner_rel->relids);
+	joinrel->rows = 0;
+	joinrel->consider_startup = parent_joinrel->consider_startup;
+	joinrel->consider_param_startup = false;
+	joinrel->consider_parallel = parent_joinrel->consider_parallel;
+	joinrel->reltarget = create_empty_pathtarget();
+	joinrel->pathlist = NIL;
+	joinrel->ppilist = NIL;
+	joinrel->partial_pathlist = NIL;
+	joinrel->cheapest_startup_path = NULL;
+	joinrel->cheapest_total_path = NULL;
+	joinrel->cheapest_unique_path = NULL;
+	joinrel->cheapest_parameterized_paths = NIL;
+	joinrel->direct_lateral_relids = NULL;
+	joinrel->lateral_relids = NULL;
+	joinrel->relid = 0;			/* indicates not a baserel */
+	joinrel->rtekind = RTE_JOIN;
+	joinrel->rel_parallel_workers = -1;
+	joinrel->serverid = InvalidOid;
+	joinrel->userid = InvalidOid;
+	joinrel->useridiscurrent = false;
+	joinrel->fdwroutine = NULL;
+	joinrel->fdw_private = NULL;
+	joinrel->joininfo = NIL;
+	joinrel->has_eclass_joins = false;
+
+	/*
+	 * The child join emits the same columns as the parent join, in the same
+	 * order, so that an Append over the child joins can stand in for the
+	 * parent join.
+	 */
+	exprs = (List *) adjust_appendrel_attrs(root,
+							  (Node *) parent_joinrel->reltarget->exprs,
+											outer_appinfo);
+	exprs = (List *) adjust_appendrel_attrs(root, (Node *) exprs,
+											inner_appinfo);
+	joinrel->reltarget->exprs = exprs;
+	joinrel->reltarget->cost = parent_joinrel->reltarget->cost;
+	joinrel->reltarget->width = parent_joinrel->reltarget->width;
+
+	set_joinrel_size_estimates(root, joinrel, outer_rel, inner_rel,
+							   sjinfo, restrictlist);
+
+	return joinrel;
+}
+
 /*
  * min_join_parameterization
  *
@@ -899,9 +1001,8 @@ fetch_upper_rel(PlannerInfo *root, UpperRelationKind kind, Relids relids)
  * find_childrel_appendrelinfo
  *		Get the AppendRelInfo associated with an appendrel child rel.
  *
- * This search could be eliminated by storing a link in child RelOptInfos,
- * but for now it doesn't seem performance-critical.  (Also, it might be
- * difficult to maintain such a link during mutation of the append_rel_list.)
+ * Normally this is just a lookup in root->append_rel_array; we fall back to
+ * searching append_rel_list if the array hasn't been set up.
  */
 AppendRelInfo *
 find_childrel_appendrelinfo(PlannerInfo *root, RelOptInfo *rel)
@@ -912,6 +1013,10 @@ find_childrel_appendrelinfo(PlannerInfo *root, RelOptInfo *rel)
 	/* Should only be called on child rels */
 	Assert(rel->reloptkind == RELOPT_OTHER_MEMBER_REL);
 
+	if (root->append_rel_array && relid < root->simple_rel_array_size &&
+		root->append_rel_array[relid] != NULL)
+		return root->append_rel_array[relid];
+
 	foreach(lc, root->append_rel_list)
 	{
 		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(lc);
@@ -30,6 +30,9 @@
 #ifdef HAVE_SYS_SHM_H
 #include <sys/shm.h>
 #endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 #include "miscadmin.h"
 #include "portability/mem.h"
@@ -79,6 +82,22 @@ static Size AnonymousShmemSize;
 static void *AnonymousShmem = NULL;
 #endif
 
+/* Size of the pages backing the main segment; zero means the system's */
+static Size ShmemPageSize = 0;
+
+/*
+ * We talk to the kernel's NUMA memory policy interface directly, rather
+ * than requiring libnuma, so supply the few definitions from <numaif.h>
+ * we need.
+ */
+#if defined(__linux__) && defined(SYS_mbind)
+#define USE_NUMA_MBIND
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE		3
+#endif
+#define SHMEM_NUMA_MAX_NODES	1024
+#endif
+
 static void *InternalIpcMemoryCreate(IpcMemoryKey memKey, Size size);
 static void IpcMemoryDetach(int status, Datum shmaddr);
 static void IpcMemoryDelete(int status, Datum shmId);
@@ -482,6 +501,8 @@ CreateAnonymousSegment(Size *size)
 		if (huge_pages == HUGE_PAGES_TRY && ptr == MAP_FAILED)
 			elog(DEBUG1, "mmap(%zu) with MAP_HUGETLB failed, huge pages disabled: %m",
 				 allocsize);
+		if (ptr != MAP_FAILED)
+			ShmemPageSize = hugepagesize;
 	}
 #endif
 
@@ -535,6 +556,110 @@ AnonymousShmemDetach(int status, Datum arg)
 
 #endif   /* USE_ANONYMOUS_SHMEM */
 
+#ifdef USE_NUMA_MBIND
+/*
+ * GetOnlineNumaNodes --- find out which NUMA nodes are online
+ *
+ * Sets the corresponding bits in *nodemask, which has room for
+ * SHMEM_NUMA_MAX_NODES nodes, and returns the number of nodes; or returns
+ * zero if we can't tell.
+ */
+static int
+GetOnlineNumaNodes(unsigned long *nodemask)
+{
+	FILE	   *fp;
+	char		buf[1024];
+	char	   *p;
+	int			nnodes = 0;
+
+	memset(nodemask, 0, SHMEM_NUMA_MAX_NODES / 8);
+
+	/* The file contains a list of ranges such as "0-1,3" */
+	fp = AllocateFile("/sys/devices/system/node/online", "r");
+	if (fp == NULL)
+		return 0;
+	if (fgets(buf, sizeof(buf), fp) == NULL)
+		buf[0] = '\0';
+	FreeFile(fp);
+
+	p = buf;
+	while (*p >= '0' && *p <= '9')
+	{
+		long		first;
+		long		last;
+		long		node;
+
+		first = last = strtol(p, &p, 10);
+		if (*p == '-')
+			last = strtol(p + 1, &p, 10);
+		for (node = first; node <= last && node < SHMEM_NUMA_MAX_NODES; node++)
+		{
+			nodemask[node / (8 * sizeof(unsigned long))] |=
+				1UL << (node % (8 * sizeof(unsigned long)));
+			nnodes++;
+		}
+		if (*p == ',')
+			p++;
+	}
+
+	return nnodes;
+}
+#endif   /* USE_NUMA_MBIND */
+
+/*
+ * PGSharedMemorySetPlacement
+ *
+ * Apply shared_memory_numa_policy to a large structure at addr..addr+size
+ * in the main shared memory segment, whose name is used for reporting.
+ * This must be done before anything touches the structure, since the kernel
+ * places a page when it is first faulted in.  Only whole pages within the
+ * range are affected, so small structures are best left alone.
+ *
+ * Failure to set the policy is not fatal: the memory is merely placed as it
+ * would have been without the request.
+ */
+void
+PGSharedMemorySetPlacement(void *addr, Size size, const char *name)
+{
+#ifdef USE_NUMA_MBIND
+	unsigned long nodemask[SHMEM_NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+	int			nnodes;
+	Size		pagesize;
+	char	   *start;
+	char	   *end;
+
+	if (shared_memory_numa_policy != SHMEM_NUMA_INTERLEAVE)
+		return;
+
+	nnodes = GetOnlineNumaNodes(nodemask);
+	if (nnodes <= 1)
+	{
+		elog(DEBUG1, "not interleaving shared memory \"%s\": system has only one NUMA node",
+			 name);
+		return;
+	}
+
+	pagesize = ShmemPageSize;
+	if (pagesize == 0)
+		pagesize = (Size) sysconf(_SC_PAGESIZE);
+	start = (char *) TYPEALIGN(pagesize, addr);
+	end = (char *) TYPEALIGN_DOWN(pagesize, (char *) addr + size);
+	if (start >= end)
+		return;
+
+	if (syscall(SYS_mbind, start, (unsigned long) (end - start),
+				MPOL_INTERLEAVE, nodemask,
+				(unsigned long) SHMEM_NUMA_MAX_NODES + 1, 0) != 0)
+		ereport(LOG,
+				(errmsg("could not interleave shared memory \"%s\" across NUMA nodes: %m",
+						name)));
+	else
+		ereport(LOG,
+				(errmsg("shared memory \"%s\" (%zu bytes) interleaved across %d NUMA nodes in %zu kB pages",
+						name, (Size) (end - start), nnodes, pagesize / 1024)));
+#endif   /* USE_NUMA_MBIND */
+}
+
 /*
  * PGSharedMemoryCreate
  *
@@ -431,3 +431,14 @@ pgwin32_ReserveSharedMemoryRegion(HANDLE hChild)
 
 	return true;
 }
+
+/*
+ * PGSharedMemorySetPlacement
+ *
+ * NUMA placement of shared memory is not implemented on Windows, so this
+ * does nothing.
+ */
+void
+PGSharedMemorySetPlacement(void *addr, Size size, const char *name)
+{
+}
@@ -16,6 +16,7 @@
 
 #include "storage/bufmgr.h"
 #include "storage/buf_internals.h"
+#include "storage/pg_shmem.h"
 
 
 BufferDescPadded *BufferDescriptors;
@@ -124,6 +125,18 @@ InitBufferPool(void)
 	{
 		int			i;
 
+		/*
+		 * Spread the buffer pool over the machine's NUMA nodes, if so
+		 * configured.  This has to happen before we touch the memory below;
+		 * otherwise it'd all end up on the postmaster's node.
+		 */
+		PGSharedMemorySetPlacement(BufferDescriptors,
+								   NBuffers * sizeof(BufferDescPadded),
+								   "Buffer Descriptors");
+		PGSharedMemorySetPlacement(BufferBlocks,
+								   NBuffers * (Size) BLCKSZ,
+								   "Buffer Blocks");
+
 		/*
 		 * Initialize all the buffer headers.
 		 */
@@ -9,6 +9,9 @@
  * in most cases the caller needs to adjust the buffer header contents
  * before the lock is released (see notes in README).
  *
+ * The lookup hints are the exception: they are read and written without
+ * any lock, and callers must verify what they get (see BufTableLookupHint).
+ *
  *
  * Portions Copyright (c) 1996-2016, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -34,6 +37,14 @@ typedef struct
 
 static HTAB *SharedBufHash;
 
+/*
+ * Lookup hints: a direct-mapped array, indexed by hash code, of the buffer
+ * IDs (plus one, so that zero means "no hint") most recently seen to hold
+ * a block with that hash code.
+ */
+static pg_atomic_uint32 *SharedBufHints;
+static int	NSharedBufHints;
+
 
 /*
  * Estimate space needed for mapping hashtable
@@ -42,7 +53,12 @@ static HTAB *SharedBufHash;
 Size
 BufTableShmemSize(int size)
 {
-	return hash_estimate_size(size, sizeof(BufferLookupEnt));
+	Size		sz;
+
+	sz = hash_estimate_size(size, sizeof(BufferLookupEnt));
+	sz = add_size(sz, mul_size(size, sizeof(pg_atomic_uint32)));
+
+	return sz;
 }
 
 /*
@@ -53,6 +69,7 @@ void
 InitBufTable(int size)
 {
 	HASHCTL		info;
+	bool		found;
 
 	/* assume no locking is needed yet */
 
@@ -65,6 +82,20 @@ InitBufTable(int size)
 								  size, size,
 								  &info,
 								  HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+
+	SharedBufHints = (pg_atomic_uint32 *)
+		ShmemInitStruct("Shared Buffer Lookup Hints",
+						mul_size(size, sizeof(pg_atomic_uint32)),
+						&found);
+	NSharedBufHints = size;
+
+	if (!found)
+	{
+		int			i;
+
+		for (i = 0; i < size; i++)
+			pg_atomic_init_u32(&SharedBufHints[i], 0);
+	}
 }
 
 /*
@@ -161,3 +192,34 @@ BufTableDelete(BufferTag *tagPtr, uint32 hashcode)
 	if (!result)				/* shouldn't happen */
 		elog(ERROR, "shared buffer hash table corrupted");
 }
+
+/*
+ * BufTableLookupHint
+ *		Guess which buffer holds the block with the given hash code
+ *
+ * Returns a buffer ID, or -1 if we have no guess.  No lock is needed, and
+ * the result may well be wrong: the caller must pin the buffer and then
+ * check that its tag is the wanted one before relying on it.
+ */
+int
+BufTableLookupHint(uint32 hashcode)
+{
+	uint32		hint;
+
+	hint = pg_atomic_read_u32(&SharedBufHints[hashcode % NSharedBufHints]);
+
+	return (int) hint - 1;
+}
+
+/*
+ * BufTableSetHint
+ *		Remember that the block with the given hash code is in buffer buf_id
+ *
+ * No lock is needed; a concurrent update just replaces one guess by another.
+ */
+void
+BufTableSetHint(uint32 hashcode, int buf_id)
+{
+	pg_atomic_write_u32(&SharedBufHints[hashcode % NSharedBufHints],
+						(uint32) (buf_id + 1));
+}
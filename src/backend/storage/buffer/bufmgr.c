@@ -128,6 +128,15 @@ int			backend_flush_after = 0;
  */
 int			target_prefetch_pages = 0;
 
+/*
+ * How many blocks sequential heap scans and VACUUM should prefetch ahead of
+ * their reads.  Zero means leave it to the kernel's own read-ahead.
+ */
+int			sequential_prefetch_size = 0;
+
+/* Replacement policy for shared buffers; see StrategyInitialUsageCount() */
+int			buffer_replacement_policy = BUFFER_REPLACEMENT_CLOCK;
+
 /* local state for StartBufferIO and related functions */
 static BufferDesc *InProgressBuf = NULL;
 static bool IsForInput;
@@ -433,7 +442,11 @@ static Buffer ReadBuffer_common(SMgrRelation reln, char relpersistence,
 				  ReadBufferMode mode, BufferAccessStrategy strategy,
 				  bool *hit);
 static bool PinBuffer(BufferDesc *buf, BufferAccessStrategy strategy);
+static bool PinBufferNoUsage(BufferDesc *buf, bool *firstPin);
 static void PinBuffer_Locked(BufferDesc *buf);
+static inline uint32 BufStateBumpUsage(uint32 buf_state,
+				  BufferAccessStrategy strategy);
+static void BumpUsageCount(BufferDesc *buf, BufferAccessStrategy strategy);
 static void UnpinBuffer(BufferDesc *buf, bool fixOwner);
 static void BufferSync(int flags);
 static uint32 WaitBufHdrUnlocked(BufferDesc *buf);
@@ -450,6 +463,8 @@ static BufferDesc *BufferAlloc(SMgrRelation smgr,
 			BlockNumber blockNum,
 			BufferAccessStrategy strategy,
 			bool *foundPtr);
+static BufferDesc *BufferAllocFound(BufferDesc *buf, bool valid,
+				 bool *foundPtr);
 static void FlushBuffer(BufferDesc *buf, SMgrRelation reln);
 static void AtProcExit_Buffers(int code, Datum arg);
 static void CheckForBufferLeaks(void);
@@ -527,10 +542,25 @@ ComputeIoConcurrency(int io_concurrency, double *target)
  */
 void
 PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
+{
+	PrefetchBufferRange(reln, forkNum, blockNum, 1);
+}
+
+/*
+ * PrefetchBufferRange -- initiate asynchronous read of a range of blocks
+ *
+ * Like PrefetchBuffer, but for the nblocks blocks starting at blockNum.
+ * Blocks that are already in shared buffers are skipped, and each run of
+ * adjacent blocks that are not is requested from the kernel in one go.
+ */
+void
+PrefetchBufferRange(Relation reln, ForkNumber forkNum, BlockNumber blockNum,
+					BlockNumber nblocks)
 {
 #ifdef USE_PREFETCH
 	Assert(RelationIsValid(reln));
 	Assert(BlockNumberIsValid(blockNum));
+	Assert(nblocks > 0);
 
 	/* Open it at the smgr level if not already done */
 	RelationOpenSmgr(reln);
@@ -544,9 +574,35 @@ PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
 				errmsg("cannot access temporary tables of other sessions")));
 
 		/* pass it off to localbuf.c */
-		LocalPrefetchBuffer(reln->rd_smgr, forkNum, blockNum);
+		while (nblocks-- > 0)
+			LocalPrefetchBuffer(reln->rd_smgr, forkNum, blockNum++);
 	}
 	else
+		PrefetchSharedBufferRange(reln->rd_smgr, forkNum, blockNum, nblocks);
+#endif   /* USE_PREFETCH */
+}
+
+/*
+ * PrefetchSharedBufferRange -- initiate asynchronous read of blocks that
+ *		live in shared buffers
+ *
+ * This is the guts of PrefetchBufferRange for a relation that isn't
+ * temporary, split out so that it can be used without a relcache entry,
+ * as during WAL replay.
+ */
+void
+PrefetchSharedBufferRange(SMgrRelation smgr_reln, ForkNumber forkNum,
+						  BlockNumber blockNum, BlockNumber nblocks)
+{
+#ifdef USE_PREFETCH
+	BlockNumber runstart = InvalidBlockNumber;
+	BlockNumber endBlock = blockNum + nblocks;
+	BlockNumber blk;
+
+	Assert(BlockNumberIsValid(blockNum));
+	Assert(nblocks > 0);
+
+	for (blk = blockNum; blk < endBlock; blk++)
 	{
 		BufferTag	newTag;		/* identity of requested block */
 		uint32		newHash;	/* hash value for newTag */
@@ -554,8 +610,7 @@ PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
 		int			buf_id;
 
 		/* create a tag so we can lookup the buffer */
-		INIT_BUFFERTAG(newTag, reln->rd_smgr->smgr_rnode.node,
-					   forkNum, blockNum);
+		INIT_BUFFERTAG(newTag, smgr_reln->smgr_rnode.node, forkNum, blk);
 
 		/* determine its hash code and partition lock ID */
 		newHash = BufTableHashCode(&newTag);
@@ -566,22 +621,33 @@ PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
 		buf_id = BufTableLookup(&newTag, newHash);
 		LWLockRelease(newPartitionLock);
 
-		/* If not in buffers, initiate prefetch */
 		if (buf_id < 0)
-			smgrprefetch(reln->rd_smgr, forkNum, blockNum);
-
-		/*
-		 * If the block *is* in buffers, we do nothing.  This is not really
-		 * ideal: the block might be just about to be evicted, which would be
-		 * stupid since we know we are going to need it soon.  But the only
-		 * easy answer is to bump the usage_count, which does not seem like a
-		 * great solution: when the caller does ultimately touch the block,
-		 * usage_count would get bumped again, resulting in too much
-		 * favoritism for blocks that are involved in a prefetch sequence. A
-		 * real fix would involve some additional per-buffer state, and it's
-		 * not clear that there's enough of a problem to justify that.
-		 */
+		{
+			/* Not in buffers, so extend or start a run to prefetch */
+			if (runstart == InvalidBlockNumber)
+				runstart = blk;
+		}
+		else if (runstart != InvalidBlockNumber)
+		{
+			/* End of a run of missing blocks, so initiate prefetch */
+			smgrprefetch(smgr_reln, forkNum, runstart, blk - runstart);
+			runstart = InvalidBlockNumber;
+		}
 	}
+	if (runstart != InvalidBlockNumber)
+		smgrprefetch(smgr_reln, forkNum, runstart, endBlock - runstart);
+
+	/*
+	 * If the block *is* in buffers, we do nothing.  This is not really ideal:
+	 * the block might be just about to be evicted, which would be stupid
+	 * since we know we are going to need it soon.  But the only easy answer
+	 * is to bump the usage_count, which does not seem like a great solution:
+	 * when the caller does ultimately touch the block, usage_count would get
+	 * bumped again, resulting in too much favoritism for blocks that are
+	 * involved in a prefetch sequence. A real fix would involve some
+	 * additional per-buffer state, and it's not clear that there's enough of
+	 * a problem to justify that.
+	 */
 #endif   /* USE_PREFETCH */
 }
 
@@ -964,6 +1030,39 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	return BufferDescriptorGetBuffer(bufHdr);
 }
 
+/*
+ * BufferAllocFound -- subroutine for BufferAlloc
+ *
+ * Finish up when the requested block was found in buffer "buf", which we
+ * have pinned; "valid" is what PinBuffer returned.
+ */
+static BufferDesc *
+BufferAllocFound(BufferDesc *buf, bool valid, bool *foundPtr)
+{
+	*foundPtr = TRUE;
+
+	if (!valid)
+	{
+		/*
+		 * We can only get here if (a) someone else is still reading in the
+		 * page, or (b) a previous read attempt failed.  We have to wait for
+		 * any active read attempt to finish, and then set up our own read
+		 * attempt if the page is still not BM_VALID.  StartBufferIO does it
+		 * all.
+		 */
+		if (StartBufferIO(buf, true))
+		{
+			/*
+			 * If we get here, previous attempts to read the buffer must have
+			 * failed ... but we shall bravely try again.
+			 */
+			*foundPtr = FALSE;
+		}
+	}
+
+	return buf;
+}
+
 /*
  * BufferAlloc -- subroutine for ReadBuffer.  Handles lookup of a shared
  *		buffer.  If no buffer exists already, selects a replacement
@@ -1008,6 +1107,47 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	newHash = BufTableHashCode(&newTag);
 	newPartitionLock = BufMappingPartitionLock(newHash);
 
+	/*
+	 * Before taking the mapping lock, see if the lookup hint for the block
+	 * points at a buffer that holds it.  We can't trust the hint, but once
+	 * we've pinned the buffer nobody can change its tag, so if the tag then
+	 * matches, the buffer is ours just as if we had found it in the mapping
+	 * table.  (The pin's compare-and-swap acts as a memory barrier, so we see
+	 * the tag as of the time the buffer was pinned.)  On busy systems this
+	 * saves most lookups of frequently used pages from contending for the
+	 * mapping partition locks.  See the README.
+	 *
+	 * The unlocked look at the tag before pinning may see a torn or stale
+	 * value, but it filters out nearly all wrong guesses without touching the
+	 * buffer's state.  The pin itself leaves usage_count alone, so that a
+	 * guess that still turns out wrong doesn't credit an unrelated buffer.
+	 */
+	buf_id = BufTableLookupHint(newHash);
+	if (buf_id >= 0)
+	{
+		buf = GetBufferDescriptor(buf_id);
+
+		if (BUFFERTAGS_EQUAL(buf->tag, newTag))
+		{
+			bool		firstPin;
+
+			valid = PinBufferNoUsage(buf, &firstPin);
+
+			buf_state = pg_atomic_read_u32(&buf->state);
+			if ((buf_state & BM_TAG_VALID) &&
+				BUFFERTAGS_EQUAL(buf->tag, newTag))
+			{
+				/* count the access as PinBuffer would have */
+				if (firstPin)
+					BumpUsageCount(buf, strategy);
+				return BufferAllocFound(buf, valid, foundPtr);
+			}
+
+			/* Wrong guess, so never mind */
+			UnpinBuffer(buf, true);
+		}
+	}
+
 	/* see if the block is in the buffer pool already */
 	LWLockAcquire(newPartitionLock, LW_SHARED);
 	buf_id = BufTableLookup(&newTag, newHash);
@@ -1025,28 +1165,10 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 		/* Can release the mapping lock as soon as we've pinned it */
 		LWLockRelease(newPartitionLock);
 
-		*foundPtr = TRUE;
+		/* Make it quicker to find the next time */
+		BufTableSetHint(newHash, buf_id);
 
-		if (!valid)
-		{
-			/*
-			 * We can only get here if (a) someone else is still reading in
-			 * the page, or (b) a previous read attempt failed.  We have to
-			 * wait for any active read attempt to finish, and then set up our
-			 * own read attempt if the page is still not BM_VALID.
-			 * StartBufferIO does it all.
-			 */
-			if (StartBufferIO(buf, true))
-			{
-				/*
-				 * If we get here, previous attempts to read the buffer must
-				 * have failed ... but we shall bravely try again.
-				 */
-				*foundPtr = FALSE;
-			}
-		}
-
-		return buf;
+		return BufferAllocFound(buf, valid, foundPtr);
 	}
 
 	/*
@@ -1237,28 +1359,9 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 			/* Can release the mapping lock as soon as we've pinned it */
 			LWLockRelease(newPartitionLock);
 
-			*foundPtr = TRUE;
+			BufTableSetHint(newHash, buf_id);
 
-			if (!valid)
-			{
-				/*
-				 * We can only get here if (a) someone else is still reading
-				 * in the page, or (b) a previous read attempt failed.  We
-				 * have to wait for any active read attempt to finish, and
-				 * then set up our own read attempt if the page is still not
-				 * BM_VALID.  StartBufferIO does it all.
-				 */
-				if (StartBufferIO(buf, true))
-				{
-					/*
-					 * If we get here, previous attempts to read the buffer
-					 * must have failed ... but we shall bravely try again.
-					 */
-					*foundPtr = FALSE;
-				}
-			}
-
-			return buf;
+			return BufferAllocFound(buf, valid, foundPtr);
 		}
 
 		/*
@@ -1290,8 +1393,9 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	 *
 	 * Clearing BM_VALID here is necessary, clearing the dirtybits is just
 	 * paranoia.  We also reset the usage_count since any recency of use of
-	 * the old content is no longer relevant.  (The usage_count starts out at
-	 * 1 so that the buffer can survive one clock-sweep pass.)
+	 * the old content is no longer relevant.  (The usage_count normally
+	 * starts out at 1 so that the buffer can survive one clock-sweep pass;
+	 * but see StrategyInitialUsageCount.)
 	 *
 	 * Make sure BM_PERMANENT is set for buffers that must be written at every
 	 * checkpoint.  Unlogged buffers only need to be written at shutdown
@@ -1303,14 +1407,16 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 				   BM_CHECKPOINT_NEEDED | BM_IO_ERROR | BM_PERMANENT |
 				   BUF_USAGECOUNT_MASK);
 	if (relpersistence == RELPERSISTENCE_PERMANENT || forkNum == INIT_FORKNUM)
-		buf_state |= BM_TAG_VALID | BM_PERMANENT | BUF_USAGECOUNT_ONE;
+		buf_state |= BM_TAG_VALID | BM_PERMANENT;
 	else
-		buf_state |= BM_TAG_VALID | BUF_USAGECOUNT_ONE;
+		buf_state |= BM_TAG_VALID;
+	buf_state += StrategyInitialUsageCount(newHash) * BUF_USAGECOUNT_ONE;
 
 	UnlockBufHdr(buf, buf_state);
 
 	if (oldPartitionLock != NULL)
 	{
+		StrategyRememberEviction(oldHash);
 		BufTableDelete(&oldTag, oldHash);
 		if (oldPartitionLock != newPartitionLock)
 			LWLockRelease(oldPartitionLock);
@@ -1318,6 +1424,8 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 
 	LWLockRelease(newPartitionLock);
 
+	BufTableSetHint(newHash, buf->buf_id);
+
 	/*
 	 * Buffer contents are currently invalid.  Try to get the io_in_progress
 	 * lock.  If StartBufferIO returns false, then someone else managed to
@@ -1592,24 +1700,62 @@ PinBuffer(BufferDesc *buf, BufferAccessStrategy strategy)
 
 			buf_state = old_buf_state;
 
-			/* increase refcount */
+			/* increase refcount and usagecount */
 			buf_state += BUF_REFCOUNT_ONE;
+			buf_state = BufStateBumpUsage(buf_state, strategy);
 
-			if (strategy == NULL)
-			{
-				/* Default case: increase usagecount unless already max. */
-				if (BUF_STATE_GET_USAGECOUNT(buf_state) < BM_MAX_USAGE_COUNT)
-					buf_state += BUF_USAGECOUNT_ONE;
-			}
-			else
+			if (pg_atomic_compare_exchange_u32(&buf->state, &old_buf_state,
+											   buf_state))
 			{
-				/*
-				 * Ring buffers shouldn't evict others from pool.  Thus we
-				 * don't make usagecount more than 1.
-				 */
-				if (BUF_STATE_GET_USAGECOUNT(buf_state) == 0)
-					buf_state += BUF_USAGECOUNT_ONE;
+				result = (buf_state & BM_VALID) != 0;
+				break;
 			}
+		}
+	}
+	else
+	{
+		/* If we previously pinned the buffer, it must surely be valid */
+		result = true;
+	}
+
+	ref->refcount++;
+	Assert(ref->refcount > 0);
+	ResourceOwnerRememberBuffer(CurrentResourceOwner, b);
+	return result;
+}
+
+/*
+ * PinBufferNoUsage -- as PinBuffer, but leave the usage_count alone.
+ *
+ * For callers that aren't yet sure they want the buffer.  *firstPin is set
+ * to whether this backend didn't already have it pinned, which is when
+ * PinBuffer would have counted the access; the caller can do that later
+ * with BumpUsageCount.
+ */
+static bool
+PinBufferNoUsage(BufferDesc *buf, bool *firstPin)
+{
+	Buffer		b = BufferDescriptorGetBuffer(buf);
+	bool		result;
+	PrivateRefCountEntry *ref;
+
+	ref = GetPrivateRefCountEntry(b, true);
+
+	if (ref == NULL)
+	{
+		uint32		buf_state;
+		uint32		old_buf_state;
+
+		ReservePrivateRefCountEntry();
+		ref = NewPrivateRefCountEntry(b);
+
+		old_buf_state = pg_atomic_read_u32(&buf->state);
+		for (;;)
+		{
+			if (old_buf_state & BM_LOCKED)
+				old_buf_state = WaitBufHdrUnlocked(buf);
+
+			buf_state = old_buf_state + BUF_REFCOUNT_ONE;
 
 			if (pg_atomic_compare_exchange_u32(&buf->state, &old_buf_state,
 											   buf_state))
@@ -1618,11 +1764,13 @@ PinBuffer(BufferDesc *buf, BufferAccessStrategy strategy)
 				break;
 			}
 		}
+		*firstPin = true;
 	}
 	else
 	{
 		/* If we previously pinned the buffer, it must surely be valid */
 		result = true;
+		*firstPin = false;
 	}
 
 	ref->refcount++;
@@ -1631,6 +1779,61 @@ PinBuffer(BufferDesc *buf, BufferAccessStrategy strategy)
 	return result;
 }
 
+/*
+ * BufStateBumpUsage -- apply PinBuffer's usage_count rule to a state value.
+ *
+ * For the default access strategy, the usage_count is incremented; for other
+ * strategies we just make sure it isn't zero.  See PinBuffer.
+ */
+static inline uint32
+BufStateBumpUsage(uint32 buf_state, BufferAccessStrategy strategy)
+{
+	if (strategy == NULL)
+	{
+		/* Default case: increase usagecount unless already max. */
+		if (BUF_STATE_GET_USAGECOUNT(buf_state) < BM_MAX_USAGE_COUNT)
+			buf_state += BUF_USAGECOUNT_ONE;
+	}
+	else
+	{
+		/*
+		 * Ring buffers shouldn't evict others from pool.  Thus we don't make
+		 * usagecount more than 1.
+		 */
+		if (BUF_STATE_GET_USAGECOUNT(buf_state) == 0)
+			buf_state += BUF_USAGECOUNT_ONE;
+	}
+
+	return buf_state;
+}
+
+/*
+ * BumpUsageCount -- count an access to a buffer pinned by PinBufferNoUsage.
+ *
+ * The caller must hold a pin.
+ */
+static void
+BumpUsageCount(BufferDesc *buf, BufferAccessStrategy strategy)
+{
+	uint32		buf_state;
+	uint32		old_buf_state;
+
+	old_buf_state = pg_atomic_read_u32(&buf->state);
+	for (;;)
+	{
+		if (old_buf_state & BM_LOCKED)
+			old_buf_state = WaitBufHdrUnlocked(buf);
+
+		buf_state = BufStateBumpUsage(old_buf_state, strategy);
+
+		/* nothing to do if the count is already where it should be */
+		if (buf_state == old_buf_state ||
+			pg_atomic_compare_exchange_u32(&buf->state, &old_buf_state,
+										   buf_state))
+			break;
+	}
+}
+
 /*
  * PinBuffer_Locked -- as above, but caller already locked the buffer header.
  * The spinlock is released before return.
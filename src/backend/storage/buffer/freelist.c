@@ -22,6 +22,20 @@
 
 #define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
 
+/*
+ * Under buffer_replacement_policy = 2q, we remember the hash codes of the
+ * blocks most recently evicted from shared buffers, as 2Q's "A1out" queue
+ * does.  There's one slot per NGHOST_PER_BUFFER buffers, addressed by the
+ * block's buffer-mapping hash code.  A slot simply holds the full hash code
+ * of the last block evicted into it (zero if none), so the table is lossy in
+ * both directions; that's fine, since it only steers a heuristic.
+ */
+#define NGHOST_PER_BUFFER		2
+#define NGhostSlots				(NBuffers / NGHOST_PER_BUFFER + 1)
+
+/* Usage count given to a block read back in while it's remembered as a ghost */
+#define GHOST_USAGE_COUNT		2
+
 
 /*
  * The shared freelist control information.
@@ -62,6 +76,7 @@ typedef struct
 
 /* Pointers to shared state */
 static BufferStrategyControl *StrategyControl = NULL;
+static pg_atomic_uint32 *StrategyGhosts = NULL;
 
 /*
  * Private (non-shared) state for managing a ring of shared buffers to re-use.
@@ -363,6 +378,59 @@ StrategyFreeBuffer(BufferDesc *buf)
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 }
 
+/*
+ * StrategyInitialUsageCount -- usage count for a newly loaded block
+ *
+ * BufferAlloc() calls this when it has assigned a buffer to the block with
+ * buffer-mapping hash code "hashcode", which was not in shared buffers.
+ *
+ * Under the plain clock sweep, the new buffer starts with a usage count of 1
+ * so that it survives one pass of the clock hand.  That means a large scan
+ * that doesn't use a buffer ring decrements the usage counts of the whole
+ * pool, and can push out the frequently used pages, before any of its own
+ * pages become candidates for eviction.
+ *
+ * Under the 2q policy, a new buffer instead starts on probation with a usage
+ * count of 0.  As the clock hand has just passed it, it still stays in the
+ * pool for about one pass, and it is promoted in the usual way if it's used
+ * again in the meantime; but pages that are only touched once by a scan are
+ * the first to go.  A block that was evicted recently enough to still have a
+ * ghost entry has proven that it's reused, so it starts at GHOST_USAGE_COUNT.
+ */
+uint32
+StrategyInitialUsageCount(uint32 hashcode)
+{
+	pg_atomic_uint32 *ghost;
+
+	if (buffer_replacement_policy != BUFFER_REPLACEMENT_2Q)
+		return 1;
+
+	ghost = &StrategyGhosts[hashcode % NGhostSlots];
+	if (hashcode != 0 && pg_atomic_read_u32(ghost) == hashcode)
+	{
+		/* Forget the ghost, so it can't promote the block twice */
+		pg_atomic_write_u32(ghost, 0);
+		return GHOST_USAGE_COUNT;
+	}
+	return 0;
+}
+
+/*
+ * StrategyRememberEviction -- note that a block has been evicted
+ *
+ * BufferAlloc() calls this when it has chosen to replace the block with
+ * buffer-mapping hash code "hashcode".  This only matters under the 2q
+ * policy; see StrategyInitialUsageCount.
+ */
+void
+StrategyRememberEviction(uint32 hashcode)
+{
+	if (buffer_replacement_policy != BUFFER_REPLACEMENT_2Q)
+		return;
+
+	pg_atomic_write_u32(&StrategyGhosts[hashcode % NGhostSlots], hashcode);
+}
+
 /*
  * StrategySyncStart -- tell BufferSync where to start syncing
  *
@@ -444,6 +512,9 @@ StrategyShmemSize(void)
 	/* size of the shared replacement strategy control block */
 	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
 
+	/* size of the ghost table used by the 2q policy */
+	size = add_size(size, mul_size(NGhostSlots, sizeof(pg_atomic_uint32)));
+
 	return size;
 }
 
@@ -458,6 +529,7 @@ void
 StrategyInitialize(bool init)
 {
 	bool		found;
+	bool		foundGhosts;
 
 	/*
 	 * Initialize the shared buffer lookup hashtable.
@@ -479,8 +551,19 @@ StrategyInitialize(bool init)
 						sizeof(BufferStrategyControl),
 						&found);
 
+	/*
+	 * The ghost table is allocated even under the plain clock sweep, so that
+	 * buffer_replacement_policy can be changed without a restart.
+	 */
+	StrategyGhosts = (pg_atomic_uint32 *)
+		ShmemInitStruct("Buffer Strategy Ghosts",
+						mul_size(NGhostSlots, sizeof(pg_atomic_uint32)),
+						&foundGhosts);
+
 	if (!found)
 	{
+		int			i;
+
 		/*
 		 * Only done once, usually in postmaster
 		 */
@@ -504,6 +587,11 @@ StrategyInitialize(bool init)
 
 		/* No pending notification */
 		StrategyControl->bgwprocno = -1;
+
+		/* No ghosts yet */
+		Assert(!foundGhosts);
+		for (i = 0; i < NGhostSlots; i++)
+			pg_atomic_init_u32(&StrategyGhosts[i], 0);
 	}
 	else
 		Assert(!init);
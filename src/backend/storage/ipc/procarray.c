@@ -168,11 +168,15 @@ static int KnownAssignedXidsGetAndSetXmin(TransactionId *xarray,
 							   TransactionId *xmin,
 							   TransactionId xmax);
 static TransactionId KnownAssignedXidsGetOldestXmin(void);
+static bool GetSnapshotDataReuse(Snapshot snapshot);
+static void GetSnapshotDataFinish(Snapshot snapshot);
 static void KnownAssignedXidsDisplay(int trace_level);
 static void KnownAssignedXidsReset(void);
 static inline void ProcArrayEndTransactionInternal(PGPROC *proc,
 								PGXACT *pgxact, TransactionId latestXid);
 static void ProcArrayGroupClearXid(PGPROC *proc, TransactionId latestXid);
+static inline int ProcSubxidCount(volatile PGPROC *proc,
+				volatile PGXACT *pgxact);
 
 /*
  * Report shared-memory space needed by CreateSharedProcArray.
@@ -239,6 +243,8 @@ CreateSharedProcArray(void)
 		 */
 		procArray->numProcs = 0;
 		procArray->maxProcs = PROCARRAY_MAXPROCS;
+		/* 0 is reserved to mean "no reusable snapshot", see GetSnapshotData */
+		ShmemVariableCache->xactCompletionCount = 1;
 		procArray->maxKnownAssignedXids = TOTAL_MAX_CACHED_SUBXIDS;
 		procArray->numKnownAssignedXids = 0;
 		procArray->tailKnownAssignedXids = 0;
@@ -357,6 +363,9 @@ ProcArrayRemove(PGPROC *proc, TransactionId latestXid)
 		if (TransactionIdPrecedes(ShmemVariableCache->latestCompletedXid,
 								  latestXid))
 			ShmemVariableCache->latestCompletedXid = latestXid;
+
+		/* Cached snapshots no longer reflect the set of running XIDs */
+		ShmemVariableCache->xactCompletionCount++;
 	}
 	else
 	{
@@ -443,6 +452,7 @@ ProcArrayEndTransaction(PGPROC *proc, TransactionId latestXid)
 		proc->recoveryConflictPending = false;
 
 		Assert(pgxact->nxids == 0);
+		Assert(proc->subxids.nxids == 0);
 		Assert(pgxact->overflowed == false);
 	}
 }
@@ -465,13 +475,16 @@ ProcArrayEndTransactionInternal(PGPROC *proc, PGXACT *pgxact,
 	proc->recoveryConflictPending = false;
 
 	/* Clear the subtransaction-XID cache too while holding the lock */
-	pgxact->nxids = 0;
+	SetProcSubxidCount(proc, pgxact, 0);
 	pgxact->overflowed = false;
 
 	/* Also advance global latestCompletedXid while holding the lock */
 	if (TransactionIdPrecedes(ShmemVariableCache->latestCompletedXid,
 							  latestXid))
 		ShmemVariableCache->latestCompletedXid = latestXid;
+
+	/* Cached snapshots no longer reflect the set of running XIDs */
+	ShmemVariableCache->xactCompletionCount++;
 }
 
 /*
@@ -611,11 +624,17 @@ ProcArrayClearTransaction(PGPROC *proc)
 	PGXACT	   *pgxact = &allPgXact[proc->pgprocno];
 
 	/*
-	 * We can skip locking ProcArrayLock here, because this action does not
-	 * actually change anyone's view of the set of running XIDs: our entry is
-	 * duplicate with the gxact that has already been inserted into the
-	 * ProcArray.
+	 * This action does not actually change anyone's view of the set of
+	 * running XIDs: our entry is duplicate with the gxact that has already
+	 * been inserted into the ProcArray.  Except our own, that is, because
+	 * our snapshots leave out our own XID.  So we must take ProcArrayLock
+	 * just to make sure that this backend doesn't reuse a snapshot taken
+	 * before the PREPARE.
 	 */
+	LWLockAcquire(ProcArrayLock, LW_EXCLUSIVE);
+	ShmemVariableCache->xactCompletionCount++;
+	LWLockRelease(ProcArrayLock);
+
 	pgxact->xid = InvalidTransactionId;
 	proc->lxid = InvalidLocalTransactionId;
 	pgxact->xmin = InvalidTransactionId;
@@ -626,7 +645,7 @@ ProcArrayClearTransaction(PGPROC *proc)
 	pgxact->delayChkpt = false;
 
 	/* Clear the subtransaction-XID cache too */
-	pgxact->nxids = 0;
+	SetProcSubxidCount(proc, pgxact, 0);
 	pgxact->overflowed = false;
 }
 
@@ -1113,7 +1132,7 @@ TransactionIdIsInProgress(TransactionId xid)
 		/*
 		 * Step 2: check the cached child-Xids arrays
 		 */
-		for (j = pgxact->nxids - 1; j >= 0; j--)
+		for (j = ProcSubxidCount(proc, pgxact) - 1; j >= 0; j--)
 		{
 			/* Fetch xid just once - see GetNewTransactionId */
 			TransactionId cxid = proc->subxids.xids[j];
@@ -1464,12 +1483,15 @@ GetMaxSnapshotXidCount(void)
 /*
  * GetMaxSnapshotSubxidCount -- get max size for snapshot sub-XID array
  *
- * We have to export this for use by snapmgr.c.
+ * On a primary, the array has to hold every backend's full subxid cache;
+ * in hot standby, all of KnownAssignedXids.  We have to export this for use
+ * by snapmgr.c.
  */
 int
 GetMaxSnapshotSubxidCount(void)
 {
-	return TOTAL_MAX_CACHED_SUBXIDS;
+	return Max(TOTAL_MAX_CACHED_SUBXIDS,
+			   procArray->maxProcs * max_cached_subxids);
 }
 
 /*
@@ -1504,6 +1526,10 @@ GetMaxSnapshotSubxidCount(void)
  *		RecentGlobalDataXmin: the global xmin for non-catalog tables
  *			>= RecentGlobalXmin
  *
+ * If no transaction has ended since the snapshot struct was last filled in,
+ * the set of running XIDs it describes is still exact, and we return it
+ * without scanning the proc array; see GetSnapshotDataReuse().
+ *
  * Note: this function should probably not be called with an argument that's
  * not statically allocated (see xip allocation below).
  */
@@ -1518,6 +1544,7 @@ GetSnapshotData(Snapshot snapshot)
 	int			count = 0;
 	int			subcount = 0;
 	bool		suboverflowed = false;
+	uint64		curXactCompletionCount;
 	volatile TransactionId replication_slot_xmin = InvalidTransactionId;
 	volatile TransactionId replication_slot_catalog_xmin = InvalidTransactionId;
 
@@ -1561,6 +1588,15 @@ GetSnapshotData(Snapshot snapshot)
 	 */
 	LWLockAcquire(ProcArrayLock, LW_SHARED);
 
+	if (GetSnapshotDataReuse(snapshot))
+	{
+		LWLockRelease(ProcArrayLock);
+		GetSnapshotDataFinish(snapshot);
+		return snapshot;
+	}
+
+	curXactCompletionCount = ShmemVariableCache->xactCompletionCount;
+
 	/* xmax is always latestCompletedXid + 1 */
 	xmax = ShmemVariableCache->latestCompletedXid;
 	Assert(TransactionIdIsNormal(xmax));
@@ -1651,12 +1687,11 @@ GetSnapshotData(Snapshot snapshot)
 					suboverflowed = true;
 				else
 				{
-					int			nxids = pgxact->nxids;
+					volatile PGPROC *proc = &allProcs[pgprocno];
+					int			nxids = ProcSubxidCount(proc, pgxact);
 
 					if (nxids > 0)
 					{
-						volatile PGPROC *proc = &allProcs[pgprocno];
-
 						memcpy(snapshot->subxip + subcount,
 							   (void *) proc->subxids.xids,
 							   nxids * sizeof(TransactionId));
@@ -1751,6 +1786,69 @@ GetSnapshotData(Snapshot snapshot)
 	snapshot->subxcnt = subcount;
 	snapshot->suboverflowed = suboverflowed;
 
+	/*
+	 * Snapshots taken during recovery are built from KnownAssignedXids,
+	 * which changes without the completion count being advanced, so they
+	 * can't be reused.
+	 */
+	if (snapshot->takenDuringRecovery)
+		snapshot->snapXactCompletionCount = 0;
+	else
+		snapshot->snapXactCompletionCount = curXactCompletionCount;
+
+	GetSnapshotDataFinish(snapshot);
+
+	return snapshot;
+}
+
+/*
+ * Try to reuse the XID arrays already present in a snapshot struct.
+ *
+ * If no transaction has ended (nor removed subtransaction XIDs) since the
+ * snapshot was computed, which ShmemVariableCache->xactCompletionCount lets
+ * us detect cheaply, then xmin, xmax and the XID arrays computed last time
+ * are still exactly right.  XIDs assigned in the meantime are >= xmax and
+ * therefore treated as running anyway.
+ *
+ * The global xmin horizons are left alone: the values computed last time
+ * can only be older than what we'd compute now, so they're still safe.
+ *
+ * Caller must hold ProcArrayLock in at least shared mode, and must call
+ * GetSnapshotDataFinish() after releasing it if we return true.
+ */
+static bool
+GetSnapshotDataReuse(Snapshot snapshot)
+{
+	Assert(LWLockHeldByMe(ProcArrayLock));
+
+	if (snapshot->snapXactCompletionCount == 0 ||
+		snapshot->snapXactCompletionCount !=
+		ShmemVariableCache->xactCompletionCount)
+		return false;
+
+	Assert(!snapshot->takenDuringRecovery);
+
+	/*
+	 * As in the full computation, advertise the xmin if we haven't got one
+	 * yet.  No XID older than the snapshot's xmin can have been running all
+	 * along without being part of it, so nobody can have computed a global
+	 * xmin newer than this one.
+	 */
+	if (!TransactionIdIsValid(MyPgXact->xmin))
+		MyPgXact->xmin = TransactionXmin = snapshot->xmin;
+
+	RecentXmin = snapshot->xmin;
+
+	return true;
+}
+
+/*
+ * Fill in the parts of a snapshot that are the same whether it was newly
+ * computed or reused.
+ */
+static void
+GetSnapshotDataFinish(Snapshot snapshot)
+{
 	snapshot->curcid = GetCurrentCommandId(false);
 
 	/*
@@ -1779,10 +1877,8 @@ GetSnapshotData(Snapshot snapshot)
 		 */
 		snapshot->lsn = GetXLogInsertRecPtr();
 		snapshot->whenTaken = GetSnapshotCurrentTimestamp();
-		MaintainOldSnapshotTimeMapping(snapshot->whenTaken, xmin);
+		MaintainOldSnapshotTimeMapping(snapshot->whenTaken, snapshot->xmin);
 	}
-
-	return snapshot;
 }
 
 /*
@@ -2009,7 +2105,13 @@ GetRunningTransactionData(void)
 		if (TransactionIdPrecedes(xid, oldestRunningXid))
 			oldestRunningXid = xid;
 
-		if (pgxact->overflowed)
+		/*
+		 * A standby tracks at most PGPROC_MAX_CACHED_SUBXIDS subxids per
+		 * transaction, so report a larger cache as overflowed; the standby
+		 * learns about the rest from XLOG_XACT_ASSIGNMENT records anyway.
+		 * This also keeps the total within the size of our xids array.
+		 */
+		if (pgxact->overflowed || pgxact->nxids > PGPROC_MAX_CACHED_SUBXIDS)
 			suboverflowed = true;
 	}
 
@@ -2030,7 +2132,7 @@ GetRunningTransactionData(void)
 			 * Save subtransaction XIDs. Other backends can't add or remove
 			 * entries while we're holding XidGenLock.
 			 */
-			nxids = pgxact->nxids;
+			nxids = ProcSubxidCount(proc, pgxact);
 			if (nxids > 0)
 			{
 				memcpy(&xids[count], (void *) proc->subxids.xids,
@@ -2997,10 +3099,27 @@ ProcArrayGetReplicationSlotXmin(TransactionId *xmin,
 }
 
 
+/*
+ * ProcSubxidCount -- number of XIDs in a proc's subxid cache
+ *
+ * PGXACT->nxids is enough unless the cache is so full that the count there
+ * has saturated.
+ */
+static inline int
+ProcSubxidCount(volatile PGPROC *proc, volatile PGXACT *pgxact)
+{
+	int			nxids = pgxact->nxids;
+
+	if (nxids == PGXACT_NXIDS_SATURATED)
+		nxids = proc->subxids.nxids;
+	return nxids;
+}
+
 #define XidCacheRemove(i) \
 	do { \
-		MyProc->subxids.xids[i] = MyProc->subxids.xids[MyPgXact->nxids - 1]; \
-		MyPgXact->nxids--; \
+		MyProc->subxids.xids[i] = \
+			MyProc->subxids.xids[MyProc->subxids.nxids - 1]; \
+		SetProcSubxidCount(MyProc, MyPgXact, MyProc->subxids.nxids - 1); \
 	} while (0)
 
 /*
@@ -3039,7 +3158,7 @@ XidCacheRemoveRunningXids(TransactionId xid,
 	{
 		TransactionId anxid = xids[i];
 
-		for (j = MyPgXact->nxids - 1; j >= 0; j--)
+		for (j = MyProc->subxids.nxids - 1; j >= 0; j--)
 		{
 			if (TransactionIdEquals(MyProc->subxids.xids[j], anxid))
 			{
@@ -3059,7 +3178,7 @@ XidCacheRemoveRunningXids(TransactionId xid,
 			elog(WARNING, "did not find subXID %u in MyProc", anxid);
 	}
 
-	for (j = MyPgXact->nxids - 1; j >= 0; j--)
+	for (j = MyProc->subxids.nxids - 1; j >= 0; j--)
 	{
 		if (TransactionIdEquals(MyProc->subxids.xids[j], xid))
 		{
@@ -3076,6 +3195,9 @@ XidCacheRemoveRunningXids(TransactionId xid,
 							  latestXid))
 		ShmemVariableCache->latestCompletedXid = latestXid;
 
+	/* Cached snapshots may still list the removed subxids */
+	ShmemVariableCache->xactCompletionCount++;
+
 	LWLockRelease(ProcArrayLock);
 }
 
@@ -130,6 +130,8 @@ static LWLockTranche MainLWLockTranche;
 static LWLockTranche BufMappingLWLockTranche;
 static LWLockTranche LockManagerLWLockTranche;
 static LWLockTranche PredicateLockManagerLWLockTranche;
+static LWLockTranche ParallelBtreeScanLWLockTranche;
+static LWLockTranche ParallelAppendLWLockTranche;
 
 /*
  * We use this structure to keep track of locked LWLocks for release
@@ -555,6 +557,23 @@ RegisterLWLockTranches(void)
 	PredicateLockManagerLWLockTranche.array_stride = sizeof(LWLockPadded);
 	LWLockRegisterTranche(LWTRANCHE_PREDICATE_LOCK_MANAGER, &PredicateLockManagerLWLockTranche);
 
+	/*
+	 * Parallel btree scans keep their lock in dynamic shared memory, so there
+	 * is no fixed array for this tranche.
+	 */
+	ParallelBtreeScanLWLockTranche.name = "parallel_btree_scan";
+	ParallelBtreeScanLWLockTranche.array_base = NULL;
+	ParallelBtreeScanLWLockTranche.array_stride = sizeof(LWLock);
+	LWLockRegisterTranche(LWTRANCHE_PARALLEL_BTREE_SCAN,
+						  &ParallelBtreeScanLWLockTranche);
+
+	/* Likewise for the lock of a parallel-aware Append node. */
+	ParallelAppendLWLockTranche.name = "parallel_append";
+	ParallelAppendLWLockTranche.array_base = NULL;
+	ParallelAppendLWLockTranche.array_stride = sizeof(LWLock);
+	LWLockRegisterTranche(LWTRANCHE_PARALLEL_APPEND,
+						  &ParallelAppendLWLockTranche);
+
 	/* Register named tranches. */
 	for (i = 0; i < NamedLWLockTrancheRequests; i++)
 		LWLockRegisterTranche(NamedLWLockTrancheArray[i].trancheId,
@@ -797,8 +797,8 @@ OldSerXidInit(void)
 	 */
 	OldSerXidSlruCtl->PagePrecedes = OldSerXidPagePrecedesLogically;
 	SimpleLruInit(OldSerXidSlruCtl, "oldserxid",
-				  NUM_OLDSERXID_BUFFERS, 0, OldSerXidLock, "pg_serial",
-				  LWTRANCHE_OLDSERXID_BUFFERS);
+				  NUM_OLDSERXID_BUFFERS, 0, "pg_serial",
+				  LWTRANCHE_OLDSERXID_BUFFERS, LWTRANCHE_OLDSERXID_BANKS);
 	/* Override default assumption that writes should be fsync'd */
 	OldSerXidSlruCtl->do_fsync = false;
 
@@ -834,11 +834,17 @@ OldSerXidAdd(TransactionId xid, SerCommitSeqNo minConflictCommitSeqNo)
 	int			slotno;
 	int			firstZeroPage;
 	bool		isNewPage;
+	LWLock	   *lock;
 
 	Assert(TransactionIdIsValid(xid));
 
 	targetPage = OldSerXidPage(xid);
+	lock = SimpleLruGetBankLock(OldSerXidSlruCtl, targetPage);
 
+	/*
+	 * OldSerXidLock protects oldSerXidControl; the SLRU buffers are protected
+	 * by their bank locks, which are taken while holding OldSerXidLock.
+	 */
 	LWLockAcquire(OldSerXidLock, LW_EXCLUSIVE);
 
 	/*
@@ -916,20 +922,30 @@ OldSerXidAdd(TransactionId xid, SerCommitSeqNo minConflictCommitSeqNo)
 
 	if (isNewPage)
 	{
-		/* Initialize intervening pages. */
+		/* Initialize intervening pages, each under its own bank lock. */
 		while (firstZeroPage != targetPage)
 		{
+			LWLock	   *zerolock;
+
+			zerolock = SimpleLruGetBankLock(OldSerXidSlruCtl, firstZeroPage);
+			LWLockAcquire(zerolock, LW_EXCLUSIVE);
 			(void) SimpleLruZeroPage(OldSerXidSlruCtl, firstZeroPage);
+			LWLockRelease(zerolock);
 			firstZeroPage = OldSerXidNextPage(firstZeroPage);
 		}
+		LWLockAcquire(lock, LW_EXCLUSIVE);
 		slotno = SimpleLruZeroPage(OldSerXidSlruCtl, targetPage);
 	}
 	else
+	{
+		LWLockAcquire(lock, LW_EXCLUSIVE);
 		slotno = SimpleLruReadPage(OldSerXidSlruCtl, targetPage, true, xid);
+	}
 
 	OldSerXidValue(slotno, xid) = minConflictCommitSeqNo;
 	OldSerXidSlruCtl->shared->page_dirty[slotno] = true;
 
+	LWLockRelease(lock);
 	LWLockRelease(OldSerXidLock);
 }
 
@@ -963,13 +979,13 @@ OldSerXidGetMinConflictCommitSeqNo(TransactionId xid)
 		return 0;
 
 	/*
-	 * The following function must be called without holding OldSerXidLock,
-	 * but will return with that lock held, which must then be released.
+	 * The following function must be called without holding the page's bank
+	 * lock, but will return with that lock held, which must then be released.
 	 */
 	slotno = SimpleLruReadPage_ReadOnly(OldSerXidSlruCtl,
 										OldSerXidPage(xid), xid);
 	val = OldSerXidValue(slotno, xid);
-	LWLockRelease(OldSerXidLock);
+	LWLockRelease(SimpleLruGetBankLock(OldSerXidSlruCtl, OldSerXidPage(xid)));
 	return val;
 }
 
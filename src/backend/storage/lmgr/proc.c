@@ -60,6 +60,7 @@ int			StatementTimeout = 0;
 int			LockTimeout = 0;
 int			IdleInTransactionSessionTimeout = 0;
 bool		log_lock_waits = false;
+int			max_cached_subxids = 1024;
 
 /* Pointer to this process's PGPROC and PGXACT structs, if any */
 PGPROC	   *MyProc = NULL;
@@ -91,8 +92,23 @@ static void RemoveProcFromArray(int code, Datum arg);
 static void ProcKill(int code, Datum arg);
 static void AuxiliaryProcKill(int code, Datum arg);
 static void CheckDeadLock(void);
+static Size FastPathLockShmemSize(void);
 
 
+/*
+ * Report shared-memory space needed for one PGPROC's fast-path lock arrays.
+ */
+static Size
+FastPathLockShmemSize(void)
+{
+	Assert(FastPathLockGroupsPerBackend > 0);
+
+	return add_size(MAXALIGN(mul_size(FastPathLockGroupsPerBackend,
+									  sizeof(uint64))),
+					MAXALIGN(mul_size(FastPathLockSlotsPerBackend(),
+									  sizeof(Oid))));
+}
+
 /*
  * Report shared-memory space needed by InitProcGlobal.
  */
@@ -116,6 +132,17 @@ ProcGlobalShmemSize(void)
 	size = add_size(size, mul_size(NUM_AUXILIARY_PROCS, sizeof(PGXACT)));
 	size = add_size(size, mul_size(max_prepared_xacts, sizeof(PGXACT)));
 
+	/* Subtransaction XID caches */
+	size = add_size(size,
+					mul_size(MaxBackends + NUM_AUXILIARY_PROCS + max_prepared_xacts,
+							 mul_size(max_cached_subxids,
+									  sizeof(TransactionId))));
+
+	/* Fast-path lock arrays */
+	size = add_size(size,
+					mul_size(MaxBackends + NUM_AUXILIARY_PROCS + max_prepared_xacts,
+							 FastPathLockShmemSize()));
+
 	return size;
 }
 
@@ -161,6 +188,8 @@ InitProcGlobal(void)
 {
 	PGPROC	   *procs;
 	PGXACT	   *pgxacts;
+	TransactionId *subxids;
+	char	   *fpPtr;
 	int			i,
 				j;
 	bool		found;
@@ -215,6 +244,28 @@ InitProcGlobal(void)
 	MemSet(pgxacts, 0, TotalProcs * sizeof(PGXACT));
 	ProcGlobal->allPgXact = pgxacts;
 
+	/*
+	 * And the subtransaction XID caches, whose size is set by
+	 * max_cached_subxids.  They're only read when a transaction has
+	 * subtransactions, so keeping them out of PGPROC costs nothing.
+	 */
+	subxids = (TransactionId *)
+		ShmemAlloc(mul_size(TotalProcs,
+							mul_size(max_cached_subxids,
+									 sizeof(TransactionId))));
+	if (!subxids)
+		ereport(FATAL,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of shared memory")));
+
+	/* And the fast-path lock arrays, sized by FastPathLockGroupsPerBackend */
+	fpPtr = ShmemAlloc(mul_size(TotalProcs, FastPathLockShmemSize()));
+	if (!fpPtr)
+		ereport(FATAL,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of shared memory")));
+	MemSet(fpPtr, 0, TotalProcs * FastPathLockShmemSize());
+
 	for (i = 0; i < TotalProcs; i++)
 	{
 		/* Common initialization for all PGPROCs, regardless of type. */
@@ -231,6 +282,11 @@ InitProcGlobal(void)
 			LWLockInitialize(&(procs[i].backendLock), LWTRANCHE_PROC);
 		}
 		procs[i].pgprocno = i;
+		procs[i].subxids.xids = subxids + (Size) i * max_cached_subxids;
+		procs[i].fpLockBits = (uint64 *) fpPtr;
+		procs[i].fpRelId = (Oid *)
+			(fpPtr + MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64)));
+		fpPtr += FastPathLockShmemSize();
 
 		/*
 		 * Newly created PGPROCs for normal backends, autovacuum and bgworkers
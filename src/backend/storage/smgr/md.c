@@ -279,9 +279,14 @@ mdexists(SMgrRelation reln, ForkNumber forkNum)
 {
 	/*
 	 * Close it first, to ensure that we notice if the fork has been unlinked
-	 * since we opened it.
+	 * since we opened it.  As an optimization, we can skip that in recovery,
+	 * where every redo routine that removes relation files closes them
+	 * first: dropped relations are closed by xact_redo, and dbase_redo and
+	 * tblspc_redo close all files before removing directories.  The WAL
+	 * prefetcher checks for existence once per block, so this matters.
 	 */
-	mdclose(reln, forkNum);
+	if (!InRecovery)
+		mdclose(reln, forkNum);
 
 	return (mdopen(reln, forkNum, EXTENSION_RETURN_NULL) != NULL);
 }
@@ -650,22 +655,41 @@ mdclose(SMgrRelation reln, ForkNumber forknum)
 }
 
 /*
- *	mdprefetch() -- Initiate asynchronous read of the specified block of a relation
+ *	mdprefetch() -- Initiate asynchronous read of the specified blocks of a relation
+ *
+ * This accepts a range of blocks because the kernel can read several
+ * adjacent pages with a single request much more efficiently.
  */
 void
-mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
+mdprefetch(SMgrRelation reln, ForkNumber forknum,
+		   BlockNumber blocknum, BlockNumber nblocks)
 {
 #ifdef USE_PREFETCH
-	off_t		seekpos;
-	MdfdVec    *v;
+	/*
+	 * Issue prefetch requests in as few requests as possible; have to split
+	 * at segment boundaries though, since those are actually separate files.
+	 */
+	while (nblocks > 0)
+	{
+		BlockNumber nfetch = nblocks;
+		off_t		seekpos;
+		MdfdVec    *v;
 
-	v = _mdfd_getseg(reln, forknum, blocknum, false, EXTENSION_FAIL);
+		v = _mdfd_getseg(reln, forknum, blocknum, false, EXTENSION_FAIL);
 
-	seekpos = (off_t) BLCKSZ *(blocknum % ((BlockNumber) RELSEG_SIZE));
+		/* stop at the end of the current segment */
+		if (blocknum % ((BlockNumber) RELSEG_SIZE) + nfetch > RELSEG_SIZE)
+			nfetch = RELSEG_SIZE - (blocknum % ((BlockNumber) RELSEG_SIZE));
 
-	Assert(seekpos < (off_t) BLCKSZ * RELSEG_SIZE);
+		seekpos = (off_t) BLCKSZ *(blocknum % ((BlockNumber) RELSEG_SIZE));
 
-	(void) FilePrefetch(v->mdfd_vfd, seekpos, BLCKSZ);
+		Assert(seekpos < (off_t) BLCKSZ * RELSEG_SIZE);
+
+		(void) FilePrefetch(v->mdfd_vfd, seekpos, (int) (BLCKSZ * nfetch));
+
+		nblocks -= nfetch;
+		blocknum += nfetch;
+	}
 #endif   /* USE_PREFETCH */
 }
 
@@ -1550,6 +1550,10 @@ ProcessUtilitySlow(Node *parsetree,
 				address = CreateAccessMethod((CreateAmStmt *) parsetree);
 				break;
 
+			case T_CreateStatsStmt:		/* CREATE STATISTICS */
+				address = CreateStatistics((CreateStatsStmt *) parsetree);
+				break;
+
 			default:
 				elog(ERROR, "unrecognized node type: %d",
 					 (int) nodeTag(parsetree));
@@ -2127,6 +2131,9 @@ CreateCommandTag(Node *parsetree)
 				case OBJECT_CONVERSION:
 					tag = "DROP CONVERSION";
 					break;
+				case OBJECT_STATISTIC_EXT:
+					tag = "DROP STATISTICS";
+					break;
 				case OBJECT_SCHEMA:
 					tag = "DROP SCHEMA";
 					break;
@@ -2563,6 +2570,10 @@ CreateCommandTag(Node *parsetree)
 			tag = "CREATE ACCESS METHOD";
 			break;
 
+		case T_CreateStatsStmt:
+			tag = "CREATE STATISTICS";
+			break;
+
 		case T_PrepareStmt:
 			tag = "PREPARE";
 			break;
@@ -3132,6 +3143,10 @@ GetCommandLogLevel(Node *parsetree)
 			lev = LOGSTMT_DDL;
 			break;
 
+		case T_CreateStatsStmt:
+			lev = LOGSTMT_DDL;
+			break;
+
 			/* already-planned queries */
 		case T_PlannedStmt:
 			{
@@ -605,6 +605,113 @@ array_agg_finalfn(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(result);
 }
 
+/*
+ * array_agg_combine
+ *		Aggregate combine function for array_agg(anynonarray).
+ *
+ * The elements of state2 are appended to those of state1.
+ */
+Datum
+array_agg_combine(PG_FUNCTION_ARGS)
+{
+	ArrayBuildState *state1;
+	ArrayBuildState *state2;
+	MemoryContext agg_context;
+	int			i;
+
+	if (!AggCheckCallContext(fcinfo, &agg_context))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	state1 = PG_ARGISNULL(0) ? NULL : (ArrayBuildState *) PG_GETARG_POINTER(0);
+	state2 = PG_ARGISNULL(1) ? NULL : (ArrayBuildState *) PG_GETARG_POINTER(1);
+
+	if (state2 == NULL)
+		PG_RETURN_POINTER(state1);
+
+	/* state2 may not live in the aggregate context, so copy it */
+	if (state1 == NULL)
+		state1 = initArrayResult(state2->element_type, agg_context, false);
+
+	for (i = 0; i < state2->nelems; i++)
+		state1 = accumArrayResult(state1,
+								  state2->dvalues[i],
+								  state2->dnulls[i],
+								  state2->element_type,
+								  agg_context);
+
+	PG_RETURN_POINTER(state1);
+}
+
+/*
+ * array_agg_serialize
+ *		Serialize ArrayBuildState into bytea for array_agg(anynonarray).
+ *
+ * The serialized form is simply the array built from the elements seen so
+ * far, in internal format.  That's only good for passing the state between
+ * backends of the same server, which is all that parallel aggregation needs.
+ * (The planner doesn't use serialization for aggregates over anonymous
+ * record types, whose typmods are backend-local.)
+ */
+Datum
+array_agg_serialize(PG_FUNCTION_ARGS)
+{
+	ArrayBuildState *state;
+	int			dims[1];
+	int			lbs[1];
+
+	/* Ensure we disallow calling when not in aggregate context */
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	state = (ArrayBuildState *) PG_GETARG_POINTER(0);
+
+	dims[0] = state->nelems;
+	lbs[0] = 1;
+
+	/* As in array_agg_finalfn, the state must not be released */
+	PG_RETURN_DATUM(makeMdArrayResult(state, 1, dims, lbs,
+									  CurrentMemoryContext,
+									  false));
+}
+
+/*
+ * array_agg_deserialize
+ *		Deserialize bytea into ArrayBuildState for array_agg(anynonarray).
+ */
+Datum
+array_agg_deserialize(PG_FUNCTION_ARGS)
+{
+	ArrayType  *array;
+	ArrayBuildState *result;
+	Oid			element_type;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *values;
+	bool	   *nulls;
+	int			nelems;
+	int			i;
+
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	/* copy, since element data may need stricter alignment than bytea's */
+	array = (ArrayType *) PG_GETARG_BYTEA_P_COPY(0);
+	element_type = ARR_ELEMTYPE(array);
+
+	get_typlenbyvalalign(element_type, &typlen, &typbyval, &typalign);
+	deconstruct_array(array, element_type, typlen, typbyval, typalign,
+					  &values, &nulls, &nelems);
+
+	result = initArrayResult(element_type, CurrentMemoryContext, false);
+
+	for (i = 0; i < nelems; i++)
+		result = accumArrayResult(result, values[i], nulls[i],
+								  element_type, CurrentMemoryContext);
+
+	PG_RETURN_POINTER(result);
+}
+
 /*
  * ARRAY_AGG(anyarray) aggregate function
  */
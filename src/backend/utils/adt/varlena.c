@@ -458,15 +458,26 @@ bytea_string_agg_transfn(PG_FUNCTION_ARGS)
 	if (!PG_ARGISNULL(1))
 	{
 		bytea	   *value = PG_GETARG_BYTEA_PP(1);
+		bool		isfirst = false;
 
-		/* On the first time through, we ignore the delimiter. */
+		/*
+		 * We always append the delimiter, so that combining states doesn't
+		 * lose it; on the first time through, remember its length so the
+		 * final function can skip it.
+		 */
 		if (state == NULL)
+		{
 			state = makeStringAggState(fcinfo);
-		else if (!PG_ARGISNULL(2))
+			isfirst = true;
+		}
+
+		if (!PG_ARGISNULL(2))
 		{
 			bytea	   *delim = PG_GETARG_BYTEA_PP(2);
 
 			appendBinaryStringInfo(state, VARDATA_ANY(delim), VARSIZE_ANY_EXHDR(delim));
+			if (isfirst)
+				state->cursor = VARSIZE_ANY_EXHDR(delim);
 		}
 
 		appendBinaryStringInfo(state, VARDATA_ANY(value), VARSIZE_ANY_EXHDR(value));
@@ -491,11 +502,13 @@ bytea_string_agg_finalfn(PG_FUNCTION_ARGS)
 
 	if (state != NULL)
 	{
+		/* As in string_agg_finalfn, skip the first delimiter */
+		int			len = state->len - state->cursor;
 		bytea	   *result;
 
-		result = (bytea *) palloc(state->len + VARHDRSZ);
-		SET_VARSIZE(result, state->len + VARHDRSZ);
-		memcpy(VARDATA(result), state->data, state->len);
+		result = (bytea *) palloc(len + VARHDRSZ);
+		SET_VARSIZE(result, len + VARHDRSZ);
+		memcpy(VARDATA(result), state->data + state->cursor, len);
 		PG_RETURN_BYTEA_P(result);
 	}
 	else
@@ -4516,9 +4529,11 @@ pg_column_size(PG_FUNCTION_ARGS)
  *
  * Syntax: string_agg(value text, delimiter text) RETURNS text
  *
- * Note: Any NULL values are ignored. The first-call delimiter isn't
- * actually used at all, and on subsequent calls the delimiter precedes
- * the associated value.
+ * Note: Any NULL values are ignored.  The delimiter precedes each
+ * associated value, including the first one; the state's cursor field holds
+ * the length of that first delimiter, which the final function skips.
+ * Keeping it in the state lets string_agg_combine concatenate partial
+ * states without having to know the delimiter.
  */
 
 /* subroutine to initialize state */
@@ -4556,11 +4571,22 @@ string_agg_transfn(PG_FUNCTION_ARGS)
 	/* Append the value unless null. */
 	if (!PG_ARGISNULL(1))
 	{
-		/* On the first time through, we ignore the delimiter. */
+		bool		isfirst = false;
+
 		if (state == NULL)
+		{
 			state = makeStringAggState(fcinfo);
-		else if (!PG_ARGISNULL(2))
-			appendStringInfoText(state, PG_GETARG_TEXT_PP(2));	/* delimiter */
+			isfirst = true;
+		}
+
+		if (!PG_ARGISNULL(2))
+		{
+			text	   *delim = PG_GETARG_TEXT_PP(2);
+
+			appendStringInfoText(state, delim);		/* delimiter */
+			if (isfirst)
+				state->cursor = VARSIZE_ANY_EXHDR(delim);
+		}
 
 		appendStringInfoText(state, PG_GETARG_TEXT_PP(1));		/* value */
 	}
@@ -4583,11 +4609,118 @@ string_agg_finalfn(PG_FUNCTION_ARGS)
 	state = PG_ARGISNULL(0) ? NULL : (StringInfo) PG_GETARG_POINTER(0);
 
 	if (state != NULL)
-		PG_RETURN_TEXT_P(cstring_to_text_with_len(state->data, state->len));
+	{
+		/* Skip the delimiter preceding the first value */
+		PG_RETURN_TEXT_P(cstring_to_text_with_len(state->data + state->cursor,
+												  state->len - state->cursor));
+	}
 	else
 		PG_RETURN_NULL();
 }
 
+/*
+ * string_agg_combine
+ *		Aggregate combine function for string_agg(text) and
+ *		string_agg(bytea).
+ *
+ * Since each state starts with the delimiter of its first value, combining
+ * is just concatenation; state1's cursor stays as it is.
+ */
+Datum
+string_agg_combine(PG_FUNCTION_ARGS)
+{
+	StringInfo	state1;
+	StringInfo	state2;
+	MemoryContext agg_context;
+
+	if (!AggCheckCallContext(fcinfo, &agg_context))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	state1 = PG_ARGISNULL(0) ? NULL : (StringInfo) PG_GETARG_POINTER(0);
+	state2 = PG_ARGISNULL(1) ? NULL : (StringInfo) PG_GETARG_POINTER(1);
+
+	if (state2 == NULL)
+		PG_RETURN_POINTER(state1);
+
+	if (state1 == NULL)
+	{
+		/* state2 may not live in the aggregate context, so copy it */
+		state1 = makeStringAggState(fcinfo);
+		state1->cursor = state2->cursor;
+	}
+
+	appendBinaryStringInfo(state1, state2->data, state2->len);
+
+	PG_RETURN_POINTER(state1);
+}
+
+/*
+ * string_agg_serialize
+ *		Serialize the StringInfo state of string_agg(text) and
+ *		string_agg(bytea) into bytea.
+ */
+Datum
+string_agg_serialize(PG_FUNCTION_ARGS)
+{
+	StringInfo	state;
+	StringInfoData buf;
+
+	/* Ensure we disallow calling when not in aggregate context */
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	state = (StringInfo) PG_GETARG_POINTER(0);
+
+	pq_begintypsend(&buf);
+
+	/* cursor */
+	pq_sendint(&buf, state->cursor, 4);
+
+	/* data */
+	pq_sendbytes(&buf, state->data, state->len);
+
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * string_agg_deserialize
+ *		Deserialize bytea into the StringInfo state of string_agg(text) and
+ *		string_agg(bytea).
+ */
+Datum
+string_agg_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea	   *sstate;
+	StringInfo	result;
+	StringInfoData buf;
+	int			cursor;
+
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	sstate = PG_GETARG_BYTEA_P(0);
+
+	/*
+	 * Copy the bytea into a StringInfo so that we can "receive" it using the
+	 * standard recv-function infrastructure.
+	 */
+	initStringInfo(&buf);
+	appendBinaryStringInfo(&buf, VARDATA(sstate), VARSIZE(sstate) - VARHDRSZ);
+
+	/* cursor */
+	cursor = pq_getmsgint(&buf, 4);
+
+	/* data */
+	result = makeStringInfo();
+	appendBinaryStringInfo(result, buf.data + buf.cursor,
+						   buf.len - buf.cursor);
+	result->cursor = cursor;
+
+	pfree(buf.data);
+
+	PG_RETURN_POINTER(result);
+}
+
 /*
  * Implementation of both concat() and concat_ws().
  *
@@ -27,6 +27,11 @@
  * query to change output tupdesc on replan --- if so, it's up to the
  * caller to notice changes and cope with them.
  *
+ * Generic plans can optionally be shared with other backends through the
+ * shared-memory cache in sharedplancache.c: a backend that has no generic
+ * plan of its own first looks there before planning, and publishes any
+ * generic plan it does build.
+ *
  * Currently, we track exactly the dependencies of plans on relations and
  * user-defined functions.  On relcache invalidation events or pg_proc
  * syscache invalidation events, we invalidate just those plans that depend
@@ -68,6 +73,7 @@
 #include "utils/memutils.h"
 #include "utils/resowner_private.h"
 #include "utils/rls.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
 
@@ -88,7 +94,23 @@
  */
 static CachedPlanSource *first_saved_plan = NULL;
 
+/*
+ * Lookup table from the PlannedStmts of saved generic plans to the plans
+ * they belong to, so that PlanCacheNoteMisestimate needn't search the list
+ * of saved CachedPlanSources.  It is created on first use.
+ */
+typedef struct GenericPlanStmtEntry
+{
+	PlannedStmt *stmt;			/* hash key --- MUST BE FIRST */
+	CachedPlan *plan;			/* generic plan containing stmt */
+} GenericPlanStmtEntry;
+
+static HTAB *generic_plan_stmts = NULL;
+
 static void ReleaseGenericPlan(CachedPlanSource *plansource);
+static void RememberGenericPlanStmts(CachedPlan *plan);
+static void ForgetGenericPlanStmts(CachedPlan *plan);
+static void AdoptSharedGenericPlan(CachedPlanSource *plansource);
 static List *RevalidateCachedQuery(CachedPlanSource *plansource);
 static bool CheckCachedPlan(CachedPlanSource *plansource);
 static CachedPlan *BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
@@ -193,6 +215,8 @@ CreateCachedPlan(Node *raw_parse_tree,
 	plansource->invalItems = NIL;
 	plansource->search_path = NULL;
 	plansource->query_context = NULL;
+	plansource->shared_key = NULL;
+	plansource->shared_key_valid = false;
 	plansource->rewriteRoleId = InvalidOid;
 	plansource->rewriteRowSecurity = false;
 	plansource->dependsOnRLS = false;
@@ -533,11 +557,115 @@ ReleaseGenericPlan(CachedPlanSource *plansource)
 		CachedPlan *plan = plansource->gplan;
 
 		Assert(plan->magic == CACHEDPLAN_MAGIC);
+		ForgetGenericPlanStmts(plan);
 		plansource->gplan = NULL;
 		ReleaseCachedPlan(plan, false);
 	}
 }
 
+/*
+ * RememberGenericPlanStmts: enter a saved generic plan's PlannedStmts into
+ * the lookup table used by PlanCacheNoteMisestimate.
+ */
+static void
+RememberGenericPlanStmts(CachedPlan *plan)
+{
+	ListCell   *lc;
+
+	if (generic_plan_stmts == NULL)
+	{
+		HASHCTL		ctl;
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(PlannedStmt *);
+		ctl.entrysize = sizeof(GenericPlanStmtEntry);
+		ctl.hcxt = CacheMemoryContext;
+		generic_plan_stmts = hash_create("Generic plan statements", 256,
+										 &ctl,
+										 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
+	foreach(lc, plan->stmt_list)
+	{
+		PlannedStmt *stmt = (PlannedStmt *) lfirst(lc);
+		GenericPlanStmtEntry *entry;
+
+		if (!IsA(stmt, PlannedStmt))
+			continue;
+		entry = (GenericPlanStmtEntry *) hash_search(generic_plan_stmts,
+													 &stmt, HASH_ENTER,
+													 NULL);
+		entry->plan = plan;
+	}
+}
+
+/*
+ * ForgetGenericPlanStmts: remove a generic plan's PlannedStmts from the
+ * lookup table, if they are there.
+ */
+static void
+ForgetGenericPlanStmts(CachedPlan *plan)
+{
+	ListCell   *lc;
+
+	if (generic_plan_stmts == NULL)
+		return;
+
+	foreach(lc, plan->stmt_list)
+	{
+		PlannedStmt *stmt = (PlannedStmt *) lfirst(lc);
+
+		if (IsA(stmt, PlannedStmt))
+			hash_search(generic_plan_stmts, &stmt, HASH_REMOVE, NULL);
+	}
+}
+
+/*
+ * AdoptSharedGenericPlan: link in a generic plan from the shared plan cache
+ *
+ * If another backend has published a generic plan for this statement, make
+ * it our generic plan, and take over the publisher's custom-plan statistics
+ * if they are more complete than ours, so that choose_custom_plan can make
+ * its decision without repeating the publisher's experiments.  The plan's
+ * validity is checked by CheckCachedPlan as usual when it is used.
+ */
+static void
+AdoptSharedGenericPlan(CachedPlanSource *plansource)
+{
+	CachedPlan *plan;
+	double		total_custom_cost;
+	int			num_custom_plans;
+
+	Assert(plansource->gplan == NULL);
+
+	plan = SharedPlanCacheFetch(plansource, &total_custom_cost,
+								&num_custom_plans);
+	if (plan == NULL)
+		return;
+
+	plansource->gplan = plan;
+	plan->refcount++;
+	MemoryContextSetParent(plan->context, CacheMemoryContext);
+	plan->is_saved = true;
+	RememberGenericPlanStmts(plan);
+	plansource->generic_cost = cached_plan_cost(plan, false);
+
+	if (num_custom_plans > plansource->num_custom_plans)
+	{
+		plansource->total_custom_cost = total_custom_cost;
+		plansource->num_custom_plans = num_custom_plans;
+	}
+
+	/*
+	 * The plan was current when we found it, but an invalidation may have
+	 * been sent since.  Now that the plan is linked in, absorb any such
+	 * messages, so that our callbacks mark it invalid if need be.  We might
+	 * already hold all the locks CheckCachedPlan takes, in which case it
+	 * would not do this for us.
+	 */
+	AcceptInvalidationMessages();
+}
+
 /*
  * RevalidateCachedQuery: ensure validity of analyzed-and-rewritten query tree.
  *
@@ -635,6 +763,8 @@ RevalidateCachedQuery(CachedPlanSource *plansource)
 	plansource->relationOids = NIL;
 	plansource->invalItems = NIL;
 	plansource->search_path = NULL;
+	plansource->shared_key = NULL;
+	plansource->shared_key_valid = false;
 
 	/*
 	 * Free the query_context.  We don't really expect MemoryContextDelete to
@@ -1009,6 +1139,7 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 	plan->is_oneshot = plansource->is_oneshot;
 	plan->is_saved = false;
 	plan->is_valid = true;
+	plan->misestimated = false;
 
 	/* assign generation number to new plan */
 	plan->generation = ++(plansource->generation);
@@ -1045,6 +1176,16 @@ choose_custom_plan(CachedPlanSource *plansource, ParamListInfo boundParams)
 	if (plansource->cursor_options & CURSOR_OPT_CUSTOM_PLAN)
 		return true;
 
+	/*
+	 * Don't keep using a generic plan whose row estimates have turned out to
+	 * be badly wrong at execution time; a custom plan at least gets to see
+	 * the actual parameter values.  The generic plan gets another chance
+	 * once it has been invalidated and rebuilt, eg after an ANALYZE.
+	 */
+	if (plansource->gplan && plansource->gplan->is_valid &&
+		plansource->gplan->misestimated)
+		return true;
+
 	/* Generate custom plans until we have done at least 5 (arbitrary) */
 	if (plansource->num_custom_plans < 5)
 		return true;
@@ -1146,6 +1287,7 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 	CachedPlan *plan = NULL;
 	List	   *qlist;
 	bool		customplan;
+	uint32		generation;
 
 	/* Assert caller is doing things in a sane order */
 	Assert(plansource->magic == CACHEDPLANSOURCE_MAGIC);
@@ -1157,6 +1299,11 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 	/* Make sure the querytree list is valid and we have parse-time locks */
 	qlist = RevalidateCachedQuery(plansource);
 
+	/* If we have no generic plan, maybe another backend has one to share */
+	if (plansource->gplan == NULL && plansource->is_saved &&
+		shared_plan_cache_size > 0)
+		AdoptSharedGenericPlan(plansource);
+
 	/* Decide whether to use a custom plan */
 	customplan = choose_custom_plan(plansource, boundParams);
 
@@ -1171,6 +1318,7 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 		else
 		{
 			/* Build a new generic plan */
+			generation = SharedPlanCacheBeginPlan();
 			plan = BuildCachedPlan(plansource, qlist, NULL);
 			/* Just make real sure plansource->gplan is clear */
 			ReleaseGenericPlan(plansource);
@@ -1183,6 +1331,7 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 				/* saved plans all live under CacheMemoryContext */
 				MemoryContextSetParent(plan->context, CacheMemoryContext);
 				plan->is_saved = true;
+				RememberGenericPlanStmts(plan);
 			}
 			else
 			{
@@ -1204,6 +1353,10 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 			 */
 			customplan = choose_custom_plan(plansource, boundParams);
 
+			/* Offer the new generic plan to other backends */
+			if (plansource->is_saved)
+				SharedPlanCacheStore(plansource, plan, generation);
+
 			/*
 			 * If we choose to plan again, we need to re-copy the query_list,
 			 * since the planner probably scribbled on it.  We can force
@@ -1282,6 +1435,33 @@ ReleaseCachedPlan(CachedPlan *plan, bool useResOwner)
 	}
 }
 
+/*
+ * PlanCacheNoteMisestimate: report that executing the given statement showed
+ * row counts far from the planner's estimates
+ *
+ * If the statement belongs to the generic plan of a saved CachedPlanSource,
+ * mark that plan so that choose_custom_plan stops selecting it.  Statements
+ * from anywhere else (custom or one-shot plans, unsaved plans, plain queries)
+ * will be planned afresh next time anyway, so we needn't do anything for
+ * them.
+ */
+void
+PlanCacheNoteMisestimate(PlannedStmt *stmt)
+{
+	GenericPlanStmtEntry *entry;
+
+	if (generic_plan_stmts == NULL)
+		return;
+
+	entry = (GenericPlanStmtEntry *) hash_search(generic_plan_stmts,
+												 &stmt, HASH_FIND, NULL);
+	if (entry != NULL && entry->plan->is_valid)
+	{
+		Assert(entry->plan->magic == CACHEDPLAN_MAGIC);
+		entry->plan->misestimated = true;
+	}
+}
+
 /*
  * CachedPlanSetParentContext: move a CachedPlanSource to a new memory context
  *
@@ -1385,6 +1565,8 @@ CopyCachedPlan(CachedPlanSource *plansource)
 	if (plansource->search_path)
 		newsource->search_path = CopyOverrideSearchPath(plansource->search_path);
 	newsource->query_context = querytree_context;
+	newsource->shared_key = NULL;
+	newsource->shared_key_valid = false;
 	newsource->rewriteRoleId = plansource->rewriteRoleId;
 	newsource->rewriteRowSecurity = plansource->rewriteRowSecurity;
 	newsource->dependsOnRLS = plansource->dependsOnRLS;
@@ -0,0 +1,837 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.c
+ *	  Shared-memory cache of generic plans.
+ *
+ * When shared_plan_cache_size is nonzero, generic plans built by
+ * GetCachedPlan are published in shared memory in serialized (nodeToString)
+ * form, so that other backends preparing the same statement can read the
+ * plan back with stringToNode instead of planning it themselves.  Each
+ * backend still executes from its own private copy of the plan tree; what
+ * is shared is the planning work, plus the custom-vs-generic cost statistics
+ * that choose_custom_plan would otherwise have to rediscover in every
+ * session.
+ *
+ * Entries are looked up by a key string built from the query's source text,
+ * the parameter types, the cursor options, the search_path that was used for
+ * parse analysis, and the analyzed-and-rewritten query tree itself.  The
+ * last item makes the key robust against anything else that can change the
+ * result of parse analysis (for instance, different objects being visible
+ * under the same search_path); since it is produced by the same
+ * deterministic code in every backend, identical statements still match.
+ * The key string is hashed into a dynahash table, and the full key is stored
+ * alongside the plan so that hash collisions are detected on lookup.  Since
+ * building the key means serializing the query tree, it is built only once
+ * per analyzed query tree and remembered in the CachedPlanSource.
+ *
+ * Key strings and plan strings live in a fixed-size byte arena that is
+ * filled as a ring buffer: when the write position wraps around, entries
+ * whose storage would be overwritten are evicted.  This is crude compared
+ * to LRU, but it needs no per-access bookkeeping, and hot statements are
+ * simply republished the next time some backend replans them.
+ *
+ * Invalidation is done by the backend that sends the sinval messages, right
+ * after it has queued them (see SendSharedInvalidMessages), rather than by
+ * every backend as it reads them: a backend that starts after the messages
+ * were sent never reads them, and so could otherwise find a stale plan that
+ * nobody has removed yet.  Each entry records the relations and syscache
+ * entries it depends on, and a small array of counters indexed by a hash of
+ * the dependency tells whether any entry depends on a given object at all,
+ * so that the common case of an invalidation that no shared plan cares about
+ * doesn't have to scan the table.
+ *
+ * That alone would still let a backend that planned before the messages
+ * went out publish its plan after the purge.  To close that window, the
+ * sender also advances a generation counter before purging.  A backend
+ * reads the counter before it absorbs pending invalidations and starts
+ * planning, and publishes the plan only if the counter is unchanged when
+ * it holds the lock to insert the entry; an unchanged counter means either
+ * that no relevant invalidation was sent meanwhile, or that its purge has
+ * not yet run and will find the new entry.  Thus every entry present in the
+ * table is as new as the latest invalidation sent.  Backends that adopt a
+ * shared plan link it in as their generic plan and then absorb pending
+ * invalidations themselves, so the plan is discarded as usual if the
+ * invalidation arrived after the lookup.
+ *
+ * Plans are only shared when they are plainly independent of the session
+ * that built them: statements touching temporary relations, statements whose
+ * rewrite or plan depends on the current role (row-level security),
+ * transient plans, and plans built by a transaction that may have changed
+ * the catalogs itself are never published.
+ *
+ *
+ * Portions Copyright (c) 1996-2016, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedplancache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/transam.h"
+#include "access/xact.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_amop.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_foreign_data_wrapper.h"
+#include "catalog/pg_foreign_server.h"
+#include "catalog/pg_namespace.h"
+#include "catalog/pg_operator.h"
+#include "catalog/pg_proc.h"
+#include "catalog/pg_type.h"
+#include "lib/stringinfo.h"
+#include "miscadmin.h"
+#include "nodes/parsenodes.h"
+#include "nodes/plannodes.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/sharedplancache.h"
+#include "utils/syscache.h"
+
+
+/* GUC variable: size of the shared plan arena in kilobytes; 0 disables */
+int			shared_plan_cache_size = 0;
+
+/*
+ * Rough guess at the average serialized size of an entry, used to size the
+ * hash table.  If the guess is too low we merely fail to publish plans once
+ * the table is full; if too high, some arena space goes unused.
+ */
+#define SHARED_PLAN_AVG_ENTRY_SIZE	4096
+
+/* Don't let a single plan take more than this fraction of the arena */
+#define SHARED_PLAN_MAX_FRACTION	4
+
+/* Number of dependency counters; see shared_plan_dep_slot */
+#define SHARED_PLAN_DEP_SLOTS		4096
+
+/*
+ * Dependencies are identified by a syscache ID and hash value, as in
+ * PlanInvalItems, or by one of these pseudo cache IDs.
+ */
+#define SHARED_PLAN_DEP_REL			(-1)	/* value is a relation OID */
+#define SHARED_PLAN_DEP_ALL			(-2)	/* every plan of the database */
+
+typedef struct SharedPlanKey
+{
+	Oid			dbid;			/* database the statement was planned in */
+	uint32		hashvalue;		/* hash of the key string */
+} SharedPlanKey;
+
+/*
+ * Hash table entry.  The variable-length data lives in the arena, laid out
+ * as: nrels relation OIDs, ninvals (cacheId, hashValue) pairs, the key
+ * string (keylen bytes plus a terminating zero), and the plan string.
+ * Besides the PlanInvalItems of the plan, the inval pairs include the
+ * search_path schemas, as NAMESPACEOID items.
+ */
+typedef struct SharedPlanEntry
+{
+	SharedPlanKey key;			/* hash key --- MUST BE FIRST */
+	Size		offset;			/* start of data in arena */
+	Size		len;			/* total length of data in arena */
+	int			nrels;			/* number of relation OIDs */
+	int			ninvals;		/* number of inval items */
+	Size		keylen;			/* length of key string */
+	double		total_custom_cost;		/* publisher's custom plan stats */
+	int			num_custom_plans;
+} SharedPlanEntry;
+
+/*
+ * Shared state.  All fields but generation are protected by
+ * SharedPlanCacheLock.
+ */
+typedef struct SharedPlanCacheHeader
+{
+	pg_atomic_uint32 generation;	/* advanced by relevant invalidations */
+	Size		arena_size;		/* size of the arena */
+	Size		write_pos;		/* next position to write at */
+	uint32		depcounts[SHARED_PLAN_DEP_SLOTS];	/* entries per dep slot */
+	char		arena[FLEXIBLE_ARRAY_MEMBER];
+} SharedPlanCacheHeader;
+
+static SharedPlanCacheHeader *SharedPlanCache = NULL;
+static HTAB *SharedPlanHash = NULL;
+
+
+static long
+shared_plan_max_entries(void)
+{
+	return Max((long) shared_plan_cache_size * 1024L /
+			   SHARED_PLAN_AVG_ENTRY_SIZE, 16);
+}
+
+/*
+ * Report shared-memory space needed by SharedPlanCacheShmemInit
+ */
+Size
+SharedPlanCacheShmemSize(void)
+{
+	Size		size;
+
+	if (shared_plan_cache_size <= 0)
+		return 0;
+
+	size = offsetof(SharedPlanCacheHeader, arena);
+	size = add_size(size, mul_size(shared_plan_cache_size, 1024));
+	size = add_size(size, hash_estimate_size(shared_plan_max_entries(),
+											 sizeof(SharedPlanEntry)));
+	return size;
+}
+
+/*
+ * Allocate and initialize the shared plan cache, if enabled
+ */
+void
+SharedPlanCacheShmemInit(void)
+{
+	HASHCTL		info;
+	Size		arena_size;
+	bool		found;
+
+	if (shared_plan_cache_size <= 0)
+		return;
+
+	arena_size = mul_size(shared_plan_cache_size, 1024);
+	SharedPlanCache = (SharedPlanCacheHeader *)
+		ShmemInitStruct("Shared Plan Cache",
+						add_size(offsetof(SharedPlanCacheHeader, arena),
+								 arena_size),
+						&found);
+	if (!found)
+	{
+		pg_atomic_init_u32(&SharedPlanCache->generation, 0);
+		SharedPlanCache->arena_size = arena_size;
+		SharedPlanCache->write_pos = 0;
+		MemSet(SharedPlanCache->depcounts, 0,
+			   sizeof(SharedPlanCache->depcounts));
+	}
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(SharedPlanKey);
+	info.entrysize = sizeof(SharedPlanEntry);
+	SharedPlanHash = ShmemInitHash("Shared Plan Cache Hash",
+								   shared_plan_max_entries(),
+								   shared_plan_max_entries(),
+								   &info,
+								   HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * Build the lookup key string for a CachedPlanSource's current query tree,
+ * or return NULL if the statement is not eligible for sharing.  The string
+ * is allocated in the plansource's query_context.
+ */
+static char *
+shared_plan_key_string(CachedPlanSource *plansource)
+{
+	StringInfoData buf;
+	MemoryContext oldcxt;
+	char	   *querystr;
+	ListCell   *lc;
+	int			i;
+
+	if (plansource->dependsOnRLS)
+		return NULL;
+	if (plansource->cursor_options & CURSOR_OPT_CUSTOM_PLAN)
+		return NULL;
+	if (plansource->query_list == NIL || plansource->search_path == NULL)
+		return NULL;
+
+	/* The temp schema differs between sessions, so stay away from it */
+	if (plansource->search_path->addTemp)
+		return NULL;
+	foreach(lc, plansource->search_path->schemas)
+	{
+		if (isAnyTempNamespace(lfirst_oid(lc)))
+			return NULL;
+	}
+
+	foreach(lc, plansource->query_list)
+	{
+		Query	   *query = (Query *) lfirst(lc);
+
+		if (!IsA(query, Query) || query->commandType == CMD_UTILITY)
+			return NULL;
+	}
+
+	foreach(lc, plansource->relationOids)
+	{
+		if (get_rel_persistence(lfirst_oid(lc)) == RELPERSISTENCE_TEMP)
+			return NULL;
+	}
+
+	querystr = nodeToString(plansource->query_list);
+
+	oldcxt = MemoryContextSwitchTo(plansource->query_context);
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "%d %d", plansource->cursor_options,
+					 plansource->num_params);
+	for (i = 0; i < plansource->num_params; i++)
+		appendStringInfo(&buf, " %u", plansource->param_types[i]);
+	appendStringInfo(&buf, " %d", plansource->search_path->addCatalog);
+	foreach(lc, plansource->search_path->schemas)
+		appendStringInfo(&buf, " %u", lfirst_oid(lc));
+	appendStringInfoChar(&buf, '\n');
+	appendStringInfoString(&buf, plansource->query_string);
+	appendStringInfoChar(&buf, '\n');
+	appendStringInfoString(&buf, querystr);
+	MemoryContextSwitchTo(oldcxt);
+
+	pfree(querystr);
+
+	return buf.data;
+}
+
+/*
+ * Get the lookup key string for a CachedPlanSource, or NULL if the statement
+ * is not eligible for sharing.  The key is computed only once per analyzed
+ * query tree; RevalidateCachedQuery forgets it along with the query tree.
+ */
+static const char *
+shared_plan_key(CachedPlanSource *plansource)
+{
+	if (!plansource->is_saved || plansource->is_oneshot ||
+		!plansource->is_valid)
+		return NULL;
+
+	if (!plansource->shared_key_valid)
+	{
+		plansource->shared_key = shared_plan_key_string(plansource);
+		plansource->shared_key_valid = true;
+	}
+	return plansource->shared_key;
+}
+
+/*
+ * Map a dependency to its counter in SharedPlanCache->depcounts.
+ */
+static int
+shared_plan_dep_slot(int cacheid, uint32 value)
+{
+	uint32		h;
+
+	h = DatumGetUInt32(hash_uint32(value)) ^ (uint32) cacheid;
+	return (int) (h % SHARED_PLAN_DEP_SLOTS);
+}
+
+/*
+ * Add delta to the dependency counters of all of an entry's dependencies.
+ * Caller must hold SharedPlanCacheLock exclusively.
+ */
+static void
+shared_plan_count_deps(SharedPlanEntry *entry, int delta)
+{
+	char	   *data = SharedPlanCache->arena + entry->offset;
+	int			i;
+
+	for (i = 0; i < entry->nrels; i++)
+	{
+		Oid			relid;
+
+		memcpy(&relid, data, sizeof(Oid));
+		data += sizeof(Oid);
+		SharedPlanCache->depcounts[shared_plan_dep_slot(SHARED_PLAN_DEP_REL,
+														relid)] += delta;
+	}
+	for (i = 0; i < entry->ninvals; i++)
+	{
+		uint32		pair[2];
+
+		memcpy(pair, data, sizeof(pair));
+		data += sizeof(pair);
+		SharedPlanCache->depcounts[shared_plan_dep_slot((int) pair[0],
+														pair[1])] += delta;
+	}
+}
+
+/*
+ * Remove an entry from the table.
+ * Caller must hold SharedPlanCacheLock exclusively.
+ */
+static void
+shared_plan_remove_entry(SharedPlanEntry *entry)
+{
+	shared_plan_count_deps(entry, -1);
+	hash_search(SharedPlanHash, &entry->key, HASH_REMOVE, NULL);
+}
+
+/*
+ * SharedPlanCacheFetch: look for a published generic plan
+ *
+ * If one is found, it is returned as a new CachedPlan in a child context of
+ * CurrentMemoryContext, just as BuildCachedPlan would have made it, and the
+ * publisher's custom-plan statistics are returned in *total_custom_cost and
+ * *num_custom_plans.  Otherwise NULL is returned.
+ *
+ * The entry was current when we looked it up, since purges are done by the
+ * sender of an invalidation, right after sending it.  No heavyweight locks
+ * are acquired here, though; the caller must absorb invalidations sent
+ * since then, and check the plan's validity with the usual executor-lock
+ * protocol before using it.
+ */
+CachedPlan *
+SharedPlanCacheFetch(CachedPlanSource *plansource,
+					 double *total_custom_cost, int *num_custom_plans)
+{
+	const char *keystr;
+	Size		keylen;
+	SharedPlanKey key;
+	SharedPlanEntry *entry;
+	char	   *planstr = NULL;
+	CachedPlan *plan;
+	List	   *plist;
+	MemoryContext plan_context;
+	MemoryContext oldcxt;
+
+	if (SharedPlanCache == NULL)
+		return NULL;
+
+	keystr = shared_plan_key(plansource);
+	if (keystr == NULL)
+		return NULL;
+	keylen = strlen(keystr);
+
+	key.dbid = MyDatabaseId;
+	key.hashvalue = DatumGetUInt32(hash_any((const unsigned char *) keystr,
+											(int) keylen));
+
+	LWLockAcquire(SharedPlanCacheLock, LW_SHARED);
+	entry = (SharedPlanEntry *) hash_search(SharedPlanHash, &key,
+											HASH_FIND, NULL);
+	if (entry != NULL && entry->keylen == keylen)
+	{
+		char	   *data = SharedPlanCache->arena + entry->offset;
+		Size		keyoff;
+		Size		planoff;
+
+		keyoff = entry->nrels * sizeof(Oid) +
+			entry->ninvals * 2 * sizeof(uint32);
+		planoff = keyoff + keylen + 1;
+		if (memcmp(data + keyoff, keystr, keylen) == 0)
+		{
+			planstr = palloc(entry->len - planoff);
+			memcpy(planstr, data + planoff, entry->len - planoff);
+			*total_custom_cost = entry->total_custom_cost;
+			*num_custom_plans = entry->num_custom_plans;
+		}
+	}
+	LWLockRelease(SharedPlanCacheLock);
+
+	if (planstr == NULL)
+		return NULL;
+
+	/*
+	 * Rebuild the plan tree in a dedicated context, and fill in a CachedPlan
+	 * the same way BuildCachedPlan does for a generic plan.
+	 */
+	plan_context = AllocSetContextCreate(CurrentMemoryContext,
+										 "CachedPlan",
+										 ALLOCSET_START_SMALL_SIZES);
+	oldcxt = MemoryContextSwitchTo(plan_context);
+
+	plist = (List *) stringToNode(planstr);
+
+	plan = (CachedPlan *) palloc(sizeof(CachedPlan));
+	plan->magic = CACHEDPLAN_MAGIC;
+	plan->stmt_list = plist;
+	plan->planRoleId = GetUserId();
+	plan->dependsOnRole = false;
+	plan->saved_xmin = InvalidTransactionId;
+	plan->refcount = 0;
+	plan->context = plan_context;
+	plan->is_oneshot = false;
+	plan->is_saved = false;
+	plan->is_valid = true;
+	plan->misestimated = false;
+	plan->generation = ++(plansource->generation);
+
+	MemoryContextSwitchTo(oldcxt);
+	pfree(planstr);
+
+	return plan;
+}
+
+/*
+ * SharedPlanCacheBeginPlan: prepare to build a plan that may be published
+ *
+ * Returns the current invalidation generation, which must be passed to
+ * SharedPlanCacheStore.  Pending invalidation messages are absorbed after
+ * reading the counter, so that the plan will be built from catalog state at
+ * least as new as the last invalidation that advanced it.
+ */
+uint32
+SharedPlanCacheBeginPlan(void)
+{
+	uint32		generation;
+
+	if (SharedPlanCache == NULL)
+		return 0;
+
+	generation = pg_atomic_read_u32(&SharedPlanCache->generation);
+	/* the read must not move past the check for pending messages */
+	pg_memory_barrier();
+	AcceptInvalidationMessages();
+
+	return generation;
+}
+
+/*
+ * SharedPlanCacheStore: publish a freshly built generic plan
+ *
+ * generation is what SharedPlanCacheBeginPlan returned before planning
+ * started; if a relevant invalidation has been sent since then, the plan
+ * might be stale and is not published.  Plans that are not safe to use in
+ * other sessions are silently ignored, as are plans too large for the arena.
+ */
+void
+SharedPlanCacheStore(CachedPlanSource *plansource, CachedPlan *plan,
+					 uint32 generation)
+{
+	const char *keystr;
+	char	   *planstr;
+	Size		keylen;
+	Size		planlen;
+	Size		len;
+	Size		pos;
+	List	   *relids = NIL;
+	List	   *invals = NIL;
+	SharedPlanKey key;
+	SharedPlanEntry *entry;
+	HASH_SEQ_STATUS status;
+	SharedPlanEntry *other;
+	ListCell   *lc;
+	char	   *data;
+	bool		found;
+
+	if (SharedPlanCache == NULL)
+		return;
+
+	if (plan->dependsOnRole || TransactionIdIsValid(plan->saved_xmin))
+		return;
+
+	/*
+	 * A transaction that has written anything might have changed catalogs,
+	 * and built the plan from catalog state nobody else can see yet.
+	 */
+	if (TransactionIdIsValid(GetTopTransactionIdIfAny()))
+		return;
+	foreach(lc, plan->stmt_list)
+	{
+		PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
+
+		if (!IsA(plannedstmt, PlannedStmt) ||
+			plannedstmt->commandType == CMD_UTILITY ||
+			plannedstmt->utilityStmt != NULL)
+			return;
+		relids = list_concat_unique_oid(relids, plannedstmt->relationOids);
+		invals = list_concat(invals, list_copy(plannedstmt->invalItems));
+	}
+	relids = list_concat_unique_oid(relids, plansource->relationOids);
+	invals = list_concat(invals, list_copy(plansource->invalItems));
+
+	keystr = shared_plan_key(plansource);
+	if (keystr == NULL)
+		return;
+	keylen = strlen(keystr);
+
+	/* The search_path schemas are dependencies, too */
+	foreach(lc, plansource->search_path->schemas)
+	{
+		PlanInvalItem *item = makeNode(PlanInvalItem);
+
+		item->cacheId = NAMESPACEOID;
+		item->hashValue = GetSysCacheHashValue1(NAMESPACEOID,
+										   ObjectIdGetDatum(lfirst_oid(lc)));
+		invals = lappend(invals, item);
+	}
+
+	planstr = nodeToString(plan->stmt_list);
+	planlen = strlen(planstr);
+
+	len = list_length(relids) * sizeof(Oid) +
+		list_length(invals) * 2 * sizeof(uint32) +
+		keylen + 1 + planlen + 1;
+	if (len > SharedPlanCache->arena_size / SHARED_PLAN_MAX_FRACTION)
+		return;
+
+	key.dbid = MyDatabaseId;
+	key.hashvalue = DatumGetUInt32(hash_any((const unsigned char *) keystr,
+											(int) keylen));
+
+	LWLockAcquire(SharedPlanCacheLock, LW_EXCLUSIVE);
+
+	/*
+	 * If the generation has moved on, an invalidation was sent while we were
+	 * planning, and its purge may already be done.  We can't tell whether it
+	 * concerns this plan, so just don't publish it.
+	 */
+	if (pg_atomic_read_u32(&SharedPlanCache->generation) != generation)
+	{
+		LWLockRelease(SharedPlanCacheLock);
+		pfree(planstr);
+		return;
+	}
+
+	entry = (SharedPlanEntry *) hash_search(SharedPlanHash, &key,
+											HASH_ENTER_NULL, &found);
+	if (entry == NULL)
+	{
+		/* table is full; just don't publish this one */
+		LWLockRelease(SharedPlanCacheLock);
+		pfree(planstr);
+		return;
+	}
+
+	/* If we're replacing an existing entry, forget its dependencies */
+	if (found)
+		shared_plan_count_deps(entry, -1);
+
+	/* Find room, wrapping around and evicting whatever is in the way */
+	pos = SharedPlanCache->write_pos;
+	if (pos + len > SharedPlanCache->arena_size)
+		pos = 0;
+	hash_seq_init(&status, SharedPlanHash);
+	while ((other = (SharedPlanEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (other == entry)
+			continue;
+		if (other->offset < pos + len && pos < other->offset + other->len)
+			shared_plan_remove_entry(other);
+	}
+
+	data = SharedPlanCache->arena + pos;
+	foreach(lc, relids)
+	{
+		Oid			relid = lfirst_oid(lc);
+
+		memcpy(data, &relid, sizeof(Oid));
+		data += sizeof(Oid);
+	}
+	foreach(lc, invals)
+	{
+		PlanInvalItem *item = (PlanInvalItem *) lfirst(lc);
+		uint32		pair[2];
+
+		pair[0] = (uint32) item->cacheId;
+		pair[1] = item->hashValue;
+		memcpy(data, pair, sizeof(pair));
+		data += sizeof(pair);
+	}
+	memcpy(data, keystr, keylen + 1);
+	data += keylen + 1;
+	memcpy(data, planstr, planlen + 1);
+
+	entry->offset = pos;
+	entry->len = len;
+	entry->nrels = list_length(relids);
+	entry->ninvals = list_length(invals);
+	entry->keylen = keylen;
+	entry->total_custom_cost = plansource->total_custom_cost;
+	entry->num_custom_plans = plansource->num_custom_plans;
+	shared_plan_count_deps(entry, 1);
+
+	SharedPlanCache->write_pos = MAXALIGN(pos + len);
+
+	LWLockRelease(SharedPlanCacheLock);
+
+	pfree(planstr);
+}
+
+/*
+ * Determine which plans an invalidation message concerns.
+ *
+ * Returns false if it can't affect any shared plan.  Otherwise sets *dbid to
+ * the database concerned (InvalidOid for all), and *cacheid and *value to the
+ * dependency to look for.  This must agree with the set of syscaches that
+ * InitPlanCache registers callbacks for: PROCOID and TYPEOID changes affect
+ * plans having them as PlanInvalItems, NAMESPACEOID changes affect plans
+ * with the schema in their search_path, and the remaining caches affect
+ * every plan, as in PlanCacheSysCallback.
+ */
+static bool
+shared_plan_message_target(const SharedInvalidationMessage *msg,
+						   Oid *dbid, int *cacheid, uint32 *value)
+{
+	if (msg->id >= 0)
+	{
+		*dbid = msg->cc.dbId;
+		switch (msg->id)
+		{
+			case PROCOID:
+			case TYPEOID:
+			case NAMESPACEOID:
+				*cacheid = msg->id;
+				*value = msg->cc.hashValue;
+				return true;
+			case OPEROID:
+			case AMOPOPID:
+			case FOREIGNSERVEROID:
+			case FOREIGNDATAWRAPPEROID:
+				*cacheid = SHARED_PLAN_DEP_ALL;
+				*value = 0;
+				return true;
+			default:
+				return false;
+		}
+	}
+	else if (msg->id == SHAREDINVALCATALOG_ID)
+	{
+		/* flushing a whole catalog resets all its caches */
+		*dbid = msg->cat.dbId;
+		*cacheid = SHARED_PLAN_DEP_ALL;
+		*value = 0;
+		switch (msg->cat.catId)
+		{
+			case ProcedureRelationId:
+			case TypeRelationId:
+			case NamespaceRelationId:
+			case OperatorRelationId:
+			case AccessMethodOperatorRelationId:
+			case ForeignServerRelationId:
+			case ForeignDataWrapperRelationId:
+				return true;
+			default:
+				return false;
+		}
+	}
+	else if (msg->id == SHAREDINVALRELCACHE_ID)
+	{
+		*dbid = msg->rc.dbId;
+		if (OidIsValid(msg->rc.relId))
+		{
+			*cacheid = SHARED_PLAN_DEP_REL;
+			*value = (uint32) msg->rc.relId;
+		}
+		else
+		{
+			*cacheid = SHARED_PLAN_DEP_ALL;
+			*value = 0;
+		}
+		return true;
+	}
+	return false;
+}
+
+/*
+ * Does the entry depend on the given object?  Arguments are as set by
+ * shared_plan_message_target.
+ */
+static bool
+shared_plan_entry_matches(SharedPlanEntry *entry, Oid dbid,
+						  int cacheid, uint32 value)
+{
+	char	   *data = SharedPlanCache->arena + entry->offset;
+	int			i;
+
+	if (OidIsValid(dbid) && entry->key.dbid != dbid)
+		return false;
+
+	if (cacheid == SHARED_PLAN_DEP_ALL)
+		return true;
+
+	if (cacheid == SHARED_PLAN_DEP_REL)
+	{
+		for (i = 0; i < entry->nrels; i++)
+		{
+			Oid			oid;
+
+			memcpy(&oid, data + i * sizeof(Oid), sizeof(Oid));
+			if (oid == (Oid) value)
+				return true;
+		}
+		return false;
+	}
+
+	data += entry->nrels * sizeof(Oid);
+	for (i = 0; i < entry->ninvals; i++)
+	{
+		uint32		pair[2];
+
+		memcpy(pair, data + i * sizeof(pair), sizeof(pair));
+		if ((int) pair[0] == cacheid && pair[1] == value)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * SharedPlanCacheInvalidateMessages
+ *		Remove plans affected by the given invalidation messages.
+ *
+ * This is called by SendSharedInvalidMessages after queueing the messages,
+ * so it runs exactly once per message, in the sending process; that includes
+ * the startup process replaying invalidations on a hot standby.  Nothing is
+ * done for messages that can't affect a shared plan, and the table is
+ * scanned only if the dependency counters say some entry may be affected.
+ */
+void
+SharedPlanCacheInvalidateMessages(const SharedInvalidationMessage *msgs,
+								  int n)
+{
+	HASH_SEQ_STATUS status;
+	SharedPlanEntry *entry;
+	Oid			dbid;
+	int			cacheid;
+	uint32		value;
+	bool		relevant = false;
+	bool		match = false;
+	int			i;
+
+	if (SharedPlanCache == NULL)
+		return;
+
+	for (i = 0; i < n && !relevant; i++)
+		relevant = shared_plan_message_target(&msgs[i], &dbid, &cacheid,
+											  &value);
+	if (!relevant)
+		return;
+
+	/*
+	 * Advance the generation before purging, so that plans being built
+	 * concurrently from older catalog state are not published after the
+	 * purge; see SharedPlanCacheStore.  This is a full memory barrier.
+	 */
+	pg_atomic_fetch_add_u32(&SharedPlanCache->generation, 1);
+
+	LWLockAcquire(SharedPlanCacheLock, LW_SHARED);
+	for (i = 0; i < n && !match; i++)
+	{
+		if (!shared_plan_message_target(&msgs[i], &dbid, &cacheid, &value))
+			continue;
+		if (cacheid == SHARED_PLAN_DEP_ALL)
+			match = (hash_get_num_entries(SharedPlanHash) > 0);
+		else
+			match = (SharedPlanCache->depcounts[shared_plan_dep_slot(cacheid,
+															value)] > 0);
+	}
+	LWLockRelease(SharedPlanCacheLock);
+
+	if (!match)
+		return;
+
+	LWLockAcquire(SharedPlanCacheLock, LW_EXCLUSIVE);
+	hash_seq_init(&status, SharedPlanHash);
+	while ((entry = (SharedPlanEntry *) hash_seq_search(&status)) != NULL)
+	{
+		for (i = 0; i < n; i++)
+		{
+			if (shared_plan_message_target(&msgs[i], &dbid, &cacheid,
+										   &value) &&
+				shared_plan_entry_matches(entry, dbid, cacheid, value))
+			{
+				shared_plan_remove_entry(entry);
+				break;
+			}
+		}
+	}
+	LWLockRelease(SharedPlanCacheLock);
+}
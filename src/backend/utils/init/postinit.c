@@ -505,6 +505,29 @@ InitializeMaxBackends(void)
 		elog(ERROR, "too many backends configured");
 }
 
+/*
+ * Initialize the number of fast-path lock groups per backend.
+ *
+ * We size the fast-path lock area from max_locks_per_transaction, on the
+ * theory that a transaction holding that many locks should be able to take
+ * all of its weak relation locks via the fast path.  The number of groups
+ * is rounded up to a power of 2 and capped at FP_LOCK_GROUPS_PER_BACKEND_MAX.
+ *
+ * Like InitializeMaxBackends, this must be called before shared memory size
+ * is determined, and in EXEC_BACKEND environment the value is passed down
+ * via BackendParameters instead.
+ */
+void
+InitializeFastPathLocks(void)
+{
+	Assert(FastPathLockGroupsPerBackend == 0);
+
+	FastPathLockGroupsPerBackend = 1;
+	while (FastPathLockGroupsPerBackend < FP_LOCK_GROUPS_PER_BACKEND_MAX &&
+		   FastPathLockSlotsPerBackend() < max_locks_per_xact)
+		FastPathLockGroupsPerBackend *= 2;
+}
+
 /*
  * Early initialization of a backend (either standalone or under postmaster).
  * This happens even before InitPostgres.
@@ -508,12 +508,14 @@ XLogDumpDisplayRecord(XLogDumpConfig *config, XLogReaderState *record)
 				if (record->blocks[block_id].bimg_info &
 					BKPIMAGE_IS_COMPRESSED)
 				{
-					printf(" (FPW); hole: offset: %u, length: %u, compression saved: %u\n",
+					printf(" (FPW); hole: offset: %u, length: %u, compression saved: %u, method: %s\n",
 						   record->blocks[block_id].hole_offset,
 						   record->blocks[block_id].hole_length,
 						   BLCKSZ -
 						   record->blocks[block_id].hole_length -
-						   record->blocks[block_id].bimg_len);
+						   record->blocks[block_id].bimg_len,
+						   (record->blocks[block_id].bimg_info &
+							BKPIMAGE_COMPRESS_LZ4) ? "lz4" : "pglz");
 				}
 				else
 				{
@@ -0,0 +1,354 @@
+/* ----------
+ * pg_lz4.c -
+ *
+ *		This is an implementation of the LZ4 block format for PostgreSQL.
+ *		It trades compression ratio for speed: a single-probe hash table
+ *		and a greedy parse find matches of 4 bytes or more at offsets up
+ *		to 65535, so both directions run at memory-copy-like speeds.
+ *		That makes it suitable for compressing data on hot paths such as
+ *		WAL insertion, where pglz is often too slow to be worthwhile.
+ *
+ *		Entry routines:
+ *
+ *			int32
+ *			pg_lz4_compress(const char *source, int32 slen, char *dest,
+ *							int32 dlen);
+ *
+ *				source is the input data to be compressed.
+ *
+ *				slen is the length of the input data.
+ *
+ *				dest is the output area for the compressed result.
+ *
+ *				dlen is the size of dest.  Compression gives up as soon as
+ *					the output would not fit, so passing a dlen smaller
+ *					than slen is a cheap way of insisting on a size
+ *					reduction.  Passing PG_LZ4_MAX_OUTPUT(slen) guarantees
+ *					success.
+ *
+ *				The return value is the number of bytes written in the
+ *				buffer dest, or -1 if compression fails; in the latter
+ *				case the contents of dest are undefined.
+ *
+ *			int32
+ *			pg_lz4_decompress(const char *source, int32 slen, char *dest,
+ *							  int32 rawsize)
+ *
+ *				source is the compressed input.
+ *
+ *				slen is the length of the compressed input.
+ *
+ *				dest is the area where the uncompressed data will be
+ *					written to.  It must be at least rawsize bytes.
+ *
+ *				rawsize is the length of the uncompressed data.
+ *
+ *				The return value is rawsize, or -1 if the input is not a
+ *				valid LZ4 block that decompresses to exactly rawsize bytes.
+ *				Every read and write is bounds-checked, so corrupt input
+ *				cannot make the decompressor touch memory outside source
+ *				and dest.
+ *
+ *		The data format:
+ *
+ *			The output is a sequence of "sequences".  Each one starts
+ *			with a token byte: the high nibble is a literal count and the
+ *			low nibble a match length minus 4.  A nibble of 15 means the
+ *			value continues in the following bytes, each of which is
+ *			added to it, until a byte other than 255 is seen.  After the
+ *			token (and literal count extension) come the literal bytes,
+ *			then a little-endian 2-byte back-reference offset, then the
+ *			match length extension, if any.
+ *
+ *			The final sequence has literals only, and stops right after
+ *			them.  As in the reference implementation, the last match
+ *			starts at least MFLIMIT bytes before the end of the input and
+ *			the last LASTLITERALS bytes are always literals, so the output
+ *			is readable by any LZ4 block decoder.
+ *
+ * Copyright (c) 2016, PostgreSQL Global Development Group
+ *
+ * src/common/pg_lz4.c
+ * ----------
+ */
+#ifndef FRONTEND
+#include "postgres.h"
+#else
+#include "postgres_fe.h"
+#endif
+
+#include "common/pg_lz4.h"
+
+
+/* ----------
+ * Local definitions
+ * ----------
+ */
+#define PG_LZ4_HASH_BITS		12
+#define PG_LZ4_HASH_SIZE		(1 << PG_LZ4_HASH_BITS)
+
+#define MINMATCH				4
+#define LASTLITERALS			5
+#define MFLIMIT					12
+#define MAX_DISTANCE			65535
+
+#define RUN_MASK				15
+#define ML_MASK					15
+
+/*
+ * Once this many bytes have gone by without a match, start skipping ahead
+ * faster, so that incompressible input doesn't cost a hash probe per byte.
+ */
+#define SKIP_TRIGGER			6
+
+
+static inline uint32
+pg_lz4_read32(const unsigned char *p)
+{
+	uint32		v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32
+pg_lz4_hash(uint32 seq)
+{
+	return (seq * 2654435761U) >> (32 - PG_LZ4_HASH_BITS);
+}
+
+/*
+ * Append a length extension (the part of a length beyond the 15 that fits
+ * in a token nibble) to op.
+ */
+static inline unsigned char *
+pg_lz4_write_length(unsigned char *op, int32 len)
+{
+	while (len >= 255)
+	{
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = (unsigned char) len;
+	return op;
+}
+
+
+/* ----------
+ * pg_lz4_compress -
+ *
+ *		Compresses source into dest.  Returns the number of bytes written
+ *		in the destination buffer, or -1 if the result does not fit in
+ *		dlen bytes.
+ * ----------
+ */
+int32
+pg_lz4_compress(const char *source, int32 slen, char *dest, int32 dlen)
+{
+	uint32		hashtable[PG_LZ4_HASH_SIZE];
+	const unsigned char *base = (const unsigned char *) source;
+	const unsigned char *ip = base;
+	const unsigned char *anchor = base;
+	const unsigned char *iend = base + slen;
+	const unsigned char *mflimit = iend - MFLIMIT;
+	const unsigned char *matchlimit = iend - LASTLITERALS;
+	unsigned char *op = (unsigned char *) dest;
+	unsigned char *oend = op + dlen;
+	int32		litlen;
+
+	if (slen < 0 || dlen < 0)
+		return -1;
+
+	/*
+	 * Inputs shorter than MFLIMIT + 1 can't contain a match that satisfies
+	 * the end-of-block rules, so they are emitted as literals only.
+	 */
+	if (slen > MFLIMIT)
+	{
+		memset(hashtable, 0, sizeof(hashtable));
+
+		while (ip <= mflimit)
+		{
+			uint32		seq = pg_lz4_read32(ip);
+			uint32		h = pg_lz4_hash(seq);
+			const unsigned char *ref = base + hashtable[h];
+			const unsigned char *mstart;
+			unsigned char *token;
+			int32		matchlen;
+			uint16		offset;
+
+			hashtable[h] = (uint32) (ip - base);
+
+			if (ref >= ip || ip - ref > MAX_DISTANCE ||
+				pg_lz4_read32(ref) != seq)
+			{
+				ip += 1 + ((ip - anchor) >> SKIP_TRIGGER);
+				continue;
+			}
+
+			/* Found a match; extend it as far as the end rules allow */
+			mstart = ip;
+			offset = (uint16) (ip - ref);
+			ip += MINMATCH;
+			ref += MINMATCH;
+			while (ip < matchlimit && *ip == *ref)
+			{
+				ip++;
+				ref++;
+			}
+			matchlen = (int32) (ip - mstart) - MINMATCH;
+			litlen = (int32) (mstart - anchor);
+
+			/* token, literal length, literals, offset, match length */
+			if (oend - op < 1 + (litlen / 255 + 1) + litlen + 2 +
+				(matchlen / 255 + 1))
+				return -1;
+
+			token = op++;
+			if (litlen >= RUN_MASK)
+			{
+				*token = RUN_MASK << 4;
+				op = pg_lz4_write_length(op, litlen - RUN_MASK);
+			}
+			else
+				*token = (unsigned char) (litlen << 4);
+			memcpy(op, anchor, litlen);
+			op += litlen;
+
+			*op++ = (unsigned char) (offset & 0xff);
+			*op++ = (unsigned char) (offset >> 8);
+
+			if (matchlen >= ML_MASK)
+			{
+				*token |= ML_MASK;
+				op = pg_lz4_write_length(op, matchlen - ML_MASK);
+			}
+			else
+				*token |= (unsigned char) matchlen;
+
+			anchor = ip;
+		}
+	}
+
+	/* Emit the remaining input as the final, literals-only sequence */
+	litlen = (int32) (iend - anchor);
+	if (oend - op < 1 + (litlen / 255 + 1) + litlen)
+		return -1;
+	if (litlen >= RUN_MASK)
+	{
+		*op++ = RUN_MASK << 4;
+		op = pg_lz4_write_length(op, litlen - RUN_MASK);
+	}
+	else
+		*op++ = (unsigned char) (litlen << 4);
+	memcpy(op, anchor, litlen);
+	op += litlen;
+
+	return (int32) (op - (unsigned char *) dest);
+}
+
+
+/* ----------
+ * pg_lz4_decompress -
+ *
+ *		Decompresses source into dest.  Returns rawsize, or -1 if the
+ *		input is corrupt or does not decompress to exactly rawsize bytes.
+ * ----------
+ */
+int32
+pg_lz4_decompress(const char *source, int32 slen, char *dest, int32 rawsize)
+{
+	const unsigned char *sp = (const unsigned char *) source;
+	const unsigned char *send = sp + slen;
+	unsigned char *dp = (unsigned char *) dest;
+	unsigned char *dend = dp + rawsize;
+
+	if (slen <= 0 || rawsize < 0)
+		return -1;
+
+	for (;;)
+	{
+		unsigned char token;
+		int32		litlen;
+		int32		matchlen;
+		int32		offset;
+		unsigned char b;
+
+		if (sp >= send)
+			return -1;
+		token = *sp++;
+
+		/* literal run */
+		litlen = token >> 4;
+		if (litlen == RUN_MASK)
+		{
+			do
+			{
+				if (sp >= send)
+					return -1;
+				b = *sp++;
+				litlen += b;
+				if (litlen > rawsize)
+					return -1;
+			} while (b == 255);
+		}
+		if (litlen > send - sp || litlen > dend - dp)
+			return -1;
+		memcpy(dp, sp, litlen);
+		dp += litlen;
+		sp += litlen;
+
+		/* the last sequence has no match part */
+		if (sp == send)
+			break;
+
+		/* back-reference */
+		if (send - sp < 2)
+			return -1;
+		offset = sp[0] | (sp[1] << 8);
+		sp += 2;
+		if (offset == 0 || offset > dp - (unsigned char *) dest)
+			return -1;
+
+		matchlen = token & ML_MASK;
+		if (matchlen == ML_MASK)
+		{
+			do
+			{
+				if (sp >= send)
+					return -1;
+				b = *sp++;
+				matchlen += b;
+				if (matchlen > rawsize)
+					return -1;
+			} while (b == 255);
+		}
+		matchlen += MINMATCH;
+		if (matchlen > dend - dp)
+			return -1;
+
+		/*
+		 * The source and destination of the copy overlap when the offset is
+		 * shorter than the match, which is how runs are encoded, so copy
+		 * byte by byte in that case.
+		 */
+		if (offset >= matchlen)
+		{
+			memcpy(dp, dp - offset, matchlen);
+			dp += matchlen;
+		}
+		else
+		{
+			while (matchlen--)
+			{
+				*dp = dp[-offset];
+				dp++;
+			}
+		}
+	}
+
+	if (dp != dend)
+		return -1;
+
+	return rawsize;
+}
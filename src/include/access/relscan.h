@@ -61,6 +61,9 @@ typedef struct HeapScanDescData
 	/* rs_numblocks is usually InvalidBlockNumber, meaning "scan whole rel" */
 	BufferAccessStrategy rs_strategy;	/* access strategy for reads */
 	bool		rs_syncscan;	/* report location to syncscan logic? */
+	int			rs_prefetch_target; /* # blocks to prefetch ahead, or 0 */
+	BlockNumber rs_prefetch_next;	/* # blocks (counting from
+									 * rs_startblock) prefetched so far */
 
 	/* scan current state */
 	bool		rs_inited;		/* false = scan not init'd yet */
@@ -125,8 +128,27 @@ typedef struct IndexScanDescData
 
 	/* state data for traversing HOT chains in index_getnext */
 	bool		xs_continue_hot;	/* T if must keep walking HOT chain */
+
+	/* parallel index scan information, in shared memory */
+	ParallelIndexScanDesc parallel_scan;
+	bool		xs_temp_snap;	/* unregister snapshot at scan end? */
 }	IndexScanDescData;
 
+/*
+ * Generic shared state for a parallel index scan.
+ *
+ * As for a parallel heap scan, each participating backend has its own
+ * IndexScanDesc pointing to this structure.  The index AM's own shared state
+ * starts ps_offset bytes from the start of the structure.
+ */
+typedef struct ParallelIndexScanDescData
+{
+	Oid			ps_relid;		/* OID of heap relation */
+	Oid			ps_indexid;		/* OID of index relation */
+	Size		ps_offset;		/* offset of AM-specific structure */
+	char		ps_snapshot_data[FLEXIBLE_ARRAY_MEMBER];
+}	ParallelIndexScanDescData;
+
 /* Struct for heap-or-index scans of system tables */
 typedef struct SysScanDescData
 {
@@ -14,6 +14,7 @@
 #define SLRU_H
 
 #include "access/xlogdefs.h"
+#include "port/atomics.h"
 #include "storage/lwlock.h"
 
 
@@ -39,6 +40,20 @@
 /* Maximum length of an SLRU name */
 #define SLRU_MAX_NAME_LENGTH	32
 
+/*
+ * The buffer slots of an SLRU are divided into banks of SLRU_BANK_SIZE slots.
+ * A page can only be held in the bank selected by its page number, so
+ * looking a page up, or choosing a victim slot for it, only ever searches
+ * one bank, however many buffers the SLRU has.  Each bank is protected by
+ * its own LWLock; SLRUs with more than SLRU_MAX_BANKLOCKS banks share each
+ * lock among several banks.
+ */
+#define SLRU_BANK_SIZE			16
+#define SLRU_MAX_BANKLOCKS		128
+
+/* Upper limit for the GUCs that set the number of buffers of an SLRU */
+#define SLRU_MAX_ALLOWED_BUFFERS	((1024 * 1024 * 1024) / BLCKSZ)
+
 /*
  * Page status codes.  Note that these do not include the "dirty" bit.
  * page_dirty can be TRUE only in the VALID or WRITE_IN_PROGRESS states;
@@ -58,11 +73,12 @@ typedef enum
  */
 typedef struct SlruSharedData
 {
-	LWLock	   *ControlLock;
-
 	/* Number of buffers managed by this SLRU structure */
 	int			num_slots;
 
+	/* Number of banks the buffers are divided into */
+	int			num_banks;
+
 	/*
 	 * Arrays holding info for each buffer slot.  Page number is undefined
 	 * when status is EMPTY, as is page_lru_count.
@@ -85,28 +101,36 @@ typedef struct SlruSharedData
 	int			lsn_groups_per_page;
 
 	/*----------
-	 * We mark a page "most recently used" by setting
-	 *		page_lru_count[slotno] = ++cur_lru_count;
-	 * The oldest page is therefore the one with the highest value of
-	 *		cur_lru_count - page_lru_count[slotno]
+	 * Each bank keeps its own LRU clock.  We mark a page "most recently used"
+	 * by setting
+	 *		page_lru_count[slotno] = ++bank_cur_lru_count[bankno];
+	 * The oldest page in the bank is therefore the one with the highest value
+	 * of
+	 *		bank_cur_lru_count[bankno] - page_lru_count[slotno]
 	 * The counts will eventually wrap around, but this calculation still
 	 * works as long as no page's age exceeds INT_MAX counts.
 	 *----------
 	 */
-	int			cur_lru_count;
+	int		   *bank_cur_lru_count;
 
 	/*
 	 * latest_page_number is the page number of the current end of the log;
 	 * this is not critical data, since we use it only to avoid swapping out
-	 * the latest page.
+	 * the latest page.  It is read and set without holding any bank lock.
 	 */
-	int			latest_page_number;
+	pg_atomic_uint32 latest_page_number;
 
-	/* LWLocks */
+	/* LWLocks for I/O on each buffer */
 	int			lwlock_tranche_id;
 	LWLockTranche lwlock_tranche;
 	char		lwlock_tranche_name[SLRU_MAX_NAME_LENGTH];
 	LWLockPadded *buffer_locks;
+
+	/* LWLocks protecting the banks, see SimpleLruGetBankLock */
+	int			bank_tranche_id;
+	LWLockTranche bank_tranche;
+	char		bank_tranche_name[SLRU_MAX_NAME_LENGTH];
+	LWLockPadded *bank_locks;
 } SlruSharedData;
 
 typedef SlruSharedData *SlruShared;
@@ -141,10 +165,41 @@ typedef struct SlruCtlData
 
 typedef SlruCtlData *SlruCtl;
 
+/*
+ * Get the LWLock protecting the bank that holds, or would hold, the given
+ * page.  It must be held to examine or modify the page's buffer slot or the
+ * page contents; see slru.c for the details.
+ */
+static inline LWLock *
+SimpleLruGetBankLock(SlruCtl ctl, int pageno)
+{
+	int			bankno = pageno % ctl->shared->num_banks;
+
+	return &ctl->shared->bank_locks[bankno % SLRU_MAX_BANKLOCKS].lock;
+}
+
+/*
+ * Get and set the page number of the current end of the log.
+ */
+static inline int
+SimpleLruGetLatestPage(SlruCtl ctl)
+{
+	return (int) pg_atomic_read_u32(&ctl->shared->latest_page_number);
+}
+
+static inline void
+SimpleLruSetLatestPage(SlruCtl ctl, int pageno)
+{
+	pg_atomic_write_u32(&ctl->shared->latest_page_number, (uint32) pageno);
+}
+
 
 extern Size SimpleLruShmemSize(int nslots, int nlsns);
 extern void SimpleLruInit(SlruCtl ctl, const char *name, int nslots, int nlsns,
-			  LWLock *ctllock, const char *subdir, int tranche_id);
+			  const char *subdir, int buffer_tranche_id,
+			  int bank_tranche_id);
+extern int	SimpleLruAutotuneBuffers(int divisor, int max);
+extern bool check_slru_buffers(const char *name, int *newval);
 extern int	SimpleLruZeroPage(SlruCtl ctl, int pageno);
 extern int SimpleLruReadPage(SlruCtl ctl, int pageno, bool write_ok,
 				  TransactionId xid);
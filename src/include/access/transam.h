@@ -134,6 +134,8 @@ typedef struct VariableCacheData
 	 */
 	TransactionId latestCompletedXid;	/* newest XID that has committed or
 										 * aborted */
+	uint64		xactCompletionCount;	/* bumped whenever the set of running
+										 * XIDs shrinks; see GetSnapshotData */
 } VariableCacheData;
 
 typedef VariableCacheData *VariableCache;
@@ -97,17 +97,25 @@ extern int	min_wal_size;
 extern int	max_wal_size;
 extern int	wal_keep_segments;
 extern int	XLOGbuffers;
+extern int	XLOGinsertLocks;
 extern int	XLogArchiveTimeout;
 extern int	wal_retrieve_retry_interval;
 extern char *XLogArchiveCommand;
 extern bool EnableHotStandby;
 extern bool fullPageWrites;
 extern bool wal_log_hints;
-extern bool wal_compression;
+extern int	wal_compression;
 extern bool log_checkpoints;
 
 extern int	CheckPointSegments;
 
+/*
+ * Upper limit for wal_insert_locks.  WALInsertLockAcquireExclusive() takes
+ * all of the insertion locks at once, so together with the other LWLocks
+ * held at that time they have to fit in lwlock.c's MAX_SIMUL_LWLOCKS.
+ */
+#define MAX_WAL_INSERT_LOCKS	128
+
 /* Archive modes */
 typedef enum ArchiveMode
 {
@@ -127,6 +135,14 @@ typedef enum WalLevel
 
 extern PGDLLIMPORT int wal_level;
 
+/* Compression methods for wal_compression */
+typedef enum WalCompression
+{
+	WAL_COMPRESSION_NONE = 0,
+	WAL_COMPRESSION_PGLZ,
+	WAL_COMPRESSION_LZ4
+} WalCompression;
+
 /* Is WAL archiving enabled (always or only while server is running normally)? */
 #define XLogArchivingActive() \
 	(AssertMacro(XLogArchiveMode == ARCHIVE_MODE_OFF || wal_level >= WAL_LEVEL_REPLICA), XLogArchiveMode > ARCHIVE_MODE_OFF)
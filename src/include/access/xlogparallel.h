@@ -0,0 +1,31 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogparallel.h
+ *	  Replay of WAL records by parallel redo workers
+ *
+ * Portions Copyright (c) 1996-2016, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/xlogparallel.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef XLOGPARALLEL_H
+#define XLOGPARALLEL_H
+
+#include "access/xlogreader.h"
+
+/* GUC parameter */
+extern int	parallel_redo_workers;
+
+/* Upper limit for parallel_redo_workers */
+#define MAX_PARALLEL_REDO_WORKERS	64
+
+extern void StartParallelRedo(void);
+extern bool ParallelRedoDispatch(XLogReaderState *record);
+extern void WaitForParallelRedoWorkers(void);
+extern void EndParallelRedo(void);
+
+extern void ParallelRedoWorkerMain(Datum main_arg);
+
+#endif   /* XLOGPARALLEL_H */
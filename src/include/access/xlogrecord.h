@@ -23,7 +23,7 @@
  *		XLogRecordBlockHeader struct
  *		XLogRecordBlockHeader struct
  *		...
- *		XLogRecordDataHeader[Short|Long] struct
+ *		XLogRecordDataHeader[Short|Long|Compressed] struct
  *		block data
  *		block data
  *		...
@@ -34,8 +34,9 @@
  * always start on MAXALIGN boundaries in the WAL files, but the rest of
  * the fields are not aligned.
  *
- * The XLogRecordBlockHeader, XLogRecordDataHeaderShort and
- * XLogRecordDataHeaderLong structs all begin with a single 'id' byte. It's
+ * The XLogRecordBlockHeader, XLogRecordDataHeaderShort,
+ * XLogRecordDataHeaderLong and XLogRecordDataHeaderCompressed structs all
+ * begin with a single 'id' byte. It's
  * used to distinguish between block references, and the main data structs.
  */
 typedef struct XLogRecord
@@ -106,7 +107,8 @@ typedef struct XLogRecordBlockHeader
  * present is BLCKSZ - the length of "hole" bytes.
  *
  * When wal_compression is enabled, a full page image which "hole" was
- * removed is additionally compressed using PGLZ compression algorithm.
+ * removed is additionally compressed using the PGLZ or LZ4 compression
+ * algorithm, as chosen by the setting; BKPIMAGE_COMPRESS_LZ4 tells which.
  * This can reduce the WAL volume, but at some extra cost of CPU spent
  * on the compression during WAL logging. In this case, since the "hole"
  * length cannot be calculated by subtracting the number of page image bytes
@@ -137,6 +139,8 @@ typedef struct XLogRecordBlockImageHeader
 /* Information stored in bimg_info */
 #define BKPIMAGE_HAS_HOLE		0x01	/* page image has "hole" */
 #define BKPIMAGE_IS_COMPRESSED		0x02		/* page image is compressed */
+#define BKPIMAGE_COMPRESS_LZ4		0x04		/* compressed with LZ4, not
+												 * PGLZ */
 
 /*
  * Extra header information used when page image has "hole" and
@@ -178,6 +182,16 @@ typedef struct XLogRecordBlockCompressHeader
  * form is used, with a single byte to hold the length. Otherwise the long
  * form is used.
  *
+ * When wal_compression is enabled, main data of a size between
+ * XLR_DATA_COMPRESS_MIN and XLR_DATA_COMPRESS_MAX bytes is compressed, and
+ * stored with the XLogRecordDataHeaderCompressed form instead if that makes
+ * the record smaller.  The header records both the compressed length, which
+ * is the number of payload bytes in the record, and the raw length, which
+ * is what the decoder hands to redo routines after decompressing.  Smaller
+ * main data rarely compresses enough to pay for the longer header, and the
+ * upper limit bounds the working buffers that must be allocated up front,
+ * since records are assembled inside critical sections.
+ *
  * (These structs are currently not used in the code, they are here just for
  * documentation purposes).
  */
@@ -197,12 +211,32 @@ typedef struct XLogRecordDataHeaderLong
 
 #define SizeOfXLogRecordDataHeaderLong (sizeof(uint8) + sizeof(uint32))
 
+typedef struct XLogRecordDataHeaderCompressed
+{
+	uint8		id;				/* XLR_BLOCK_ID_DATA_COMPRESSED */
+	uint8		method;			/* XLR_DATA_COMPRESS_* */
+	/* followed by uint32 data_length, unaligned */
+	/* followed by uint32 raw_length, unaligned */
+}	XLogRecordDataHeaderCompressed;
+
+#define SizeOfXLogRecordDataHeaderCompressed \
+	(sizeof(uint8) * 2 + sizeof(uint32) * 2)
+
+/* Compression methods stored in XLogRecordDataHeaderCompressed */
+#define XLR_DATA_COMPRESS_PGLZ		1
+#define XLR_DATA_COMPRESS_LZ4		2
+
+/* Range of main data lengths that are considered for compression */
+#define XLR_DATA_COMPRESS_MIN		512
+#define XLR_DATA_COMPRESS_MAX		(2 * BLCKSZ)
+
 /*
  * Block IDs used to distinguish different kinds of record fragments. Block
  * references are numbered from 0 to XLR_MAX_BLOCK_ID. A rmgr is free to use
  * any ID number in that range (although you should stick to small numbers,
  * because the WAL machinery is optimized for that case). A couple of ID
- * numbers are reserved to denote the "main" data portion of the record.
+ * numbers are reserved to denote the "main" data portion of the record, and
+ * the replication origin.
  *
  * The maximum is currently set at 32, quite arbitrarily. Most records only
  * need a handful of block references, but there are a few exceptions that
@@ -213,5 +247,6 @@ typedef struct XLogRecordDataHeaderLong
 #define XLR_BLOCK_ID_DATA_SHORT		255
 #define XLR_BLOCK_ID_DATA_LONG		254
 #define XLR_BLOCK_ID_ORIGIN			253
+#define XLR_BLOCK_ID_DATA_COMPRESSED	252
 
 #endif   /* XLOGRECORD_H */
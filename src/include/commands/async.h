@@ -17,11 +17,7 @@
 
 #include "fmgr.h"
 
-/*
- * The number of SLRU page buffers we use for the notification queue.
- */
-#define NUM_ASYNC_BUFFERS	8
-
+extern int	notify_buffers;
 extern bool Trace_notify;
 extern volatile sig_atomic_t notifyInterruptPending;
 
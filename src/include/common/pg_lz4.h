@@ -0,0 +1,34 @@
+/* ----------
+ * pg_lz4.h -
+ *
+ *	Definitions for the builtin LZ4 block format compressor
+ *
+ * src/include/common/pg_lz4.h
+ * ----------
+ */
+
+#ifndef _PG_LZ4_H_
+#define _PG_LZ4_H_
+
+
+/* ----------
+ * PG_LZ4_MAX_OUTPUT -
+ *
+ *		Macro to compute the worst-case size of pg_lz4_compress() output
+ *		for an input of the given length.  Incompressible input grows by
+ *		one length byte per 255 literals plus a small constant overhead.
+ * ----------
+ */
+#define PG_LZ4_MAX_OUTPUT(_dlen)		((_dlen) + ((_dlen) / 255) + 16)
+
+
+/* ----------
+ * Global function declarations
+ * ----------
+ */
+extern int32 pg_lz4_compress(const char *source, int32 slen, char *dest,
+				int32 dlen);
+extern int32 pg_lz4_decompress(const char *source, int32 slen, char *dest,
+				  int32 rawsize);
+
+#endif   /* _PG_LZ4_H_ */
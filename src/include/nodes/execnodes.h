@@ -17,6 +17,7 @@
 #include "access/genam.h"
 #include "access/heapam.h"
 #include "executor/instrument.h"
+#include "lib/ilist.h"
 #include "lib/pairingheap.h"
 #include "nodes/params.h"
 #include "nodes/plannodes.h"
@@ -421,6 +422,9 @@ typedef struct EState
 	HeapTuple  *es_epqTuple;	/* array of EPQ substitute tuples */
 	bool	   *es_epqTupleSet; /* true if EPQ tuple is provided */
 	bool	   *es_epqScanDone; /* true if EPQ tuple has been fetched */
+
+	bool		es_misestimated;	/* did some node's row count differ too
+									 * much from the estimate? */
 } EState;
 
 
@@ -498,21 +502,34 @@ typedef struct TupleHashTableData *TupleHashTable;
 
 typedef struct TupleHashEntryData
 {
-	/* firstTuple must be the first field in this struct! */
 	MinimalTuple firstTuple;	/* copy of first tuple in this group */
-	/* there may be additional data beyond the end of this struct */
-} TupleHashEntryData;			/* VARIABLE LENGTH STRUCT */
+	void	   *additional;		/* per-group data requested by the caller */
+	uint32		status;			/* hash status */
+	uint32		hash;			/* hash value (cached) */
+} TupleHashEntryData;
+
+/* define parameters necessary to generate the tuple hash table interface */
+#define SH_PREFIX tuplehash
+#define SH_ELEMENT_TYPE TupleHashEntryData
+#define SH_KEY_TYPE MinimalTuple
+#define SH_SCOPE extern
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+/* highest fraction of a tuple hash table's buckets that are kept in use */
+#define TUPLEHASH_FILLFACTOR	0.8
 
 typedef struct TupleHashTableData
 {
-	HTAB	   *hashtab;		/* underlying dynahash table */
+	tuplehash_hash *hashtab;	/* underlying open-addressing hash table */
 	int			numCols;		/* number of columns in lookup key */
 	AttrNumber *keyColIdx;		/* attr numbers of key columns */
 	FmgrInfo   *tab_hash_funcs; /* hash functions for table datatype(s) */
 	FmgrInfo   *tab_eq_funcs;	/* equality functions for table datatype(s) */
 	MemoryContext tablecxt;		/* memory context containing table */
 	MemoryContext tempcxt;		/* context for function evaluations */
-	Size		entrysize;		/* actual size to make each hash entry */
+	Size		additionalsize; /* size of per-group data, if any */
+	uint32		hash_iv;		/* initial value for the hash computation */
 	TupleTableSlot *tableslot;	/* slot for referencing table entries */
 	/* The following fields are set transiently for each table search: */
 	TupleTableSlot *inputslot;	/* current input tuple's slot */
@@ -520,24 +537,22 @@ typedef struct TupleHashTableData
 	FmgrInfo   *cur_eq_funcs;	/* equality functions for input vs. table */
 }	TupleHashTableData;
 
-typedef HASH_SEQ_STATUS TupleHashIterator;
+typedef tuplehash_iterator TupleHashIterator;
 
 /*
  * Use InitTupleHashIterator/TermTupleHashIterator for a read/write scan.
  * Use ResetTupleHashIterator if the table can be frozen (in this case no
- * explicit scan termination is needed).
+ * explicit scan termination is needed).  Since the hash table doesn't need
+ * any cleanup after a scan, the two flavors are now equivalent.
  */
 #define InitTupleHashIterator(htable, iter) \
-	hash_seq_init(iter, (htable)->hashtab)
+	tuplehash_start_iterate((htable)->hashtab, iter)
 #define TermTupleHashIterator(iter) \
-	hash_seq_term(iter)
+	((void) 0)
 #define ResetTupleHashIterator(htable, iter) \
-	do { \
-		hash_freeze((htable)->hashtab); \
-		hash_seq_init(iter, (htable)->hashtab); \
-	} while (0)
-#define ScanTupleHashTable(iter) \
-	((TupleHashEntry) hash_seq_search(iter))
+	InitTupleHashIterator(htable, iter)
+#define ScanTupleHashTable(htable, iter) \
+	tuplehash_iterate((htable)->hashtab, iter)
 
 
 /* ----------------------------------------------------------------
@@ -1143,7 +1158,9 @@ typedef struct ModifyTableState
  *	 AppendState information
  *
  *		nplans			how many plans are in the array
- *		whichplan		which plan is being executed (0 .. n-1)
+ *		whichplan		which plan is being executed (0 .. n-1), or -1
+ *						if a parallel-aware Append has yet to choose one
+ *		pstate			shared state for parallel-aware Append, or NULL
  * ----------------
  */
 typedef struct AppendState
@@ -1152,6 +1169,10 @@ typedef struct AppendState
 	PlanState **appendplans;	/* array of PlanStates for my inputs */
 	int			as_nplans;
 	int			as_whichplan;
+	struct ParallelAppendState *as_pstate;	/* shared state, if parallel */
+	Size		pstate_len;		/* size of parallel append state */
+	bool	   *as_pruned;		/* subplans excluded at run time, or NULL */
+	bool		as_prune_pending;	/* must as_pruned be recomputed? */
 } AppendState;
 
 /* ----------------
@@ -1175,6 +1196,7 @@ typedef struct MergeAppendState
 	TupleTableSlot **ms_slots;	/* array of length ms_nplans */
 	struct binaryheap *ms_heap; /* binary heap of slot indices */
 	bool		ms_initialized; /* are subplans started? */
+	bool	   *ms_pruned;		/* subplans excluded at run time, or NULL */
 } MergeAppendState;
 
 /* ----------------
@@ -1317,6 +1339,7 @@ typedef struct
  *		RuntimeContext	   expr context for evaling runtime Skeys
  *		RelationDesc	   index relation descriptor
  *		ScanDesc		   index scan descriptor
+ *		PscanLen		   size of parallel index scan descriptor
  *
  *		ReorderQueue	   tuples that need reordering due to re-check
  *		ReachedEnd		   have we fetched all tuples from index already?
@@ -1342,6 +1365,7 @@ typedef struct IndexScanState
 	ExprContext *iss_RuntimeContext;
 	Relation	iss_RelationDesc;
 	IndexScanDesc iss_ScanDesc;
+	Size		iss_PscanLen;
 
 	/* These are needed for re-checking ORDER BY expr ordering */
 	pairingheap *iss_ReorderQueue;
@@ -1369,6 +1393,7 @@ typedef struct IndexScanState
  *		ScanDesc		   index scan descriptor
  *		VMBuffer		   buffer in use for visibility map testing, if any
  *		HeapFetches		   number of tuples we were forced to fetch from heap
+ *		PscanLen		   size of parallel index-only scan descriptor
  * ----------------
  */
 typedef struct IndexOnlyScanState
@@ -1387,6 +1412,7 @@ typedef struct IndexOnlyScanState
 	IndexScanDesc ioss_ScanDesc;
 	Buffer		ioss_VMBuffer;
 	long		ioss_HeapFetches;
+	Size		ioss_PscanLen;
 } IndexOnlyScanState;
 
 /* ----------------
@@ -1434,6 +1460,9 @@ typedef struct BitmapIndexScanState
  *		prefetch_pages	   # pages prefetch iterator is ahead of current
  *		prefetch_target    current target prefetch distance
  *		prefetch_maximum   maximum value for prefetch_target
+ *		pstate			   shared state for parallel bitmap scan, or NULL
+ *		bitmap_seg		   DSM segment holding the shared bitmap
+ *		shared_tbmiterator iterator over the shared bitmap
  * ----------------
  */
 typedef struct BitmapHeapScanState
@@ -1449,6 +1478,9 @@ typedef struct BitmapHeapScanState
 	int			prefetch_pages;
 	int			prefetch_target;
 	int			prefetch_maximum;
+	struct ParallelBitmapHeapState *pstate;
+	struct dsm_segment *bitmap_seg;
+	TBMSharedIterator *shared_tbmiterator;
 } BitmapHeapScanState;
 
 /* ----------------
@@ -1771,9 +1803,48 @@ typedef struct MaterialState
 	ScanState	ss;				/* its first field is NodeTag */
 	int			eflags;			/* capability flags to pass to tuplestore */
 	bool		eof_underlying; /* reached end of underlying plan? */
+	double		ntuples;		/* tuples fetched from underlying plan */
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+/* ----------------
+ *	 ResultCacheState information
+ *
+ *		result cache nodes remember the output of their subplan for
+ *		each distinct set of parameter values.  The cache is bounded by
+ *		work_mem; least recently used entries are evicted to make room.
+ * ----------------
+ */
+struct ResultCacheEntry;
+struct ResultCacheTuple;
+struct resultcache_hash;
+
+typedef struct ResultCacheState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	int			rc_status;		/* value of ExecResultCache state machine */
+	int			nkeys;			/* number of cache keys */
+	struct resultcache_hash *hashtable; /* hash table for cache entries */
+	TupleDesc	hashkeydesc;	/* tuple descriptor for cache keys */
+	TupleTableSlot *tableslot;	/* slot for stored cache keys */
+	TupleTableSlot *probeslot;	/* virtual slot for the current keys */
+	List	   *param_exprs;	/* ExprStates for the cache key exprs */
+	Bitmapset  *keyparamids;	/* PARAM_EXEC paramids used in the keys */
+	MemoryContext tableContext; /* memory context holding cached tuples */
+	dlist_head	lru_list;		/* least recently used entry first */
+	Size		mem_used;		/* bytes of memory used by the cache */
+	Size		mem_limit;		/* memory limit in bytes */
+	struct ResultCacheEntry *entry; /* entry being filled or read, or NULL */
+	struct ResultCacheTuple *last_tuple;	/* last tuple returned from
+											 * entry, or NULL */
+	/* statistics, for EXPLAIN ANALYZE */
+	long		cache_hits;		/* lookups that found a complete entry */
+	long		cache_misses;	/* lookups that had to scan the subplan */
+	long		cache_evictions;	/* entries evicted to free memory */
+	long		cache_overflows;	/* scans too large to cache at all */
+	Size		mem_peak;		/* peak value of mem_used */
+} ResultCacheState;
+
 /* ----------------
  *	 SortState information
  * ----------------
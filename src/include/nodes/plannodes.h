@@ -202,12 +202,24 @@ typedef struct ModifyTable
 /* ----------------
  *	 Append node -
  *		Generate the concatenation of the results of sub-plans.
+ *
+ *		In a parallel-aware Append, the subplans before first_partial_plan
+ *		are non-partial and must each be run by just one participant.
+ *
+ * If prunequals isn't NIL, it and pruneconstraints each have one entry per
+ * subplan: a list of restriction clauses involving Params, and a list of
+ * the child relation's constraints.  At execution time a subplan is skipped
+ * if the clauses, with the current parameter values substituted, refute
+ * its constraints.  Subplans that aren't candidates have NIL entries.
  * ----------------
  */
 typedef struct Append
 {
 	Plan		plan;
 	List	   *appendplans;
+	int			first_partial_plan;
+	List	   *pruneconstraints;	/* per-subplan constraint lists */
+	List	   *prunequals;		/* per-subplan parameterized clauses */
 } Append;
 
 /* ----------------
@@ -225,6 +237,9 @@ typedef struct MergeAppend
 	Oid		   *sortOperators;	/* OIDs of operators to sort them by */
 	Oid		   *collations;		/* OIDs of collations */
 	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
+	/* run-time pruning info, as in struct Append */
+	List	   *pruneconstraints;	/* per-subplan constraint lists */
+	List	   *prunequals;		/* per-subplan parameterized clauses */
 } MergeAppend;
 
 /* ----------------
@@ -665,6 +680,25 @@ typedef struct Material
 	Plan		plan;
 } Material;
 
+/* ----------------
+ *		result cache node
+ *
+ * A Result Cache sits on the inner side of a parameterized nestloop and
+ * remembers the output of its subplan for each distinct set of parameter
+ * values, so that repeated outer keys can be answered without rescanning
+ * the subplan.  param_exprs are the cache keys (the nestloop's Params);
+ * hashOperators are hashable equality operators for each of them.
+ * ----------------
+ */
+typedef struct ResultCache
+{
+	Plan		plan;
+	int			numKeys;		/* number of cache keys */
+	List	   *param_exprs;	/* cache keys in the form of exprs; compared
+								 * by binary image, see nodeResultCache.c */
+	uint32		est_entries;	/* planner's estimate of cache entries */
+} ResultCache;
+
 /* ----------------
  *		sort node
  * ----------------
@@ -182,6 +182,15 @@ typedef struct PlannerInfo
 	 */
 	RangeTblEntry **simple_rte_array;	/* rangetable as an array */
 
+	/*
+	 * append_rel_array is the same length as simple_rel_array and holds, for
+	 * each appendrel child relid, a pointer to its AppendRelInfo (NULL for
+	 * other entries).  This saves searching append_rel_list, which can be
+	 * very long once large inheritance sets have been expanded.  It is NULL
+	 * if append_rel_list was empty when the arrays were set up.
+	 */
+	struct AppendRelInfo **append_rel_array;
+
 	/*
 	 * all_baserels is a Relids set of all base relids (but not "other"
 	 * relids) in the query; that is, the Relids identifier of the final join
@@ -410,6 +419,8 @@ typedef struct PlannerInfo
  *				(includes both direct and indirect lateral references)
  *		indexlist - list of IndexOptInfo nodes for relation's indexes
  *					(always NIL if it's not a table)
+ *		statlist - list of StatisticExtInfo nodes for the relation's
+ *					extended statistics (always NIL if it's not a table)
  *		pages - number of disk pages in relation (zero if not a table)
  *		tuples - number of tuples in relation (not considering restrictions)
  *		allvisfrac - fraction of disk pages that are marked all-visible
@@ -422,6 +433,10 @@ typedef struct PlannerInfo
  *
  *		For otherrels that are appendrel members, these fields are filled
  *		in just as for a baserel, except we don't bother with lateral_vars.
+ *		However, for appendrel members that are plain tables we postpone
+ *		reading indexlist, statlist, pages, tuples, allvisfrac and the
+ *		foreign-table fields until the member has survived constraint
+ *		exclusion; catalog_info_pending is true until then.
  *
  * If the relation is either a foreign table or a join of foreign tables that
  * all belong to the same foreign server and are assigned to the same user to
@@ -518,12 +533,14 @@ typedef struct RelOptInfo
 	List	   *lateral_vars;	/* LATERAL Vars and PHVs referenced by rel */
 	Relids		lateral_referencers;	/* rels that reference me laterally */
 	List	   *indexlist;		/* list of IndexOptInfo */
+	List	   *statlist;		/* list of StatisticExtInfo */
 	BlockNumber pages;			/* size estimates derived from pg_class */
 	double		tuples;
 	double		allvisfrac;
 	PlannerInfo *subroot;		/* if subquery */
 	List	   *subplan_params; /* if subquery */
 	int			rel_parallel_workers;	/* wanted number of parallel workers */
+	bool		catalog_info_pending;	/* see finish_relation_info() */
 
 	/* Information about foreign tables and foreign joins */
 	Oid			serverid;		/* identifies server for the table or join */
@@ -620,6 +637,7 @@ typedef struct IndexOptInfo
 	bool		amsearchnulls;	/* can AM search for NULL/NOT NULL entries? */
 	bool		amhasgettuple;	/* does AM have amgettuple interface? */
 	bool		amhasgetbitmap; /* does AM have amgetbitmap interface? */
+	bool		amcanparallel;	/* does AM support parallel scan? */
 	/* Rather than include amapi.h here, we declare amcostestimate like this */
 	void		(*amcostestimate) ();	/* AM's cost estimator */
 } IndexOptInfo;
@@ -654,6 +672,23 @@ typedef struct ForeignKeyOptInfo
 	List	   *rinfos[INDEX_MAX_KEYS];
 } ForeignKeyOptInfo;
 
+/*
+ * StatisticExtInfo
+ *		Information about extended statistics for planning/optimization
+ *
+ * Each pg_statistic_ext row is represented by one or more nodes of this
+ * type, one per kind of statistics that has actually been built.
+ */
+typedef struct StatisticExtInfo
+{
+	NodeTag		type;
+
+	Oid			statOid;		/* OID of the statistics row */
+	RelOptInfo *rel;			/* back-link to statistic's table */
+	char		kind;			/* statistic kind of this entry */
+	Bitmapset  *keys;			/* attnums of the columns covered */
+} StatisticExtInfo;
+
 
 /*
  * EquivalenceClasses
@@ -1100,11 +1135,15 @@ typedef struct CustomPath
  * elements.  These cases are optimized during create_append_plan.
  * In particular, an AppendPath with no subpaths is a "dummy" path that
  * is created to represent the case that a relation is provably empty.
+ *
+ * In a parallel-aware AppendPath, the subpaths before first_partial_path
+ * are non-partial paths, each of which will be run by a single worker.
  */
 typedef struct AppendPath
 {
 	Path		path;
 	List	   *subpaths;		/* list of component Paths */
+	int			first_partial_path;		/* index of first partial subpath */
 } AppendPath;
 
 #define IS_DUMMY_PATH(p) \
@@ -1151,6 +1190,21 @@ typedef struct MaterialPath
 	Path	   *subpath;
 } MaterialPath;
 
+/*
+ * ResultCachePath represents a Result Cache plan node atop the parameterized
+ * inner path of a nestloop.  hash_exprs are the outer-side expressions the
+ * inner path is parameterized by; they are used to estimate how many
+ * distinct cache keys will be seen over 'calls' rescans.
+ */
+typedef struct ResultCachePath
+{
+	Path		path;
+	Path	   *subpath;		/* the parameterized path being cached */
+	List	   *hash_exprs;		/* outer-side cache key expressions */
+	double		calls;			/* expected number of rescans */
+	uint32		est_entries;	/* expected number of entries to fit */
+} ResultCachePath;
+
 /*
  * UniquePath represents elimination of distinct rows from the output of
  * its subpath.
@@ -34,6 +34,10 @@ typedef struct TIDBitmap TIDBitmap;
 /* Likewise, TBMIterator is private */
 typedef struct TBMIterator TBMIterator;
 
+/* ... as are the shared iteration state and a process's handle on it */
+typedef struct TBMSharedIteratorState TBMSharedIteratorState;
+typedef struct TBMSharedIterator TBMSharedIterator;
+
 /* Result structure for tbm_iterate */
 typedef struct
 {
@@ -63,4 +67,11 @@ extern TBMIterator *tbm_begin_iterate(TIDBitmap *tbm);
 extern TBMIterateResult *tbm_iterate(TBMIterator *iterator);
 extern void tbm_end_iterate(TBMIterator *iterator);
 
+extern Size tbm_shared_iterate_size(const TIDBitmap *tbm);
+extern void tbm_prepare_shared_iterate(TIDBitmap *tbm,
+						   TBMSharedIteratorState *target);
+extern TBMSharedIterator *tbm_attach_shared_iterate(TBMSharedIteratorState *state);
+extern TBMIterateResult *tbm_shared_iterate(TBMSharedIterator *iterator);
+extern void tbm_end_shared_iterate(TBMSharedIterator *iterator);
+
 #endif   /* TIDBITMAP_H */
@@ -22,6 +22,7 @@
  */
 extern bool enable_geqo;
 extern int	geqo_threshold;
+extern int	greedy_join_threshold;
 extern int	min_parallel_relation_size;
 
 /* Hook for plugins to get control in set_rel_pathlist() */
@@ -53,6 +54,7 @@ extern RelOptInfo *standard_join_search(PlannerInfo *root, int levels_needed,
 					 List *initial_rels);
 
 extern void generate_gather_paths(PlannerInfo *root, RelOptInfo *rel);
+extern int	compute_parallel_worker(RelOptInfo *rel, BlockNumber pages);
 
 #ifdef OPTIMIZER_DEBUG
 extern void debug_print_rel(PlannerInfo *root, RelOptInfo *rel);
@@ -105,6 +107,13 @@ extern bool have_join_order_restriction(PlannerInfo *root,
 extern bool have_dangerous_phv(PlannerInfo *root,
 				   Relids outer_relids, Relids inner_params);
 
+/*
+ * greedyjoin.c
+ *	  greedy join order search for large join problems
+ */
+extern RelOptInfo *greedy_join_search(PlannerInfo *root, int levels_needed,
+				   List *initial_rels);
+
 /*
  * equivclass.c
  *	  routines for managing EquivalenceClasses
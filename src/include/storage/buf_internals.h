@@ -314,6 +314,8 @@ extern bool StrategyRejectBuffer(BufferAccessStrategy strategy,
 
 extern int	StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc);
 extern void StrategyNotifyBgWriter(int bgwprocno);
+extern uint32 StrategyInitialUsageCount(uint32 hashcode);
+extern void StrategyRememberEviction(uint32 hashcode);
 
 extern Size StrategyShmemSize(void);
 extern void StrategyInitialize(bool init);
@@ -323,6 +325,8 @@ extern Size BufTableShmemSize(int size);
 extern void InitBufTable(int size);
 extern uint32 BufTableHashCode(BufferTag *tagPtr);
 extern int	BufTableLookup(BufferTag *tagPtr, uint32 hashcode);
+extern int	BufTableLookupHint(uint32 hashcode);
+extern void BufTableSetHint(uint32 hashcode, int buf_id);
 extern int	BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id);
 extern void BufTableDelete(BufferTag *tagPtr, uint32 hashcode);
 
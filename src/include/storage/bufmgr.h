@@ -34,6 +34,13 @@ typedef enum BufferAccessStrategyType
 	BAS_VACUUM					/* VACUUM */
 } BufferAccessStrategyType;
 
+/* Possible values for buffer_replacement_policy */
+typedef enum BufferReplacementPolicy
+{
+	BUFFER_REPLACEMENT_CLOCK,	/* plain clock sweep */
+	BUFFER_REPLACEMENT_2Q		/* clock sweep with probation and ghosts */
+} BufferReplacementPolicy;
+
 /* Possible modes for ReadBufferExtended() */
 typedef enum
 {
@@ -47,8 +54,9 @@ typedef enum
 								 * replay; otherwise same as RBM_NORMAL */
 } ReadBufferMode;
 
-/* forward declared, to avoid having to expose buf_internals.h here */
+/* forward declared, to avoid having to expose buf_internals.h and smgr.h */
 struct WritebackContext;
+struct SMgrRelationData;
 
 /* in globals.c ... this duplicates miscadmin.h */
 extern PGDLLIMPORT int NBuffers;
@@ -59,6 +67,8 @@ extern int	bgwriter_lru_maxpages;
 extern double bgwriter_lru_multiplier;
 extern bool track_io_timing;
 extern int	target_prefetch_pages;
+extern int	sequential_prefetch_size;
+extern int	buffer_replacement_policy;
 
 extern int	checkpoint_flush_after;
 extern int	backend_flush_after;
@@ -78,6 +88,9 @@ extern PGDLLIMPORT int32 *LocalRefCount;
 /* upper limit for effective_io_concurrency */
 #define MAX_IO_CONCURRENCY 1000
 
+/* upper limit for sequential_prefetch_size */
+#define MAX_SEQUENTIAL_PREFETCH_SIZE 4096
+
 /* special block number for ReadBuffer() */
 #define P_NEW	InvalidBlockNumber		/* grow the file to get a new page */
 
@@ -165,6 +178,11 @@ extern PGDLLIMPORT int32 *LocalRefCount;
 extern bool ComputeIoConcurrency(int io_concurrency, double *target);
 extern void PrefetchBuffer(Relation reln, ForkNumber forkNum,
 			   BlockNumber blockNum);
+extern void PrefetchBufferRange(Relation reln, ForkNumber forkNum,
+					BlockNumber blockNum, BlockNumber nblocks);
+extern void PrefetchSharedBufferRange(struct SMgrRelationData *smgr_reln,
+						  ForkNumber forkNum, BlockNumber blockNum,
+						  BlockNumber nblocks);
 extern Buffer ReadBuffer(Relation reln, BlockNumber blockNum);
 extern Buffer ReadBufferExtended(Relation reln, ForkNumber forkNum,
 				   BlockNumber blockNum, ReadBufferMode mode,
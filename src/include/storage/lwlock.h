@@ -225,6 +225,13 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_MXACTMEMBER_BUFFERS,
 	LWTRANCHE_ASYNC_BUFFERS,
 	LWTRANCHE_OLDSERXID_BUFFERS,
+	LWTRANCHE_CLOG_BANKS,
+	LWTRANCHE_COMMITTS_BANKS,
+	LWTRANCHE_SUBTRANS_BANKS,
+	LWTRANCHE_MXACTOFFSET_BANKS,
+	LWTRANCHE_MXACTMEMBER_BANKS,
+	LWTRANCHE_ASYNC_BANKS,
+	LWTRANCHE_OLDSERXID_BANKS,
 	LWTRANCHE_WAL_INSERT,
 	LWTRANCHE_BUFFER_CONTENT,
 	LWTRANCHE_BUFFER_IO_IN_PROGRESS,
@@ -234,6 +241,8 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_BUFFER_MAPPING,
 	LWTRANCHE_LOCK_MANAGER,
 	LWTRANCHE_PREDICATE_LOCK_MANAGER,
+	LWTRANCHE_PARALLEL_BTREE_SCAN,
+	LWTRANCHE_PARALLEL_APPEND,
 	LWTRANCHE_FIRST_USER_DEFINED
 }	BuiltinTrancheIds;
 
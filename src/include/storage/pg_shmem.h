@@ -41,8 +41,9 @@ typedef struct PGShmemHeader	/* standard header for all Postgres shmem */
 #endif
 } PGShmemHeader;
 
-/* GUC variable */
+/* GUC variables */
 extern int	huge_pages;
+extern int	shared_memory_numa_policy;
 
 /* Possible values for huge_pages */
 typedef enum
@@ -52,6 +53,13 @@ typedef enum
 	HUGE_PAGES_TRY
 }	HugePagesType;
 
+/* Possible values for shared_memory_numa_policy */
+typedef enum
+{
+	SHMEM_NUMA_LOCAL,			/* kernel default: node of first touch */
+	SHMEM_NUMA_INTERLEAVE		/* spread pages across all nodes */
+}	SharedMemoryNumaPolicy;
+
 #ifndef WIN32
 extern unsigned long UsedShmemSegID;
 #else
@@ -68,5 +76,7 @@ extern PGShmemHeader *PGSharedMemoryCreate(Size size, bool makePrivate,
 					 int port, PGShmemHeader **shim);
 extern bool PGSharedMemoryIsInUse(unsigned long id1, unsigned long id2);
 extern void PGSharedMemoryDetach(void);
+extern void PGSharedMemorySetPlacement(void *addr, Size size,
+						   const char *name);
 
 #endif   /* PG_SHMEM_H */
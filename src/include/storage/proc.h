@@ -21,23 +21,42 @@
 #include "storage/pg_sema.h"
 
 /*
- * Each backend advertises up to PGPROC_MAX_CACHED_SUBXIDS TransactionIds
- * for non-aborted subtransactions of its current top transaction.  These
- * have to be treated as running XIDs by other backends.
+ * Each backend advertises up to max_cached_subxids TransactionIds for
+ * non-aborted subtransactions of its current top transaction.  These have to
+ * be treated as running XIDs by other backends.  The caches are allocated in
+ * shared memory at startup, separately from the PGPROCs, since their size
+ * is only known then.
  *
  * We also keep track of whether the cache overflowed (ie, the transaction has
  * generated at least one subtransaction that didn't fit in the cache).
  * If none of the caches have overflowed, we can assume that an XID that's not
  * listed anywhere in the PGPROC array is not a running transaction.  Else we
- * have to look at pg_subtrans.
+ * have to look at pg_subtrans, which is much slower, and which every snapshot
+ * taken while the transaction runs has to do too.
+ *
+ * PGPROC_MAX_CACHED_SUBXIDS is the number of subtransaction XIDs a hot
+ * standby tracks for each primary transaction (see xact.c's XID assignment
+ * records), and the smallest allowed max_cached_subxids.  It's part of the
+ * WAL protocol, so it doesn't vary with max_cached_subxids.
  */
 #define PGPROC_MAX_CACHED_SUBXIDS 64	/* XXX guessed-at value */
 
+/* Upper limit for max_cached_subxids */
+#define MAX_CACHED_SUBXIDS_LIMIT	PG_UINT16_MAX
+
 struct XidCache
 {
-	TransactionId xids[PGPROC_MAX_CACHED_SUBXIDS];
+	int			nxids;			/* # of valid entries in xids */
+	TransactionId *xids;		/* max_cached_subxids entries */
 };
 
+/*
+ * PGXACT->nxids mirrors PGPROC->subxids.nxids, but to keep PGXACT small it's
+ * a uint8 that sticks at PGXACT_NXIDS_SATURATED for caches at least that
+ * full.  Only then do readers need to fetch the exact count from the PGPROC.
+ */
+#define PGXACT_NXIDS_SATURATED	PG_UINT8_MAX
+
 /* Flags for PGXACT->vacuumFlags */
 #define		PROC_IS_AUTOVACUUM	0x01	/* is it an autovac worker? */
 #define		PROC_IN_VACUUM		0x02	/* currently running lazy vacuum */
@@ -51,12 +70,21 @@ struct XidCache
 	(PROC_IN_VACUUM | PROC_IN_ANALYZE | PROC_VACUUM_FOR_WRAPAROUND)
 
 /*
- * We allow a small number of "weak" relation locks (AccesShareLock,
+ * We allow a limited number of "weak" relation locks (AccesShareLock,
  * RowShareLock, RowExclusiveLock) to be recorded in the PGPROC structure
  * rather than the main lock table.  This eases contention on the lock
  * manager LWLocks.  See storage/lmgr/README for additional details.
+ *
+ * The slots are divided into groups of FP_LOCK_SLOTS_PER_GROUP, whose lock
+ * bits fit in one uint64.  The number of groups is derived from
+ * max_locks_per_transaction at startup.
  */
-#define		FP_LOCK_SLOTS_PER_BACKEND 16
+extern PGDLLIMPORT int FastPathLockGroupsPerBackend;
+
+#define		FP_LOCK_GROUPS_PER_BACKEND_MAX	1024
+#define		FP_LOCK_SLOTS_PER_GROUP			16	/* don't change */
+#define		FastPathLockSlotsPerBackend() \
+	(FP_LOCK_SLOTS_PER_GROUP * FastPathLockGroupsPerBackend)
 
 /*
  * An invalid pgprocno.  Must be larger than the maximum number of PGPROC
@@ -161,8 +189,9 @@ struct PGPROC
 	LWLock		backendLock;
 
 	/* Lock manager data, recording fast-path locks taken by this backend. */
-	uint64		fpLockBits;		/* lock modes held for each fast-path slot */
-	Oid			fpRelId[FP_LOCK_SLOTS_PER_BACKEND];		/* slots for rel oids */
+	uint64	   *fpLockBits;		/* lock modes held for each fast-path slot,
+								 * one uint64 per group */
+	Oid		   *fpRelId;		/* slots for rel oids */
 	bool		fpVXIDLock;		/* are we holding a fast-path VXID lock? */
 	LocalTransactionId fpLocalTransactionId;	/* lxid for fast-path VXID
 												 * lock */
@@ -206,9 +235,22 @@ typedef struct PGXACT
 	bool		delayChkpt;		/* true if this proc delays checkpoint start;
 								 * previously called InCommit */
 
-	uint8		nxids;
+	uint8		nxids;			/* # of entries in PGPROC->subxids, or
+								 * PGXACT_NXIDS_SATURATED if more */
 } PGXACT;
 
+/*
+ * Store the size of a subxid cache in both PGPROC and PGXACT.  The PGPROC
+ * is updated first, so that a reader who sees the new PGXACT value also
+ * sees the new exact count.
+ */
+#define SetProcSubxidCount(proc, pgxact, n) \
+	do { \
+		int			nxids_ = (n); \
+		(proc)->subxids.nxids = nxids_; \
+		(pgxact)->nxids = Min(nxids_, PGXACT_NXIDS_SATURATED); \
+	} while (0)
+
 /*
  * There is one ProcGlobal struct for the whole database cluster.
  */
@@ -262,6 +304,7 @@ extern int	StatementTimeout;
 extern int	LockTimeout;
 extern int	IdleInTransactionSessionTimeout;
 extern bool log_lock_waits;
+extern int	max_cached_subxids;
 
 
 /*
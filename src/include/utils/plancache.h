@@ -18,6 +18,9 @@
 #include "access/tupdesc.h"
 #include "nodes/params.h"
 
+/* avoid including nodes/plannodes.h here */
+struct PlannedStmt;
+
 #define CACHEDPLANSOURCE_MAGIC		195726186
 #define CACHEDPLAN_MAGIC			953717834
 
@@ -94,6 +97,8 @@ typedef struct CachedPlanSource
 	struct OverrideSearchPath *search_path;		/* search_path used for
 												 * parsing and planning */
 	MemoryContext query_context;	/* context holding the above, or NULL */
+	char	   *shared_key;		/* shared plan cache key, in query_context */
+	bool		shared_key_valid;		/* has shared_key been computed? */
 	Oid			rewriteRoleId;	/* Role ID we did rewriting for */
 	bool		rewriteRowSecurity;		/* row_security used during rewrite */
 	bool		dependsOnRLS;	/* is rewritten query specific to the above? */
@@ -138,6 +143,7 @@ typedef struct CachedPlan
 	int			generation;		/* parent's generation number for this plan */
 	int			refcount;		/* count of live references to this struct */
 	MemoryContext context;		/* context containing this CachedPlan */
+	bool		misestimated;	/* did execution show bad row estimates? */
 } CachedPlan;
 
 
@@ -177,4 +183,6 @@ extern CachedPlan *GetCachedPlan(CachedPlanSource *plansource,
 			  bool useResOwner);
 extern void ReleaseCachedPlan(CachedPlan *plan, bool useResOwner);
 
+extern void PlanCacheNoteMisestimate(struct PlannedStmt *stmt);
+
 #endif   /* PLANCACHE_H */
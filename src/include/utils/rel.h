@@ -99,6 +99,14 @@ typedef struct RelationData
 	Oid			rd_oidindex;	/* OID of unique index on OID, if any */
 	Oid			rd_replidindex; /* OID of replica identity index, if any */
 
+	/* data managed by RelationGetStatExtList: */
+	List	   *rd_statlist;	/* list of OIDs of extended stats */
+	bool		rd_statvalid;	/* true if list has been computed */
+
+	/* data managed by RelationGetCheckConstraintExprs: */
+	List	   *rd_checkexprs;	/* planner-ready CHECK constraint trees */
+	MemoryContext rd_checkcxt;	/* private memory cxt for rd_checkexprs */
+
 	/* data managed by RelationGetIndexAttrBitmap: */
 	Bitmapset  *rd_indexattr;	/* identifies columns used in indexes */
 	Bitmapset  *rd_keyattr;		/* cols that can be ref'd by foreign keys */
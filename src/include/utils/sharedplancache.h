@@ -0,0 +1,35 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.h
+ *	  Shared-memory cache of generic plans.
+ *
+ *
+ * Portions Copyright (c) 1996-2016, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/utils/sharedplancache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDPLANCACHE_H
+#define SHAREDPLANCACHE_H
+
+#include "storage/sinval.h"
+#include "utils/plancache.h"
+
+/* GUC variable */
+extern int	shared_plan_cache_size;
+
+extern Size SharedPlanCacheShmemSize(void);
+extern void SharedPlanCacheShmemInit(void);
+
+extern CachedPlan *SharedPlanCacheFetch(CachedPlanSource *plansource,
+					 double *total_custom_cost, int *num_custom_plans);
+extern uint32 SharedPlanCacheBeginPlan(void);
+extern void SharedPlanCacheStore(CachedPlanSource *plansource,
+					 CachedPlan *plan, uint32 generation);
+
+extern void SharedPlanCacheInvalidateMessages(const SharedInvalidationMessage *msgs,
+								  int n);
+
+#endif   /* SHAREDPLANCACHE_H */
@@ -109,6 +109,14 @@ typedef struct SnapshotData
 
 	int64		whenTaken;		/* timestamp when snapshot was taken */
 	XLogRecPtr	lsn;			/* position in the WAL stream when taken */
+
+	/*
+	 * The value of ShmemVariableCache->xactCompletionCount when the XID
+	 * arrays were last filled in, or 0 if they can't be reused.  Only
+	 * meaningful in the statically allocated snapshots that are passed to
+	 * GetSnapshotData.
+	 */
+	uint64		snapXactCompletionCount;
 } SnapshotData;
 
 /*
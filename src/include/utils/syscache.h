@@ -80,6 +80,8 @@ enum SysCacheIdentifier
 	REPLORIGIDENT,
 	REPLORIGNAME,
 	RULERELNAME,
+	STATEXTNAMENSP,
+	STATEXTOID,
 	STATRELATTINH,
 	TABLESPACEOID,
 	TRFOID,
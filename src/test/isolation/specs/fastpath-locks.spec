@@ -0,0 +1,60 @@
+# Fast-path locks on many relations
+#
+# A transaction that reads an inheritance tree with many children should be
+# able to take more than 16 of its relation locks via the fast path, and a
+# strong locker must still see every one of those locks, whichever fast-path
+# slot group it landed in.
+
+setup
+{
+  CREATE TABLE fpparent (i int);
+  DO $$
+  BEGIN
+    FOR n IN 1..200 LOOP
+      EXECUTE format('CREATE TABLE fpchild%s () INHERITS (fpparent)', n);
+    END LOOP;
+  END;
+  $$;
+  CREATE FUNCTION fplock_children() RETURNS int LANGUAGE plpgsql AS $$
+  DECLARE
+    nfailed int := 0;
+  BEGIN
+    FOR n IN 1..200 LOOP
+      BEGIN
+        EXECUTE format('LOCK TABLE fpchild%s IN ACCESS EXCLUSIVE MODE NOWAIT', n);
+      EXCEPTION WHEN lock_not_available THEN
+        nfailed := nfailed + 1;
+      END;
+    END LOOP;
+    RETURN nfailed;
+  END;
+  $$;
+}
+
+teardown
+{
+  DROP FUNCTION fplock_children();
+  DO $$
+  BEGIN
+    FOR n IN 1..200 LOOP
+      EXECUTE format('DROP TABLE fpchild%s', n);
+    END LOOP;
+  END;
+  $$;
+  DROP TABLE fpparent;
+}
+
+session "s1"
+setup		{ BEGIN; }
+step "s1read"	{ SELECT count(*) FROM fpparent; }
+step "s1fastpath"
+{
+  SELECT count(*) > 16 FROM pg_locks
+   WHERE pid = pg_backend_pid() AND locktype = 'relation' AND fastpath;
+}
+step "s1c"	{ COMMIT; }
+
+session "s2"
+step "s2lock"	{ SELECT fplock_children(); }
+
+permutation "s1read" "s1fastpath" "s2lock" "s1c" "s2lock"
@@ -0,0 +1,42 @@
+# Visibility of a transaction with many subtransactions
+#
+# Other sessions must treat all the subtransactions of a running transaction
+# as in progress, including ones beyond the old fixed-size subxid cache, and
+# must see the committed ones once it commits.  Every other subtransaction
+# aborts, which exercises removal of entries from the cache.
+
+setup
+{
+  CREATE TABLE subxids (i int);
+}
+
+teardown
+{
+  DROP TABLE subxids;
+}
+
+session "s1"
+setup		{ BEGIN; }
+step "s1sub"
+{
+  DO $$
+  BEGIN
+    FOR n IN 1..300 LOOP
+      BEGIN
+        INSERT INTO subxids VALUES (n);
+        IF n % 2 = 0 THEN
+          RAISE division_by_zero;
+        END IF;
+      EXCEPTION WHEN division_by_zero THEN
+        NULL;
+      END;
+    END LOOP;
+  END;
+  $$;
+}
+step "s1c"	{ COMMIT; }
+
+session "s2"
+step "s2count"	{ SELECT count(*), sum(i) FROM subxids; }
+
+permutation "s1sub" "s2count" "s1c" "s2count"
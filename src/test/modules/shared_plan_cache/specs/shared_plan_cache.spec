@@ -0,0 +1,50 @@
+# Shared plan cache
+#
+# s1 builds a generic plan with seqscans disabled, and s2 adopts it: its
+# plan uses an index scan although a seqscan is what s2 would choose itself.
+# The planner settings are changed in a step of their own, because the
+# source text of the PREPARE is part of the lookup key.
+# After s1 replaces the (inlined) function the plan depends on, neither s3,
+# which has not read the invalidation message yet, nor s2 may get the old
+# plan from the cache.
+
+setup
+{
+  CREATE TABLE spc_tab (a int PRIMARY KEY, b text);
+  INSERT INTO spc_tab SELECT g, 'row ' || g FROM generate_series(1, 1000) g;
+  ANALYZE spc_tab;
+  CREATE FUNCTION spc_bound() RETURNS int LANGUAGE sql IMMUTABLE AS 'SELECT 1';
+}
+
+teardown
+{
+  DROP TABLE spc_tab;
+  DROP FUNCTION spc_bound();
+}
+
+session "s1"
+setup
+{
+  PREPARE q AS SELECT count(b) FROM spc_tab WHERE a > spc_bound();
+}
+step "s1_noseqscan"	{ SET enable_seqscan = off; SET enable_bitmapscan = off; }
+step "s1_explain"	{ EXPLAIN (COSTS OFF) EXECUTE q; }
+step "s1_replace"	{ CREATE OR REPLACE FUNCTION spc_bound() RETURNS int LANGUAGE sql IMMUTABLE AS 'SELECT 990'; }
+
+session "s2"
+setup
+{
+  PREPARE q AS SELECT count(b) FROM spc_tab WHERE a > spc_bound();
+}
+step "s2_explain"	{ EXPLAIN (COSTS OFF) EXECUTE q; }
+step "s2_execute"	{ EXECUTE q; }
+
+session "s3"
+setup
+{
+  PREPARE q AS SELECT count(b) FROM spc_tab WHERE a > spc_bound();
+}
+step "s3_explain"	{ EXPLAIN (COSTS OFF) EXECUTE q; }
+step "s3_execute"	{ EXECUTE q; }
+
+permutation "s1_noseqscan" "s1_explain" "s2_explain" "s1_replace" "s3_explain" "s3_execute" "s2_explain" "s2_execute"
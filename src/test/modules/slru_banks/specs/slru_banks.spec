@@ -0,0 +1,74 @@
+# SLRU banks
+#
+# Runs with the SLRU buffer sizes in slru_banks.conf, so that the multixact
+# and notify code has to switch bank locks when the data it writes or reads
+# crosses a page boundary.  Three sessions key-share lock every row, which
+# creates multixacts with two and then three members; an update then reads
+# all their members and creates four-member multixacts.  That's tens of
+# thousands of members, spread over dozens of member pages.  A transaction
+# with a thousand subtransactions and a big batch of notifications exercise
+# pg_subtrans, pg_clog and pg_notify.
+
+setup
+{
+  CREATE TABLE slru_tab (a int PRIMARY KEY, b int);
+  INSERT INTO slru_tab SELECT g, 0 FROM generate_series(1, 5000) g;
+  CREATE TABLE slru_sub (a int);
+}
+
+teardown
+{
+  DROP TABLE slru_tab, slru_sub;
+}
+
+session "s1"
+step "s1_begin"		{ BEGIN; }
+step "s1_lock"		{ SELECT count(*) FROM (SELECT a FROM slru_tab FOR KEY SHARE) s; }
+step "s1_commit"	{ COMMIT; }
+
+session "s2"
+step "s2_begin"		{ BEGIN; }
+step "s2_lock"		{ SELECT count(*) FROM (SELECT a FROM slru_tab FOR KEY SHARE) s; }
+step "s2_commit"	{ COMMIT; }
+
+session "s3"
+step "s3_begin"		{ BEGIN; }
+step "s3_lock"		{ SELECT count(*) FROM (SELECT a FROM slru_tab FOR KEY SHARE) s; }
+step "s3_commit"	{ COMMIT; }
+
+session "s4"
+step "s4_members"
+{
+  SELECT count(*) AS nrows, min(n) AS min_members, max(n) AS max_members
+    FROM (SELECT (SELECT count(*) FROM pg_get_multixact_members(xmax) m
+                   WHERE m.mode = 'keysh') AS n
+            FROM slru_tab) s;
+}
+step "s4_update"	{ UPDATE slru_tab SET b = 1; }
+step "s4_updated"	{ SELECT count(*) FROM slru_tab WHERE b = 1; }
+step "s4_subxacts"	{ SELECT count(*) FROM slru_sub; }
+
+session "s5"
+step "s5_begin"		{ BEGIN; }
+step "s5_subxacts"
+{
+  DO $$
+  BEGIN
+    FOR i IN 1..1000 LOOP
+      BEGIN
+        INSERT INTO slru_sub VALUES (i);
+      EXCEPTION WHEN others THEN
+        NULL;
+      END;
+    END LOOP;
+  END $$;
+}
+step "s5_commit"	{ COMMIT; }
+step "s5_listen"	{ LISTEN slru_chan; }
+step "s5_notify"
+{
+  SELECT count(pg_notify('slru_chan', repeat('x', 2000) || g))
+    FROM generate_series(1, 200) g;
+}
+
+permutation "s1_begin" "s1_lock" "s2_begin" "s2_lock" "s3_begin" "s3_lock" "s4_members" "s4_update" "s1_commit" "s2_commit" "s3_commit" "s4_updated" "s5_begin" "s5_subxacts" "s4_subxacts" "s5_commit" "s4_subxacts" "s5_listen" "s5_notify"
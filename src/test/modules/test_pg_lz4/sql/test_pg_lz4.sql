@@ -0,0 +1,24 @@
+CREATE EXTENSION test_pg_lz4;
+
+-- round trips at and around the 512-byte and 2 * BLCKSZ boundaries
+CREATE TEMP TABLE lz4_inputs AS
+SELECT kord, sord, kind, label, rawlen
+FROM (VALUES (1, 'zeros'), (2, 'text'), (3, 'random')) AS k(kord, kind),
+     (VALUES (1, '512 - 1', 511), (2, '512', 512), (3, '512 + 1', 513),
+             (4, '2 * BLCKSZ - 1', 2 * current_setting('block_size')::int - 1),
+             (5, '2 * BLCKSZ', 2 * current_setting('block_size')::int),
+             (6, '2 * BLCKSZ + 1', 2 * current_setting('block_size')::int + 1))
+       AS s(sord, label, rawlen);
+
+SELECT kind, label, test_pg_lz4_roundtrip(kind, rawlen) < rawlen AS shrank
+FROM lz4_inputs ORDER BY kord, sord;
+
+-- truncated and corrupted input
+SELECT kind, label, test_pg_lz4_corrupt(kind, rawlen) AS rejected
+FROM lz4_inputs ORDER BY kord, sord;
+
+SELECT test_pg_lz4_malformed();
+
+-- bad arguments
+SELECT test_pg_lz4_roundtrip('zeros', 0);
+SELECT test_pg_lz4_roundtrip('bogus', 10);
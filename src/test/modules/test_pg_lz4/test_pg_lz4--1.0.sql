@@ -0,0 +1,18 @@
+/* src/test/modules/test_pg_lz4/test_pg_lz4--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_pg_lz4" to load this file. \quit
+
+CREATE FUNCTION test_pg_lz4_roundtrip(kind pg_catalog.text,
+					   rawlen pg_catalog.int4)
+    RETURNS pg_catalog.int4 STRICT
+	AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_pg_lz4_corrupt(kind pg_catalog.text,
+					   rawlen pg_catalog.int4)
+    RETURNS pg_catalog.bool STRICT
+	AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_pg_lz4_malformed()
+    RETURNS pg_catalog.void STRICT
+	AS 'MODULE_PATHNAME' LANGUAGE C;
@@ -0,0 +1,299 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_pg_lz4.c
+ *		Test code for the builtin LZ4 block compressor.
+ *
+ * Copyright (c) 2016, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_pg_lz4/test_pg_lz4.c
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "common/pg_lz4.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "utils/builtins.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_pg_lz4_roundtrip);
+PG_FUNCTION_INFO_V1(test_pg_lz4_corrupt);
+PG_FUNCTION_INFO_V1(test_pg_lz4_malformed);
+
+/* Largest input we let the caller ask for */
+#define MAX_RAW_SIZE		(1024 * 1024)
+
+/* Bytes appended to every output buffer to catch overruns */
+#define GUARD_SIZE			64
+#define GUARD_BYTE			0x7e
+
+static char *make_input(const char *kind, int32 rawlen);
+static int32 compress_input(const char *raw, int32 rawlen, char **compressed);
+static void check_guard(const char *buf, int32 len, const char *what);
+
+/*
+ * Build rawlen bytes of test input of the given kind.
+ *
+ * The "random" kind uses its own generator with a fixed seed, so that the
+ * compressed output, and therefore the test results, are the same on every
+ * run and platform.
+ */
+static char *
+make_input(const char *kind, int32 rawlen)
+{
+	static const char phrase[] = "the quick brown fox jumps over the lazy dog ";
+	char	   *raw;
+	int32		i;
+
+	if (rawlen < 1 || rawlen > MAX_RAW_SIZE)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("raw length must be between 1 and %d bytes",
+						MAX_RAW_SIZE)));
+
+	raw = palloc(rawlen);
+
+	if (strcmp(kind, "zeros") == 0)
+		memset(raw, 0, rawlen);
+	else if (strcmp(kind, "text") == 0)
+	{
+		for (i = 0; i < rawlen; i++)
+			raw[i] = phrase[i % (sizeof(phrase) - 1)];
+	}
+	else if (strcmp(kind, "random") == 0)
+	{
+		uint32		seed = 12345;
+
+		for (i = 0; i < rawlen; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			raw[i] = (char) (seed >> 16);
+		}
+	}
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("unrecognized input kind \"%s\"", kind)));
+
+	return raw;
+}
+
+/*
+ * Compress raw into a worst-case sized buffer, which must always succeed,
+ * and check that the same input does not fit in one byte less.
+ */
+static int32
+compress_input(const char *raw, int32 rawlen, char **compressed)
+{
+	int32		maxlen = PG_LZ4_MAX_OUTPUT(rawlen);
+	char	   *buf;
+	int32		clen;
+
+	buf = palloc(maxlen + GUARD_SIZE);
+	memset(buf + maxlen, GUARD_BYTE, GUARD_SIZE);
+
+	clen = pg_lz4_compress(raw, rawlen, buf, maxlen);
+	if (clen <= 0 || clen > maxlen)
+		elog(ERROR, "compressing %d bytes into %d bytes failed: %d",
+			 rawlen, maxlen, clen);
+	check_guard(buf + maxlen, GUARD_SIZE, "compression");
+
+	if (pg_lz4_compress(raw, rawlen, buf, clen - 1) != -1)
+		elog(ERROR, "compressing %d bytes into %d bytes did not fail",
+			 rawlen, clen - 1);
+	check_guard(buf + maxlen, GUARD_SIZE, "compression");
+
+	/* the short attempt may have clobbered the output, so redo it */
+	clen = pg_lz4_compress(raw, rawlen, buf, maxlen);
+
+	*compressed = buf;
+	return clen;
+}
+
+/*
+ * Complain if the guard area after an output buffer was written to.
+ */
+static void
+check_guard(const char *buf, int32 len, const char *what)
+{
+	int32		i;
+
+	for (i = 0; i < len; i++)
+	{
+		if ((unsigned char) buf[i] != GUARD_BYTE)
+			elog(ERROR, "%s wrote past the end of its output buffer", what);
+	}
+}
+
+/*
+ * Compress and decompress rawlen bytes of the given kind of input and check
+ * that the result matches.  Returns the compressed length.
+ */
+Datum
+test_pg_lz4_roundtrip(PG_FUNCTION_ARGS)
+{
+	char	   *kind = text_to_cstring(PG_GETARG_TEXT_PP(0));
+	int32		rawlen = PG_GETARG_INT32(1);
+	char	   *raw;
+	char	   *compressed;
+	char	   *decompressed;
+	int32		clen;
+	int32		result;
+
+	raw = make_input(kind, rawlen);
+	clen = compress_input(raw, rawlen, &compressed);
+
+	decompressed = palloc(rawlen + GUARD_SIZE);
+	memset(decompressed + rawlen, GUARD_BYTE, GUARD_SIZE);
+
+	result = pg_lz4_decompress(compressed, clen, decompressed, rawlen);
+	if (result != rawlen)
+		elog(ERROR, "decompressing %d bytes returned %d, expected %d",
+			 clen, result, rawlen);
+	check_guard(decompressed + rawlen, GUARD_SIZE, "decompression");
+	if (memcmp(raw, decompressed, rawlen) != 0)
+		elog(ERROR, "decompressed data does not match the input");
+
+	pfree(raw);
+	pfree(compressed);
+	pfree(decompressed);
+
+	PG_RETURN_INT32(clen);
+}
+
+/*
+ * Check that truncated and corrupted versions of the compressed form of
+ * rawlen bytes of the given kind of input are handled safely.
+ *
+ * Truncated input and a wrong raw length must always be rejected.  A
+ * flipped byte may land in literal data and go unnoticed, so for those we
+ * only insist that the decompressor stays within its output buffer and
+ * reports either failure or exactly rawlen bytes.  Returns true if at
+ * least one flipped input was rejected.
+ */
+Datum
+test_pg_lz4_corrupt(PG_FUNCTION_ARGS)
+{
+	char	   *kind = text_to_cstring(PG_GETARG_TEXT_PP(0));
+	int32		rawlen = PG_GETARG_INT32(1);
+	char	   *raw;
+	char	   *compressed;
+	char	   *decompressed;
+	int32		clen;
+	int32		result;
+	int32		truncated[3];
+	int32		i;
+	bool		rejected = false;
+
+	raw = make_input(kind, rawlen);
+	clen = compress_input(raw, rawlen, &compressed);
+
+	/* one spare byte so that a raw length one too large can be tried */
+	decompressed = palloc(rawlen + 1 + GUARD_SIZE);
+	memset(decompressed + rawlen, GUARD_BYTE, 1 + GUARD_SIZE);
+
+	truncated[0] = clen - 1;
+	truncated[1] = clen / 2;
+	truncated[2] = 1;
+	for (i = 0; i < lengthof(truncated); i++)
+	{
+		if (truncated[i] < 1)
+			continue;
+		result = pg_lz4_decompress(compressed, truncated[i],
+								   decompressed, rawlen);
+		if (result != -1)
+			elog(ERROR, "decompressing %d of %d bytes returned %d",
+				 truncated[i], clen, result);
+		check_guard(decompressed + rawlen, 1 + GUARD_SIZE, "decompression");
+	}
+
+	decompressed[rawlen - 1] = GUARD_BYTE;
+	result = pg_lz4_decompress(compressed, clen, decompressed, rawlen - 1);
+	if (result != -1)
+		elog(ERROR, "decompressing into a raw length one too small returned %d",
+			 result);
+	check_guard(decompressed + rawlen - 1, 1 + GUARD_SIZE, "decompression");
+	result = pg_lz4_decompress(compressed, clen, decompressed, rawlen + 1);
+	if (result != -1)
+		elog(ERROR, "decompressing into a raw length one too large returned %d",
+			 result);
+	check_guard(decompressed + rawlen + 1, GUARD_SIZE, "decompression");
+	memset(decompressed + rawlen, GUARD_BYTE, 1 + GUARD_SIZE);
+
+	for (i = 0; i < clen; i++)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		compressed[i] ^= 0xff;
+		result = pg_lz4_decompress(compressed, clen, decompressed, rawlen);
+		compressed[i] ^= 0xff;
+
+		if (result == -1)
+			rejected = true;
+		else if (result != rawlen)
+			elog(ERROR, "decompressing with byte %d flipped returned %d",
+				 i, result);
+		check_guard(decompressed + rawlen, 1 + GUARD_SIZE, "decompression");
+	}
+
+	pfree(raw);
+	pfree(compressed);
+	pfree(decompressed);
+
+	PG_RETURN_BOOL(rejected);
+}
+
+/*
+ * Check that a set of hand-built malformed inputs is rejected.
+ */
+Datum
+test_pg_lz4_malformed(PG_FUNCTION_ARGS)
+{
+	static const struct
+	{
+		const char *name;
+		const char *data;
+		int32		len;
+		int32		rawsize;
+	}			cases[] =
+	{
+		/* an empty input is never valid */
+		{"empty input", "", 0, 0},
+		/* one literal, then a match with offset 0 */
+		{"zero offset", "\x10" "a" "\x00\x00" "\x00", 5, 6},
+		/* one literal, then a match reaching back two bytes */
+		{"offset before start", "\x10" "a" "\x02\x00" "\x00", 5, 6},
+		/* a literal length extension byte is missing */
+		{"truncated literal length", "\xf0", 1, 15},
+		/* a match length extension byte is missing */
+		{"truncated match length", "\x1f" "a" "\x01\x00", 4, 20},
+		/* the offset is cut short */
+		{"truncated offset", "\x10" "a" "\x01", 3, 5},
+		/* more literals than the output can hold */
+		{"literal overrun", "\x40" "abcd", 5, 3},
+		/* a match running past the end of the output */
+		{"match overrun", "\x10" "a" "\x01\x00" "\x00", 5, 4},
+		/* valid data, but shorter than the expected raw length */
+		{"short output", "\x30" "abc", 4, 4}
+	};
+	char		buf[64 + GUARD_SIZE];
+	int32		i;
+
+	for (i = 0; i < lengthof(cases); i++)
+	{
+		int32		result;
+
+		memset(buf, GUARD_BYTE, sizeof(buf));
+		result = pg_lz4_decompress(cases[i].data, cases[i].len,
+								   buf, cases[i].rawsize);
+		if (result != -1)
+			elog(ERROR, "malformed input \"%s\" was accepted", cases[i].name);
+		check_guard(buf + cases[i].rawsize, GUARD_SIZE, "decompression");
+	}
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,13 @@
+CREATE EXTENSION test_subxids;
+
+-- more subtransactions than the subxid cache holds
+BEGIN;
+SELECT test_subxids(2000, 3);
+SELECT test_subxids(100);
+COMMIT;
+
+SELECT test_subxids(0);
+
+-- bad arguments
+SELECT test_subxids(-1);
+SELECT test_subxids(10, -1);
@@ -0,0 +1,9 @@
+/* src/test/modules/test_subxids/test_subxids--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_subxids" to load this file. \quit
+
+CREATE FUNCTION test_subxids(num_subxacts pg_catalog.int4,
+					   abort_interval pg_catalog.int4 default 0)
+    RETURNS pg_catalog.void STRICT
+	AS 'MODULE_PATHNAME' LANGUAGE C;
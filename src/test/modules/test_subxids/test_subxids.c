@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_subxids.c
+ *		Benchmark for transactions with many subtransactions.
+ *
+ * Copyright (c) 2016, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_subxids/test_subxids.c
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/xact.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "utils/resowner.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_subxids);
+
+/*
+ * Start num_subxacts subtransactions one after another, assign each an XID,
+ * and release it into the current transaction.  If abort_interval is
+ * positive, every abort_interval'th subtransaction is rolled back instead.
+ *
+ * The committed subtransactions stay in the caller's subxid cache until the
+ * top-level transaction ends, so calling this inside an open transaction
+ * sets up the same situation as a long series of SAVEPOINTs or PL/pgSQL
+ * exception blocks that modify data.
+ */
+Datum
+test_subxids(PG_FUNCTION_ARGS)
+{
+	int32		num_subxacts = PG_GETARG_INT32(0);
+	int32		abort_interval = PG_GETARG_INT32(1);
+	MemoryContext oldcontext = CurrentMemoryContext;
+	ResourceOwner oldowner = CurrentResourceOwner;
+	int32		i;
+
+	if (num_subxacts < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("number of subtransactions must be a non-negative integer")));
+	if (abort_interval < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("abort interval must be a non-negative integer")));
+
+	for (i = 0; i < num_subxacts; i++)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		BeginInternalSubTransaction(NULL);
+		(void) GetCurrentTransactionId();
+
+		if (abort_interval > 0 && (i + 1) % abort_interval == 0)
+			RollbackAndReleaseCurrentSubTransaction();
+		else
+			ReleaseCurrentSubTransaction();
+
+		MemoryContextSwitchTo(oldcontext);
+		CurrentResourceOwner = oldowner;
+	}
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,10 @@
+CREATE EXTENSION test_wal_insert;
+
+SELECT test_wal_insert(100);
+SELECT test_wal_insert(10, 8192, 3);
+SELECT test_wal_insert(0);
+
+-- bad arguments
+SELECT test_wal_insert(-1);
+SELECT test_wal_insert(10, 0);
+SELECT test_wal_insert(10, 100, -1);
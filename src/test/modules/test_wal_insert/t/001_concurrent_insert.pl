@@ -0,0 +1,63 @@
+# Drive WAL insertion from many sessions at once, and check that the
+# resulting WAL has an intact prev-link chain and can be replayed
+use strict;
+use warnings;
+
+use TestLib;
+use Test::More tests => 5;
+use PostgresNode;
+
+my $clients      = 16;
+my $transactions = 20;
+my $records      = 100;
+
+# Few insertion locks and many clients, so that reservations race
+my $node = get_new_node('main');
+$node->init;
+$node->append_conf('postgresql.conf', qq(
+wal_insert_locks = 2
+max_connections = 30
+max_wal_size = 1GB
+));
+$node->start;
+$node->safe_psql('postgres', 'CREATE EXTENSION test_wal_insert');
+
+my $script = $node->basedir . '/wal_insert.sql';
+append_to_file($script, qq(\\set size random(1, 2000)
+\\set flush random(0, 1) * 25
+SELECT test_wal_insert($records, :size, :flush);
+));
+
+my $start_lsn =
+  $node->safe_psql('postgres', 'SELECT pg_current_xlog_location()');
+
+$node->command_ok(
+	[   'pgbench', '-n', '-f', $script, '-c', $clients, '-j', '4',
+		'-t', $transactions, 'postgres' ],
+	'concurrent WAL insertion');
+
+# a commit flushes everything inserted by the benchmark
+$node->safe_psql('postgres', 'CREATE TABLE wal_insert_end (a int)');
+my $end_lsn =
+  $node->safe_psql('postgres', 'SELECT pg_current_xlog_location()');
+
+# pg_xlogdump checks every record's prev-link against the record before it
+my ($stdout, $stderr);
+my $result = IPC::Run::run [
+	'pg_xlogdump', '-r', 'XLOG',
+	'-p',          $node->data_dir . '/pg_xlog',
+	'-s',          $start_lsn,
+	'-e',          $end_lsn ],
+  '>', \$stdout, '2>', \$stderr;
+ok($result, 'pg_xlogdump reads the concurrently inserted WAL');
+is($stderr, '', 'pg_xlogdump reports no errors');
+
+my $noops = () = $stdout =~ /desc: NOOP/g;
+is($noops, $clients * $transactions * $records,
+	'every inserted record is in the WAL');
+
+# Crash recovery must replay the same WAL
+$node->stop('immediate');
+$node->start;
+is($node->safe_psql('postgres', 'SELECT count(*) FROM wal_insert_end'),
+	'0', 'crash recovery after concurrent WAL insertion');
@@ -0,0 +1,10 @@
+/* src/test/modules/test_wal_insert/test_wal_insert--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_wal_insert" to load this file. \quit
+
+CREATE FUNCTION test_wal_insert(num_records pg_catalog.int4,
+					   record_size pg_catalog.int4 default 100,
+					   flush_interval pg_catalog.int4 default 0)
+    RETURNS pg_catalog.void STRICT
+	AS 'MODULE_PATHNAME' LANGUAGE C;
@@ -0,0 +1,88 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_wal_insert.c
+ *		Microbenchmark for concurrent WAL insertion.
+ *
+ * Copyright (c) 2016, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_wal_insert/test_wal_insert.c
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/xlog.h"
+#include "access/xloginsert.h"
+#include "catalog/pg_control.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_wal_insert);
+
+/* Largest record payload we let the caller ask for */
+#define MAX_RECORD_SIZE		(1024 * 1024)
+
+/*
+ * Insert num_records no-op WAL records with record_size bytes of payload
+ * each.  If flush_interval is positive, flush the WAL after every that many
+ * records, and at the end.
+ *
+ * Nothing but the WAL insertion itself is done, so running this from many
+ * sessions at once (for example with pgbench) measures how well WAL
+ * reservation and the insertion locks scale.
+ */
+Datum
+test_wal_insert(PG_FUNCTION_ARGS)
+{
+	int32		num_records = PG_GETARG_INT32(0);
+	int32		record_size = PG_GETARG_INT32(1);
+	int32		flush_interval = PG_GETARG_INT32(2);
+	char	   *payload;
+	XLogRecPtr	recptr = InvalidXLogRecPtr;
+	int32		i;
+
+	if (num_records < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("number of records must be a non-negative integer")));
+	if (record_size < 1 || record_size > MAX_RECORD_SIZE)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("record size must be between 1 and %d bytes",
+						MAX_RECORD_SIZE)));
+	if (flush_interval < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("flush interval must be a non-negative integer")));
+
+	if (RecoveryInProgress())
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("recovery is in progress"),
+				 errhint("WAL cannot be inserted during recovery.")));
+
+	payload = palloc0(record_size);
+
+	for (i = 0; i < num_records; i++)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		XLogBeginInsert();
+		XLogRegisterData(payload, record_size);
+		recptr = XLogInsert(RM_XLOG_ID, XLOG_NOOP);
+
+		if (flush_interval > 0 && (i + 1) % flush_interval == 0)
+			XLogFlush(recptr);
+	}
+
+	if (flush_interval > 0 && recptr != InvalidXLogRecPtr)
+		XLogFlush(recptr);
+
+	pfree(payload);
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,96 @@
+# Test crash recovery and streaming replay with parallel redo workers
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 6;
+
+# Replay a workload that exercises the record types workers apply (heap
+# inserts, deletes, HOT updates and btree leaf inserts) interleaved with
+# barrier records, including visibility map changes from VACUUM.
+sub run_workload
+{
+	my ($node) = @_;
+
+	$node->safe_psql('postgres', qq(
+		CREATE TABLE tab_redo (a int PRIMARY KEY, b int, c text);
+		INSERT INTO tab_redo SELECT g, g % 100, repeat('x', 100)
+		  FROM generate_series(1, 20000) g;
+		VACUUM tab_redo;
+		UPDATE tab_redo SET b = b + 1 WHERE a % 3 = 0;
+		DELETE FROM tab_redo WHERE a % 7 = 0;
+		INSERT INTO tab_redo SELECT g, g % 100, 'y'
+		  FROM generate_series(20001, 30000) g;
+		VACUUM tab_redo;
+		UPDATE tab_redo SET c = 'z' WHERE a % 11 = 0;
+		CREATE INDEX tab_redo_b ON tab_redo (b);
+	));
+}
+
+my $check_query = qq(
+	SET enable_seqscan = off;
+	SELECT count(*), sum(a), sum(b), count(*) FILTER (WHERE c = 'z')
+	  FROM tab_redo WHERE b >= 0;
+);
+
+my $node_master = get_new_node('master');
+$node_master->init(allows_streaming => 1);
+$node_master->append_conf('postgresql.conf', qq(
+parallel_redo_workers = 2
+max_worker_processes = 8
+log_min_messages = debug1
+));
+$node_master->start;
+
+# Crash recovery
+$node_master->safe_psql('postgres', 'CHECKPOINT');
+run_workload($node_master);
+my $expected = $node_master->safe_psql('postgres', $check_query);
+
+$node_master->stop('immediate');
+$node_master->start;
+
+like(
+	slurp_file($node_master->logfile),
+	qr/started 2 parallel redo workers/,
+	'crash recovery started parallel redo workers');
+is($node_master->safe_psql('postgres', $check_query),
+	$expected, 'crash recovery with parallel redo workers');
+is( $node_master->safe_psql(
+		'postgres',
+		'SELECT count(*) FROM tab_redo WHERE a <= 20000 AND a % 7 = 0'),
+	'0',
+	'deleted rows stay deleted after crash recovery');
+
+# Streaming replay
+my $backup_name = 'my_backup';
+$node_master->backup($backup_name);
+my $node_standby = get_new_node('standby');
+$node_standby->init_from_backup($node_master, $backup_name,
+	has_streaming => 1);
+$node_standby->start;
+
+$node_master->safe_psql('postgres', 'DROP TABLE tab_redo');
+run_workload($node_master);
+$expected = $node_master->safe_psql('postgres', $check_query);
+
+my $applname = $node_standby->name;
+my $caughtup_query =
+"SELECT pg_current_xlog_location() <= replay_location FROM pg_stat_replication WHERE application_name = '$applname';";
+$node_master->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for standby to catch up";
+
+like(
+	slurp_file($node_standby->logfile),
+	qr/started 2 parallel redo workers/,
+	'standby started parallel redo workers');
+is($node_standby->safe_psql('postgres', $check_query),
+	$expected, 'streaming replay with parallel redo workers');
+
+# Promotion shuts the workers down and ends recovery
+$node_standby->promote;
+$node_standby->poll_query_until('postgres',
+	'SELECT NOT pg_is_in_recovery()')
+  or die "Timed out while waiting for promotion";
+is($node_standby->safe_psql('postgres', $check_query),
+	$expected, 'promoted standby has replayed everything');
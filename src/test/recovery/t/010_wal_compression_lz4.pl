@@ -0,0 +1,88 @@
+# Test replay and pg_xlogdump of WAL written with wal_compression = lz4
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 6;
+
+# Generate full-page images and records with large main data.  Logical
+# messages between XLR_DATA_COMPRESS_MIN and XLR_DATA_COMPRESS_MAX bytes
+# have their main data compressed; the larger one is stored as is.
+sub run_workload
+{
+	my ($node) = @_;
+
+	$node->safe_psql('postgres', qq(
+		CHECKPOINT;
+		INSERT INTO tab_lz4 SELECT g, repeat(md5(g::text), 4)
+		  FROM generate_series(1, 5000) g;
+		CHECKPOINT;
+		UPDATE tab_lz4 SET b = md5(b) WHERE a % 5 = 0;
+		SELECT pg_logical_emit_message(false, 'lz4', repeat('x', 4000));
+		SELECT pg_logical_emit_message(false, 'lz4',
+		  string_agg(md5(g::text), '')) FROM generate_series(1, 20) g;
+		SELECT pg_logical_emit_message(false, 'lz4', repeat('y', 40000));
+		DELETE FROM tab_lz4 WHERE a % 7 = 0;
+	));
+}
+
+my $check_query =
+  'SELECT count(*), sum(a), md5(string_agg(b, \',\' ORDER BY a)) FROM tab_lz4';
+
+my $node_master = get_new_node('master');
+$node_master->init(allows_streaming => 1);
+$node_master->append_conf('postgresql.conf', qq(
+wal_compression = lz4
+full_page_writes = on
+));
+$node_master->start;
+$node_master->safe_psql('postgres',
+	'CREATE TABLE tab_lz4 (a int PRIMARY KEY, b text)');
+
+my $backup_name = 'my_backup';
+$node_master->backup($backup_name);
+my $node_standby = get_new_node('standby');
+$node_standby->init_from_backup($node_master, $backup_name,
+	has_streaming => 1);
+$node_standby->start;
+
+# Streaming replay
+my $start_lsn =
+  $node_master->safe_psql('postgres', 'SELECT pg_current_xlog_location()');
+run_workload($node_master);
+
+# a commit flushes everything written by the workload
+$node_master->safe_psql('postgres', 'CREATE TABLE tab_lz4_end (a int)');
+my $end_lsn =
+  $node_master->safe_psql('postgres', 'SELECT pg_current_xlog_location()');
+my $expected = $node_master->safe_psql('postgres', $check_query);
+
+my $applname = $node_standby->name;
+my $caughtup_query =
+"SELECT '$end_lsn'::pg_lsn <= replay_location FROM pg_stat_replication WHERE application_name = '$applname';";
+$node_master->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for standby to catch up";
+
+is($node_standby->safe_psql('postgres', $check_query),
+	$expected, 'streaming replay of lz4-compressed WAL');
+
+# pg_xlogdump must decompress the same records
+my ($stdout, $stderr);
+my $result = IPC::Run::run [
+	'pg_xlogdump', '-b',
+	'-p',          $node_master->data_dir . '/pg_xlog',
+	'-s',          $start_lsn,
+	'-e',          $end_lsn ],
+  '>', \$stdout, '2>', \$stderr;
+ok($result, 'pg_xlogdump reads lz4-compressed WAL');
+is($stderr, '', 'pg_xlogdump reports no errors');
+like($stdout, qr/\(FPW\);.*method: lz4/,
+	'pg_xlogdump shows lz4-compressed page images');
+like($stdout, qr/nontransactional message size 4000 bytes/,
+	'pg_xlogdump decodes compressed main data');
+
+# Crash recovery
+$node_master->stop('immediate');
+$node_master->start;
+is($node_master->safe_psql('postgres', $check_query),
+	$expected, 'crash recovery of lz4-compressed WAL');
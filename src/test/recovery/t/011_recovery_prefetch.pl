@@ -0,0 +1,133 @@
+# Test crash recovery and streaming replay with WAL prefetching enabled,
+# including records that remove relation files the prefetcher may have open
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 6;
+
+# Recreate a database and a tablespace under the same names, with tables
+# that are written after the old ones are dropped, so that replay and the
+# prefetcher see the same relations come and go.  There are no checkpoints
+# in between, so crash recovery replays all of it.
+sub run_workload
+{
+	my ($node, $tablespace_dir) = @_;
+
+	foreach my $round (1 .. 2)
+	{
+		$node->safe_psql('postgres', qq(
+			CREATE DATABASE db_prefetch;
+			CREATE TABLESPACE ts_prefetch LOCATION '$tablespace_dir';
+		));
+		$node->safe_psql('db_prefetch', qq(
+			CREATE TABLE tab_db (a int PRIMARY KEY, b text);
+			INSERT INTO tab_db SELECT g, repeat('x', 100)
+			  FROM generate_series(1, 10000) g;
+			UPDATE tab_db SET b = 'y' WHERE a % 3 = 0;
+		));
+		$node->safe_psql('postgres', qq(
+			CREATE TABLE tab_ts (a int, b text) TABLESPACE ts_prefetch;
+			INSERT INTO tab_ts SELECT g, 'z' FROM generate_series(1, 10000) g;
+			UPDATE tab_ts SET b = 'w' WHERE a % 5 = 0;
+			DROP TABLE tab_ts;
+			DROP TABLESPACE ts_prefetch;
+			DROP DATABASE db_prefetch;
+		));
+	}
+
+	$node->safe_psql('postgres', qq(
+		CREATE DATABASE db_prefetch;
+		CREATE TABLE tab_main (a int PRIMARY KEY, b int);
+		INSERT INTO tab_main SELECT g, g FROM generate_series(1, 20000) g;
+		UPDATE tab_main SET b = b + 1 WHERE a % 2 = 0;
+		DELETE FROM tab_main WHERE a % 7 = 0;
+	));
+	$node->safe_psql('db_prefetch', qq(
+		CREATE TABLE tab_db (a int PRIMARY KEY, b text);
+		INSERT INTO tab_db SELECT g, 'v' FROM generate_series(1, 1000) g;
+	));
+}
+
+my $check_main = 'SELECT count(*), sum(a), sum(b) FROM tab_main';
+my $check_db   = 'SELECT count(*), sum(a) FROM tab_db';
+
+my $node_master = get_new_node('master');
+$node_master->init(allows_streaming => 1);
+$node_master->append_conf('postgresql.conf', qq(
+recovery_prefetch_distance = 256kB
+log_min_messages = debug1
+));
+$node_master->start;
+
+# Crash recovery
+my $tablespace_dir = TestLib::tempdir;
+$node_master->safe_psql('postgres', 'CHECKPOINT');
+run_workload($node_master, $tablespace_dir);
+my $expected_main = $node_master->safe_psql('postgres', $check_main);
+my $expected_db = $node_master->safe_psql('db_prefetch', $check_db);
+
+$node_master->stop('immediate');
+$node_master->start;
+
+like(
+	slurp_file($node_master->logfile),
+	qr/recovery prefetched \d+ blocks/,
+	'crash recovery prefetched blocks');
+is($node_master->safe_psql('postgres', $check_main),
+	$expected_main, 'crash recovery with prefetching');
+is($node_master->safe_psql('db_prefetch', $check_db),
+	$expected_db, 'crash recovery of a recreated database');
+
+# Streaming replay.  The standby would share the tablespace location with
+# the master, so only the database part of the workload runs here.
+$node_master->safe_psql('postgres', 'DROP DATABASE db_prefetch');
+$node_master->safe_psql('postgres', 'DROP TABLE tab_main');
+
+my $backup_name = 'my_backup';
+$node_master->backup($backup_name);
+my $node_standby = get_new_node('standby');
+$node_standby->init_from_backup($node_master, $backup_name,
+	has_streaming => 1);
+$node_standby->start;
+
+foreach my $round (1 .. 3)
+{
+	$node_master->safe_psql('postgres', 'CREATE DATABASE db_prefetch');
+	$node_master->safe_psql('db_prefetch', qq(
+		CREATE TABLE tab_db (a int PRIMARY KEY, b text);
+		INSERT INTO tab_db SELECT g, repeat('x', 100)
+		  FROM generate_series(1, 10000 * $round) g;
+		UPDATE tab_db SET b = 'y' WHERE a % 3 = 0;
+	));
+	$node_master->safe_psql('postgres', 'DROP DATABASE db_prefetch')
+	  if $round < 3;
+}
+$node_master->safe_psql('postgres', qq(
+	CREATE TABLE tab_main (a int PRIMARY KEY, b int);
+	INSERT INTO tab_main SELECT g, g FROM generate_series(1, 20000) g;
+	UPDATE tab_main SET b = b + 1 WHERE a % 2 = 0;
+));
+$expected_main = $node_master->safe_psql('postgres', $check_main);
+$expected_db = $node_master->safe_psql('db_prefetch', $check_db);
+
+my $applname = $node_standby->name;
+my $caughtup_query =
+"SELECT pg_current_xlog_location() <= replay_location FROM pg_stat_replication WHERE application_name = '$applname';";
+$node_master->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for standby to catch up";
+
+is($node_standby->safe_psql('postgres', $check_main),
+	$expected_main, 'streaming replay with prefetching');
+is($node_standby->safe_psql('db_prefetch', $check_db),
+	$expected_db, 'streaming replay of a recreated database');
+
+# Promotion ends recovery, which reports the prefetch statistics
+$node_standby->promote;
+$node_standby->poll_query_until('postgres',
+	'SELECT NOT pg_is_in_recovery()')
+  or die "Timed out while waiting for promotion";
+like(
+	slurp_file($node_standby->logfile),
+	qr/recovery prefetched \d+ blocks/,
+	'standby prefetched blocks');
@@ -562,3 +562,92 @@ FROM generate_series(1, 3) g(i);
 reset enable_seqscan;
 reset enable_indexscan;
 reset enable_bitmapscan;
+
+--
+-- Partition-wise join and aggregation of inheritance trees
+--
+create table pwj_a (k int, v int);
+alter table pwj_a add constraint pwj_a_empty check (false) no inherit;
+create table pwj_a1 (check (k >= 0 and k < 100)) inherits (pwj_a);
+create table pwj_a2 (check (k >= 100 and k < 200)) inherits (pwj_a);
+create table pwj_b (k int, w int);
+alter table pwj_b add constraint pwj_b_empty check (false) no inherit;
+create table pwj_b1 (check (k >= 0 and k < 100)) inherits (pwj_b);
+create table pwj_b2 (check (k >= 100 and k < 200)) inherits (pwj_b);
+insert into pwj_a1 select i, i % 10 from generate_series(0, 99) i;
+insert into pwj_a2 select i, i % 10 from generate_series(100, 199) i;
+insert into pwj_b1 select i, i % 7 from generate_series(0, 99, 2) i;
+insert into pwj_b2 select i, i % 7 from generate_series(100, 199, 2) i;
+analyze pwj_a;
+analyze pwj_a1;
+analyze pwj_a2;
+analyze pwj_b;
+analyze pwj_b1;
+analyze pwj_b2;
+
+set enable_partitionwise_join = on;
+explain (costs off)
+select count(*) from pwj_a, pwj_b where pwj_a.k = pwj_b.k;
+select count(*) from pwj_a, pwj_b where pwj_a.k = pwj_b.k;
+select count(*) from pwj_a left join pwj_b on pwj_a.k = pwj_b.k;
+select count(*) from pwj_a where not exists
+  (select 1 from pwj_b where pwj_b.k = pwj_a.k);
+
+-- a join clause on another column can't be used
+explain (costs off)
+select count(*) from pwj_a, pwj_b where pwj_a.v = pwj_b.w;
+
+set enable_partitionwise_aggregate = on;
+select v, count(*), sum(k) from pwj_a group by v order by v;
+select pwj_a.v, sum(pwj_b.w) from pwj_a, pwj_b
+  where pwj_a.k = pwj_b.k group by pwj_a.v order by pwj_a.v;
+reset enable_partitionwise_aggregate;
+reset enable_partitionwise_join;
+drop table pwj_a cascade;
+drop table pwj_b cascade;
+
+--
+-- Run-time exclusion of inheritance children, using Param values
+--
+create table rtp (a int);
+create table rtp1 (check (a >= 1 and a < 10)) inherits (rtp);
+create table rtp2 (check (a >= 10 and a < 20)) inherits (rtp);
+create table rtp3 (check (a >= 20 and a < 30)) inherits (rtp);
+insert into rtp1 values (1), (2);
+insert into rtp2 values (11), (12);
+insert into rtp3 values (21), (22);
+
+create function explain_rtp(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in execute 'explain (analyze, costs off, timing off) ' || query
+    loop
+        -- the timing lines vary from run to run
+        continue when ln like 'Planning time:%' or ln like 'Execution time:%';
+        return next ln;
+    end loop;
+end;
+$$;
+
+-- only rtp and rtp2 can contain matching rows
+select explain_rtp('select * from rtp where a = (select 11)');
+select * from rtp where a = (select 11);
+-- a NULL value excludes every child that has a constraint
+select * from rtp where a = (select null::int);
+
+drop function explain_rtp(text);
+drop table rtp cascade;
+
+--
+-- Constraint exclusion must notice changes to the children's constraints
+--
+create table lcx (a int);
+create table lcx1 (constraint lcx1_a check (a < 10)) inherits (lcx);
+create table lcx2 (constraint lcx2_a check (a >= 10)) inherits (lcx);
+explain (costs off) select * from lcx where a = 5;
+alter table lcx2 drop constraint lcx2_a;
+explain (costs off) select * from lcx where a = 5;
+drop table lcx cascade;
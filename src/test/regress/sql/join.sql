@@ -1758,3 +1758,21 @@ from fkest f
 where f.c = 1;
 
 rollback;
+
+--
+-- test greedy join search
+--
+
+set greedy_join_threshold = 2;
+
+select count(*)
+from tenk1 a
+  join tenk1 b on a.unique1 = b.unique2
+  join int4_tbl c on a.unique1 = c.f1
+  left join onek d on b.unique2 = d.unique1;
+
+select count(*)
+from int4_tbl i4, int8_tbl i8, tenk1 t
+where t.unique1 = i4.f1;
+
+reset greedy_join_threshold;
@@ -156,3 +156,30 @@ end$$ language plpgsql;
 
 select cachebug();
 select cachebug();
+
+-- Check that a generic plan whose row estimates turn out to be badly wrong
+-- is not reused
+
+create temp table skewed as
+  select case when i <= 990 then 1 else i end as a, i as b
+  from generate_series(1, 1000) i;
+analyze skewed;
+
+set misestimate_replan_ratio = 0.5;  -- fail, would flag every plan
+set misestimate_replan_ratio = 10;
+
+prepare p3(int) as select b from skewed where a = $1 order by b desc limit 1;
+
+-- the first five executions get custom plans; after that, generic is used
+execute p3(995);
+execute p3(995);
+execute p3(995);
+execute p3(995);
+execute p3(995);
+explain (costs off) execute p3(995);
+
+-- the generic plan's sort expects 91 rows, but will see 990
+execute p3(1);
+explain (costs off) execute p3(995);
+
+reset misestimate_replan_ratio;
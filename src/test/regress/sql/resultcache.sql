@@ -0,0 +1,69 @@
+--
+-- Result Cache
+--
+
+-- Run EXPLAIN ANALYZE, hiding the numbers that vary from run to run
+CREATE FUNCTION explain_resultcache(query text) RETURNS SETOF text
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+BEGIN
+    FOR ln IN
+        EXECUTE format('EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF) %s', query)
+    LOOP
+        IF ln LIKE 'Planning time:%' OR ln LIKE 'Execution time:%' THEN
+            CONTINUE;
+        END IF;
+        ln := regexp_replace(ln, 'Memory Usage: \d+', 'Memory Usage: N');
+        RETURN NEXT ln;
+    END LOOP;
+END;
+$$;
+
+CREATE TABLE rc_outer (a int, n numeric);
+INSERT INTO rc_outer SELECT g % 10, g FROM generate_series(1, 1000) g;
+CREATE TABLE rc_inner (a int PRIMARY KEY, b text);
+INSERT INTO rc_inner SELECT g, 'row ' || g FROM generate_series(1, 10000) g;
+ANALYZE rc_outer;
+ANALYZE rc_inner;
+
+SET enable_resultcache = on;
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SET enable_material = off;
+SET enable_bitmapscan = off;
+
+-- Ten distinct outer keys, each seen a hundred times
+SELECT explain_resultcache('
+SELECT count(*), max(i.b) FROM rc_outer o JOIN rc_inner i ON i.a = o.a');
+SELECT count(*), max(i.b) FROM rc_outer o JOIN rc_inner i ON i.a = o.a;
+
+-- Same answer without the cache
+SET enable_resultcache = off;
+SELECT count(*), max(i.b) FROM rc_outer o JOIN rc_inner i ON i.a = o.a;
+SET enable_resultcache = on;
+
+-- Keys that are equal but distinguishable must not share cache entries:
+-- numeric 1.0 = 1.00, but their text forms differ.
+CREATE TABLE rc_num_outer (n numeric);
+INSERT INTO rc_num_outer
+  SELECT CASE WHEN g % 2 = 0 THEN 1.0 ELSE 1.00 END
+  FROM generate_series(1, 100) g;
+CREATE TABLE rc_num_inner (t text PRIMARY KEY);
+INSERT INTO rc_num_inner VALUES ('1.0'), ('1.00');
+ANALYZE rc_num_outer;
+ANALYZE rc_num_inner;
+
+SELECT i.t, count(*)
+  FROM rc_num_outer o JOIN rc_num_inner i ON i.t = o.n::text
+  GROUP BY i.t ORDER BY i.t;
+
+RESET enable_resultcache;
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+RESET enable_material;
+RESET enable_bitmapscan;
+
+DROP TABLE rc_outer, rc_inner, rc_num_outer, rc_num_inner;
+DROP FUNCTION explain_resultcache(text);
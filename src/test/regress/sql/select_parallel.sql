@@ -19,6 +19,22 @@ explain (costs off)
   select count(*) from a_star;
 select count(*) from a_star;
 
+-- test Parallel Append mixing partial and non-partial subplans
+alter table c_star set (parallel_workers = 0);
+alter table d_star set (parallel_workers = 0);
+explain (costs off)
+  select count(*) from a_star;
+select count(*) from a_star;
+
+-- without Parallel Append, we can't use a partial plan at all
+set enable_parallel_append to off;
+explain (costs off)
+  select count(*) from a_star;
+select count(*) from a_star;
+reset enable_parallel_append;
+alter table c_star reset (parallel_workers);
+alter table d_star reset (parallel_workers);
+
 -- test that parallel_restricted function doesn't run in worker
 alter table tenk1 set (parallel_workers = 4);
 explain (verbose, costs off)
@@ -39,6 +55,53 @@ explain (costs off)
 	select  sum(parallel_restricted(unique1)) from tenk1
 	group by(parallel_restricted(unique1));
 
+-- test parallel index scans.
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+
+explain (costs off)
+	select  count((unique1)) from tenk1 where hundred > 1;
+select  count((unique1)) from tenk1 where hundred > 1;
+
+-- test parallel index-only scans.
+explain (costs off)
+	select  count(*) from tenk1 where thousand > 95;
+select  count(*) from tenk1 where thousand > 95;
+
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+-- test parallel bitmap heap scan.
+set enable_seqscan to off;
+set enable_indexscan to off;
+
+explain (costs off)
+	select  count((unique1)) from tenk1 where hundred > 1;
+select  count((unique1)) from tenk1 where hundred > 1;
+
+reset enable_seqscan;
+reset enable_indexscan;
+
+-- test partial aggregation of string_agg and array_agg
+explain (costs off)
+	select length(string_agg(stringu1::text, ',')),
+		array_length(array_agg(unique1), 1) from tenk1;
+select length(string_agg(stringu1::text, ',')),
+	array_length(array_agg(unique1), 1) from tenk1;
+
+-- test removal of duplicates in workers for DISTINCT aggregates
+explain (costs off)
+	select count(distinct hundred) from tenk1;
+select count(distinct hundred) from tenk1;
+explain (costs off)
+	select ten, count(distinct hundred) from tenk1 group by ten;
+select ten, count(distinct hundred) from tenk1 group by ten;
+
+-- not when the aggregate sees the column through an expression, since
+-- values equal under the column's equality might be told apart
+explain (costs off)
+	select count(distinct stringu1::text) from tenk1;
+
 set force_parallel_mode=1;
 
 explain (costs off)
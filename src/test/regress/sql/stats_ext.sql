@@ -0,0 +1,77 @@
+-- Generic extended statistics support
+
+-- We will be checking estimated row counts, so make sure we get simple
+-- non-parallel plans.
+SET max_parallel_workers_per_gather = 0;
+
+-- report the number of estimated rows in the top node of a query's plan
+CREATE FUNCTION check_estimated_rows(text) RETURNS int
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+BEGIN
+    FOR ln IN EXECUTE format('EXPLAIN %s', $1)
+    LOOP
+        RETURN substring(ln FROM 'rows=(\d+)')::int;
+    END LOOP;
+END;
+$$;
+
+-- Verify failures
+CREATE TABLE ext_stats_test (x int, y int, z int, p point);
+CREATE STATISTICS tst ON x FROM ext_stats_test;
+CREATE STATISTICS tst ON x, x FROM ext_stats_test;
+CREATE STATISTICS tst ON x, nonexistent FROM ext_stats_test;
+CREATE STATISTICS tst ON x, ctid FROM ext_stats_test;
+CREATE STATISTICS tst ON x, p FROM ext_stats_test;
+CREATE STATISTICS tst (unrecognized) ON x, y FROM ext_stats_test;
+CREATE STATISTICS tst ON x, y FROM nonexistent;
+
+-- Verify creation, duplicate names and dependencies on the columns
+CREATE STATISTICS tst ON y, x FROM ext_stats_test;
+CREATE STATISTICS tst ON y, z FROM ext_stats_test;
+CREATE STATISTICS IF NOT EXISTS tst ON y, z FROM ext_stats_test;
+CREATE STATISTICS tst_ndistinct (ndistinct) ON x, z FROM ext_stats_test;
+SELECT stxname, stxkeys, stxkind
+  FROM pg_statistic_ext WHERE stxrelid = 'ext_stats_test'::regclass
+ ORDER BY stxname;
+ALTER TABLE ext_stats_test DROP COLUMN y;
+SELECT stxname FROM pg_statistic_ext WHERE stxrelid = 'ext_stats_test'::regclass;
+DROP STATISTICS tst;
+DROP STATISTICS IF EXISTS tst;
+DROP STATISTICS tst_ndistinct;
+DROP TABLE ext_stats_test;
+
+-- Check that the statistics are used for estimates.  The table is small
+-- enough for ANALYZE to read all of it, so the estimates are stable.
+CREATE TABLE ext_stats_corr (a int, b int, c int);
+INSERT INTO ext_stats_corr
+     SELECT i % 100, i % 100, i FROM generate_series(1, 10000) s(i);
+ANALYZE ext_stats_corr;
+
+-- without extended statistics the columns are assumed independent
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 1');
+SELECT check_estimated_rows('SELECT a, b FROM ext_stats_corr GROUP BY a, b');
+
+CREATE STATISTICS ext_stats_corr_abc ON a, b, c FROM ext_stats_corr;
+
+-- not used until ANALYZE has built them
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 1');
+
+ANALYZE ext_stats_corr;
+
+-- functional dependencies
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 1');
+
+-- multi-column ndistinct
+SELECT check_estimated_rows('SELECT a, b FROM ext_stats_corr GROUP BY a, b');
+
+-- dropping the statistics object reverts to the old estimates
+DROP STATISTICS ext_stats_corr_abc;
+SELECT check_estimated_rows('SELECT * FROM ext_stats_corr WHERE a = 1 AND b = 1');
+SELECT check_estimated_rows('SELECT a, b FROM ext_stats_corr GROUP BY a, b');
+
+DROP TABLE ext_stats_corr;
+DROP FUNCTION check_estimated_rows(text);
+RESET max_parallel_workers_per_gather;